@@ -0,0 +1,280 @@
+#ifndef PRIME_FUSION_CBOR_NATIVE_H
+#define PRIME_FUSION_CBOR_NATIVE_H
+
+#include "KeyDispatch.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace pf {
+
+/**
+ * @brief Header-only CBOR (RFC 8949) writer with the same interface as CborSpanWriter.
+ * Every item is a header byte plus a big-endian argument written in place, so
+ * nothing crosses into libcbor.so. The fixed-width calls mirror libcbor's
+ * cbor_encode_uintN/negint64, which keeps the "Native" variant byte-identical
+ * to the libcbor path it is compared against.
+ */
+class NativeCborWriter {
+public:
+    NativeCborWriter(uint8_t* dst, size_t cap) : start_(dst), ptr_(dst), end_(dst + cap) {}
+
+    void map(size_t n) { head(0xa0, n); }
+    void array(size_t n) { head(0x80, n); }
+    void tag(uint64_t t) { head(0xc0, t); }
+
+    // Shortest argument, like cbor_encode_uint
+    void uint(uint64_t v) { head(0x00, v); }
+    void negint(uint64_t v) { head(0x20, v); }
+
+    // Fixed widths, like cbor_encode_uint8..64 (uint8 inlines 0..23)
+    void uint8(uint8_t v) { v < 24 ? put1(v) : fixed(0x18, v, 1); }
+    void uint16(uint16_t v) { fixed(0x19, v, 2); }
+    void uint32(uint32_t v) { fixed(0x1a, v, 4); }
+    void uint64(uint64_t v) { fixed(0x1b, v, 8); }
+    void negint64(uint64_t v) { fixed(0x3b, v, 8); }
+
+    // CBOR negative integers carry -1 - v
+    void sint(int64_t v) {
+        if (v >= 0) uint((uint64_t)v);
+        else negint((uint64_t)(-1 - v));
+    }
+
+    void single(float v) {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        fixed(0xfa, bits, 4);
+    }
+
+    void text(const char* s, size_t len) {
+        head(0x60, len);
+        raw(s, len);
+    }
+
+    void bytes(const uint8_t* b, size_t len) {
+        head(0x40, len);
+        raw(b, len);
+    }
+
+    /**
+     * @brief Bytes written, or 0 if any item did not fit.
+     */
+    size_t result() const { return overflow_ ? 0 : (size_t)(ptr_ - start_); }
+
+private:
+    void put1(uint8_t b) {
+        if (ptr_ == end_) { overflow_ = true; return; }
+        *ptr_++ = b;
+    }
+
+    // Initial byte `ib` followed by the low `width` bytes of v, big-endian.
+    void fixed(uint8_t ib, uint64_t v, int width) {
+        if (end_ - ptr_ < 1 + width) { overflow_ = true; return; }
+        *ptr_++ = ib;
+        for (int shift = 8 * (width - 1); shift >= 0; shift -= 8) *ptr_++ = (uint8_t)(v >> shift);
+    }
+
+    void head(uint8_t major, uint64_t v) {
+        if (v < 24) put1((uint8_t)(major | v));
+        else if (v <= 0xff) fixed(major | 24, v, 1);
+        else if (v <= 0xffff) fixed(major | 25, v, 2);
+        else if (v <= 0xffffffffu) fixed(major | 26, v, 4);
+        else fixed(major | 27, v, 8);
+    }
+
+    void raw(const void* src, size_t len) {
+        if (overflow_ || (size_t)(end_ - ptr_) < len) { overflow_ = true; return; }
+        memcpy(ptr_, src, len);
+        ptr_ += len;
+    }
+
+    uint8_t* start_;
+    uint8_t* ptr_;
+    uint8_t* end_;
+    bool overflow_ = false;
+};
+
+/**
+ * @brief Pull-style CBOR reader over a bounds-checked cursor.
+ * The caller asks for the item it expects next (map header, text key, number)
+ * instead of being called back per item. A type mismatch or truncated input
+ * clears ok() for good; after that every read returns 0 or an empty string, so
+ * a decode loop only needs to check ok() once per key.
+ * Indefinite-length items are not supported and count as failures.
+ */
+class NativeCborReader {
+public:
+    NativeCborReader(const uint8_t* data, size_t len) : ptr_(data), end_(data + len) {}
+
+    bool ok() const { return !failed_; }
+    bool at_end() const { return ptr_ == end_; }
+
+    // Major type (0..7) of the next item, or -1 at the end of the input
+    int peek_major() const { return ptr_ < end_ ? *ptr_ >> 5 : -1; }
+
+    uint64_t map() { return head(5); }
+    uint64_t array() { return head(4); }
+    uint64_t tag() { return head(6); }
+    uint64_t uint() { return head(0); }
+
+    int64_t sint() {
+        switch (peek_major()) {
+            case 0: return (int64_t)head(0);
+            case 1: return -1 - (int64_t)head(1);
+            default: return fail();
+        }
+    }
+
+    // Half, single or double precision; integers are accepted as well.
+    double real() {
+        if (ptr_ >= end_) return fail();
+        switch (*ptr_) {
+            case 0xf9: return half((uint16_t)arg_bytes(2));
+            case 0xfa: {
+                uint32_t bits = (uint32_t)arg_bytes(4);
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                return f;
+            }
+            case 0xfb: {
+                uint64_t bits = arg_bytes(8);
+                double d;
+                memcpy(&d, &bits, sizeof(d));
+                return d;
+            }
+            default: return (double)sint();
+        }
+    }
+
+    // Like real(), but a single-precision item is copied bit for bit (NaN payloads included).
+    float single() {
+        if (ptr_ < end_ && *ptr_ == 0xfa) {
+            uint32_t bits = (uint32_t)arg_bytes(4);
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+        return (float)real();
+    }
+
+    /**
+     * @brief Reads a text (major 3) or byte (major 2) string in place.
+     * @return Pointer into the input, valid as long as the input buffer
+     */
+    const char* text(size_t& len) { return string(3, len); }
+    const uint8_t* bytes(size_t& len) { return (const uint8_t*)string(2, len); }
+
+    /**
+     * @brief Reads a text key and resolves it through `table`.
+     * @return The key's id, or -1 for an unknown key or a key that is not text
+     */
+    template <size_t N>
+    int key(const KeyTable<N>& table) {
+        if (peek_major() != 3) {
+            skip();
+            return -1;
+        }
+        size_t len;
+        const char* k = text(len);
+        return table.find(k, len);
+    }
+
+    /**
+     * @return An unsigned integer key below `limit`, or -1
+     */
+    int int_key(uint64_t limit) {
+        if (peek_major() != 0) {
+            skip();
+            return -1;
+        }
+        uint64_t k = uint();
+        return k < limit ? (int)k : -1;
+    }
+
+    /**
+     * @brief Skips one complete item, containers included.
+     */
+    void skip(int depth = 0) {
+        if (depth > 16) { fail(); return; }
+        int major = peek_major();
+        uint64_t n = head(major);
+        if (failed_) return;
+        switch (major) {
+            case 2:
+            case 3: advance(n); break;
+            case 4: for (uint64_t i = 0; i < n && !failed_; i++) skip(depth + 1); break;
+            case 5: for (uint64_t i = 0; i < 2 * n && !failed_; i++) skip(depth + 1); break;
+            case 6: skip(depth + 1); break; // Tag: skip the tagged item
+            default: break;                 // Integers, floats and simple values carry no payload
+        }
+    }
+
+private:
+    uint64_t fail() {
+        failed_ = true;
+        ptr_ = end_;
+        return 0;
+    }
+
+    void advance(uint64_t n) {
+        if ((uint64_t)(end_ - ptr_) < n) fail();
+        else ptr_ += n;
+    }
+
+    // Reads the initial byte and returns its argument.
+    uint64_t head(int major) {
+        if (ptr_ >= end_ || (*ptr_ >> 5) != major) return fail();
+        uint8_t info = *ptr_ & 0x1f;
+        if (info < 24) {
+            ptr_++;
+            return info;
+        }
+        switch (info) {
+            case 24: return arg_bytes(1);
+            case 25: return arg_bytes(2);
+            case 26: return arg_bytes(4);
+            case 27: return arg_bytes(8);
+            default: return fail(); // Reserved or indefinite length
+        }
+    }
+
+    // Skips the initial byte and reads `width` argument bytes, big-endian.
+    uint64_t arg_bytes(int width) {
+        if (end_ - ptr_ < 1 + width) return fail();
+        ptr_++;
+        uint64_t v = 0;
+        for (int i = 0; i < width; i++) v = v << 8 | *ptr_++;
+        return v;
+    }
+
+    const char* string(int major, size_t& len) {
+        uint64_t n = head(major);
+        if (failed_ || (uint64_t)(end_ - ptr_) < n) {
+            fail();
+            len = 0;
+            return "";
+        }
+        const char* s = (const char*)ptr_;
+        ptr_ += n;
+        len = (size_t)n;
+        return s;
+    }
+
+    static double half(uint16_t h) {
+        int exp = (h >> 10) & 0x1f;
+        int mant = h & 0x3ff;
+        double v;
+        if (exp == 0) v = mant * (1.0 / (1 << 24));
+        else if (exp != 31) v = (mant + 1024) * ((double)(1ull << exp) / (1ull << 25));
+        else v = mant == 0 ? __builtin_inf() : __builtin_nan("");
+        return (h & 0x8000) ? -v : v;
+    }
+
+    const uint8_t* ptr_;
+    const uint8_t* end_;
+    bool failed_ = false;
+};
+
+} // namespace pf
+
+#endif // PRIME_FUSION_CBOR_NATIVE_H
@@ -0,0 +1,447 @@
+#ifndef PRIME_FUSION_CBOR_SCHEMA_CODEC_H
+#define PRIME_FUSION_CBOR_SCHEMA_CODEC_H
+
+#include "SchemaCodec.h"
+#include "ColumnarBlock.h"
+#include "cbor_native.h"
+#include "cbor_span_writer.h"
+#include <cbor.h>
+#include <vector>
+
+namespace pf {
+
+template <typename Out> void write_cbor_number(Out& out, uint8_t v) { out.uint(v); }
+template <typename Out> void write_cbor_number(Out& out, uint16_t v) { out.uint(v); }
+template <typename Out> void write_cbor_number(Out& out, uint32_t v) { out.uint(v); }
+template <typename Out> void write_cbor_number(Out& out, uint64_t v) { out.uint(v); }
+template <typename Out> void write_cbor_number(Out& out, int8_t v) { out.sint(v); }
+template <typename Out> void write_cbor_number(Out& out, int16_t v) { out.sint(v); }
+template <typename Out> void write_cbor_number(Out& out, int32_t v) { out.sint(v); }
+template <typename Out> void write_cbor_number(Out& out, int64_t v) { out.sint(v); }
+template <typename Out> void write_cbor_number(Out& out, float v) { out.single(v); }
+
+/**
+ * @brief Encodes T as a definite-length map keyed by name, short name or integer key.
+ * BYTES fields become byte strings, CHARS text strings, numeric arrays arrays.
+ */
+template <KeyStyle Style, typename T, typename Out>
+void write_cbor_schema(Out& out, const T& m) {
+    out.map(schema_size<T>());
+    for_each_field<T>([&](auto i) {
+        constexpr const FieldDesc& d = PayloadSchema<T>::fields[decltype(i)::value];
+        if constexpr (Style == KeyStyle::Int) {
+            out.uint((uint64_t)d.key);
+        } else {
+            constexpr const char* key = schema_key(d, Style);
+            out.text(key, key_length(key));
+        }
+
+        const auto* p = field_ptr<d.type>(m, d);
+        if constexpr (d.type == FieldType::BYTES) {
+            out.bytes(p, d.count);
+        } else if constexpr (d.type == FieldType::CHARS) {
+            out.text(p, strnlen(p, d.count));
+        } else if constexpr (d.count == 1) {
+            write_cbor_number(out, *p);
+        } else {
+            out.array(d.count);
+            for (size_t k = 0; k < d.count; k++) write_cbor_number(out, p[k]);
+        }
+    });
+}
+
+template <KeyStyle Style, typename T, typename Out>
+void write_cbor_schema_records(Out& out, const std::vector<T>& records) {
+    out.array(records.size());
+    for (const T& r : records) write_cbor_schema<Style>(out, r);
+}
+
+// Largest encoding of one value, header included.
+constexpr size_t cbor_number_bound(FieldType type) {
+    switch (type) {
+        case FieldType::U8:
+        case FieldType::I8: return 2;
+        case FieldType::U16:
+        case FieldType::I16: return 3;
+        case FieldType::U64:
+        case FieldType::I64: return 9;
+        default: return 5; // 32-bit ints, float32
+    }
+}
+
+/**
+ * @brief Worst-case size of write_cbor_schema<Style>(T), from the schema alone.
+ */
+template <typename T, KeyStyle Style>
+constexpr size_t cbor_schema_max_size() {
+    size_t n = 9; // map header
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const FieldDesc& d = PayloadSchema<T>::fields[i];
+        n += (Style == KeyStyle::Int) ? 9 : 9 + key_length(schema_key(d, Style));
+        if (d.type == FieldType::BYTES || d.type == FieldType::CHARS) n += 9 + d.count;
+        else if (d.count == 1) n += cbor_number_bound(d.type);
+        else n += 9 + d.count * cbor_number_bound(d.type);
+    }
+    return n;
+}
+
+/**
+ * @brief cbor_stream_decode callbacks that fill T, or one record of T per map.
+ * CBOR callbacks do not say where an item sits, so the decoder keeps a fixed
+ * stack of open containers with the items each still expects. In a record map
+ * an even count left means the next item is a key. Values of unknown keys,
+ * nested containers included, are counted off and skipped. Nothing allocates
+ * except `records` growing past its capacity, and the outer array header
+ * reserves that up front.
+ */
+template <typename T, KeyStyle Style>
+struct CborSchemaDecoder {
+    static constexpr int kMaxDepth = 8;
+
+    struct Frame {
+        uint64_t left; // Items still expected; a map of n pairs expects 2n
+        bool map;
+    };
+
+    T* m = nullptr;
+    std::vector<T>* records = nullptr; // Set when decoding an array of records
+    Frame stack[kMaxDepth];
+    int depth = 0;
+    int record_depth = 1; // Depth of a record's map once it is open
+    int field = -1;
+    size_t elem = 0;
+    size_t input_len = 0;
+    bool failed = false;
+
+    explicit CborSchemaDecoder(T* out) : m(out) {}
+    explicit CborSchemaDecoder(std::vector<T>* out) : records(out), record_depth(2) {}
+
+    bool at_key() const { return depth == record_depth && stack[depth - 1].map && stack[depth - 1].left % 2 == 0; }
+    bool at_value() const { return depth == record_depth && stack[depth - 1].map && stack[depth - 1].left % 2 == 1; }
+    bool in_value_array() const { return depth == record_depth + 1 && !stack[depth - 1].map; }
+
+    // One item finished; closes every container it completes.
+    void item_done() {
+        while (depth > 0) {
+            if (--stack[depth - 1].left > 0) return;
+            depth--;
+        }
+    }
+
+    void open(uint64_t items, bool map) {
+        if (items == 0) {
+            item_done();
+        } else if (depth == kMaxDepth) {
+            failed = true;
+        } else {
+            stack[depth++] = Frame{items, map};
+        }
+    }
+
+    void key(int f) {
+        field = f;
+        elem = 0;
+    }
+
+    template <typename V>
+    void number(V v) {
+        if (at_value() || in_value_array()) {
+            if (field >= 0) store_number(*m, PayloadSchema<T>::fields[field], elem++, v);
+        } else if (at_key()) {
+            if constexpr (Style == KeyStyle::Int) {
+                key(v >= 0 ? schema_find<T>((uint64_t)v) : -1);
+            } else {
+                key(-1);
+            }
+        }
+        item_done();
+    }
+
+    void text(const void* data, size_t len, bool is_text) {
+        if (at_value()) {
+            if (field >= 0) store_bytes(*m, PayloadSchema<T>::fields[field], data, len);
+        } else if (at_key()) {
+            if constexpr (Style != KeyStyle::Int) {
+                key(is_text ? schema_find<T, Style>((const char*)data, len) : -1);
+            } else {
+                key(-1);
+            }
+        }
+        item_done();
+    }
+
+    static CborSchemaDecoder* self(void* ctx) { return (CborSchemaDecoder*)ctx; }
+
+    static void on_uint8(void* ctx, uint8_t v) { self(ctx)->number((uint64_t)v); }
+    static void on_uint16(void* ctx, uint16_t v) { self(ctx)->number((uint64_t)v); }
+    static void on_uint32(void* ctx, uint32_t v) { self(ctx)->number((uint64_t)v); }
+    static void on_uint64(void* ctx, uint64_t v) { self(ctx)->number(v); }
+
+    // CBOR negative integers carry -1 - v
+    static void on_negint8(void* ctx, uint8_t v) { self(ctx)->number(-1 - (int64_t)v); }
+    static void on_negint16(void* ctx, uint16_t v) { self(ctx)->number(-1 - (int64_t)v); }
+    static void on_negint32(void* ctx, uint32_t v) { self(ctx)->number(-1 - (int64_t)v); }
+    static void on_negint64(void* ctx, uint64_t v) { self(ctx)->number(-1 - (int64_t)v); }
+
+    static void on_float(void* ctx, float v) { self(ctx)->number(v); }
+    static void on_double(void* ctx, double v) { self(ctx)->number(v); }
+    static void on_simple(void* ctx) { self(ctx)->item_done(); } // null, undefined
+    static void on_bool(void* ctx, bool) { self(ctx)->item_done(); }
+
+    static void on_string(void* ctx, cbor_data data, size_t len) { self(ctx)->text(data, len, true); }
+    static void on_byte_string(void* ctx, cbor_data data, size_t len) { self(ctx)->text(data, len, false); }
+
+    static void on_array_start(void* ctx, size_t n) {
+        CborSchemaDecoder* c = self(ctx);
+        // Every record takes at least one byte, which bounds a corrupt header.
+        if (c->records && c->depth == 0) c->records->reserve(n < c->input_len ? n : c->input_len);
+        c->open(n, false);
+    }
+
+    static void on_map_start(void* ctx, size_t n) {
+        CborSchemaDecoder* c = self(ctx);
+        if (c->records && c->depth == c->record_depth - 1) {
+            c->records->emplace_back();
+            c->m = &c->records->back();
+        }
+        c->open(2 * n, true);
+    }
+
+    // Tags wrap the next item, which reports itself.
+    static void on_tag(void*, uint64_t) {}
+
+    // Indefinite-length items are never produced by the schema encoders.
+    static void on_indef(void* ctx) { self(ctx)->failed = true; }
+
+    static struct cbor_callbacks callbacks() {
+        struct cbor_callbacks cb = cbor_empty_callbacks;
+        cb.uint8 = on_uint8;
+        cb.uint16 = on_uint16;
+        cb.uint32 = on_uint32;
+        cb.uint64 = on_uint64;
+        cb.negint8 = on_negint8;
+        cb.negint16 = on_negint16;
+        cb.negint32 = on_negint32;
+        cb.negint64 = on_negint64;
+        cb.float2 = on_float;
+        cb.float4 = on_float;
+        cb.float8 = on_double;
+        cb.null = on_simple;
+        cb.undefined = on_simple;
+        cb.boolean = on_bool;
+        cb.string = on_string;
+        cb.byte_string = on_byte_string;
+        cb.array_start = on_array_start;
+        cb.map_start = on_map_start;
+        cb.tag = on_tag;
+        cb.string_start = on_indef;
+        cb.byte_string_start = on_indef;
+        cb.indef_array_start = on_indef;
+        cb.indef_map_start = on_indef;
+        return cb;
+    }
+
+    /**
+     * @brief Decodes one top-level item.
+     * @return false on malformed or truncated input, or nesting past kMaxDepth
+     */
+    bool run(const uint8_t* data, size_t len) {
+        static const struct cbor_callbacks cb = callbacks();
+        input_len = len;
+        size_t offset = 0;
+        do {
+            struct cbor_decoder_result res = cbor_stream_decode(data + offset, len - offset, &cb, this);
+            if (res.status != CBOR_DECODER_FINISHED || res.read == 0) return false;
+            offset += res.read;
+        } while (depth > 0 && !failed && offset < len);
+        return depth == 0 && !failed;
+    }
+};
+
+template <KeyStyle Style, typename T>
+bool read_cbor_schema(const uint8_t* data, size_t len, T& m) {
+    CborSchemaDecoder<T, Style> decoder(&m);
+    return decoder.run(data, len);
+}
+
+/**
+ * @brief Decodes an array of maps into `records`, replacing its contents.
+ * The vector keeps its capacity, so steady-state decodes do not reallocate.
+ */
+template <KeyStyle Style, typename T>
+bool read_cbor_schema_records(const uint8_t* data, size_t len, std::vector<T>& records) {
+    records.clear();
+    CborSchemaDecoder<T, Style> decoder(&records);
+    return decoder.run(data, len);
+}
+
+// --- Native (pull) decode, see cbor_native.h ---
+
+template <typename T>
+void read_native_number(NativeCborReader& in, T& m, const FieldDesc& d, size_t index) {
+    switch (in.peek_major()) {
+        case 0: store_number(m, d, index, in.uint()); break;
+        case 1: store_number(m, d, index, in.sint()); break;
+        case 7:
+            if (d.type == FieldType::F32) store_number(m, d, index, in.single());
+            else store_number(m, d, index, in.real());
+            break;
+        default: in.skip(); break;
+    }
+}
+
+template <typename T>
+void read_native_value(NativeCborReader& in, T& m, const FieldDesc& d) {
+    size_t len;
+    switch (in.peek_major()) {
+        case 2: {
+            const uint8_t* b = in.bytes(len);
+            store_bytes(m, d, b, len);
+            break;
+        }
+        case 3: {
+            const char* s = in.text(len);
+            store_bytes(m, d, s, len);
+            break;
+        }
+        case 4: {
+            uint64_t n = in.array();
+            for (uint64_t k = 0; k < n && in.ok(); k++) read_native_number(in, m, d, k);
+            break;
+        }
+        default: read_native_number(in, m, d, 0); break;
+    }
+}
+
+template <KeyStyle Style, typename T>
+int read_native_key(NativeCborReader& in) {
+    if constexpr (Style == KeyStyle::Int) {
+        if (in.peek_major() == 0) return schema_find<T>(in.uint());
+    } else if (in.peek_major() == 3) {
+        size_t len;
+        const char* key = in.text(len);
+        return schema_find<T, Style>(key, len);
+    }
+    in.skip();
+    return -1;
+}
+
+template <KeyStyle Style, typename T>
+void read_native_map(NativeCborReader& in, T& m) {
+    uint64_t pairs = in.map();
+    for (uint64_t i = 0; i < pairs && in.ok(); i++) {
+        int f = read_native_key<Style, T>(in);
+        if (f < 0) in.skip();
+        else read_native_value(in, m, PayloadSchema<T>::fields[f]);
+    }
+}
+
+/**
+ * @brief Same result as read_cbor_schema, through NativeCborReader instead of libcbor.
+ */
+template <KeyStyle Style, typename T>
+bool read_cbor_schema_native(const uint8_t* data, size_t len, T& m) {
+    NativeCborReader in(data, len);
+    read_native_map<Style>(in, m);
+    return in.ok();
+}
+
+template <KeyStyle Style, typename T>
+bool read_cbor_schema_records_native(const uint8_t* data, size_t len, std::vector<T>& records) {
+    records.clear();
+    NativeCborReader in(data, len);
+    uint64_t n = in.array();
+    records.reserve(n < len ? n : len);
+    for (uint64_t i = 0; i < n && in.ok(); i++) {
+        records.emplace_back();
+        read_native_map<Style>(in, records.back());
+    }
+    return in.ok();
+}
+
+// --- Columnar blocks, see ColumnarBlock.h ---
+
+/**
+ * @brief Worst-case size of write_cbor_columns for `records` records.
+ */
+template <typename T>
+inline size_t cbor_columns_max_size(size_t records) {
+    size_t n = 9 + (1 + key_length(kColumnCountKey)) + 9;
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const FieldDesc& d = PayloadSchema<T>::fields[i];
+        n += 9 + key_length(d.short_name) + 9;
+        n += d.type == FieldType::BYTES ? records * d.count : delta_column_bound(records);
+    }
+    return n;
+}
+
+/**
+ * @brief Writes `records` as {"n": count, <short name>: column bytes, ...}.
+ * Each column is built in `scratch` (grown once, then reused) and copied out
+ * as one byte string.
+ */
+template <typename T, typename Out>
+void write_cbor_columns(Out& out, const std::vector<T>& records, std::vector<uint8_t>& scratch) {
+    static_assert(schema_is_columnar<T>(), "Columnar blocks need integer and BYTES fields only");
+    size_t need = column_scratch_size<T>(records.size());
+    if (scratch.size() < need) scratch.resize(need);
+
+    out.map(1 + schema_size<T>());
+    out.text(kColumnCountKey, key_length(kColumnCountKey));
+    out.uint(records.size());
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const char* key = PayloadSchema<T>::fields[i].short_name;
+        out.text(key, key_length(key));
+        out.bytes(scratch.data(), write_column(records, i, scratch.data()));
+    }
+}
+
+/**
+ * @brief Decodes a write_cbor_columns block into `records`, resized to its count.
+ * The count must precede the columns. Unknown keys are skipped; a column that
+ * does not hold exactly one value per record fails the decode. A failed
+ * decode leaves `records` empty, never a partly filled block.
+ */
+template <typename T>
+bool read_cbor_columns(const uint8_t* data, size_t len, std::vector<T>& records) {
+    NativeCborReader in(data, len);
+    uint64_t pairs = in.map();
+    bool sized = false;
+    for (uint64_t i = 0; i < pairs && in.ok(); i++) {
+        if (in.peek_major() != 3) {
+            in.skip();
+            in.skip();
+            continue;
+        }
+        size_t klen;
+        const char* key = in.text(klen);
+        if (klen == key_length(kColumnCountKey) && memcmp(key, kColumnCountKey, klen) == 0) {
+            uint64_t n = in.uint();
+            if (n > len) { // Every record takes at least a byte per column
+                sized = false;
+                break;
+            }
+            records.resize(n);
+            sized = true;
+            continue;
+        }
+        int f = schema_find<T, KeyStyle::ShortName>(key, klen);
+        if (f < 0 || in.peek_major() != 2) {
+            in.skip();
+            continue;
+        }
+        size_t blen;
+        const uint8_t* column = in.bytes(blen);
+        if (!in.ok() || !sized || !read_column(column, blen, f, records)) {
+            sized = false;
+            break;
+        }
+    }
+    if (in.ok() && sized) return true;
+    records.clear();
+    return false;
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_CBOR_SCHEMA_CODEC_H
@@ -0,0 +1,78 @@
+#ifndef PRIME_FUSION_CBOR_SPAN_WRITER_H
+#define PRIME_FUSION_CBOR_SPAN_WRITER_H
+
+#include <cbor.h>
+#include <cstdint>
+#include <cstring>
+
+namespace pf {
+
+/**
+ * @brief Appends CBOR items to caller-owned memory through libcbor's encoders.
+ * libcbor returns 0 when an item does not fit; that is latched and reported
+ * via result(), like SpanStream/SpanBuffer in the other formats.
+ * NativeCborWriter (cbor_native.h) has the same interface, so encoders written
+ * as templates over the writer run on either.
+ */
+class CborSpanWriter {
+public:
+    CborSpanWriter(uint8_t* dst, size_t cap) : start_(dst), ptr_(dst), left_(cap) {}
+
+    void map(size_t n) { advance(cbor_encode_map_start(n, ptr_, left_)); }
+    void array(size_t n) { advance(cbor_encode_array_start(n, ptr_, left_)); }
+    void tag(uint64_t t) { advance(cbor_encode_tag(t, ptr_, left_)); }
+    void uint(uint64_t v) { advance(cbor_encode_uint(v, ptr_, left_)); }
+    void negint(uint64_t v) { advance(cbor_encode_negint(v, ptr_, left_)); }
+
+    void uint8(uint8_t v) { advance(cbor_encode_uint8(v, ptr_, left_)); }
+    void uint16(uint16_t v) { advance(cbor_encode_uint16(v, ptr_, left_)); }
+    void uint32(uint32_t v) { advance(cbor_encode_uint32(v, ptr_, left_)); }
+    void uint64(uint64_t v) { advance(cbor_encode_uint64(v, ptr_, left_)); }
+    void negint64(uint64_t v) { advance(cbor_encode_negint64(v, ptr_, left_)); }
+
+    // CBOR negative integers carry -1 - v
+    void sint(int64_t v) {
+        if (v >= 0) uint((uint64_t)v);
+        else negint((uint64_t)(-1 - v));
+    }
+
+    void single(float v) { advance(cbor_encode_single(v, ptr_, left_)); }
+
+    void text(const char* s, size_t len) {
+        advance(cbor_encode_string_start(len, ptr_, left_));
+        raw(s, len);
+    }
+
+    void bytes(const uint8_t* b, size_t len) {
+        advance(cbor_encode_bytestring_start(len, ptr_, left_));
+        raw(b, len);
+    }
+
+    /**
+     * @brief Bytes written, or 0 if any item did not fit.
+     */
+    size_t result() const { return overflow_ ? 0 : (size_t)(ptr_ - start_); }
+
+private:
+    void advance(size_t n) {
+        if (n == 0) overflow_ = true;
+        ptr_ += n;
+        left_ -= n;
+    }
+
+    void raw(const void* src, size_t len) {
+        if (overflow_ || len > left_) { overflow_ = true; return; }
+        memcpy(ptr_, src, len);
+        ptr_ += len;
+        left_ -= len;
+    }
+
+    uint8_t* start_;
+    uint8_t* ptr_;
+    size_t left_;
+    bool overflow_ = false;
+};
+
+} // namespace pf
+
+#endif // PRIME_FUSION_CBOR_SPAN_WRITER_H
@@ -0,0 +1,67 @@
+#ifndef PRIME_FUSION_CBOR_TYPED_ARRAY_H
+#define PRIME_FUSION_CBOR_TYPED_ARRAY_H
+
+#include "cbor_native.h"
+#include <cstdint>
+#include <cstring>
+
+namespace pf {
+
+// The "TypedArrays" variants move whole numeric arrays as one memcpy, which
+// is only the RFC 8746 little-endian layout on a little-endian host.
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+              "cbor_typed_array.h copies host memory as little-endian typed arrays");
+
+/**
+ * @brief RFC 8746 tag for a little-endian typed array of T.
+ */
+template <typename T> struct CborTypedArrayTag;
+template <> struct CborTypedArrayTag<uint16_t> { static constexpr uint64_t value = 69; };
+template <> struct CborTypedArrayTag<float> { static constexpr uint64_t value = 85; };
+
+/**
+ * @brief Writes vals[0..count) as tag + byte string (RFC 8746, little-endian).
+ * One memcpy replaces `count` individually encoded items. Out is either
+ * CborSpanWriter or NativeCborWriter.
+ */
+template <typename Out, typename T>
+void write_typed_array(Out& out, const T* vals, size_t count) {
+    out.tag(CborTypedArrayTag<T>::value);
+    out.bytes((const uint8_t*)vals, count * sizeof(T));
+}
+
+/**
+ * @brief Copies a typed-array byte string into dst[0..count).
+ * @return false (dst untouched) if the tag is not T's or the length is not exactly count elements
+ */
+template <typename T>
+bool load_typed_array(uint64_t tag, const uint8_t* src, size_t len, T* dst, size_t count) {
+    if (tag != CborTypedArrayTag<T>::value || len != count * sizeof(T)) return false;
+    memcpy(dst, src, len);
+    return true;
+}
+
+/**
+ * @brief Pull decode of a numeric array value in either form: an RFC 8746
+ * typed array or a plain CBOR array (read element by element with `read_one`).
+ * Elements past `count` are read and dropped.
+ */
+template <typename T, typename ReadOne>
+void read_numeric_array(NativeCborReader& in, T* dst, size_t count, ReadOne&& read_one) {
+    if (in.peek_major() == 6) {
+        uint64_t tag = in.tag();
+        size_t len;
+        const uint8_t* b = in.bytes(len);
+        load_typed_array(tag, b, len, dst, count);
+        return;
+    }
+    uint64_t n = in.array();
+    for (uint64_t i = 0; i < n && in.ok(); i++) {
+        T v = read_one(in);
+        if (i < count) dst[i] = v;
+    }
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_CBOR_TYPED_ARRAY_H
@@ -1,4 +1,7 @@
 #include "IBenchmark.h"
+#include "KeyDispatch.h"
+#include "cbor_native.h"
+#include "cbor_span_writer.h"
 #include <cbor.h>
 #include <iostream>
 #include <vector>
@@ -19,10 +22,12 @@ class CborBenchmark : public IBenchmark {
 public:
     enum Variant { STANDARD, STRING_KEYS };
     Variant variant_ = STANDARD;
+    bool native_ = false; // "Native*" variants encode and decode through cbor_native.h instead of libcbor
 
     void setup(const BenchmarkConfig& config) override {
-        if (config.variant_name == "StringKeys") variant_ = STRING_KEYS;
+        if (config.variant_name == "StringKeys" || config.variant_name == "NativeStringKeys") variant_ = STRING_KEYS;
         else variant_ = STANDARD;
+        native_ = config.variant_name.compare(0, 6, "Native") == 0;
         std::cout << "[CBOR] Setup complete. Variant: " << config.variant_name << std::endl;
 
         // --- Integrity Verification ---
@@ -48,67 +53,46 @@ public:
         }
     }
 
+    // Map header + 18 keys (<= 18 chars) + 17 ints (<= 9 bytes) + 32-byte hash
+    static constexpr size_t kMaxEncodedSize = 1 + 18 * (1 + 18) + 17 * 9 + (2 + 32);
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
-        const Payload& m = *static_cast<const Payload*>(data);
         // High-Performance Streaming Implementation (Stack-based, No Malloc)
-        unsigned char buffer[2048]; // Sufficient for 18 fields
-        unsigned char* ptr = buffer;
-        size_t buffer_size = sizeof(buffer);
-        size_t n;
+        unsigned char buffer[kMaxEncodedSize];
+        size_t n = encode_into(data, buffer, sizeof(buffer));
+        return std::vector<uint8_t>(buffer, buffer + n);
+    }
 
-        // Encode Map Header (18 items)
-        n = cbor_encode_map_start(18, ptr, buffer_size);
-        ptr += n; buffer_size -= n;
-
-        // Helper: Encode Text String (optimized with explicit length)
-        auto encode_string_len = [&](const char* str, size_t len) {
-            size_t n = cbor_encode_string_start(len, ptr, buffer_size);
-            ptr += n; buffer_size -= n;
-            memcpy(ptr, str, len);
-            ptr += len; buffer_size -= len;
-        };
-        
-        // Helper: Encode Byte String
-        auto encode_bytes = [&](const uint8_t* data, size_t len) {
-            size_t n = cbor_encode_bytestring_start(len, ptr, buffer_size);
-            ptr += n; buffer_size -= n;
-            memcpy(ptr, data, len);
-            ptr += len; buffer_size -= len;
-        };
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const Payload& m = *static_cast<const Payload*>(data);
+        if (cap < kMaxEncodedSize) return 0;
+        if (native_) {
+            NativeCborWriter out(dst, cap);
+            write_payload(out, m);
+            return out.result();
+        }
+        CborSpanWriter out(dst, cap);
+        write_payload(out, m);
+        return out.result();
+    }
 
-        // Helper: Encode Adaptive Integer (Size Optimization)
-        auto encode_uint = [&](uint64_t val) {
-            if (val <= 23) {
-                // Inline tiny int (0-23)
-                size_t n = cbor_encode_uint8((uint8_t)val, ptr, buffer_size); 
-                ptr += n; buffer_size -= n;
-            } else if (val <= 0xFF) {
-                size_t n = cbor_encode_uint8((uint8_t)val, ptr, buffer_size);
-                ptr += n; buffer_size -= n;
-            } else if (val <= 0xFFFF) {
-                size_t n = cbor_encode_uint16((uint16_t)val, ptr, buffer_size);
-                ptr += n; buffer_size -= n;
-            } else if (val <= 0xFFFFFFFF) {
-                size_t n = cbor_encode_uint32((uint32_t)val, ptr, buffer_size);
-                ptr += n; buffer_size -= n;
-            } else {
-                size_t n = cbor_encode_uint64(val, ptr, buffer_size);
-                ptr += n; buffer_size -= n;
-            }
-        };
+    // Values take the shortest encoding (uint); integer keys are single bytes (uint8).
+    template <typename Out>
+    void write_payload(Out& out, const Payload& m) {
+        // Encode Map Header (18 items)
+        out.map(18);
 
         // Helper Lambda for K/V pair
-        // Note: We use cbor_encode_uint8 for keys to ensure 1-byte encoding (manual optimization)
         auto encode_pair = [&](uint8_t key, uint64_t val) {
-            size_t k_len = cbor_encode_uint8(key, ptr, buffer_size);
-            ptr += k_len; buffer_size -= k_len;
-            
-            encode_uint(val); // Adaptive value
+            out.uint8(key);
+            out.uint(val);
         };
 
         auto encode_str_pair = [&](const char* key, size_t key_len, uint64_t val) {
-             encode_string_len(key, key_len);
-             encode_uint(val);
+            out.text(key, key_len);
+            out.uint(val);
         };
 
         if (variant_ == STRING_KEYS) {
@@ -117,8 +101,8 @@ public:
             encode_str_pair("block_number", 12, m.block_number);
             
             // Hash ByteString
-            encode_string_len("hash", 4);
-            encode_bytes(m.hash, 32);
+            out.text("hash", 4);
+            out.bytes(m.hash, 32);
 
             encode_str_pair("time_usec", 9, m.time_usec);
             encode_str_pair("fix_type", 8, m.fix_type);
@@ -142,8 +126,8 @@ public:
             encode_pair(1, m.block_number);
             
             // Hash (Key 2)
-            n = cbor_encode_uint8(2, ptr, buffer_size); ptr += n; buffer_size -= n;
-            encode_bytes(m.hash, 32);
+            out.uint8(2);
+            out.bytes(m.hash, 32);
             
             encode_pair(3, m.time_usec);
             encode_pair(4, m.fix_type);
@@ -161,24 +145,38 @@ public:
             encode_pair(16, m.vel_acc);
             encode_pair(17, m.hdg_acc);
         }
-
-        return std::vector<uint8_t>(buffer, ptr);
     }
 
+    // String keys resolve to the Standard variant's integer keys, so both key
+    // styles share the value switch in handle_int_value.
+    static constexpr KeyEntry kKeys[] = {
+        {"timestamp", 0}, {"block_number", 1}, {"hash", 2}, {"time_usec", 3}, {"fix_type", 4},
+        {"lat", 5}, {"lon", 6}, {"alt", 7}, {"eph", 8}, {"epv", 9}, {"vel", 10}, {"cog", 11},
+        {"satellites_visible", 12}, {"alt_ellipsoid", 13}, {"h_acc", 14}, {"v_acc", 15},
+        {"vel_acc", 16}, {"hdg_acc", 17},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
     // --- Streaming Decoder Context & Callbacks ---
     struct DecodeContext {
         Payload* m;
         Variant variant;
-        std::string current_key_str;
-        int64_t current_key_int = -1;
+        FieldProjection want;
+        int field = -1; // Resolved key of the pending value, -1 if unknown or not wanted
         bool waiting_for_value = false; // Next item is a value
+
+        DecodeContext(Payload* p, Variant v, FieldMask fields) : m(p), variant(v), want(fields, 18) {}
+
+        void set_key(int key) {
+            field = want.wants(key) ? key : -1;
+            waiting_for_value = true;
+        }
     };
 
     static void on_string(void* ctx, cbor_data data, size_t len) {
         DecodeContext* c = (DecodeContext*)ctx;
         if (!c->waiting_for_value) {
-            c->current_key_str.assign((const char*)data, len);
-            c->waiting_for_value = true;
+            c->set_key((c->variant == STRING_KEYS) ? kFields.find((const char*)data, len) : -1);
         } else {
             // No string values in Payload, ignore or handle if needed
         }
@@ -187,10 +185,10 @@ public:
     static void on_byte_string(void* ctx, cbor_data data, size_t len) {
         DecodeContext* c = (DecodeContext*)ctx;
         if (c->waiting_for_value) {
-             // Only 'hash' or int key 2 is bytes
-             if ((c->variant == STRING_KEYS && c->current_key_str == "hash") || 
-                 (c->variant == STANDARD && c->current_key_int == 2)) {
-                 if (len == 32) memcpy(c->m->hash, data, 32);
+             // Only 'hash' (key 2) is bytes; an unwanted hash is never copied
+             if (c->field == 2 && len == 32) {
+                 memcpy(c->m->hash, data, 32);
+                 c->want.found(2);
              }
              c->waiting_for_value = false;
         }
@@ -199,54 +197,32 @@ public:
     static void handle_int_value(DecodeContext* c, uint64_t val) {
         if (!c->waiting_for_value) {
             // It's a key (Integer Variant)
-            c->current_key_int = val;
-            c->waiting_for_value = true;
+            c->set_key((c->variant == STANDARD && val <= 17) ? (int)val : -1);
             return;
         }
 
-        // It's a value, assign based on key
-        if (c->variant == STRING_KEYS) {
-            const std::string& k = c->current_key_str;
-            if (k == "timestamp") c->m->timestamp = val;
-            else if (k == "block_number") c->m->block_number = val;
-            else if (k == "time_usec") c->m->time_usec = val;
-            else if (k == "fix_type") c->m->fix_type = val;
-            else if (k == "lat") c->m->lat = (int32_t)val;
-            else if (k == "lon") c->m->lon = (int32_t)val;
-            else if (k == "alt") c->m->alt = (int32_t)val;
-            else if (k == "eph") c->m->eph = val;
-            else if (k == "epv") c->m->epv = val;
-            else if (k == "vel") c->m->vel = val;
-            else if (k == "cog") c->m->cog = val;
-            else if (k == "satellites_visible") c->m->satellites_visible = (uint8_t)val;
-            else if (k == "alt_ellipsoid") c->m->alt_ellipsoid = (int32_t)val;
-            else if (k == "h_acc") c->m->h_acc = (uint32_t)val;
-            else if (k == "v_acc") c->m->v_acc = (uint32_t)val;
-            else if (k == "vel_acc") c->m->vel_acc = (uint32_t)val;
-            else if (k == "hdg_acc") c->m->hdg_acc = (uint32_t)val;
-        } else {
-            // Integer Keys
-            switch(c->current_key_int) {
-                case 0: c->m->timestamp = val; break;
-                case 1: c->m->block_number = (uint32_t)val; break;
-                // case 2 is hash (bytes), handled in on_byte_string
-                case 3: c->m->time_usec = val; break;
-                case 4: c->m->fix_type = (uint8_t)val; break;
-                case 5: c->m->lat = (int32_t)val; break;
-                case 6: c->m->lon = (int32_t)val; break;
-                case 7: c->m->alt = (int32_t)val; break;
-                case 8: c->m->eph = (uint16_t)val; break;
-                case 9: c->m->epv = (uint16_t)val; break;
-                case 10: c->m->vel = (uint16_t)val; break;
-                case 11: c->m->cog = (uint16_t)val; break;
-                case 12: c->m->satellites_visible = (uint8_t)val; break;
-                case 13: c->m->alt_ellipsoid = (int32_t)val; break;
-                case 14: c->m->h_acc = (uint32_t)val; break;
-                case 15: c->m->v_acc = (uint32_t)val; break;
-                case 16: c->m->vel_acc = (uint32_t)val; break;
-                case 17: c->m->hdg_acc = (uint32_t)val; break;
-            }
+        // It's a value, assign based on the resolved key
+        switch(c->field) {
+            case 0: c->m->timestamp = val; break;
+            case 1: c->m->block_number = (uint32_t)val; break;
+            // case 2 is hash (bytes), handled in on_byte_string
+            case 3: c->m->time_usec = val; break;
+            case 4: c->m->fix_type = (uint8_t)val; break;
+            case 5: c->m->lat = (int32_t)val; break;
+            case 6: c->m->lon = (int32_t)val; break;
+            case 7: c->m->alt = (int32_t)val; break;
+            case 8: c->m->eph = (uint16_t)val; break;
+            case 9: c->m->epv = (uint16_t)val; break;
+            case 10: c->m->vel = (uint16_t)val; break;
+            case 11: c->m->cog = (uint16_t)val; break;
+            case 12: c->m->satellites_visible = (uint8_t)val; break;
+            case 13: c->m->alt_ellipsoid = (int32_t)val; break;
+            case 14: c->m->h_acc = (uint32_t)val; break;
+            case 15: c->m->v_acc = (uint32_t)val; break;
+            case 16: c->m->vel_acc = (uint32_t)val; break;
+            case 17: c->m->hdg_acc = (uint32_t)val; break;
         }
+        if (c->field >= 0 && c->field != 2) c->want.found(c->field);
         c->waiting_for_value = false;
     }
 
@@ -255,8 +231,24 @@ public:
     static void on_uint32(void* ctx, uint32_t val) { handle_int_value((DecodeContext*)ctx, val); }
     static void on_uint64(void* ctx, uint64_t val) { handle_int_value((DecodeContext*)ctx, val); }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
+        CborBenchmark::decode_fields(data, len, out_data, kAllFields);
+    }
+
+    // Both decoders stop reading once the last selected field is stored.
+    void decode_fields(const uint8_t* data, size_t len, void* out_data, FieldMask fields) override {
         Payload& m = *static_cast<Payload*>(out_data);
+        if (native_) {
+            decode_native(data, len, m, fields);
+            return;
+        }
+        struct cbor_callbacks callbacks = make_callbacks();
+        decode_stream(callbacks, data, len, m, fields);
+    }
+
+    static struct cbor_callbacks make_callbacks() {
         struct cbor_callbacks callbacks = cbor_empty_callbacks;
         callbacks.uint8 = on_uint8;
         callbacks.uint16 = on_uint16;
@@ -265,14 +257,16 @@ public:
         callbacks.string = on_string;
         callbacks.byte_string = on_byte_string;
         // Map start/end ignored, we just process flow
-        
-        DecodeContext ctx;
-        ctx.m = &m;
-        ctx.variant = variant_;
-        
+        return callbacks;
+    }
+
+    void decode_stream(const struct cbor_callbacks& callbacks, const uint8_t* data, size_t len, Payload& m,
+                       FieldMask fields = kAllFields) {
+        DecodeContext ctx(&m, variant_, fields);
+
         size_t offset = 0;
-        while(offset < buffer.size()) {
-            cbor_decoder_result res = cbor_stream_decode(buffer.data() + offset, buffer.size() - offset, &callbacks, &ctx);
+        while(offset < len && !ctx.want.done()) {
+            cbor_decoder_result res = cbor_stream_decode(data + offset, len - offset, &callbacks, &ctx);
             if (res.read == 0) break;
             offset += res.read;
             
@@ -282,10 +276,74 @@ public:
         }
     }
 
+    // Pull decode: the loop asks for each key and value in turn, so the value
+    // read can follow the field's type instead of one handler for all integers.
+    // Unselected values are skipped by their header alone.
+    void decode_native(const uint8_t* data, size_t len, Payload& m, FieldMask fields = kAllFields) {
+        NativeCborReader in(data, len);
+        FieldProjection want(fields, 18);
+        uint64_t pairs = in.map();
+        for (uint64_t i = 0; i < pairs && in.ok() && !want.done(); i++) {
+            int field = (variant_ == STRING_KEYS) ? in.key(kFields) : in.int_key(18);
+            if (!want.wants(field)) {
+                in.skip();
+                continue;
+            }
+            switch (field) {
+                case 0: m.timestamp = in.uint(); break;
+                case 1: m.block_number = (uint32_t)in.uint(); break;
+                case 2: {
+                    size_t n;
+                    const uint8_t* hash = in.bytes(n);
+                    if (n == 32) memcpy(m.hash, hash, 32);
+                    break;
+                }
+                case 3: m.time_usec = in.uint(); break;
+                case 4: m.fix_type = (uint8_t)in.uint(); break;
+                case 5: m.lat = (int32_t)in.sint(); break;
+                case 6: m.lon = (int32_t)in.sint(); break;
+                case 7: m.alt = (int32_t)in.sint(); break;
+                case 8: m.eph = (uint16_t)in.uint(); break;
+                case 9: m.epv = (uint16_t)in.uint(); break;
+                case 10: m.vel = (uint16_t)in.uint(); break;
+                case 11: m.cog = (uint16_t)in.uint(); break;
+                case 12: m.satellites_visible = (uint8_t)in.uint(); break;
+                case 13: m.alt_ellipsoid = (int32_t)in.sint(); break;
+                case 14: m.h_acc = (uint32_t)in.uint(); break;
+                case 15: m.v_acc = (uint32_t)in.uint(); break;
+                case 16: m.vel_acc = (uint32_t)in.uint(); break;
+                case 17: m.hdg_acc = (uint32_t)in.uint(); break;
+                default: in.skip(); break;
+            }
+            want.found(field);
+        }
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        // Qualified calls bind statically: no virtual dispatch per frame.
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* frame, size_t frame_cap) {
+            return CborBenchmark::encode_into(item, frame, frame_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        if (native_) {
+            return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+                decode_native(frame, frame_len, *static_cast<Payload*>(out));
+            });
+        }
+        // Callback table built once per batch instead of once per message.
+        struct cbor_callbacks callbacks = make_callbacks();
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            decode_stream(callbacks, frame, frame_len, *static_cast<Payload*>(out));
+        });
+    }
+
     void teardown() override {}
 
     std::string name() const override {
-        return (variant_ == STRING_KEYS) ? "CBOR-StringKeys" : "CBOR-Standard";
+        std::string keys = (variant_ == STRING_KEYS) ? "StringKeys" : "Standard";
+        return native_ ? "CBOR-Native-" + keys : "CBOR-" + keys;
     }
 };
 
@@ -1,4 +1,7 @@
 #include "IBenchmark.h"
+#include "KeyDispatch.h"
+#include "cbor_native.h"
+#include "cbor_span_writer.h"
 #include <cbor.h>
 #include <iostream>
 #include <vector>
@@ -9,7 +12,10 @@ namespace pf {
 
 class CborBenchmarkAttitude : public IBenchmark {
 public:
+    bool native_ = false;
+
     void setup(const BenchmarkConfig& config) override {
+        native_ = config.variant_name == "Native";
         PayloadAttitude p;
         memset(&p, 0, sizeof(p));
         p.roll = 1.0f;
@@ -23,28 +29,43 @@ public:
              std::cerr << "[CBOR-Attitude] Sanity Check: FAILED" << std::endl;
              exit(1);
         }
-        (void)config;
     }
 
+    // Map header + 7 keys (<= 4 chars) + uint32 + 6 single floats
+    static constexpr size_t kMaxEncodedSize = 1 + 7 * (1 + 4) + 5 + 6 * 5;
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
+        unsigned char buffer[kMaxEncodedSize];
+        size_t n = encode_into(data, buffer, sizeof(buffer));
+        return std::vector<uint8_t>(buffer, buffer + n);
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
         const PayloadAttitude& m = *static_cast<const PayloadAttitude*>(data);
-        unsigned char buffer[1024];
-        unsigned char* ptr = buffer;
-        size_t buffer_size = sizeof(buffer);
-        size_t n;
-
-        n = cbor_encode_map_start(7, ptr, buffer_size); ptr += n; buffer_size -= n;
-        
-        // Helper
+        if (cap < kMaxEncodedSize) return 0;
+        if (native_) {
+            NativeCborWriter out(dst, cap);
+            write_payload(out, m);
+            return out.result();
+        }
+        CborSpanWriter out(dst, cap);
+        write_payload(out, m);
+        return out.result();
+    }
+
+    template <typename Out>
+    void write_payload(Out& out, const PayloadAttitude& m) {
+        out.map(7);
+
         auto encode_pair_uint = [&](const char* key, unsigned val) {
-            n = cbor_encode_string_start(strlen(key), ptr, buffer_size); ptr += n; buffer_size -= n;
-            memcpy(ptr, key, strlen(key)); ptr += strlen(key); buffer_size -= strlen(key);
-            n = cbor_encode_uint32(val, ptr, buffer_size); ptr += n; buffer_size -= n;
+            out.text(key, strlen(key));
+            out.uint32(val);
         };
         auto encode_pair_float = [&](const char* key, float val) {
-            n = cbor_encode_string_start(strlen(key), ptr, buffer_size); ptr += n; buffer_size -= n;
-            memcpy(ptr, key, strlen(key)); ptr += strlen(key); buffer_size -= strlen(key);
-            n = cbor_encode_single(val, ptr, buffer_size); ptr += n; buffer_size -= n;
+            out.text(key, strlen(key));
+            out.single(val);
         };
 
         encode_pair_uint("boot", m.time_boot_ms);
@@ -54,15 +75,26 @@ public:
         encode_pair_float("rs", m.rollspeed);
         encode_pair_float("ps", m.pitchspeed);
         encode_pair_float("ys", m.yawspeed);
-
-        return std::vector<uint8_t>(buffer, ptr);
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    enum Field { BOOT, ROLL, PITCH, YAW, ROLLSPEED, PITCHSPEED, YAWSPEED };
+    static constexpr KeyEntry kKeys[] = {
+        {"boot", BOOT}, {"r", ROLL}, {"p", PITCH}, {"y", YAW},
+        {"rs", ROLLSPEED}, {"ps", PITCHSPEED}, {"ys", YAWSPEED},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadAttitude& m = *static_cast<PayloadAttitude*>(out_data);
+        if (native_) {
+            decode_native(data, len, m);
+            return;
+        }
         // Correct DOM usage
         struct cbor_load_result result;
-        cbor_item_t* item = cbor_load(buffer.data(), buffer.size(), &result);
+        cbor_item_t* item = cbor_load(data, len, &result);
         if(!item) return;
 
         if(cbor_isa_map(item)) {
@@ -70,27 +102,58 @@ public:
             size_t sz = cbor_map_size(item);
             for(size_t i=0; i<sz; i++) {
                 if(!cbor_isa_string(pairs[i].key)) continue;
-                std::string k((char*)cbor_string_handle(pairs[i].key), cbor_string_length(pairs[i].key));
+                int field = kFields.find((const char*)cbor_string_handle(pairs[i].key), cbor_string_length(pairs[i].key));
                 
                 cbor_item_t* val = pairs[i].value;
-                if (k=="boot") m.time_boot_ms = cbor_get_int(val);
+                if (field == BOOT) m.time_boot_ms = cbor_get_int(val);
                 else {
                     float f = 0;
                     if (cbor_isa_float_ctrl(val)) f = cbor_float_get_float(val);
-                    if (k=="r") m.roll=f;
-                    else if (k=="p") m.pitch=f;
-                    else if (k=="y") m.yaw=f;
-                    else if (k=="rs") m.rollspeed=f;
-                    else if (k=="ps") m.pitchspeed=f;
-                    else if (k=="ys") m.yawspeed=f;
+                    switch (field) {
+                        case ROLL: m.roll=f; break;
+                        case PITCH: m.pitch=f; break;
+                        case YAW: m.yaw=f; break;
+                        case ROLLSPEED: m.rollspeed=f; break;
+                        case PITCHSPEED: m.pitchspeed=f; break;
+                        case YAWSPEED: m.yawspeed=f; break;
+                    }
                 }
             }
         }
         cbor_decref(&item);
     }
 
+    void decode_native(const uint8_t* data, size_t len, PayloadAttitude& m) {
+        NativeCborReader in(data, len);
+        uint64_t pairs = in.map();
+        for (uint64_t i = 0; i < pairs && in.ok(); i++) {
+            switch (in.key(kFields)) {
+                case BOOT: m.time_boot_ms = (uint32_t)in.uint(); break;
+                case ROLL: m.roll = in.single(); break;
+                case PITCH: m.pitch = in.single(); break;
+                case YAW: m.yaw = in.single(); break;
+                case ROLLSPEED: m.rollspeed = in.single(); break;
+                case PITCHSPEED: m.pitchspeed = in.single(); break;
+                case YAWSPEED: m.yawspeed = in.single(); break;
+                default: in.skip(); break;
+            }
+        }
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* frame, size_t frame_cap) {
+            return CborBenchmarkAttitude::encode_into(item, frame, frame_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+            CborBenchmarkAttitude::decode(frame, frame_len, out);
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "CBOR-Attitude"; }
+    std::string name() const override { return native_ ? "CBOR-Native-Attitude" : "CBOR-Attitude"; }
 };
 
 } // pf
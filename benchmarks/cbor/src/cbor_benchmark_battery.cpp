@@ -1,4 +1,8 @@
 #include "IBenchmark.h"
+#include "KeyDispatch.h"
+#include "cbor_native.h"
+#include "cbor_span_writer.h"
+#include "cbor_typed_array.h"
 #include <cbor.h>
 #include <iostream>
 #include <vector>
@@ -9,7 +13,12 @@ namespace pf {
 
 class CborBenchmarkBattery : public IBenchmark {
 public:
+    bool native_ = false;
+    bool typed_arrays_ = false; // voltages as an RFC 8746 uint16 typed array
+
     void setup(const BenchmarkConfig& config) override {
+        native_ = config.variant_name == "Native" || config.variant_name == "NativeTypedArrays";
+        typed_arrays_ = config.variant_name == "TypedArrays" || config.variant_name == "NativeTypedArrays";
         // Sanity Check
         PayloadBattery p;
         memset(&p, 0, sizeof(p));
@@ -25,35 +34,46 @@ public:
              std::cerr << "[CBOR-Battery] Sanity Check: FAILED" << std::endl;
              exit(1);
         }
-        (void)config;
     }
 
+    // Map header + 9 keys (<= 7 chars) + 8 ints (<= 9 bytes) + voltages[10]
+    static constexpr size_t kMaxEncodedSize = 1 + 9 * (1 + 7) + 8 * 9 + (1 + 10 * 3);
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
+        unsigned char buffer[kMaxEncodedSize];
+        size_t n = encode_into(data, buffer, sizeof(buffer));
+        return std::vector<uint8_t>(buffer, buffer + n);
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
         const PayloadBattery& m = *static_cast<const PayloadBattery*>(data);
-        unsigned char buffer[1024]; 
-        unsigned char* ptr = buffer;
-        size_t buffer_size = sizeof(buffer);
-        size_t n;
+        if (cap < kMaxEncodedSize) return 0;
+        if (native_) {
+            NativeCborWriter out(dst, cap);
+            write_payload(out, m);
+            return out.result();
+        }
+        CborSpanWriter out(dst, cap);
+        write_payload(out, m);
+        return out.result();
+    }
 
+    template <typename Out>
+    void write_payload(Out& out, const PayloadBattery& m) {
         // Map(9 items)
-        n = cbor_encode_map_start(9, ptr, buffer_size); ptr += n; buffer_size -= n;
-
-        auto cbor_encode_text_string = [&](uint8_t* p, size_t sz, const char* str, size_t len) {
-             size_t k = cbor_encode_string_start(len, p, sz);
-             memcpy(p + k, str, len);
-             return k + len;
-        };
+        out.map(9);
 
         auto encode_pair_uint = [&](const char* key, unsigned val) {
-            n = cbor_encode_text_string(ptr, buffer_size, key, strlen(key)); ptr += n; buffer_size -= n;
-            n = cbor_encode_uint32(val, ptr, buffer_size); ptr += n; buffer_size -= n;
+            out.text(key, strlen(key));
+            out.uint32(val);
         };
         
         auto encode_pair_int = [&](const char* key, int val) {
-            n = cbor_encode_text_string(ptr, buffer_size, key, strlen(key)); ptr += n; buffer_size -= n;
-            if(val >= 0) n = cbor_encode_uint32(val, ptr, buffer_size);
-            else n = cbor_encode_negint(-1 - val, ptr, buffer_size); 
-            ptr += n; buffer_size -= n;
+            out.text(key, strlen(key));
+            if(val >= 0) out.uint32(val);
+            else out.negint(-1 - val);
         };
         
         encode_pair_uint("id", m.id);
@@ -62,52 +82,73 @@ public:
         encode_pair_int("temp", m.temperature);
         
         // Voltages Array
-        n = cbor_encode_text_string(ptr, buffer_size, "volt", 4); ptr += n; buffer_size -= n;
-        n = cbor_encode_array_start(10, ptr, buffer_size); ptr += n; buffer_size -= n;
-        for(int i=0; i<10; i++) {
-             n = cbor_encode_uint16(m.voltages[i], ptr, buffer_size); ptr += n; buffer_size -= n;
+        out.text("volt", 4);
+        if (typed_arrays_) {
+            write_typed_array(out, m.voltages, 10);
+        } else {
+            out.array(10);
+            for(int i=0; i<10; i++) out.uint16(m.voltages[i]);
         }
         
         encode_pair_int("current", m.current_battery);
         encode_pair_int("cons", m.current_consumed);
         encode_pair_int("energy", m.energy_consumed);
         encode_pair_int("rem", m.battery_remaining);
-
-        return std::vector<uint8_t>(buffer, ptr);
     }
 
+    enum Field { ID, FUNC, TYPE, TEMP, VOLT, CURRENT, CONS, ENERGY, REM };
+    static constexpr KeyEntry kKeys[] = {
+        {"id", ID}, {"func", FUNC}, {"type", TYPE}, {"temp", TEMP}, {"volt", VOLT},
+        {"current", CURRENT}, {"cons", CONS}, {"energy", ENERGY}, {"rem", REM},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
     // Streaming Decoder
     struct DecodeContext {
         PayloadBattery* m;
-        std::string current_key;
+        int field = -1;
         bool waiting_for_value = false;
         bool in_voltages = false;
         int idx = 0;
+        uint64_t tag = 0;
     };
 
     static void on_string(void* ctx, cbor_data data, size_t len) {
         DecodeContext* c = (DecodeContext*)ctx;
         if (!c->waiting_for_value) {
-            c->current_key.assign((const char*)data, len);
+            c->field = kFields.find((const char*)data, len);
             c->waiting_for_value = true;
-            if(c->current_key == "volt") { c->in_voltages = true; c->idx = 0; }
+            if(c->field == VOLT) { c->in_voltages = true; c->idx = 0; }
             else c->in_voltages = false;
         }
     }
 
+    static void on_tag(void* ctx, uint64_t tag) { ((DecodeContext*)ctx)->tag = tag; }
+
+    static void on_bytes(void* ctx, cbor_data data, size_t len) {
+        DecodeContext* c = (DecodeContext*)ctx;
+        if (c->in_voltages) {
+            load_typed_array(c->tag, data, len, c->m->voltages, 10);
+            c->in_voltages = false;
+        }
+        c->waiting_for_value = false;
+    }
+
     static void handle_int(DecodeContext* c, int64_t val) {
          if (c->in_voltages) {
              if(c->idx < 10) c->m->voltages[c->idx++] = (uint16_t)val;
              if(c->idx == 10) { c->in_voltages = false; c->waiting_for_value = false; }
          } else if (c->waiting_for_value) {
-             if (c->current_key == "id") c->m->id = (uint8_t)val;
-             else if (c->current_key == "func") c->m->battery_function = (uint8_t)val;
-             else if (c->current_key == "type") c->m->type = (uint8_t)val;
-             else if (c->current_key == "temp") c->m->temperature = (int16_t)val;
-             else if (c->current_key == "current") c->m->current_battery = (int16_t)val;
-             else if (c->current_key == "cons") c->m->current_consumed = (int32_t)val;
-             else if (c->current_key == "energy") c->m->energy_consumed = (int32_t)val;
-             else if (c->current_key == "rem") c->m->battery_remaining = (int8_t)val;
+             switch (c->field) {
+                 case ID: c->m->id = (uint8_t)val; break;
+                 case FUNC: c->m->battery_function = (uint8_t)val; break;
+                 case TYPE: c->m->type = (uint8_t)val; break;
+                 case TEMP: c->m->temperature = (int16_t)val; break;
+                 case CURRENT: c->m->current_battery = (int16_t)val; break;
+                 case CONS: c->m->current_consumed = (int32_t)val; break;
+                 case ENERGY: c->m->energy_consumed = (int32_t)val; break;
+                 case REM: c->m->battery_remaining = (int8_t)val; break;
+             }
              c->waiting_for_value = false;
          }
     }
@@ -116,33 +157,96 @@ public:
     static void on_uint16(void* ctx, uint16_t val) { handle_int((DecodeContext*)ctx, val); }
     static void on_uint32(void* ctx, uint32_t val) { handle_int((DecodeContext*)ctx, val); }
     static void on_uint64(void* ctx, uint64_t val) { handle_int((DecodeContext*)ctx, val); }
+    static void on_negint8(void* ctx, uint8_t val) { handle_int((DecodeContext*)ctx, -1 - (int64_t)val); }
+    static void on_negint16(void* ctx, uint16_t val) { handle_int((DecodeContext*)ctx, -1 - (int64_t)val); }
+    static void on_negint32(void* ctx, uint32_t val) { handle_int((DecodeContext*)ctx, -1 - (int64_t)val); }
     static void on_negint64(void* ctx, uint64_t val) { handle_int((DecodeContext*)ctx, -1 - (int64_t)val); }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadBattery& m = *static_cast<PayloadBattery*>(out_data);
-        
+        if (native_) {
+            decode_native(data, len, m);
+            return;
+        }
+        struct cbor_callbacks callbacks = make_callbacks();
+        decode_stream(callbacks, data, len, m);
+    }
+
+    static struct cbor_callbacks make_callbacks() {
         struct cbor_callbacks callbacks = cbor_empty_callbacks;
         callbacks.string = on_string;
+        callbacks.tag = on_tag;
+        callbacks.byte_string = on_bytes;
         callbacks.uint8 = on_uint8;
         callbacks.uint16 = on_uint16;
         callbacks.uint32 = on_uint32;
         callbacks.uint64 = on_uint64;
+        // cbor_encode_negint picks the shortest width, so every width can arrive.
+        callbacks.negint8 = on_negint8;
+        callbacks.negint16 = on_negint16;
+        callbacks.negint32 = on_negint32;
         callbacks.negint64 = on_negint64;
-        
+        return callbacks;
+    }
+
+    void decode_stream(const struct cbor_callbacks& callbacks, const uint8_t* data, size_t len, PayloadBattery& m) {
         DecodeContext ctx;
         ctx.m = &m;
         
         size_t offset = 0;
-        while(offset < buffer.size()) {
-             cbor_decoder_result res = cbor_stream_decode(buffer.data() + offset, buffer.size() - offset, &callbacks, &ctx);
+        while(offset < len) {
+             cbor_decoder_result res = cbor_stream_decode(data + offset, len - offset, &callbacks, &ctx);
              if (res.read == 0) break;
              offset += res.read;
              if (res.status != CBOR_DECODER_FINISHED) break; 
         }
     }
 
+    void decode_native(const uint8_t* data, size_t len, PayloadBattery& m) {
+        NativeCborReader in(data, len);
+        uint64_t pairs = in.map();
+        for (uint64_t i = 0; i < pairs && in.ok(); i++) {
+            switch (in.key(kFields)) {
+                case ID: m.id = (uint8_t)in.uint(); break;
+                case FUNC: m.battery_function = (uint8_t)in.uint(); break;
+                case TYPE: m.type = (uint8_t)in.uint(); break;
+                case TEMP: m.temperature = (int16_t)in.sint(); break;
+                case VOLT:
+                    read_numeric_array(in, m.voltages, 10, [](NativeCborReader& r) { return (uint16_t)r.uint(); });
+                    break;
+                case CURRENT: m.current_battery = (int16_t)in.sint(); break;
+                case CONS: m.current_consumed = (int32_t)in.sint(); break;
+                case ENERGY: m.energy_consumed = (int32_t)in.sint(); break;
+                case REM: m.battery_remaining = (int8_t)in.sint(); break;
+                default: in.skip(); break;
+            }
+        }
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* frame, size_t frame_cap) {
+            return CborBenchmarkBattery::encode_into(item, frame, frame_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        if (native_) {
+            return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+                decode_native(frame, frame_len, *static_cast<PayloadBattery*>(out));
+            });
+        }
+        struct cbor_callbacks callbacks = make_callbacks();
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            decode_stream(callbacks, frame, frame_len, *static_cast<PayloadBattery*>(out));
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "CBOR-Battery"; }
+    std::string name() const override {
+        return std::string("CBOR-") + (native_ ? "Native-" : "") + (typed_arrays_ ? "TypedArrays-" : "") + "Battery";
+    }
 };
 
 } // namespace pf
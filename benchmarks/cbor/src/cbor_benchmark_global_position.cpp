@@ -1,4 +1,7 @@
 #include "IBenchmark.h"
+#include "KeyDispatch.h"
+#include "cbor_native.h"
+#include "cbor_span_writer.h"
 #include <cbor.h>
 #include <iostream>
 #include <vector>
@@ -8,7 +11,10 @@ namespace pf {
 
 class CborBenchmarkGlobalPosition : public IBenchmark {
 public:
+    bool native_ = false;
+
     void setup(const BenchmarkConfig& config) override {
+        native_ = config.variant_name == "Native";
         PayloadGlobalPosition p;
         memset(&p, 0, sizeof(p));
         p.lat = 123456789;
@@ -22,29 +28,44 @@ public:
              std::cerr << "[CBOR-GlobalPos] Sanity Check: FAILED" << std::endl;
              exit(1);
         }
-        (void)config;
     }
 
+    // Map header + 9 keys (<= 4 chars) + 9 ints (<= 9 bytes)
+    static constexpr size_t kMaxEncodedSize = 1 + 9 * (1 + 4) + 9 * 9;
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
+        unsigned char buffer[kMaxEncodedSize];
+        size_t n = encode_into(data, buffer, sizeof(buffer));
+        return std::vector<uint8_t>(buffer, buffer + n);
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
         const PayloadGlobalPosition& m = *static_cast<const PayloadGlobalPosition*>(data);
-        unsigned char buffer[1024];
-        unsigned char* ptr = buffer;
-        size_t buffer_size = sizeof(buffer);
-        size_t n;
+        if (cap < kMaxEncodedSize) return 0;
+        if (native_) {
+            NativeCborWriter out(dst, cap);
+            write_payload(out, m);
+            return out.result();
+        }
+        CborSpanWriter out(dst, cap);
+        write_payload(out, m);
+        return out.result();
+    }
+
+    template <typename Out>
+    void write_payload(Out& out, const PayloadGlobalPosition& m) {
+        out.map(9);
 
-        n = cbor_encode_map_start(9, ptr, buffer_size); ptr += n; buffer_size -= n;
-        
         auto encode_pair_int = [&](const char* key, int64_t val) {
-            n = cbor_encode_string_start(strlen(key), ptr, buffer_size); ptr += n; buffer_size -= n;
-            memcpy(ptr, key, strlen(key)); ptr += strlen(key); buffer_size -= strlen(key);
-            if(val >= 0) n = cbor_encode_uint64(val, ptr, buffer_size);
-            else n = cbor_encode_negint64(-1 - val, ptr, buffer_size);
-            ptr += n; buffer_size -= n;
+            out.text(key, strlen(key));
+            if(val >= 0) out.uint64(val);
+            else out.negint64(-1 - val);
         };
         auto encode_pair_uint = [&](const char* key, uint64_t val) {
-             n = cbor_encode_string_start(strlen(key), ptr, buffer_size); ptr += n; buffer_size -= n;
-             memcpy(ptr, key, strlen(key)); ptr += strlen(key); buffer_size -= strlen(key);
-             n = cbor_encode_uint64(val, ptr, buffer_size); ptr += n; buffer_size -= n;
+            out.text(key, strlen(key));
+            out.uint64(val);
         };
 
         encode_pair_uint("boot", m.time_boot_ms);
@@ -56,14 +77,32 @@ public:
         encode_pair_int("vy", m.vy);
         encode_pair_int("vz", m.vz);
         encode_pair_uint("hdg", m.hdg);
+    }
+
+    enum Field { BOOT, LAT, LON, ALT, REL, VX, VY, VZ, HDG };
+    static constexpr KeyEntry kKeys[] = {
+        {"boot", BOOT}, {"lat", LAT}, {"lon", LON}, {"alt", ALT}, {"rel", REL},
+        {"vx", VX}, {"vy", VY}, {"vz", VZ}, {"hdg", HDG},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
 
-        return std::vector<uint8_t>(buffer, ptr);
+    // libcbor stores a negint as its magnitude n, encoding the value -1 - n.
+    static int64_t get_signed(cbor_item_t* val) {
+        if (cbor_isa_uint(val)) return (int64_t)cbor_get_int(val);
+        if (cbor_isa_negint(val)) return -1 - (int64_t)cbor_get_int(val);
+        return 0;
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadGlobalPosition& m = *static_cast<PayloadGlobalPosition*>(out_data);
+        if (native_) {
+            decode_native(data, len, m);
+            return;
+        }
         struct cbor_load_result result;
-        cbor_item_t* item = cbor_load(buffer.data(), buffer.size(), &result);
+        cbor_item_t* item = cbor_load(data, len, &result);
         if(!item) return;
 
         if(cbor_isa_map(item)) {
@@ -71,46 +110,58 @@ public:
             size_t sz = cbor_map_size(item);
             for(size_t i=0; i<sz; i++) {
                 if(!cbor_isa_string(pairs[i].key)) continue;
-                std::string k((char*)cbor_string_handle(pairs[i].key), cbor_string_length(pairs[i].key));
+                int field = kFields.find((const char*)cbor_string_handle(pairs[i].key), cbor_string_length(pairs[i].key));
                 cbor_item_t* val = pairs[i].value;
 
-                if (k=="boot") m.time_boot_ms = cbor_get_int(val);
-                else if (k=="lat") m.lat = cbor_get_int(val); // Works for negint too if handled by cbor_get_int?
-                // Wait, cbor_get_int returns based on type?
-                // libcbor helper: 
-                // cbor_get_int returns [uint8...uint64]. For negint it might be tricky.
-                // Let's use specific checks or the generic helper.
-                // Actually `cbor_get_int` is for uint. `cbor_get_int` is a macro? No.
-                // Let's assume standard libcbor helpers.
-                // For signed integers, check type.
-                
-                else if (k=="lat" || k=="lon" || k=="alt" || k=="rel" || k=="vx" || k=="vy" || k=="vz") {
-                    int64_t v = 0;
-                    if(cbor_isa_uint(val)) v = cbor_get_int(val);
-                    else if(cbor_isa_negint(val)) {
-                        // value is -1 - val
-                        uint64_t uv = cbor_get_int(val); // returns the magnitude
-                        // Actual value is -1 - uv.
-                        // wait, libcbor representation for negint stores the "value" part directly.
-                        // Correct logic: -1 - value.
-                        v = -1 - (int64_t)uv;
-                    }
-                    if(k=="lat") m.lat = (int32_t)v;
-                    else if(k=="lon") m.lon = (int32_t)v;
-                    else if(k=="alt") m.alt = (int32_t)v;
-                    else if(k=="rel") m.relative_alt = (int32_t)v;
-                    else if(k=="vx") m.vx = (int16_t)v;
-                    else if(k=="vy") m.vy = (int16_t)v;
-                    else if(k=="vz") m.vz = (int16_t)v;
+                switch (field) {
+                    case BOOT: m.time_boot_ms = cbor_get_int(val); break;
+                    case LAT: m.lat = (int32_t)get_signed(val); break;
+                    case LON: m.lon = (int32_t)get_signed(val); break;
+                    case ALT: m.alt = (int32_t)get_signed(val); break;
+                    case REL: m.relative_alt = (int32_t)get_signed(val); break;
+                    case VX: m.vx = (int16_t)get_signed(val); break;
+                    case VY: m.vy = (int16_t)get_signed(val); break;
+                    case VZ: m.vz = (int16_t)get_signed(val); break;
+                    case HDG: m.hdg = (uint16_t)cbor_get_int(val); break;
                 }
-                else if (k=="hdg") m.hdg = (uint16_t)cbor_get_int(val);
             }
         }
         cbor_decref(&item);
     }
 
+    void decode_native(const uint8_t* data, size_t len, PayloadGlobalPosition& m) {
+        NativeCborReader in(data, len);
+        uint64_t pairs = in.map();
+        for (uint64_t i = 0; i < pairs && in.ok(); i++) {
+            switch (in.key(kFields)) {
+                case BOOT: m.time_boot_ms = (uint32_t)in.uint(); break;
+                case LAT: m.lat = (int32_t)in.sint(); break;
+                case LON: m.lon = (int32_t)in.sint(); break;
+                case ALT: m.alt = (int32_t)in.sint(); break;
+                case REL: m.relative_alt = (int32_t)in.sint(); break;
+                case VX: m.vx = (int16_t)in.sint(); break;
+                case VY: m.vy = (int16_t)in.sint(); break;
+                case VZ: m.vz = (int16_t)in.sint(); break;
+                case HDG: m.hdg = (uint16_t)in.uint(); break;
+                default: in.skip(); break;
+            }
+        }
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* frame, size_t frame_cap) {
+            return CborBenchmarkGlobalPosition::encode_into(item, frame, frame_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+            CborBenchmarkGlobalPosition::decode(frame, frame_len, out);
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "CBOR-GlobalPos"; }
+    std::string name() const override { return native_ ? "CBOR-Native-GlobalPos" : "CBOR-GlobalPos"; }
 };
 
 } // pf
@@ -1,4 +1,5 @@
 #include "IBenchmark.h"
+#include "cbor_schema_codec.h"
 #include <cbor.h>
 #include <iostream>
 #include <vector>
@@ -9,108 +10,96 @@ namespace pf {
 
 class CborBenchmarkGPSBlock : public IBenchmark {
 public:
+    bool native_ = false;
+    // "Columnar": one byte-string column per field (ColumnarBlock.h). The container
+    // is ~20 items, so it is written and read with the native codec only.
+    bool columnar_ = false;
+    std::vector<uint8_t> column_scratch_;
+
     void setup(const BenchmarkConfig& config) override {
+        native_ = config.variant_name == "Native";
+        columnar_ = config.variant_name == "Columnar";
         PayloadGPSBlock p;
         for(int i=0; i<50; i++) {
             PayloadGPSRaw raw; 
             memset(&raw, 0, sizeof(raw));
             raw.timestamp = 1000 + i;
+            raw.lat = -473977418 + i;
+            raw.eph = 120;
+            raw.hash[31] = (uint8_t)i;
             p.messages.push_back(raw);
         }
         auto buf = encode(&p);
         PayloadGPSBlock d;
         decode(buf, &d);
-        if (d.messages.size() == 50 && d.messages[0].timestamp == 1000) {
+        if (d.messages.size() == 50 && d.messages[0].timestamp == 1000 && d.messages[49].lat == -473977369 &&
+            d.messages[49].eph == 120 && d.messages[49].hash[31] == 49) {
              std::cout << "[CBOR-GPSBlock] Sanity Check: PASS" << std::endl;
         } else {
              std::cerr << "[CBOR-GPSBlock] Sanity Check: FAILED " << d.messages.size() << std::endl;
              exit(1);
         }
-        (void)config;
     }
 
-    std::vector<uint8_t> encode(const void* data) override {
-        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
-        unsigned char buffer[8192];
-        unsigned char* ptr = buffer;
-        size_t buffer_size = sizeof(buffer);
-        size_t n;
+    // Every PayloadGPSRaw field, under the schema's short keys
+    static constexpr size_t kMaxRecordSize = cbor_schema_max_size<PayloadGPSRaw, KeyStyle::ShortName>();
 
-        // Array of N
-        n = cbor_encode_array_start(m.messages.size(), ptr, buffer_size); ptr += n; buffer_size -= n;
-        
-        auto encode_key = [&](const char* key) {
-             size_t len = strlen(key);
-             size_t k = cbor_encode_string_start(len, ptr, buffer_size); ptr += k; buffer_size -= k;
-             memcpy(ptr, key, len); ptr += len; buffer_size -= len;
-        };
+    size_t max_encoded_size(const void* data) override {
+        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        if (columnar_) return cbor_columns_max_size<PayloadGPSRaw>(m.messages.size());
+        return 9 + m.messages.size() * kMaxRecordSize;
+    }
 
-        for(const auto& r : m.messages) {
-             n = cbor_encode_map_start(7, ptr, buffer_size); ptr += n; buffer_size -= n;
-             
-             encode_key("ts"); n = cbor_encode_uint64(r.timestamp, ptr, buffer_size); ptr += n; buffer_size -= n;
-             encode_key("bn"); n = cbor_encode_uint32(r.block_number, ptr, buffer_size); ptr += n; buffer_size -= n;
-             encode_key("tu"); n = cbor_encode_uint64(r.time_usec, ptr, buffer_size); ptr += n; buffer_size -= n;
-             encode_key("ft"); n = cbor_encode_uint8(r.fix_type, ptr, buffer_size); ptr += n; buffer_size -= n;
-             encode_key("lat"); 
-             if(r.lat>=0) n=cbor_encode_uint64(r.lat, ptr, buffer_size); else n=cbor_encode_negint64(-1-r.lat, ptr, buffer_size); 
-             ptr += n; buffer_size -= n;
-             
-             encode_key("lon");
-             if(r.lon>=0) n=cbor_encode_uint64(r.lon, ptr, buffer_size); else n=cbor_encode_negint64(-1-r.lon, ptr, buffer_size);
-             ptr += n; buffer_size -= n;
+    std::vector<uint8_t> encode(const void* data) override {
+        std::vector<uint8_t> buffer(max_encoded_size(data));
+        buffer.resize(encode_into(data, buffer.data(), buffer.size()));
+        return buffer;
+    }
 
-             encode_key("alt");
-             if(r.alt>=0) n=cbor_encode_uint64(r.alt, ptr, buffer_size); else n=cbor_encode_negint64(-1-r.alt, ptr, buffer_size);
-             ptr += n; buffer_size -= n;
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        if (columnar_) {
+            NativeCborWriter out(dst, cap);
+            write_cbor_columns(out, m.messages, column_scratch_);
+            return out.result();
         }
-
-        return std::vector<uint8_t>(buffer, ptr);
+        if (native_) {
+            NativeCborWriter out(dst, cap);
+            write_cbor_schema_records<KeyStyle::ShortName>(out, m.messages);
+            return out.result();
+        }
+        CborSpanWriter out(dst, cap);
+        write_cbor_schema_records<KeyStyle::ShortName>(out, m.messages);
+        return out.result();
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    // Streams straight into `messages`; no cbor_item_t tree is built.
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadGPSBlock& m = *static_cast<PayloadGPSBlock*>(out_data);
-        struct cbor_load_result result;
-        cbor_item_t* item = cbor_load(buffer.data(), buffer.size(), &result);
-        if(!item) return;
+        if (columnar_) read_cbor_columns(data, len, m.messages);
+        else if (native_) read_cbor_schema_records_native<KeyStyle::ShortName>(data, len, m.messages);
+        else read_cbor_schema_records<KeyStyle::ShortName>(data, len, m.messages);
+    }
 
-        if(cbor_isa_array(item)) {
-            size_t size = cbor_array_size(item);
-            m.messages.resize(size);
-            cbor_item_t** items = cbor_array_handle(item);
-            for(size_t i=0; i<size; i++) {
-                // items[i] is a Map representing one GPSRaw
-                if(cbor_isa_map(items[i])) {
-                    cbor_pair* pairs = cbor_map_handle(items[i]);
-                    size_t map_sz = cbor_map_size(items[i]);
-                    for(size_t j=0; j<map_sz; j++) {
-                         std::string k((char*)cbor_string_handle(pairs[j].key), cbor_string_length(pairs[j].key));
-                         cbor_item_t* v = pairs[j].value;
-                         if(k=="ts") m.messages[i].timestamp = cbor_get_int(v);
-                         else if(k=="bn") m.messages[i].block_number = cbor_get_int(v);
-                         else if(k=="tu") m.messages[i].time_usec = cbor_get_int(v);
-                         else if(k=="ft") m.messages[i].fix_type = cbor_get_int(v);
-                         else if(k=="lat") {
-                            if(cbor_isa_negint(v)) m.messages[i].lat = -1 - cbor_get_int(v);
-                            else m.messages[i].lat = cbor_get_int(v);
-                         }
-                         else if(k=="lon") {
-                            if(cbor_isa_negint(v)) m.messages[i].lon = -1 - cbor_get_int(v);
-                            else m.messages[i].lon = cbor_get_int(v);
-                         }
-                         else if(k=="alt") {
-                            if(cbor_isa_negint(v)) m.messages[i].alt = -1 - cbor_get_int(v);
-                            else m.messages[i].alt = cbor_get_int(v);
-                         }
-                    }
-                }
-            }
-        }
-        cbor_decref(&item);
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* frame, size_t frame_cap) {
+            return CborBenchmarkGPSBlock::encode_into(item, frame, frame_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+            CborBenchmarkGPSBlock::decode(frame, frame_len, out);
+        });
     }
 
     void teardown() override {}
-    std::string name() const override { return "CBOR-GPSBlock"; }
+    std::string name() const override {
+        if (columnar_) return "CBOR-Columnar-GPSBlock";
+        return native_ ? "CBOR-Native-GPSBlock" : "CBOR-GPSBlock";
+    }
 };
 
 } // pf
@@ -1,4 +1,8 @@
 #include "IBenchmark.h"
+#include "KeyDispatch.h"
+#include "cbor_native.h"
+#include "cbor_span_writer.h"
+#include "cbor_typed_array.h"
 #include <cbor.h>
 #include <iostream>
 #include <vector>
@@ -8,7 +12,12 @@ namespace pf {
 
 class CborBenchmarkOdometry : public IBenchmark {
 public:
+    bool native_ = false;
+    bool typed_arrays_ = false; // q/pcov/vcov as RFC 8746 float32 typed arrays
+
     void setup(const BenchmarkConfig& config) override {
+        native_ = config.variant_name == "Native" || config.variant_name == "NativeTypedArrays";
+        typed_arrays_ = config.variant_name == "TypedArrays" || config.variant_name == "NativeTypedArrays";
         // Sanity Check
         PayloadOdometry p;
         memset(&p, 0, sizeof(p));
@@ -25,133 +34,176 @@ public:
              std::cerr << "Time: " << d.time_usec << " PCOV[0]: " << d.pose_covariance[0] << std::endl;
              exit(1);
         }
-        (void)config;
     }
 
+    // Map header + 15 keys (<= 5 chars) + uint64 + 2 uint32 + 9 floats + q[4] + 2 x cov[21]
+    static constexpr size_t kMaxEncodedSize = 1 + 15 * (1 + 5) + 9 + 2 * 5 + 9 * 5 + (1 + 4 * 5) + 2 * (2 + 21 * 5);
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
+        unsigned char buffer[kMaxEncodedSize];
+        size_t n = encode_into(data, buffer, sizeof(buffer));
+        return std::vector<uint8_t>(buffer, buffer + n);
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
         const PayloadOdometry& m = *static_cast<const PayloadOdometry*>(data);
-        unsigned char buffer[4096]; 
-        unsigned char* ptr = buffer;
-        size_t buffer_size = sizeof(buffer);
-        size_t n;
+        if (cap < kMaxEncodedSize) return 0;
+        if (native_) {
+            NativeCborWriter out(dst, cap);
+            write_payload(out, m);
+            return out.result();
+        }
+        CborSpanWriter out(dst, cap);
+        write_payload(out, m);
+        return out.result();
+    }
 
+    template <typename Out>
+    void write_payload(Out& out, const PayloadOdometry& m) {
         // Map(15 items)
-        n = cbor_encode_map_start(15, ptr, buffer_size); ptr += n; buffer_size -= n;
-
-        auto cbor_encode_text_string = [&](uint8_t* p, size_t sz, const char* str, size_t len) {
-             size_t k = cbor_encode_string_start(len, p, sz);
-             memcpy(p + k, str, len);
-             return k + len;
-        };
+        out.map(15);
 
         auto encode_pair_uint64 = [&](const char* key, uint64_t val) {
-            n = cbor_encode_text_string(ptr, buffer_size, key, strlen(key)); ptr += n; buffer_size -= n;
-            n = cbor_encode_uint64(val, ptr, buffer_size); ptr += n; buffer_size -= n;
+            out.text(key, strlen(key));
+            out.uint64(val);
         };
         auto encode_pair_uint = [&](const char* key, unsigned val) {
-            n = cbor_encode_text_string(ptr, buffer_size, key, strlen(key)); ptr += n; buffer_size -= n;
-            n = cbor_encode_uint32(val, ptr, buffer_size); ptr += n; buffer_size -= n;
+            out.text(key, strlen(key));
+            out.uint32(val);
         };
         auto encode_pair_float = [&](const char* key, float val) {
-            n = cbor_encode_text_string(ptr, buffer_size, key, strlen(key)); ptr += n; buffer_size -= n;
-            n = cbor_encode_single(val, ptr, buffer_size); ptr += n; buffer_size -= n;
+            out.text(key, strlen(key));
+            out.single(val);
         };
-        
+        auto encode_float_array = [&](const char* key, const float* vals, int count) {
+            out.text(key, strlen(key));
+            if (typed_arrays_) {
+                write_typed_array(out, vals, count);
+                return;
+            }
+            out.array(count);
+            for(int i=0; i<count; i++) out.single(vals[i]);
+        };
+
         encode_pair_uint64("time", m.time_usec);
         encode_pair_uint("frame", m.frame_id);
         encode_pair_uint("child", m.child_frame_id);
-        
+
         encode_pair_float("x", m.x);
         encode_pair_float("y", m.y);
         encode_pair_float("z", m.z);
-        
-        // Quaternions
-        n = cbor_encode_text_string(ptr, buffer_size, "q", 1); ptr += n; buffer_size -= n;
-        n = cbor_encode_array_start(4, ptr, buffer_size); ptr += n; buffer_size -= n;
-        for(int i=0; i<4; i++) {
-             n = cbor_encode_single(m.q[i], ptr, buffer_size); ptr += n; buffer_size -= n;
-        }
-        
+
+        encode_float_array("q", m.q, 4);
+
         encode_pair_float("vx", m.vx);
         encode_pair_float("vy", m.vy);
         encode_pair_float("vz", m.vz);
-        
+
         encode_pair_float("rs", m.rollspeed);
         encode_pair_float("ps", m.pitchspeed);
         encode_pair_float("ys", m.yawspeed);
-        
-        // Pose Cov
-        n = cbor_encode_text_string(ptr, buffer_size, "pcov", 4); ptr += n; buffer_size -= n;
-        n = cbor_encode_array_start(21, ptr, buffer_size); ptr += n; buffer_size -= n;
-        for(int i=0; i<21; i++) {
-             n = cbor_encode_single(m.pose_covariance[i], ptr, buffer_size); ptr += n; buffer_size -= n;
-        }
 
-        // Vel Cov
-        n = cbor_encode_text_string(ptr, buffer_size, "vcov", 4); ptr += n; buffer_size -= n;
-        n = cbor_encode_array_start(21, ptr, buffer_size); ptr += n; buffer_size -= n;
-        for(int i=0; i<21; i++) {
-             n = cbor_encode_single(m.velocity_covariance[i], ptr, buffer_size); ptr += n; buffer_size -= n;
-        }
-
-        return std::vector<uint8_t>(buffer, ptr);
+        encode_float_array("pcov", m.pose_covariance, 21);
+        encode_float_array("vcov", m.velocity_covariance, 21);
     }
 
+    enum Field { TIME, FRAME, CHILD, X, Y, Z, Q, VX, VY, VZ, RS, PS, YS, PCOV, VCOV };
+    static constexpr KeyEntry kKeys[] = {
+        {"time", TIME}, {"frame", FRAME}, {"child", CHILD}, {"x", X}, {"y", Y}, {"z", Z}, {"q", Q},
+        {"vx", VX}, {"vy", VY}, {"vz", VZ}, {"rs", RS}, {"ps", PS}, {"ys", YS},
+        {"pcov", PCOV}, {"vcov", VCOV},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
     // --- Streaming Decoder Context & Callbacks ---
+    // Array values (q, pcov, vcov) keep waiting_for_value set until their last element.
+    // A typed array (tag + byte string) completes the value in one callback.
+    // Values of unselected fields are still counted, so the key/value pairing
+    // holds, but never stored.
     struct DecodeContext {
         PayloadOdometry* m;
-        std::string current_key;
+        FieldProjection want;
+        int field = -1;
+        bool store = false; // field is selected
         bool waiting_for_value = false;
-        enum State { NONE, Q, PCOV, VCOV };
-        State state = NONE;
         int idx = 0;
+        uint64_t tag = 0;
+
+        DecodeContext(PayloadOdometry* p, FieldMask fields) : m(p), want(fields, 15) {}
+
+        void end_value() {
+            if (store) want.found(field);
+            waiting_for_value = false;
+        }
     };
 
     static void on_string(void* ctx, cbor_data data, size_t len) {
         DecodeContext* c = (DecodeContext*)ctx;
         if (!c->waiting_for_value) {
-            c->current_key.assign((const char*)data, len);
+            c->field = kFields.find((const char*)data, len);
+            c->store = c->want.wants(c->field);
             c->waiting_for_value = true;
-            
-            if (c->current_key == "q") c->state = DecodeContext::Q;
-            else if (c->current_key == "pcov") c->state = DecodeContext::PCOV;
-            else if (c->current_key == "vcov") c->state = DecodeContext::VCOV;
-            else c->state = DecodeContext::NONE;
-            
             c->idx = 0;
         }
     }
 
+    static void on_tag(void* ctx, uint64_t tag) { ((DecodeContext*)ctx)->tag = tag; }
+
+    static void on_bytes(void* ctx, cbor_data data, size_t len) {
+        DecodeContext* c = (DecodeContext*)ctx;
+        if (!c->waiting_for_value) return;
+        if (c->store) {
+            switch (c->field) {
+                case Q: load_typed_array(c->tag, data, len, c->m->q, 4); break;
+                case PCOV: load_typed_array(c->tag, data, len, c->m->pose_covariance, 21); break;
+                case VCOV: load_typed_array(c->tag, data, len, c->m->velocity_covariance, 21); break;
+            }
+        }
+        c->end_value();
+    }
+
+    static void array_element(DecodeContext* c, float* dst, int count, float val) {
+        if (c->idx < count && c->store) dst[c->idx] = val;
+        if (++c->idx >= count) c->end_value();
+    }
+
     static void handle_float(DecodeContext* c, float val) {
-        if (c->state == DecodeContext::Q) {
-            if(c->idx < 4) c->m->q[c->idx++] = val;
-            if(c->idx == 4) { c->state = DecodeContext::NONE; c->waiting_for_value = false; }
-        } else if (c->state == DecodeContext::PCOV) {
-            if(c->idx < 21) c->m->pose_covariance[c->idx++] = val;
-            if(c->idx == 21) { c->state = DecodeContext::NONE; c->waiting_for_value = false; }
-        } else if (c->state == DecodeContext::VCOV) {
-            if(c->idx < 21) c->m->velocity_covariance[c->idx++] = val;
-            if(c->idx == 21) { c->state = DecodeContext::NONE; c->waiting_for_value = false; }
-        } else if (c->waiting_for_value) {
-            if (c->current_key == "x") c->m->x = val;
-            else if (c->current_key == "y") c->m->y = val;
-            else if (c->current_key == "z") c->m->z = val;
-            else if (c->current_key == "vx") c->m->vx = val;
-            else if (c->current_key == "vy") c->m->vy = val;
-            else if (c->current_key == "vz") c->m->vz = val;
-            else if (c->current_key == "rs") c->m->rollspeed = val;
-            else if (c->current_key == "ps") c->m->pitchspeed = val;
-            else if (c->current_key == "ys") c->m->yawspeed = val;
-            c->waiting_for_value = false; 
+        if (!c->waiting_for_value) return;
+        switch (c->field) {
+            case Q: array_element(c, c->m->q, 4, val); return;
+            case PCOV: array_element(c, c->m->pose_covariance, 21, val); return;
+            case VCOV: array_element(c, c->m->velocity_covariance, 21, val); return;
+        }
+        if (c->store) store_float(c, val);
+        c->end_value();
+    }
+
+    static void store_float(DecodeContext* c, float val) {
+        switch (c->field) {
+            case X: c->m->x = val; break;
+            case Y: c->m->y = val; break;
+            case Z: c->m->z = val; break;
+            case VX: c->m->vx = val; break;
+            case VY: c->m->vy = val; break;
+            case VZ: c->m->vz = val; break;
+            case RS: c->m->rollspeed = val; break;
+            case PS: c->m->pitchspeed = val; break;
+            case YS: c->m->yawspeed = val; break;
         }
     }
     
     static void handle_int(DecodeContext* c, uint64_t val) {
          if (c->waiting_for_value) {
-             if (c->current_key == "time") c->m->time_usec = val;
-             else if (c->current_key == "frame") c->m->frame_id = (uint8_t)val;
-             else if (c->current_key == "child") c->m->child_frame_id = (uint8_t)val;
-             c->waiting_for_value = false;
+             if (c->store) {
+                 switch (c->field) {
+                     case TIME: c->m->time_usec = val; break;
+                     case FRAME: c->m->frame_id = (uint8_t)val; break;
+                     case CHILD: c->m->child_frame_id = (uint8_t)val; break;
+                 }
+             }
+             c->end_value();
          }
     }
 
@@ -163,12 +215,30 @@ public:
     static void on_uint64(void* ctx, uint64_t val) { handle_int((DecodeContext*)ctx, val); }
 
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
+        CborBenchmarkOdometry::decode_fields(data, len, out_data, kAllFields);
+    }
+
+    // Both decoders stop once the last selected field is stored. The native
+    // one steps over an unselected covariance array by item headers alone.
+    void decode_fields(const uint8_t* data, size_t len, void* out_data, FieldMask fields) override {
         PayloadOdometry& m = *static_cast<PayloadOdometry*>(out_data);
-        
+        if (native_) {
+            decode_native(data, len, m, fields);
+            return;
+        }
+        struct cbor_callbacks callbacks = make_callbacks();
+        decode_stream(callbacks, data, len, m, fields);
+    }
+
+    static struct cbor_callbacks make_callbacks() {
         struct cbor_callbacks callbacks = cbor_empty_callbacks;
         callbacks.string = on_string;
-         
+        callbacks.tag = on_tag;
+        callbacks.byte_string = on_bytes;
+
         callbacks.float2 = on_float; 
         callbacks.float4 = on_float;
         callbacks.float8 = on_double;
@@ -176,21 +246,80 @@ public:
         callbacks.uint16 = on_uint16;
         callbacks.uint32 = on_uint32;
         callbacks.uint64 = on_uint64;
-        
-        DecodeContext ctx;
-        ctx.m = &m;
-        
+        return callbacks;
+    }
+
+    void decode_stream(const struct cbor_callbacks& callbacks, const uint8_t* data, size_t len, PayloadOdometry& m,
+                       FieldMask fields = kAllFields) {
+        DecodeContext ctx(&m, fields);
+
         size_t offset = 0;
-        while(offset < buffer.size()) {
-             cbor_decoder_result res = cbor_stream_decode(buffer.data() + offset, buffer.size() - offset, &callbacks, &ctx);
+        while(offset < len && !ctx.want.done()) {
+             cbor_decoder_result res = cbor_stream_decode(data + offset, len - offset, &callbacks, &ctx);
              if (res.read == 0) break;
              offset += res.read;
              if (res.status != CBOR_DECODER_FINISHED) break; 
         }
     }
 
+    static void read_floats(NativeCborReader& in, float* dst, size_t count) {
+        read_numeric_array(in, dst, count, [](NativeCborReader& r) { return r.single(); });
+    }
+
+    void decode_native(const uint8_t* data, size_t len, PayloadOdometry& m, FieldMask fields = kAllFields) {
+        NativeCborReader in(data, len);
+        FieldProjection want(fields, 15);
+        uint64_t pairs = in.map();
+        for (uint64_t i = 0; i < pairs && in.ok() && !want.done(); i++) {
+            int field = in.key(kFields);
+            if (!want.wants(field)) {
+                in.skip();
+                continue;
+            }
+            switch (field) {
+                case TIME: m.time_usec = in.uint(); break;
+                case FRAME: m.frame_id = (uint8_t)in.uint(); break;
+                case CHILD: m.child_frame_id = (uint8_t)in.uint(); break;
+                case X: m.x = in.single(); break;
+                case Y: m.y = in.single(); break;
+                case Z: m.z = in.single(); break;
+                case Q: read_floats(in, m.q, 4); break;
+                case VX: m.vx = in.single(); break;
+                case VY: m.vy = in.single(); break;
+                case VZ: m.vz = in.single(); break;
+                case RS: m.rollspeed = in.single(); break;
+                case PS: m.pitchspeed = in.single(); break;
+                case YS: m.yawspeed = in.single(); break;
+                case PCOV: read_floats(in, m.pose_covariance, 21); break;
+                case VCOV: read_floats(in, m.velocity_covariance, 21); break;
+                default: in.skip(); break;
+            }
+            want.found(field);
+        }
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* frame, size_t frame_cap) {
+            return CborBenchmarkOdometry::encode_into(item, frame, frame_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        if (native_) {
+            return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+                decode_native(frame, frame_len, *static_cast<PayloadOdometry*>(out));
+            });
+        }
+        struct cbor_callbacks callbacks = make_callbacks();
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            decode_stream(callbacks, frame, frame_len, *static_cast<PayloadOdometry*>(out));
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "CBOR-Odometry"; }
+    std::string name() const override {
+        return std::string("CBOR-") + (native_ ? "Native-" : "") + (typed_arrays_ ? "TypedArrays-" : "") + "Odometry";
+    }
 };
 
 } // namespace pf
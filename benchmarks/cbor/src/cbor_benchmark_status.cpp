@@ -1,4 +1,5 @@
 #include "IBenchmark.h"
+#include "cbor_schema_codec.h"
 #include <cbor.h>
 #include <iostream>
 #include <vector>
@@ -8,7 +9,10 @@ namespace pf {
 
 class CborBenchmarkStatus : public IBenchmark {
 public:
+    bool native_ = false;
+
     void setup(const BenchmarkConfig& config) override {
+        native_ = config.variant_name == "Native";
          // Sanity
         PayloadStatus p;
         p.severity = 5;
@@ -23,65 +27,55 @@ public:
             std::cerr << "[CBOR-Status] Sanity Check: FAILED" << std::endl;
             exit(1);
         }
-        (void)config;
     }
 
-    std::vector<uint8_t> encode(const void* data) override {
-        const PayloadStatus& m = *static_cast<const PayloadStatus*>(data);
-        unsigned char buffer[1024];
-        unsigned char* ptr = buffer;
-        size_t buffer_size = sizeof(buffer);
-        size_t n;
-
-        n = cbor_encode_map_start(2, ptr, buffer_size); ptr += n; buffer_size -= n;
-        
-        // Helper
-        auto encode_str = [&](const char* key, const char* str) {
-            n = cbor_encode_string_start(strlen(key), ptr, buffer_size); ptr += n; buffer_size -= n;
-            memcpy(ptr, key, strlen(key)); ptr += strlen(key); buffer_size -= strlen(key);
-            
-            size_t vlen = strlen(str);
-            n = cbor_encode_string_start(vlen, ptr, buffer_size); ptr += n; buffer_size -= n;
-            memcpy(ptr, str, vlen); ptr += vlen; buffer_size -= vlen;
-        };
+    // Map header + 2 keys + severity + text[50]
+    static constexpr size_t kMaxEncodedSize = 1 + 2 * (1 + 3) + 2 + 2 + sizeof(PayloadStatus::text);
 
-        // Sev
-        n = cbor_encode_string_start(3, ptr, buffer_size); ptr += n; buffer_size -= n;
-        memcpy(ptr, "sev", 3); ptr += 3; buffer_size -= 3;
-        n = cbor_encode_uint8(m.severity, ptr, buffer_size); ptr += n; buffer_size -= n;
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
 
-        // Txt
-        encode_str("txt", m.text);
+    std::vector<uint8_t> encode(const void* data) override {
+        unsigned char buffer[kMaxEncodedSize];
+        size_t n = encode_into(data, buffer, sizeof(buffer));
+        return std::vector<uint8_t>(buffer, buffer + n);
+    }
 
-        return std::vector<uint8_t>(buffer, ptr);
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadStatus& m = *static_cast<const PayloadStatus*>(data);
+        if (cap < kMaxEncodedSize) return 0;
+        if (native_) {
+            NativeCborWriter out(dst, cap);
+            write_cbor_schema<KeyStyle::ShortName>(out, m);
+            return out.result();
+        }
+        CborSpanWriter out(dst, cap);
+        write_cbor_schema<KeyStyle::ShortName>(out, m);
+        return out.result();
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    // Streams straight into the payload; no cbor_item_t tree is built.
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadStatus& m = *static_cast<PayloadStatus*>(out_data);
-        struct cbor_load_result result;
-        cbor_item_t* item = cbor_load(buffer.data(), buffer.size(), &result);
-        if(!item) return;
+        if (native_) read_cbor_schema_native<KeyStyle::ShortName>(data, len, m);
+        else read_cbor_schema<KeyStyle::ShortName>(data, len, m);
+    }
 
-        if(cbor_isa_map(item)) {
-            cbor_pair* pairs = cbor_map_handle(item);
-            size_t sz = cbor_map_size(item);
-            for(size_t i=0; i<sz; i++) {
-                if(!cbor_isa_string(pairs[i].key)) continue;
-                std::string k((char*)cbor_string_handle(pairs[i].key), cbor_string_length(pairs[i].key));
-                if (k == "sev") m.severity = cbor_get_int(pairs[i].value);
-                else if (k == "txt" && cbor_isa_string(pairs[i].value)) {
-                    size_t vl = cbor_string_length(pairs[i].value);
-                    size_t cp = vl < 49 ? vl : 49;
-                    memcpy(m.text, cbor_string_handle(pairs[i].value), cp);
-                    m.text[cp] = '\0';
-                }
-            }
-        }
-        cbor_decref(&item);
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* frame, size_t frame_cap) {
+            return CborBenchmarkStatus::encode_into(item, frame, frame_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+            CborBenchmarkStatus::decode(frame, frame_len, out);
+        });
     }
 
     void teardown() override {}
-    std::string name() const override { return "CBOR-Status"; }
+    std::string name() const override { return native_ ? "CBOR-Native-Status" : "CBOR-Status"; }
 };
 
 } // pf
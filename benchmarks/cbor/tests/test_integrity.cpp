@@ -1,58 +1,344 @@
 #include "IBenchmark.h"
+#include "cbor_native.h"
+#include "cbor_typed_array.h"
+#include "plugin_check.hpp"
 #include <iostream>
+#include <cmath>
 #include <cstring>
-#include <cassert>
-#include <memory> 
+#include <memory>
 
-// External factory function
+// External factory function (pf_cbor, the GPSRaw scenario)
 extern "C" pf::IBenchmark* create_benchmark();
 
+using namespace pf;
+
+static int failures = 0;
+
 void log(const std::string& msg) {
     std::cout << "[CBOR-TEST] " << msg << std::endl;
 }
 
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "[CBOR-TEST] FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// The Native variant must write the bytes the libcbor variant writes, for
+// every pooled payload, and both must decode them to the same struct.
+template <typename T>
+void check_native(const char* libcbor_variant, const char* native_variant) {
+    CreateBenchmarkFunc create = load_plugin<T>(PF_PLUGIN_DIR, "cbor");
+    if (!create) {
+        check(false, std::string("plugin for ") + native_variant + " loads");
+        return;
+    }
+    std::unique_ptr<IBenchmark> lib = create_configured(create, libcbor_variant, 1);
+    std::unique_ptr<IBenchmark> native = create_configured(create, native_variant, 1);
+    const std::string label = lib->name() + " vs " + native->name();
+
+    size_t n = 0;
+    for (const T& p : check_payloads<T>()) {
+        std::vector<uint8_t> expected = lib->encode(&p);
+        std::vector<uint8_t> actual = native->encode(&p);
+        if (expected.empty() || actual != expected) {
+            check(false, label + ": payload " + std::to_string(n) + " encodes differently");
+            return;
+        }
+        T a = zeroed_payload<T>();
+        T b = zeroed_payload<T>();
+        lib->decode(expected, &a);
+        native->decode(expected, &b);
+        const std::string diff = first_difference(a, b);
+        if (!diff.empty()) {
+            check(false, label + ": payload " + std::to_string(n) + " decodes differently at " + diff);
+            return;
+        }
+        n++;
+    }
+    lib->teardown();
+    native->teardown();
+    log(label + ": " + std::to_string(n) + " payloads byte-identical");
+}
+
+// {0: "abc", 1: [1, -2, [3, {4: 1.5f}], h'0102'], 2: 1(5), 3: 7}
+static std::vector<uint8_t> nested_sample() {
+    uint8_t buf[64];
+    NativeCborWriter out(buf, sizeof(buf));
+    out.map(4);
+    out.uint(0); out.text("abc", 3);
+    out.uint(1); out.array(4);
+        out.uint(1); out.sint(-2);
+        out.array(2); out.uint(3); out.map(1); out.uint(4); out.single(1.5f);
+        const uint8_t b[] = {1, 2};
+        out.bytes(b, sizeof(b));
+    out.uint(2); out.tag(1); out.uint(5);
+    out.uint(3); out.uint(7);
+    return std::vector<uint8_t>(buf, buf + out.result());
+}
+
+// Reads nested_sample() key by key, skipping the values of keys 0..2.
+// @return The value of key 3, or 0 once the reader has failed
+static uint64_t read_sample(NativeCborReader& in) {
+    uint64_t n = in.map();
+    for (uint64_t i = 0; i < n && in.ok(); i++) {
+        if (in.int_key(4) == 3) return in.uint();
+        in.skip();
+    }
+    return 0;
+}
+
+void check_reader() {
+    const std::vector<uint8_t> sample = nested_sample();
+
+    // 1. skip() steps over text, nested arrays and maps, floats, byte strings and tags
+    {
+        NativeCborReader in(sample.data(), sample.size());
+        check(read_sample(in) == 7 && in.ok() && in.at_end(), "skip() over nested values");
+    }
+
+    // 2. Every truncation fails, and stays failed
+    for (size_t len = 0; len < sample.size(); len++) {
+        NativeCborReader in(sample.data(), len);
+        read_sample(in);
+        check(!in.ok(), "truncated at " + std::to_string(len) + " of " + std::to_string(sample.size()) + " latches ok() false");
+        check(in.uint() == 0 && !in.ok() && in.at_end(), "reads after a truncation return 0");
+    }
+
+    // 3. A type mismatch fails, and later well-formed items are not read
+    {
+        NativeCborReader in(sample.data(), sample.size());
+        check(in.array() == 0 && !in.ok(), "array() on a map latches ok() false");
+        check(in.map() == 0 && !in.ok(), "map() after a mismatch returns 0");
+    }
+    {
+        const uint8_t text_key[] = {0xa1, 0x61, 'k', 0x01}; // {"k": 1}
+        NativeCborReader in(text_key, sizeof(text_key));
+        in.map();
+        size_t len;
+        check(in.uint() == 0 && !in.ok(), "uint() on a text key latches ok() false");
+        check(in.text(len) != nullptr && len == 0, "text() after a mismatch is empty");
+    }
+    {
+        const uint8_t str[] = {0x65, 'a', 'b'}; // Text claiming 5 bytes, 2 present
+        NativeCborReader in(str, sizeof(str));
+        size_t len;
+        in.text(len);
+        check(!in.ok() && len == 0, "text() longer than the input latches ok() false");
+    }
+
+    // 4. Indefinite lengths and runaway nesting are refused
+    {
+        const uint8_t indefinite[] = {0x9f, 0x01, 0xff};
+        NativeCborReader in(indefinite, sizeof(indefinite));
+        in.skip();
+        check(!in.ok(), "indefinite-length array latches ok() false");
+    }
+    {
+        std::vector<uint8_t> deep(32, 0x81); // [[[...[0]...]]]
+        deep.push_back(0x00);
+        NativeCborReader in(deep.data(), deep.size());
+        in.skip();
+        check(!in.ok(), "skip() deeper than 16 levels latches ok() false");
+    }
+}
+
+// A TypedArrays decoder must read the plain-array frames of Standard as
+// well as its own, and both into the payload that was encoded.
+template <typename T>
+void check_typed_array_variant(const char* variant) {
+    CreateBenchmarkFunc create = load_plugin<T>(PF_PLUGIN_DIR, "cbor");
+    if (!create) {
+        check(false, std::string("plugin for ") + variant + " loads");
+        return;
+    }
+    std::unique_ptr<IBenchmark> plain = create_configured(create, "Standard", 1);
+    std::unique_ptr<IBenchmark> typed = create_configured(create, variant, 1);
+
+    size_t n = 0;
+    for (const T& p : check_payloads<T>()) {
+        std::vector<uint8_t> own = typed->encode(&p);
+        std::vector<uint8_t> other = plain->encode(&p);
+        T a = zeroed_payload<T>();
+        T b = zeroed_payload<T>();
+        typed->decode(own, &a);
+        typed->decode(other, &b);
+        const std::string own_diff = first_difference(p, a);
+        const std::string other_diff = first_difference(p, b);
+        if (own.size() >= other.size() || !own_diff.empty() || !other_diff.empty()) {
+            check(false, typed->name() + ": payload " + std::to_string(n) + " mismatch at " +
+                             (own_diff.empty() ? other_diff : own_diff));
+            return;
+        }
+        n++;
+    }
+    plain->teardown();
+    typed->teardown();
+    log(std::string(variant) + " " + scenario_suffix<T>() + ": " + std::to_string(n) +
+        " payloads round-trip, and Standard frames decode");
+}
+
+void check_typed_array_helpers() {
+    float floats[21];
+    for (size_t i = 0; i < 21; i++) floats[i] = (float)i * -0.37f;
+    floats[1] = -0.0f;
+    floats[2] = std::nanf("0x2a"); // The payload bits must survive too
+    floats[3] = INFINITY;
+    uint16_t shorts[10];
+    for (size_t i = 0; i < 10; i++) shorts[i] = (uint16_t)(0xfff0 + i);
+
+    // [85(h'<floats>'), 69(h'<shorts>'), [1.5, 2.5, 3.5]]
+    uint8_t buf[256];
+    NativeCborWriter out(buf, sizeof(buf));
+    out.array(3);
+    write_typed_array(out, floats, 21);
+    write_typed_array(out, shorts, 10);
+    out.array(3);
+    out.single(1.5f); out.single(2.5f); out.single(3.5f);
+    const size_t len = out.result();
+    check(len == 1 + (2 + 2 + 84) + (2 + 1 + 20) + (1 + 3 * 5), "typed arrays are tag + byte string");
+
+    // 1. read_numeric_array returns both typed arrays bit for bit, and reads a
+    //    plain array element by element, dropping the elements past count
+    float floats_back[21] = {};
+    uint16_t shorts_back[10] = {};
+    float plain_back[2] = {};
+    NativeCborReader in(buf, len);
+    in.array();
+    auto read_float = [](NativeCborReader& r) { return r.single(); };
+    read_numeric_array(in, floats_back, 21, read_float);
+    read_numeric_array(in, shorts_back, 10, [](NativeCborReader& r) { return (uint16_t)r.uint(); });
+    read_numeric_array(in, plain_back, 2, read_float);
+    check(in.ok() && in.at_end(), "typed and plain arrays read to the end");
+    check(memcmp(floats_back, floats, sizeof(floats)) == 0, "float32 typed array round-trips bitwise");
+    check(memcmp(shorts_back, shorts, sizeof(shorts)) == 0, "uint16 typed array round-trips");
+    check(plain_back[0] == 1.5f && plain_back[1] == 2.5f, "plain array fills count elements");
+
+    // 2. load_typed_array refuses a foreign tag or a length other than count
+    //    elements, and leaves dst untouched
+    uint16_t dst[10] = {7, 7, 7, 7, 7, 7, 7, 7, 7, 7};
+    const uint16_t untouched[10] = {7, 7, 7, 7, 7, 7, 7, 7, 7, 7};
+    const uint8_t* src = (const uint8_t*)shorts;
+    check(!load_typed_array(CborTypedArrayTag<float>::value, src, 20, dst, 10), "uint16 load refuses tag 85");
+    check(!load_typed_array(CborTypedArrayTag<uint16_t>::value, src, 18, dst, 10), "short typed array is refused");
+    check(!load_typed_array(CborTypedArrayTag<uint16_t>::value, src, 20, dst, 9), "long typed array is refused");
+    check(memcmp(dst, untouched, sizeof(dst)) == 0, "refused typed arrays leave dst untouched");
+    check(load_typed_array(CborTypedArrayTag<uint16_t>::value, src, 20, dst, 10) &&
+              memcmp(dst, shorts, sizeof(dst)) == 0, "matching typed array loads");
+
+    // 3. A typed array cut short fails the reader instead of reading past the input
+    NativeCborReader cut(buf, 1 + 2 + 2 + 40);
+    cut.array();
+    float partial[21] = {};
+    read_numeric_array(cut, partial, 21, read_float);
+    check(!cut.ok(), "truncated typed array latches ok() false");
+}
+
+// decode() is a complete parse: a repeated key keeps its last value. A
+// projection stops at the first occurrence of the last field it selected.
+void check_full_decode(IBenchmark& bench) {
+    uint8_t frame[16];
+    NativeCborWriter out(frame, sizeof(frame));
+    out.map(3);
+    out.uint(0); out.uint(1);   // timestamp = 1
+    out.uint(1); out.uint(7);   // block_number = 7
+    out.uint(0); out.uint(2);   // timestamp = 2
+    const size_t len = out.result();
+
+    for (const char* variant : {"Standard", "Native"}) {
+        BenchmarkConfig config;
+        config.iterations = 1;
+        config.variant_name = variant;
+        bench.setup(config);
+
+        Payload full = zeroed_payload<Payload>();
+        bench.decode(frame, len, &full);
+        check(full.timestamp == 2 && full.block_number == 7, std::string(variant) + " decode() keeps the last value");
+
+        Payload first = zeroed_payload<Payload>();
+        bench.decode_fields(frame, len, &first, 1u << 0);
+        check(first.timestamp == 1 && first.block_number == 0, std::string(variant) + " decode_fields() stops at the first value");
+    }
+}
+
 int main() {
     log("Starting CBOR Integrity Test...");
 
     std::unique_ptr<pf::IBenchmark> bench(create_benchmark());
-    
-    // 1. Test Standard Variant (Int Keys)
-    {
+
+    // 1. Both key styles round-trip the GPSRaw payload
+    for (const char* variant : {"Standard", "StringKeys"}) {
         pf::BenchmarkConfig config;
         config.iterations = 1;
-        config.variant_name = "Standard";
+        config.variant_name = variant;
         bench->setup(config);
-        
+
         pf::Payload original;
+        memset(&original, 0, sizeof(original));
         original.timestamp = 9876543210;
         memset(original.hash, 0xBB, 32);
-        
-        std::vector<uint8_t> buffer = bench->encode(original);
-        log("Standard Encoded Size: " + std::to_string(buffer.size()) + " bytes");
-        
-        // Mock Decode Check (since decode is currently a stub in skeleton)
-        // In real impl, we'd assert(decoded == original);
-        // assert(buffer.size() > 0);
-    }
-    
-    // 2. Test String Keys Variant
-    {
-        pf::BenchmarkConfig config;
-        config.iterations = 1;
-        config.variant_name = "StringKeys";
-        bench->setup(config);
-        
-        pf::Payload original;
-        original.timestamp = 9876543210;
-        
-        std::vector<uint8_t> buffer = bench->encode(original);
-        log("StringKey Encoded Size: " + std::to_string(buffer.size()) + " bytes");
-        
-        // Sanity Check: String keys should be larger
-        // assert(buffer.size() > prev_size); 
-    }
-    
-    log("Integrity Check Passed!");
+
+        std::vector<uint8_t> buffer = bench->encode(&original);
+        log(std::string(variant) + " Encoded Size: " + std::to_string(buffer.size()) + " bytes");
+
+        pf::Payload decoded;
+        memset(&decoded, 0, sizeof(decoded));
+        bench->decode(buffer, &decoded);
+        check(first_difference(original, decoded).empty(), std::string(variant) + " round-trips");
+    }
+    check_full_decode(*bench);
     bench->teardown();
+
+    // 2. cbor_native.h writes libcbor's bytes in every scenario and key style
+    check_native<PayloadGPSRaw>("Standard", "Native");
+    check_native<PayloadGPSRaw>("StringKeys", "NativeStringKeys");
+    check_native<PayloadBattery>("Standard", "Native");
+    check_native<PayloadOdometry>("Standard", "Native");
+    check_native<PayloadAttitude>("Standard", "Native");
+    check_native<PayloadGlobalPosition>("Standard", "Native");
+    check_native<PayloadStatus>("Standard", "Native");
+    check_native<PayloadGPSBlock>("Standard", "Native");
+
+    // 3. NativeCborReader on malformed and nested input
+    check_reader();
+
+    // 4. RFC 8746 typed arrays: the helpers, and both TypedArrays variants
+    check_typed_array_helpers();
+    check_native<PayloadOdometry>("TypedArrays", "NativeTypedArrays");
+    check_native<PayloadBattery>("TypedArrays", "NativeTypedArrays");
+    for (const char* variant : {"TypedArrays", "NativeTypedArrays"}) {
+        check_typed_array_variant<PayloadOdometry>(variant);
+        check_typed_array_variant<PayloadBattery>(variant);
+    }
+
+    // 5. No codec drops a field
+    for (const std::vector<std::string>& lost : {
+             schema_coverage_failures<PayloadGPSRaw>("cbor", {"Standard", "StringKeys", "Native", "NativeStringKeys"}),
+             schema_coverage_failures<PayloadBattery>("cbor", {"Standard", "Native", "TypedArrays", "NativeTypedArrays"}),
+             schema_coverage_failures<PayloadOdometry>("cbor", {"Standard", "Native", "TypedArrays", "NativeTypedArrays"}),
+             schema_coverage_failures<PayloadAttitude>("cbor", {"Standard", "Native"}),
+             schema_coverage_failures<PayloadGlobalPosition>("cbor", {"Standard", "Native"}),
+             schema_coverage_failures<PayloadStatus>("cbor", {"Standard", "Native"}),
+             schema_coverage_failures<PayloadGPSBlock>("cbor", {"Standard", "Native", "Columnar"})}) {
+        for (const std::string& f : lost) check(false, f);
+    }
+
+    // 6. Columnar GPSBlock at its edges
+    CreateBenchmarkFunc create = load_plugin<PayloadGPSBlock>(PF_PLUGIN_DIR, "cbor");
+    check(create != nullptr, "plugin cbor_gps_block loads");
+    if (create) {
+        std::unique_ptr<IBenchmark> columnar = create_configured(create, "Columnar", 1);
+        const std::string diff = columnar_round_trip_difference(*columnar);
+        check(diff.empty(), columnar->name() + ": " + diff);
+        if (diff.empty()) log(columnar->name() + ": edge blocks round-trip, truncated frames fail");
+        columnar->teardown();
+    }
+
+    if (failures) {
+        log(std::to_string(failures) + " check(s) failed");
+        return 1;
+    }
+    log("Integrity Check Passed!");
     return 0;
 }
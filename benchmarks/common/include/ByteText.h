@@ -0,0 +1,395 @@
+#ifndef PRIME_FUSION_BYTE_TEXT_H
+#define PRIME_FUSION_BYTE_TEXT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(PF_BYTE_TEXT_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>
+#define PF_BYTE_TEXT_SSE2 1
+#elif !defined(PF_BYTE_TEXT_SCALAR) && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PF_BYTE_TEXT_NEON 1
+#endif
+
+namespace pf {
+
+/**
+ * @brief Hex and base64 for byte fields carried in text formats (JSON's hash).
+ * Each codec has a table-driven loop, which takes any length, and a vector
+ * loop over whole blocks: SSE2 on x86-64, where it is always available, and
+ * NEON on AArch64. The public functions below run the vector loop first and
+ * finish the remainder with the tables. Defining PF_BYTE_TEXT_SCALAR before
+ * the include leaves only the tables.
+ *
+ * Hex is written lowercase and read in either case. Base64 is the RFC 4648
+ * alphabet with '=' padding; decoding rejects any other character.
+ */
+namespace byte_text {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+constexpr char kBase64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr uint8_t kInvalid = 0xFF;
+
+// kHexPairs.c[b] holds the two hex digits of byte b
+struct HexPairs { char c[256][2]; };
+// value[ch]: the digit value of character ch, kInvalid if it is not one
+struct DigitValues { uint8_t value[256]; };
+
+constexpr HexPairs make_hex_pairs() {
+    HexPairs t{};
+    for (int b = 0; b < 256; b++) {
+        t.c[b][0] = kHexDigits[b >> 4];
+        t.c[b][1] = kHexDigits[b & 0x0f];
+    }
+    return t;
+}
+
+constexpr DigitValues make_hex_values() {
+    DigitValues t{};
+    for (int c = 0; c < 256; c++) t.value[c] = kInvalid;
+    for (int d = 0; d < 16; d++) {
+        t.value[(uint8_t)kHexDigits[d]] = (uint8_t)d;
+        if (d >= 10) t.value['A' + d - 10] = (uint8_t)d;
+    }
+    return t;
+}
+
+constexpr DigitValues make_base64_values() {
+    DigitValues t{};
+    for (int c = 0; c < 256; c++) t.value[c] = kInvalid;
+    for (int d = 0; d < 64; d++) t.value[(uint8_t)kBase64Chars[d]] = (uint8_t)d;
+    return t;
+}
+
+inline constexpr HexPairs kHexPairs = make_hex_pairs();
+inline constexpr DigitValues kHexValues = make_hex_values();
+inline constexpr DigitValues kBase64Values = make_base64_values();
+
+// --- Tables ---
+
+inline void hex_encode_table(const uint8_t* src, size_t n, char* dst) {
+    for (size_t i = 0; i < n; i++) memcpy(dst + 2 * i, kHexPairs.c[src[i]], 2);
+}
+
+inline bool hex_decode_table(const char* src, size_t n, uint8_t* dst) {
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t hi = kHexValues.value[(uint8_t)src[2 * i]];
+        const uint8_t lo = kHexValues.value[(uint8_t)src[2 * i + 1]];
+        if ((hi | lo) & 0xF0) return false;
+        dst[i] = (uint8_t)(hi << 4 | lo);
+    }
+    return true;
+}
+
+inline size_t base64_encode_table(const uint8_t* src, size_t n, char* dst) {
+    char* out = dst;
+    size_t i = 0;
+    for (; i + 3 <= n; i += 3, out += 4) {
+        const uint32_t v = (uint32_t)src[i] << 16 | (uint32_t)src[i + 1] << 8 | src[i + 2];
+        out[0] = kBase64Chars[v >> 18];
+        out[1] = kBase64Chars[(v >> 12) & 63];
+        out[2] = kBase64Chars[(v >> 6) & 63];
+        out[3] = kBase64Chars[v & 63];
+    }
+    if (i < n) {
+        const bool two = i + 1 < n;
+        const uint32_t v = (uint32_t)src[i] << 16 | (two ? (uint32_t)src[i + 1] << 8 : 0);
+        out[0] = kBase64Chars[v >> 18];
+        out[1] = kBase64Chars[(v >> 12) & 63];
+        out[2] = two ? kBase64Chars[(v >> 6) & 63] : '=';
+        out[3] = '=';
+        out += 4;
+    }
+    return (size_t)(out - dst);
+}
+
+// Whole quads only; the last one may end in "=" or "==". n is the byte count.
+inline bool base64_decode_table(const char* src, size_t len, uint8_t* dst, size_t& n) {
+    n = 0;
+    if (len % 4) return false;
+    for (size_t i = 0; i < len; i += 4) {
+        const int pad = i + 4 < len ? 0 : (src[i + 3] == '=') + (src[i + 3] == '=' && src[i + 2] == '=');
+        const uint8_t a = kBase64Values.value[(uint8_t)src[i]];
+        const uint8_t b = kBase64Values.value[(uint8_t)src[i + 1]];
+        const uint8_t c = pad == 2 ? 0 : kBase64Values.value[(uint8_t)src[i + 2]];
+        const uint8_t d = pad >= 1 ? 0 : kBase64Values.value[(uint8_t)src[i + 3]];
+        if ((a | b | c | d) & 0xC0) return false;
+        const uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | d;
+        dst[n++] = (uint8_t)(v >> 16);
+        if (pad < 2) dst[n++] = (uint8_t)(v >> 8);
+        if (pad < 1) dst[n++] = (uint8_t)v;
+    }
+    return true;
+}
+
+// --- Vector loops ---
+// Each returns how much it consumed (always whole blocks); the tables do the rest.
+
+#if defined(PF_BYTE_TEXT_SSE2)
+
+// Nibbles (0..15 per byte) to their lowercase hex digits
+inline __m128i sse2_hex_digits(__m128i nibbles) {
+    const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+}
+
+// True in lanes where lo <= x - base <= hi (x - base taken as signed, which
+// keeps characters >= 0x80 out of every range used here)
+inline __m128i sse2_in_range(__m128i x, char base, char span) {
+    const __m128i d = _mm_sub_epi8(x, _mm_set1_epi8(base));
+    return _mm_and_si128(_mm_cmpgt_epi8(d, _mm_set1_epi8(-1)), _mm_cmplt_epi8(d, _mm_set1_epi8((char)(span + 1))));
+}
+
+// Hex characters to nibble values; ok loses the lanes that are not hex digits
+inline __m128i sse2_hex_values(__m128i c, __m128i& ok) {
+    const __m128i is_digit = sse2_in_range(c, '0', 9);
+    const __m128i folded = _mm_or_si128(c, _mm_set1_epi8(0x20)); // 'A'..'F' -> 'a'..'f'
+    const __m128i is_alpha = sse2_in_range(folded, 'a', 5);
+    ok = _mm_and_si128(ok, _mm_or_si128(is_digit, is_alpha));
+    return _mm_or_si128(_mm_and_si128(is_digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+                        _mm_and_si128(is_alpha, _mm_sub_epi8(folded, _mm_set1_epi8('a' - 10))));
+}
+
+// 16 bytes -> 32 digits per block
+inline size_t hex_encode_simd(const uint8_t* src, size_t n, char* dst) {
+    const __m128i low = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i hi = sse2_hex_digits(_mm_and_si128(_mm_srli_epi16(v, 4), low));
+        const __m128i lo = sse2_hex_digits(_mm_and_si128(v, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+// 32 digits -> 16 bytes per block; done counts the bytes written
+inline bool hex_decode_simd(const char* src, size_t n, uint8_t* dst, size_t& done) {
+    const __m128i low_byte = _mm_set1_epi16(0x00ff);
+    for (done = 0; done + 16 <= n; done += 16) {
+        __m128i ok = _mm_set1_epi8(-1);
+        const __m128i a = sse2_hex_values(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * done)), ok);
+        const __m128i b = sse2_hex_values(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * done + 16)), ok);
+        if (_mm_movemask_epi8(ok) != 0xFFFF) return false;
+        // Each 16-bit lane holds (high digit, low digit); fold it into one byte
+        const __m128i ab = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(a, 4), _mm_srli_epi16(a, 8)), low_byte);
+        const __m128i bb = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(b, 4), _mm_srli_epi16(b, 8)), low_byte);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + done), _mm_packus_epi16(ab, bb));
+    }
+    return true;
+}
+
+// 12 bytes -> 16 characters per block. SSE2 has no byte shuffle, so each
+// 32-bit lane is loaded with its 3 bytes by hand; the bit split and the
+// alphabet mapping run on all four lanes at once.
+inline size_t base64_encode_simd(const uint8_t* src, size_t n, char* dst) {
+    const __m128i six = _mm_set1_epi32(63);
+    size_t i = 0;
+    for (; i + 12 <= n; i += 12) {
+        const uint8_t* s = src + i;
+        const __m128i v = _mm_setr_epi32(s[0] << 16 | s[1] << 8 | s[2], s[3] << 16 | s[4] << 8 | s[5],
+                                         s[6] << 16 | s[7] << 8 | s[8], s[9] << 16 | s[10] << 8 | s[11]);
+        // Lane bytes, in memory order: bits 23..18, 17..12, 11..6, 5..0
+        __m128i idx = _mm_srli_epi32(v, 18);
+        idx = _mm_or_si128(idx, _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 12), six), 8));
+        idx = _mm_or_si128(idx, _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(v, 6), six), 16));
+        idx = _mm_or_si128(idx, _mm_slli_epi32(_mm_and_si128(v, six), 24));
+        // 'A' + idx, moved on at each boundary of the alphabet
+        __m128i shift = _mm_set1_epi8('A');
+        shift = _mm_add_epi8(shift, _mm_and_si128(_mm_cmpgt_epi8(idx, _mm_set1_epi8(25)), _mm_set1_epi8('a' - 'A' - 26)));
+        shift = _mm_add_epi8(shift, _mm_and_si128(_mm_cmpgt_epi8(idx, _mm_set1_epi8(51)), _mm_set1_epi8('0' - 'a' - 26)));
+        shift = _mm_add_epi8(shift, _mm_and_si128(_mm_cmpgt_epi8(idx, _mm_set1_epi8(61)), _mm_set1_epi8('+' - '0' - 10)));
+        shift = _mm_add_epi8(shift, _mm_and_si128(_mm_cmpgt_epi8(idx, _mm_set1_epi8(62)), _mm_set1_epi8('/' - '+' - 1)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i / 3 * 4), _mm_add_epi8(idx, shift));
+    }
+    return i;
+}
+
+// 16 characters -> 12 bytes per block; consumed counts characters. The
+// block's two 8-byte stores run 2 bytes past its output, so at least two
+// quads (4 or more bytes) always stay for the table, padded final quad
+// included.
+inline bool base64_decode_simd(const char* src, size_t len, uint8_t* dst, size_t& consumed) {
+    const __m128i low_byte = _mm_set1_epi32(0xff);
+    for (consumed = 0; consumed + 20 < len; consumed += 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + consumed));
+        const __m128i upper = sse2_in_range(c, 'A', 25);
+        const __m128i lower = sse2_in_range(c, 'a', 25);
+        const __m128i digit = sse2_in_range(c, '0', 9);
+        const __m128i plus = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+        const __m128i slash = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+        const __m128i ok = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+        if (_mm_movemask_epi8(ok) != 0xFFFF) return false;
+        __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+        shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+        shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+        shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+        shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+        const __m128i v = _mm_add_epi8(c, shift);
+        // Two 6-bit values per 16-bit word, then both words of a lane with
+        // one multiply-add: bits = (v0 << 6 | v1) << 12 | (v2 << 6 | v3)
+        const __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00ff)), 6), _mm_srli_epi16(v, 8));
+        const __m128i bits = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        // Most significant byte first in each lane, then close the gap
+        // between the two lanes of each 64-bit half
+        const __m128i be = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(bits, 16), low_byte),
+                                                     _mm_and_si128(bits, _mm_set1_epi32(0xff00))),
+                                        _mm_slli_epi32(_mm_and_si128(bits, low_byte), 16));
+        const __m128i packed = _mm_or_si128(_mm_and_si128(be, _mm_set1_epi64x(0xffffff)),
+                                            _mm_srli_epi64(_mm_and_si128(be, _mm_set1_epi64x(0xffffff00000000LL)), 8));
+        uint8_t* out = dst + consumed / 4 * 3;
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 6), _mm_unpackhi_epi64(packed, packed));
+    }
+    return true;
+}
+
+#elif defined(PF_BYTE_TEXT_NEON)
+
+// Hex characters to nibble values; ok loses the lanes that are not hex digits
+inline uint8x16_t neon_hex_values(uint8x16_t c, uint8x16_t& ok) {
+    const uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+    const uint8x16_t alpha = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    const uint8x16_t is_digit = vcltq_u8(digit, vdupq_n_u8(10));
+    const uint8x16_t is_alpha = vcltq_u8(alpha, vdupq_n_u8(6));
+    ok = vandq_u8(ok, vorrq_u8(is_digit, is_alpha));
+    return vbslq_u8(is_digit, digit, vaddq_u8(alpha, vdupq_n_u8(10)));
+}
+
+// 16 bytes -> 32 digits per block; vst2 interleaves the high and low digits
+inline size_t hex_encode_simd(const uint8_t* src, size_t n, char* dst) {
+    const uint8x16_t digits = vld1q_u8(reinterpret_cast<const uint8_t*>(kHexDigits));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const uint8x16_t v = vld1q_u8(src + i);
+        uint8x16x2_t out;
+        out.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(v, 4));
+        out.val[1] = vqtbl1q_u8(digits, vandq_u8(v, vdupq_n_u8(0x0f)));
+        vst2q_u8(reinterpret_cast<uint8_t*>(dst + 2 * i), out);
+    }
+    return i;
+}
+
+// 32 digits -> 16 bytes per block; vld2 splits high and low digits
+inline bool hex_decode_simd(const char* src, size_t n, uint8_t* dst, size_t& done) {
+    for (done = 0; done + 16 <= n; done += 16) {
+        const uint8x16x2_t c = vld2q_u8(reinterpret_cast<const uint8_t*>(src + 2 * done));
+        uint8x16_t ok = vdupq_n_u8(0xFF);
+        const uint8x16_t hi = neon_hex_values(c.val[0], ok);
+        const uint8x16_t lo = neon_hex_values(c.val[1], ok);
+        if (vminvq_u8(ok) == 0) return false;
+        vst1q_u8(dst + done, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+    }
+    return true;
+}
+
+// 48 bytes -> 64 characters per block: vld3 splits the byte triples, the
+// alphabet is one 64-byte table lookup, vst4 interleaves the quads
+inline size_t base64_encode_simd(const uint8_t* src, size_t n, char* dst) {
+    const uint8_t* alphabet = reinterpret_cast<const uint8_t*>(kBase64Chars);
+    uint8x16x4_t table;
+    for (int k = 0; k < 4; k++) table.val[k] = vld1q_u8(alphabet + 16 * k);
+    size_t i = 0;
+    for (; i + 48 <= n; i += 48) {
+        const uint8x16x3_t in = vld3q_u8(src + i);
+        uint8x16x4_t out;
+        out.val[0] = vshrq_n_u8(in.val[0], 2);
+        out.val[1] = vorrq_u8(vshlq_n_u8(vandq_u8(in.val[0], vdupq_n_u8(0x03)), 4), vshrq_n_u8(in.val[1], 4));
+        out.val[2] = vorrq_u8(vshlq_n_u8(vandq_u8(in.val[1], vdupq_n_u8(0x0f)), 2), vshrq_n_u8(in.val[2], 6));
+        out.val[3] = vandq_u8(in.val[2], vdupq_n_u8(0x3f));
+        for (int k = 0; k < 4; k++) out.val[k] = vqtbl4q_u8(table, out.val[k]);
+        vst4q_u8(reinterpret_cast<uint8_t*>(dst + i / 3 * 4), out);
+    }
+    return i;
+}
+
+// Base64 characters to 6-bit values; ok loses the lanes outside the alphabet
+inline uint8x16_t neon_base64_values(uint8x16_t c, uint8x16_t& ok) {
+    const uint8x16_t upper = vsubq_u8(c, vdupq_n_u8('A'));
+    const uint8x16_t lower = vsubq_u8(c, vdupq_n_u8('a'));
+    const uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+    const uint8x16_t is_upper = vcltq_u8(upper, vdupq_n_u8(26));
+    const uint8x16_t is_lower = vcltq_u8(lower, vdupq_n_u8(26));
+    const uint8x16_t is_digit = vcltq_u8(digit, vdupq_n_u8(10));
+    const uint8x16_t is_plus = vceqq_u8(c, vdupq_n_u8('+'));
+    const uint8x16_t is_slash = vceqq_u8(c, vdupq_n_u8('/'));
+    ok = vandq_u8(ok, vorrq_u8(vorrq_u8(is_upper, is_lower), vorrq_u8(is_digit, vorrq_u8(is_plus, is_slash))));
+    uint8x16_t v = vandq_u8(is_upper, upper);
+    v = vorrq_u8(v, vandq_u8(is_lower, vaddq_u8(lower, vdupq_n_u8(26))));
+    v = vorrq_u8(v, vandq_u8(is_digit, vaddq_u8(digit, vdupq_n_u8(52))));
+    v = vorrq_u8(v, vandq_u8(is_plus, vdupq_n_u8(62)));
+    return vorrq_u8(v, vandq_u8(is_slash, vdupq_n_u8(63)));
+}
+
+// 64 characters -> 48 bytes per block, never the final quad (it may be padded)
+inline bool base64_decode_simd(const char* src, size_t len, uint8_t* dst, size_t& consumed) {
+    for (consumed = 0; consumed + 64 < len; consumed += 64) {
+        const uint8x16x4_t c = vld4q_u8(reinterpret_cast<const uint8_t*>(src + consumed));
+        uint8x16_t ok = vdupq_n_u8(0xFF);
+        uint8x16_t v[4];
+        for (int k = 0; k < 4; k++) v[k] = neon_base64_values(c.val[k], ok);
+        if (vminvq_u8(ok) == 0) return false;
+        uint8x16x3_t out;
+        out.val[0] = vorrq_u8(vshlq_n_u8(v[0], 2), vshrq_n_u8(v[1], 4));
+        out.val[1] = vorrq_u8(vshlq_n_u8(v[1], 4), vshrq_n_u8(v[2], 2));
+        out.val[2] = vorrq_u8(vshlq_n_u8(v[2], 6), v[3]);
+        vst3q_u8(dst + consumed / 4 * 3, out);
+    }
+    return true;
+}
+
+#else
+
+inline size_t hex_encode_simd(const uint8_t*, size_t, char*) { return 0; }
+inline bool hex_decode_simd(const char*, size_t, uint8_t*, size_t& done) { done = 0; return true; }
+inline size_t base64_encode_simd(const uint8_t*, size_t, char*) { return 0; }
+inline bool base64_decode_simd(const char*, size_t, uint8_t*, size_t& consumed) { consumed = 0; return true; }
+
+#endif
+
+} // namespace byte_text
+
+// Lowercase hex of n bytes into dst[0..2n)
+inline void hex_encode(const uint8_t* src, size_t n, char* dst) {
+    const size_t done = byte_text::hex_encode_simd(src, n, dst);
+    byte_text::hex_encode_table(src + done, n - done, dst + 2 * done);
+}
+
+// n bytes from the 2n hex digits at src; false on a non-hex digit
+inline bool hex_decode(const char* src, size_t n, uint8_t* dst) {
+    size_t done = 0;
+    if (!byte_text::hex_decode_simd(src, n, dst, done)) return false;
+    return byte_text::hex_decode_table(src + 2 * done, n - done, dst + done);
+}
+
+constexpr size_t base64_size(size_t n) { return (n + 2) / 3 * 4; }
+
+// Bytes that base64_decode() will write for this text (len a multiple of 4)
+inline size_t base64_decoded_size(const char* src, size_t len) {
+    if (len < 4) return 0;
+    return len / 4 * 3 - (src[len - 1] == '=') - (src[len - 1] == '=' && src[len - 2] == '=');
+}
+
+// Padded base64 of n bytes into dst; returns base64_size(n)
+inline size_t base64_encode(const uint8_t* src, size_t n, char* dst) {
+    const size_t done = byte_text::base64_encode_simd(src, n, dst);
+    return done / 3 * 4 + byte_text::base64_encode_table(src + done, n - done, dst + done / 3 * 4);
+}
+
+// dst must hold base64_decoded_size(src, len) bytes; n gets that count
+inline bool base64_decode(const char* src, size_t len, uint8_t* dst, size_t& n) {
+    n = 0;
+    if (len % 4) return false;
+    size_t consumed = 0, tail = 0;
+    if (!byte_text::base64_decode_simd(src, len, dst, consumed)) return false;
+    if (!byte_text::base64_decode_table(src + consumed, len - consumed, dst + consumed / 4 * 3, tail)) return false;
+    n = consumed / 4 * 3 + tail;
+    return true;
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_BYTE_TEXT_H
@@ -0,0 +1,212 @@
+#ifndef PRIME_FUSION_COLUMNAR_BLOCK_H
+#define PRIME_FUSION_COLUMNAR_BLOCK_H
+
+#include "SchemaCodec.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief Structure-of-arrays layout for blocks of records (GPSBlock).
+ * Instead of one map per record, a block carries the record count under
+ * kColumnCountKey and then one column per schema field, keyed by short name:
+ * - Integer fields: each record's value minus the previous record's (the first
+ *   record against 0), zigzag-mapped and written as LEB128 varints. Monotonic
+ *   and slow-moving fields (timestamps, lat/lon/alt, accuracies) shrink to one
+ *   or two bytes per record, and constant fields to one.
+ * - BYTES fields: every record's bytes back to back.
+ * Differences are taken modulo 2^64, so every value round-trips exactly
+ * whatever its type. F32 and CHARS fields have no column encoding; schemas used
+ * here must not contain them.
+ *
+ * The formats differ only in the container: CBOR and MsgPack put each column in
+ * a byte string, protobuf uses packed `sint64` fields (its own zigzag varints),
+ * and JSON writes the differences as a plain number array.
+ */
+
+constexpr const char* kColumnCountKey = "n";
+
+// Longest LEB128 encoding of a 64-bit value
+constexpr size_t kMaxVarintBytes = 10;
+
+constexpr bool is_integer_field(FieldType type) {
+    return type != FieldType::F32 && type != FieldType::BYTES && type != FieldType::CHARS;
+}
+
+template <typename T>
+constexpr bool schema_is_columnar() {
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const FieldDesc& d = PayloadSchema<T>::fields[i];
+        if (d.type == FieldType::BYTES) continue;
+        if (!is_integer_field(d.type) || d.count != 1) return false;
+    }
+    return true;
+}
+
+inline uint64_t zigzag_encode(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+inline int64_t zigzag_decode(uint64_t u) { return (int64_t)(u >> 1) ^ -(int64_t)(u & 1); }
+
+inline size_t put_varint(uint8_t* dst, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        dst[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    dst[n++] = (uint8_t)v;
+    return n;
+}
+
+/**
+ * @return false if the input ends inside the varint or it is longer than 10 bytes
+ */
+inline bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Value of an integer scalar field, sign- or zero-extended to 64 bits.
+ */
+template <typename T>
+inline int64_t load_integer(const T& m, const FieldDesc& d) {
+    const char* p = reinterpret_cast<const char*>(&m) + d.offset;
+    switch (d.type) {
+        case FieldType::U8: return *reinterpret_cast<const uint8_t*>(p);
+        case FieldType::U16: return *reinterpret_cast<const uint16_t*>(p);
+        case FieldType::U32: return *reinterpret_cast<const uint32_t*>(p);
+        case FieldType::U64: return (int64_t)*reinterpret_cast<const uint64_t*>(p);
+        case FieldType::I8: return *reinterpret_cast<const int8_t*>(p);
+        case FieldType::I16: return *reinterpret_cast<const int16_t*>(p);
+        case FieldType::I32: return *reinterpret_cast<const int32_t*>(p);
+        case FieldType::I64: return *reinterpret_cast<const int64_t*>(p);
+        default: return 0;
+    }
+}
+
+/**
+ * @brief Calls f(int64_t delta) for field d of every record, in order.
+ */
+template <typename T, typename F>
+inline void for_each_delta(const std::vector<T>& records, const FieldDesc& d, F&& f) {
+    uint64_t prev = 0;
+    for (const T& r : records) {
+        uint64_t v = (uint64_t)load_integer(r, d);
+        f((int64_t)(v - prev));
+        prev = v;
+    }
+}
+
+/**
+ * @brief Undoes for_each_delta: feed it one delta per record, in order.
+ */
+struct DeltaScatter {
+    uint64_t prev = 0;
+
+    template <typename T>
+    void add(T& m, const FieldDesc& d, int64_t delta) {
+        prev += (uint64_t)delta;
+        store_number(m, d, 0, prev);
+    }
+};
+
+inline size_t delta_column_bound(size_t records) { return records * kMaxVarintBytes; }
+
+/**
+ * @brief Writes the varint delta column of field d.
+ * @return Bytes written; dst must hold delta_column_bound(records.size())
+ */
+template <typename T>
+inline size_t write_delta_column(const std::vector<T>& records, const FieldDesc& d, uint8_t* dst) {
+    size_t n = 0;
+    for_each_delta(records, d, [&](int64_t delta) { n += put_varint(dst + n, zigzag_encode(delta)); });
+    return n;
+}
+
+/**
+ * @brief Reads a varint delta column into field d of every record.
+ * @return false unless the column holds exactly records.size() varints
+ */
+template <typename T>
+inline bool read_delta_column(const uint8_t* src, size_t len, const FieldDesc& d, std::vector<T>& records) {
+    const uint8_t* p = src;
+    const uint8_t* end = src + len;
+    DeltaScatter scatter;
+    for (T& r : records) {
+        uint64_t u;
+        if (!get_varint(p, end, u)) return false;
+        scatter.add(r, d, zigzag_decode(u));
+    }
+    return p == end;
+}
+
+/**
+ * @brief Concatenates BYTES field d of every record into dst (records * d.count bytes).
+ */
+template <typename T>
+inline void gather_bytes(const std::vector<T>& records, const FieldDesc& d, uint8_t* dst) {
+    for (const T& r : records) {
+        memcpy(dst, reinterpret_cast<const char*>(&r) + d.offset, d.count);
+        dst += d.count;
+    }
+}
+
+/**
+ * @return false unless len is exactly records.size() * d.count
+ */
+template <typename T>
+inline bool scatter_bytes(const uint8_t* src, size_t len, const FieldDesc& d, std::vector<T>& records) {
+    if (len != records.size() * d.count) return false;
+    for (T& r : records) {
+        memcpy(reinterpret_cast<char*>(&r) + d.offset, src, d.count);
+        src += d.count;
+    }
+    return true;
+}
+
+/**
+ * @brief Largest encoded column of any field of T, for sizing one scratch buffer.
+ */
+template <typename T>
+inline size_t column_scratch_size(size_t records) {
+    size_t n = delta_column_bound(records);
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const FieldDesc& d = PayloadSchema<T>::fields[i];
+        if (d.type == FieldType::BYTES && records * d.count > n) n = records * d.count;
+    }
+    return n;
+}
+
+/**
+ * @brief Writes column `field` of T into scratch.
+ * @return Its length: varint deltas for integer fields, raw bytes for BYTES
+ */
+template <typename T>
+inline size_t write_column(const std::vector<T>& records, size_t field, uint8_t* scratch) {
+    const FieldDesc& d = PayloadSchema<T>::fields[field];
+    if (d.type == FieldType::BYTES) {
+        gather_bytes(records, d, scratch);
+        return records.size() * d.count;
+    }
+    return write_delta_column(records, d, scratch);
+}
+
+/**
+ * @brief Inverse of write_column; records must already have the block's size.
+ */
+template <typename T>
+inline bool read_column(const uint8_t* src, size_t len, size_t field, std::vector<T>& records) {
+    const FieldDesc& d = PayloadSchema<T>::fields[field];
+    if (d.type == FieldType::BYTES) return scatter_bytes(src, len, d, records);
+    return read_delta_column(src, len, d, records);
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_COLUMNAR_BLOCK_H
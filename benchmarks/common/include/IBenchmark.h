@@ -5,6 +5,7 @@
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <cstring>
 #include "mavlink_types.h" // Include the new types
 
 namespace pf {
@@ -21,7 +22,101 @@ struct BenchmarkConfig {
 // Legacy Payload struct removed (Now in mavlink_types.h as PayloadGPSRaw)
 // We typedef it here for strict backward compatibility during transition if needed,
 // but we will use void* in the interface.
-using Payload = PayloadGPSRaw; 
+using Payload = PayloadGPSRaw;
+
+// Field selection for decode_fields(): bit i selects PayloadSchema<T>::fields[i]
+// (for GPSBlock, field i of every PayloadGPSRaw record).
+using FieldMask = uint64_t;
+static constexpr FieldMask kAllFields = ~(FieldMask)0;
+
+/**
+ * @brief The selected fields a projected decode has not stored yet.
+ * A streaming decoder stores a value only if wants() its field, marks it
+ * found(), and stops reading the message once done(). Field ids are schema
+ * indices, the same bits as FieldMask.
+ * kAllFields is the full decode that decode() runs: every field stays wanted,
+ * so a repeated key keeps its last value, and done() never ends the message
+ * early.
+ */
+class FieldProjection {
+public:
+    FieldProjection(FieldMask fields, size_t field_count)
+        : pending_(field_count >= 64 ? fields : fields & (((FieldMask)1 << field_count) - 1)),
+          complete_(fields == kAllFields) {}
+
+    bool wants(int field) const { return field >= 0 && field < 64 && ((pending_ >> field) & 1); }
+    void found(int field) {
+        if (!complete_) pending_ &= ~((FieldMask)1 << field);
+    }
+    bool done() const { return !complete_ && pending_ == 0; }
+
+private:
+    FieldMask pending_;
+    bool complete_;
+};
+
+// Batch framing: every message in an encode_batch() buffer is preceded by
+// its length as a 4-byte little-endian prefix.
+static constexpr size_t kFramePrefixBytes = 4;
+
+inline void write_frame_prefix(uint8_t* dst, uint32_t len) {
+    dst[0] = (uint8_t)len;
+    dst[1] = (uint8_t)(len >> 8);
+    dst[2] = (uint8_t)(len >> 16);
+    dst[3] = (uint8_t)(len >> 24);
+}
+
+/**
+ * @brief Step to the next length-prefixed frame of a batch buffer.
+ * @return true if a complete frame starts at offset (offset is advanced past it)
+ */
+inline bool next_frame(const uint8_t* data, size_t len, size_t& offset,
+                       const uint8_t*& frame, size_t& frame_len) {
+    if (offset > len || len - offset < kFramePrefixBytes) return false;
+    const uint8_t* p = data + offset;
+    uint32_t n = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    if (len - offset - kFramePrefixBytes < n) return false;
+    frame = p + kFramePrefixBytes;
+    frame_len = n;
+    offset += kFramePrefixBytes + n;
+    return true;
+}
+
+/**
+ * @brief Frame loop shared by encode_batch() implementations.
+ * encode_one(item, dst, cap) writes one message and returns its size (0 = no fit).
+ * @return Total bytes written, or 0 if the batch does not fit in cap
+ */
+template <typename EncodeOne>
+size_t encode_frames(const void* const* items, size_t count, uint8_t* dst, size_t cap, EncodeOne&& encode_one) {
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (cap - offset < kFramePrefixBytes) return 0;
+        size_t n = encode_one(items[i], dst + offset + kFramePrefixBytes, cap - offset - kFramePrefixBytes);
+        if (n == 0) return 0;
+        write_frame_prefix(dst + offset, (uint32_t)n);
+        offset += kFramePrefixBytes + n;
+    }
+    return offset;
+}
+
+/**
+ * @brief Frame loop shared by decode_batch() implementations.
+ * decode_one(frame, frame_len, out) decodes one message.
+ * @return Number of frames decoded
+ */
+template <typename DecodeOne>
+size_t decode_frames(const uint8_t* data, size_t len, void* const* outs, size_t count, DecodeOne&& decode_one) {
+    size_t offset = 0;
+    size_t decoded = 0;
+    const uint8_t* frame;
+    size_t frame_len;
+    while (decoded < count && next_frame(data, len, offset, frame, frame_len)) {
+        decode_one(frame, frame_len, outs[decoded]);
+        decoded++;
+    }
+    return decoded;
+}
 
 /**
  * @brief Immutable Benchmark Interface (Type-Erased)
@@ -44,12 +139,92 @@ public:
      */
     virtual std::vector<uint8_t> encode(const void* data) = 0;
 
+    /**
+     * @brief Required-size query for encode_into().
+     * @param data Pointer to the struct (casted to void*)
+     * @return Upper bound on the bytes encode_into() writes for this payload
+     */
+    virtual size_t max_encoded_size(const void* data) {
+        return encode(data).size();
+    }
+
+    /**
+     * @brief Encode into a caller-owned buffer (no heap allocation, no copy).
+     * @param data Pointer to the struct (casted to void*)
+     * @param dst Output buffer owned by the caller
+     * @param cap Capacity of dst in bytes
+     * @return Bytes written, or 0 if the message does not fit in cap
+     */
+    virtual size_t encode_into(const void* data, uint8_t* dst, size_t cap) {
+        // Fallback for plugins without a native path: still pays the vector.
+        std::vector<uint8_t> tmp = encode(data);
+        if (tmp.size() > cap) return 0;
+        memcpy(dst, tmp.data(), tmp.size());
+        return tmp.size();
+    }
+
+    /**
+     * @brief Decode a non-owning byte range back into a struct.
+     * Lets callers decode straight out of socket buffers, mmap regions or
+     * ring slots without copying into a vector first.
+     * @param data Start of the serialized message
+     * @param len Length of the serialized message in bytes
+     * @param out_data Pointer to target struct (casted to void*)
+     */
+    virtual void decode(const uint8_t* data, size_t len, void* out_data) = 0;
+
     /**
      * @brief Decode a buffer back into a struct.
      * @param buffer The serialized data
      * @param out_data Pointer to target struct (casted to void*)
      */
-    virtual void decode(const std::vector<uint8_t>& buffer, void* out_data) = 0;
+    virtual void decode(const std::vector<uint8_t>& buffer, void* out_data) {
+        decode(buffer.data(), buffer.size(), out_data);
+    }
+
+    /**
+     * @brief Decode only the selected fields of a message ("access K fields").
+     * Fields outside the mask may be left unwritten. Formats that can read a
+     * field without parsing the rest of the message override this; the
+     * default has to decode everything.
+     * @param data Start of the serialized message
+     * @param len Length of the serialized message in bytes
+     * @param out_data Pointer to target struct (casted to void*)
+     * @param fields Fields the caller will read from out_data
+     */
+    virtual void decode_fields(const uint8_t* data, size_t len, void* out_data, FieldMask /*fields*/) {
+        decode(data, len, out_data);
+    }
+
+    /**
+     * @brief Encode N payloads into one buffer as length-prefixed frames.
+     * Plugins override this to build their writer/packer once per batch
+     * instead of once per message.
+     * @param items Array of count payload pointers (casted to void*)
+     * @param count Number of payloads
+     * @param dst Output buffer owned by the caller
+     * @param cap Capacity of dst in bytes
+     * @return Total bytes written, or 0 if the batch does not fit in cap
+     */
+    virtual size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* out, size_t out_cap) {
+            return encode_into(item, out, out_cap);
+        });
+    }
+
+    /**
+     * @brief Decode length-prefixed frames produced by encode_batch().
+     * @param data Start of the batch buffer
+     * @param len Length of the batch buffer in bytes
+     * @param outs Array of count target struct pointers (casted to void*)
+     * @param count Maximum number of frames to decode
+     * @return Number of frames decoded
+     */
+    virtual size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) {
+        return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+            decode(frame, frame_len, out);
+        });
+    }
 
     /**
      * @brief Clean up resources.
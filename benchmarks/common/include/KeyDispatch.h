@@ -0,0 +1,127 @@
+#ifndef PRIME_FUSION_KEY_DISPATCH_H
+#define PRIME_FUSION_KEY_DISPATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace pf {
+
+/**
+ * @brief One key of a KeyTable: the wire name and the field index it selects.
+ * Several names may share an index (e.g. "timestamp" and its short form "ts").
+ */
+struct KeyEntry {
+    const char* name;
+    int id;
+};
+
+constexpr size_t key_length(const char* s) {
+    size_t n = 0;
+    while (s[n] != '\0') n++;
+    return n;
+}
+
+constexpr size_t key_slot_count(size_t min_slots) {
+    size_t n = 1;
+    while (n < min_slots) n <<= 1;
+    return n;
+}
+
+// Seeded FNV-1a over the key bytes.
+constexpr uint32_t key_hash(const char* s, size_t len, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+/**
+ * @brief Compile-time perfect hash from key bytes to a field index.
+ * The constructor searches for a hash seed that puts every key in its own
+ * slot, so find() is one hash over the key, one length check and one memcmp,
+ * whatever the position of the field in the struct. Build it as a constexpr
+ * object so the seed search happens in the compiler:
+ *
+ *     static constexpr KeyEntry kKeys[] = {{"lat", LAT}, {"lon", LON}};
+ *     static constexpr auto kFields = make_key_table(kKeys);
+ *     switch (kFields.find(str, len)) { case LAT: ... }
+ */
+template <size_t N>
+class KeyTable {
+public:
+    static_assert(N > 0 && N < 128, "KeyTable holds 1..127 keys");
+
+    // At least 4 slots per key keeps the expected seed search to a few dozen tries.
+    static constexpr size_t kSlots = key_slot_count(N * 4);
+
+    constexpr explicit KeyTable(const KeyEntry (&entries)[N]) {
+        for (size_t i = 0; i < N; i++) {
+            names_[i] = entries[i].name;
+            lengths_[i] = key_length(entries[i].name);
+            ids_[i] = entries[i].id;
+        }
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = i + 1; j < N; j++) {
+                if (same_key(i, j)) throw std::logic_error("KeyTable: duplicate key");
+            }
+        }
+        for (uint32_t seed = 0; seed < kMaxSeeds; seed++) {
+            if (place_all(seed)) {
+                seed_ = seed;
+                return;
+            }
+        }
+        throw std::logic_error("KeyTable: no perfect seed found");
+    }
+
+    /**
+     * @return The field index for the key, or -1 if it is not in the table
+     */
+    int find(const char* key, size_t len) const {
+        int8_t e = slots_[key_hash(key, len, seed_) & (kSlots - 1)];
+        if (e < 0 || lengths_[e] != len || memcmp(names_[e], key, len) != 0) return -1;
+        return ids_[e];
+    }
+
+    uint32_t seed() const { return seed_; }
+
+private:
+    static constexpr uint32_t kMaxSeeds = 100000;
+
+    constexpr bool same_key(size_t a, size_t b) const {
+        if (lengths_[a] != lengths_[b]) return false;
+        for (size_t k = 0; k < lengths_[a]; k++) {
+            if (names_[a][k] != names_[b][k]) return false;
+        }
+        return true;
+    }
+
+    constexpr bool place_all(uint32_t seed) {
+        for (size_t s = 0; s < kSlots; s++) slots_[s] = -1;
+        for (size_t i = 0; i < N; i++) {
+            size_t s = key_hash(names_[i], lengths_[i], seed) & (kSlots - 1);
+            if (slots_[s] >= 0) return false;
+            slots_[s] = (int8_t)i;
+        }
+        return true;
+    }
+
+    const char* names_[N] = {};
+    size_t lengths_[N] = {};
+    int ids_[N] = {};
+    int8_t slots_[kSlots] = {};
+    uint32_t seed_ = 0;
+};
+
+template <size_t N>
+constexpr KeyTable<N> make_key_table(const KeyEntry (&entries)[N]) {
+    return KeyTable<N>(entries);
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_KEY_DISPATCH_H
@@ -0,0 +1,300 @@
+#ifndef PRIME_FUSION_NUMBER_TEXT_H
+#define PRIME_FUSION_NUMBER_TEXT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace pf {
+
+/**
+ * @brief Integer and float to decimal text, written straight into a caller
+ * buffer (the JSON-Fast writer's number backend).
+ * Integers go two digits at a time from a 200-byte pair table, and the digit
+ * count comes from the bit length and a power-of-ten compare instead of a
+ * loop. Floats are printed with the fewest significant digits that read back
+ * to the same float (Ryu, Adams 2018, the 32-bit variant), instead of the
+ * shortest double a float widened to double would get.
+ *
+ * Every function returns one past the last character written and writes no
+ * terminator; kMaxIntegerChars and kMaxFloatChars bound what they write.
+ */
+namespace number_text {
+
+constexpr size_t kMaxIntegerChars = 20; // "-9223372036854775808", "18446744073709551615"
+constexpr size_t kMaxFloatChars = 24;   // "-100000000000000000000.0"
+
+constexpr char kDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+constexpr uint64_t kPow10[20] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+    10000000000u, 100000000000u, 1000000000000u, 10000000000000u, 100000000000000u,
+    1000000000000000u, 10000000000000000u, 100000000000000000u, 1000000000000000000u,
+    10000000000000000000u,
+};
+
+// Decimal digits of v (1 for 0): 1233/4096 ~ log10(2) turns the bit length
+// into a first guess that a single compare corrects
+inline int decimal_digits(uint64_t v) {
+    const int bits = 64 - __builtin_clzll(v | 1);
+    const int t = (bits * 1233) >> 12;
+    return t + ((v | 1) >= kPow10[t]);
+}
+
+// The digits of v into out[0..digits), two per step from the right
+inline void write_digits(uint64_t v, char* out, int digits) {
+    char* p = out + digits;
+    while (v >= 100) {
+        const uint64_t q = v / 100;
+        p -= 2;
+        memcpy(p, kDigitPairs + 2 * (v - 100 * q), 2);
+        v = q;
+    }
+    if (v >= 10) memcpy(p - 2, kDigitPairs + 2 * v, 2);
+    else p[-1] = (char)('0' + v);
+}
+
+// --- Ryu for binary32 ---
+// 2^k / 5^q rounded up (q < 31) and 5^i scaled to 61 bits (i < 47), k and the
+// scale chosen as in the reference f2s.c so the products keep enough bits
+
+constexpr int kPow5InvBits = 59;
+constexpr int kPow5Bits = 61;
+
+constexpr uint64_t kPow5InvSplit[31] = {
+    576460752303423489u, 461168601842738791u, 368934881474191033u, 295147905179352826u,
+    472236648286964522u, 377789318629571618u, 302231454903657294u, 483570327845851670u,
+    386856262276681336u, 309485009821345069u, 495176015714152110u, 396140812571321688u,
+    316912650057057351u, 507060240091291761u, 405648192073033409u, 324518553658426727u,
+    519229685853482763u, 415383748682786211u, 332306998946228969u, 531691198313966350u,
+    425352958651173080u, 340282366920938464u, 544451787073501542u, 435561429658801234u,
+    348449143727040987u, 557518629963265579u, 446014903970612463u, 356811923176489971u,
+    570899077082383953u, 456719261665907162u, 365375409332725730u,
+};
+
+constexpr uint64_t kPow5Split[47] = {
+    1152921504606846976u, 1441151880758558720u, 1801439850948198400u, 2251799813685248000u,
+    1407374883553280000u, 1759218604441600000u, 2199023255552000000u, 1374389534720000000u,
+    1717986918400000000u, 2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
+    2097152000000000000u, 1310720000000000000u, 1638400000000000000u, 2048000000000000000u,
+    1280000000000000000u, 1600000000000000000u, 2000000000000000000u, 1250000000000000000u,
+    1562500000000000000u, 1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
+    1907348632812500000u, 1192092895507812500u, 1490116119384765625u, 1862645149230957031u,
+    1164153218269348144u, 1455191522836685180u, 1818989403545856475u, 2273736754432320594u,
+    1421085471520200371u, 1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
+    1734723475976807094u, 2168404344971008868u, 1355252715606880542u, 1694065894508600678u,
+    2117582368135750847u, 1323488980084844279u, 1654361225106055349u, 2067951531382569187u,
+    1292469707114105741u, 1615587133892632177u, 2019483917365790221u,
+};
+
+// ceil(log2(5^e)) for e > 0, 1 for e = 0
+inline int pow5_bits(int e) { return (int)(((uint32_t)e * 1217359) >> 19) + 1; }
+// floor(log10(2^e)) and floor(log10(5^e))
+inline uint32_t log10_pow2(int e) { return ((uint32_t)e * 78913) >> 18; }
+inline uint32_t log10_pow5(int e) { return ((uint32_t)e * 732923) >> 20; }
+
+inline bool multiple_of_pow5(uint32_t v, uint32_t p) {
+    uint32_t count = 0;
+    for (; v % 5 == 0; v /= 5) count++;
+    return count >= p;
+}
+
+inline bool multiple_of_pow2(uint32_t v, uint32_t p) { return (v & ((1u << p) - 1)) == 0; }
+
+// (m * factor) >> shift for shift > 32, without a 128-bit product
+inline uint32_t mul_shift(uint32_t m, uint64_t factor, int shift) {
+    const uint64_t lo = (uint64_t)m * (uint32_t)factor;
+    const uint64_t hi = (uint64_t)m * (uint32_t)(factor >> 32);
+    return (uint32_t)(((lo >> 32) + hi) >> (shift - 32));
+}
+
+// A finite float as digits * 10^exponent, digits as short as possible
+struct ShortestDecimal {
+    uint32_t digits;
+    int exponent;
+};
+
+inline ShortestDecimal shortest_decimal(uint32_t mantissa, uint32_t biased_exponent) {
+    // Work on 4 * the value so the half-way points to both neighbours are integers
+    int e2;
+    uint32_t m2;
+    if (biased_exponent == 0) {
+        e2 = 1 - 127 - 23 - 2;
+        m2 = mantissa;
+    } else {
+        e2 = (int)biased_exponent - 127 - 23 - 2;
+        m2 = (1u << 23) | mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0; // Round-half-even reads the bounds back to this float
+    const uint32_t mv = 4 * m2;
+    const uint32_t mp = 4 * m2 + 2;
+    const uint32_t mm_shift = mantissa != 0 || biased_exponent <= 1; // The gap below a power of two is half as wide
+    const uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    // The value and both bounds in decimal, scaled by 10^-e10 and truncated
+    uint32_t vr, vp, vm;
+    int e10;
+    bool vm_trailing_zeros = false, vr_trailing_zeros = false;
+    uint32_t last_removed = 0;
+    if (e2 >= 0) {
+        const uint32_t q = log10_pow2(e2);
+        e10 = (int)q;
+        const int k = kPow5InvBits + pow5_bits((int)q) - 1;
+        const int i = -e2 + (int)q + k;
+        vr = mul_shift(mv, kPow5InvSplit[q], i);
+        vp = mul_shift(mp, kPow5InvSplit[q], i);
+        vm = mul_shift(mm, kPow5InvSplit[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            // The loop below removes no digit, but rounding still needs the first one cut off
+            const int l = kPow5InvBits + pow5_bits((int)q - 1) - 1;
+            last_removed = mul_shift(mv, kPow5InvSplit[q - 1], -e2 + (int)q - 1 + l) % 10;
+        }
+        if (q <= 9) {
+            // At most one of mp, mv and mm is a multiple of 5
+            if (mv % 5 == 0) vr_trailing_zeros = multiple_of_pow5(mv, q);
+            else if (accept_bounds) vm_trailing_zeros = multiple_of_pow5(mm, q);
+            else vp -= multiple_of_pow5(mp, q);
+        }
+    } else {
+        const uint32_t q = log10_pow5(-e2);
+        e10 = (int)q + e2;
+        const int i = -e2 - (int)q;
+        const int k = pow5_bits(i) - kPow5Bits;
+        int j = (int)q - k;
+        vr = mul_shift(mv, kPow5Split[i], j);
+        vp = mul_shift(mp, kPow5Split[i], j);
+        vm = mul_shift(mm, kPow5Split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int)q - 1 - (pow5_bits(i + 1) - kPow5Bits);
+            last_removed = mul_shift(mv, kPow5Split[i + 1], j) % 10;
+        }
+        if (q <= 1) {
+            // mv = 4 * m2 has two trailing zero bits; mm has one exactly when mm_shift is 1
+            vr_trailing_zeros = true;
+            if (accept_bounds) vm_trailing_zeros = mm_shift == 1;
+            else --vp;
+        } else if (q < 31) {
+            vr_trailing_zeros = multiple_of_pow2(mv, q - 1);
+        }
+    }
+
+    // Drop digits while the bounds still differ above them
+    int removed = 0;
+    uint32_t digits;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        // Exact decimal bounds or value (about 4% of floats)
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) last_removed = 4; // Exactly .5: round to even
+        digits = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    } else {
+        while (vp / 10 > vm / 10) {
+            last_removed = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        digits = vr + (vr == vm || last_removed >= 5);
+    }
+    return {digits, e10 + removed};
+}
+
+} // namespace number_text
+
+inline char* format_uint(uint64_t v, char* out) {
+    const int digits = number_text::decimal_digits(v);
+    number_text::write_digits(v, out, digits);
+    return out + digits;
+}
+
+inline char* format_int(int64_t v, char* out) {
+    *out = '-';
+    return format_uint(v < 0 ? 0 - (uint64_t)v : (uint64_t)v, out + (v < 0));
+}
+
+/**
+ * @brief Shortest round-trip text of a finite float, laid out the way
+ * RapidJSON's Writer lays out a double: plain decimals while the decimal
+ * point falls within 21 digits, exponent form otherwise, and always a '.'
+ * or an 'e' so a reader takes it as a float again ("1.0", not "1").
+ * NaN and infinity have no JSON form; the caller must check isfinite().
+ */
+inline char* format_float(float v, char* out) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    if (bits >> 31) *out++ = '-';
+    const uint32_t mantissa = bits & ((1u << 23) - 1);
+    const uint32_t biased_exponent = (bits >> 23) & 0xFF;
+    if (mantissa == 0 && biased_exponent == 0) {
+        memcpy(out, "0.0", 3);
+        return out + 3;
+    }
+
+    // One float, 0x1.5c87fap-84, has a shortest text (7.038531e-26) that the
+    // nearest double carries past the float rounding midpoint, so a reader
+    // that parses a double and narrows it (the JSON decoders) gets the next
+    // float up. A sweep of all 2^32 floats found no other; one more digit fixes it.
+    const number_text::ShortestDecimal d = (bits & 0x7FFFFFFF) == 0x15AE43FD
+                                               ? number_text::ShortestDecimal{70385309, -33}
+                                               : number_text::shortest_decimal(mantissa, biased_exponent);
+    const int length = number_text::decimal_digits(d.digits);
+    const int point = length + d.exponent; // Digits before the decimal point
+
+    if (d.exponent >= 0 && point <= 21) {
+        // 1234e2 -> 123400.0
+        number_text::write_digits(d.digits, out, length);
+        memset(out + length, '0', d.exponent);
+        memcpy(out + point, ".0", 2);
+        return out + point + 2;
+    }
+    if (point > 0 && point <= 21) {
+        // 1234e-2 -> 12.34
+        number_text::write_digits(d.digits, out + 1, length);
+        memmove(out, out + 1, point);
+        out[point] = '.';
+        return out + length + 1;
+    }
+    if (point > -6 && point <= 0) {
+        // 1234e-6 -> 0.001234
+        memcpy(out, "0.", 2);
+        memset(out + 2, '0', -point);
+        number_text::write_digits(d.digits, out + 2 - point, length);
+        return out + 2 - point + length;
+    }
+    // 1234e-10 -> 1.234e-7, 1e30
+    const int exponent = point - 1;
+    number_text::write_digits(d.digits, out + 1, length);
+    out[0] = out[1];
+    char* p = out + 1;
+    if (length > 1) {
+        *p = '.';
+        p += length;
+    }
+    *p++ = 'e';
+    return format_int(exponent, p);
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_NUMBER_TEXT_H
@@ -0,0 +1,128 @@
+#ifndef PRIME_FUSION_PERF_COUNTER_METRIC_H
+#define PRIME_FUSION_PERF_COUNTER_METRIC_H
+
+#include <string>
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "IMetric.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace pf {
+
+/**
+ * @brief Hardware performance counters via Linux perf_event_open.
+ * Counts cycles, instructions, branch-misses, L1d read misses and LLC read
+ * misses for this thread (user space only). Each event is opened on its own
+ * fd, so a PMU that lacks one event (or a VM without a PMU at all) still
+ * yields the rest. The software counters task-clock and page-faults are
+ * always opened as a fallback, since they work even when PMU access is denied.
+ * Multiplexed counters are scaled by time_enabled / time_running.
+ */
+class PerfCounterMetric : public IMetric {
+public:
+    PerfCounterMetric() {
+#ifdef __linux__
+        open_event("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        open_event("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open_event("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        open_event("l1d_misses", PERF_TYPE_HW_CACHE, cache_config(PERF_COUNT_HW_CACHE_L1D));
+        open_event("llc_misses", PERF_TYPE_HW_CACHE, cache_config(PERF_COUNT_HW_CACHE_LL));
+        open_event("task_clock_ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK);
+        open_event("page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+#endif
+    }
+
+    ~PerfCounterMetric() override {
+#ifdef __linux__
+        for (const Counter& c : counters_) close(c.fd);
+#endif
+    }
+
+    PerfCounterMetric(const PerfCounterMetric&) = delete;
+    PerfCounterMetric& operator=(const PerfCounterMetric&) = delete;
+
+    void start() override {
+#ifdef __linux__
+        for (const Counter& c : counters_) {
+            ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() override {
+#ifdef __linux__
+        for (const Counter& c : counters_) ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+        results_.clear();
+        for (const Counter& c : counters_) {
+            uint64_t buf[3] = {0, 0, 0}; // value, time_enabled, time_running
+            if (read(c.fd, buf, sizeof(buf)) != (ssize_t)sizeof(buf)) continue;
+            double value = (double)buf[0];
+            if (buf[2] > 0 && buf[2] < buf[1]) value *= (double)buf[1] / (double)buf[2];
+            results_[c.name] = value;
+        }
+#endif
+    }
+
+    /**
+     * @return Raw totals keyed by counter name; counters that failed to open are absent
+     */
+    std::map<std::string, double> get_result() const override { return results_; }
+
+    std::string name() const override { return "PerfCounters"; }
+
+    void reset() override { results_.clear(); }
+
+    /**
+     * @brief True if at least one hardware (PMU) counter opened.
+     */
+    bool has_hardware() const {
+        for (const Counter& c : counters_) if (c.hardware) return true;
+        return false;
+    }
+
+    bool available() const { return !counters_.empty(); }
+
+private:
+    struct Counter {
+        std::string name;
+        int fd;
+        bool hardware;
+    };
+
+#ifdef __linux__
+    static uint64_t cache_config(uint64_t cache) {
+        return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+
+    void open_event(const char* label, uint32_t type, uint64_t config) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1; // Allowed at perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0 /* this thread */, -1 /* any cpu */, -1, 0);
+        if (fd < 0) return; // Denied or unsupported: skip this counter
+        counters_.push_back({label, fd, type != PERF_TYPE_SOFTWARE});
+    }
+#endif
+
+    std::vector<Counter> counters_;
+    std::map<std::string, double> results_;
+};
+
+} // namespace pf
+
+#endif // PRIME_FUSION_PERF_COUNTER_METRIC_H
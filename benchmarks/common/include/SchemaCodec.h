@@ -0,0 +1,177 @@
+#ifndef PRIME_FUSION_SCHEMA_CODEC_H
+#define PRIME_FUSION_SCHEMA_CODEC_H
+
+#include "KeyDispatch.h"
+#include "mavlink_types.h"
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace pf {
+
+/**
+ * @brief Format-independent half of the schema codecs.
+ * The per-format codecs walk PayloadSchema<T>::fields with for_each_field(),
+ * which expands to one call per field with the index as a compile-time
+ * constant. Each call's FieldDesc is therefore a constant expression, and the
+ * compiler resolves the key, offset and type of every field at build time.
+ * Decoders go the other way: the key is resolved once (schema_find) and the
+ * value is stored through the runtime descriptor (store_number/store_bytes).
+ */
+
+enum class KeyStyle {
+    Name,      // "satellites_visible"
+    ShortName, // "sv"
+    Int        // 12
+};
+
+template <FieldType Type> struct FieldCType;
+template <> struct FieldCType<FieldType::U8> { using type = uint8_t; };
+template <> struct FieldCType<FieldType::U16> { using type = uint16_t; };
+template <> struct FieldCType<FieldType::U32> { using type = uint32_t; };
+template <> struct FieldCType<FieldType::U64> { using type = uint64_t; };
+template <> struct FieldCType<FieldType::I8> { using type = int8_t; };
+template <> struct FieldCType<FieldType::I16> { using type = int16_t; };
+template <> struct FieldCType<FieldType::I32> { using type = int32_t; };
+template <> struct FieldCType<FieldType::I64> { using type = int64_t; };
+template <> struct FieldCType<FieldType::F32> { using type = float; };
+template <> struct FieldCType<FieldType::BYTES> { using type = uint8_t; };
+template <> struct FieldCType<FieldType::CHARS> { using type = char; };
+
+template <typename T>
+constexpr size_t schema_size() {
+    return sizeof(PayloadSchema<T>::fields) / sizeof(FieldDesc);
+}
+
+template <typename T>
+constexpr bool schema_keys_are_positions() {
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        if (PayloadSchema<T>::fields[i].key != (int)i) return false;
+    }
+    return true;
+}
+
+/**
+ * @return The index of the field called `name` (its member name), or -1
+ */
+template <typename T>
+constexpr int schema_index_of(const char* name) {
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const char* a = PayloadSchema<T>::fields[i].name;
+        const char* b = name;
+        while (*a && *a == *b) { a++; b++; }
+        if (*a == *b) return (int)i;
+    }
+    return -1;
+}
+
+// Bytes of one element of a field of this type
+constexpr size_t field_type_size(FieldType t) {
+    switch (t) {
+        case FieldType::U16: case FieldType::I16: return 2;
+        case FieldType::U32: case FieldType::I32: case FieldType::F32: return 4;
+        case FieldType::U64: case FieldType::I64: return 8;
+        default: return 1;
+    }
+}
+
+constexpr const char* schema_key(const FieldDesc& d, KeyStyle style) {
+    return style == KeyStyle::Name ? d.name : d.short_name;
+}
+
+/**
+ * @brief Pointer to the first element of a field, typed after the descriptor.
+ */
+template <FieldType Type, typename T>
+const typename FieldCType<Type>::type* field_ptr(const T& m, const FieldDesc& d) {
+    return reinterpret_cast<const typename FieldCType<Type>::type*>(reinterpret_cast<const char*>(&m) + d.offset);
+}
+
+template <typename T, typename F, size_t... I>
+inline void for_each_field_impl(F&& f, std::index_sequence<I...>) {
+    (f(std::integral_constant<size_t, I>{}), ...);
+}
+
+/**
+ * @brief Calls f(std::integral_constant<size_t, I>) for every field of T, in order.
+ * Inside f, `constexpr const FieldDesc& d = PayloadSchema<T>::fields[decltype(i)::value];`
+ * gives a descriptor usable in `if constexpr`.
+ */
+template <typename T, typename F>
+inline void for_each_field(F&& f) {
+    for_each_field_impl<T>(f, std::make_index_sequence<schema_size<T>()>{});
+}
+
+template <typename T, KeyStyle Style, size_t... I>
+constexpr KeyTable<sizeof...(I)> make_schema_key_table(std::index_sequence<I...>) {
+    const KeyEntry entries[] = {{schema_key(PayloadSchema<T>::fields[I], Style), (int)I}...};
+    return KeyTable<sizeof...(I)>(entries);
+}
+
+template <typename T, KeyStyle Style>
+struct SchemaKeys {
+    static_assert(Style != KeyStyle::Int, "Integer keys are looked up by position");
+    static constexpr auto table = make_schema_key_table<T, Style>(std::make_index_sequence<schema_size<T>()>{});
+};
+
+/**
+ * @return The field index for a string key, or -1 if T has no such field
+ */
+template <typename T, KeyStyle Style>
+inline int schema_find(const char* key, size_t len) {
+    return SchemaKeys<T, Style>::table.find(key, len);
+}
+
+/**
+ * @return The field index for an integer key, or -1 if T has no such field
+ */
+template <typename T>
+inline int schema_find(uint64_t key) {
+    static_assert(schema_keys_are_positions<T>(), "Integer keys must equal field positions");
+    return key < schema_size<T>() ? (int)key : -1;
+}
+
+/**
+ * @brief Stores a decoded number into element `index` of a numeric field.
+ * Values are narrowed with a plain cast, as the hand-written decoders do.
+ * Byte and text fields, and indices past the array length, are ignored.
+ */
+template <typename T, typename V>
+inline void store_number(T& m, const FieldDesc& d, size_t index, V v) {
+    if (index >= d.count) return;
+    char* p = reinterpret_cast<char*>(&m) + d.offset;
+    switch (d.type) {
+        case FieldType::U8: reinterpret_cast<uint8_t*>(p)[index] = (uint8_t)v; break;
+        case FieldType::U16: reinterpret_cast<uint16_t*>(p)[index] = (uint16_t)v; break;
+        case FieldType::U32: reinterpret_cast<uint32_t*>(p)[index] = (uint32_t)v; break;
+        case FieldType::U64: reinterpret_cast<uint64_t*>(p)[index] = (uint64_t)v; break;
+        case FieldType::I8: reinterpret_cast<int8_t*>(p)[index] = (int8_t)v; break;
+        case FieldType::I16: reinterpret_cast<int16_t*>(p)[index] = (int16_t)v; break;
+        case FieldType::I32: reinterpret_cast<int32_t*>(p)[index] = (int32_t)v; break;
+        case FieldType::I64: reinterpret_cast<int64_t*>(p)[index] = (int64_t)v; break;
+        case FieldType::F32: reinterpret_cast<float*>(p)[index] = (float)v; break;
+        case FieldType::BYTES:
+        case FieldType::CHARS: break;
+    }
+}
+
+/**
+ * @brief Stores a decoded byte or text string.
+ * BYTES fields take the data only if the length matches exactly; CHARS fields
+ * are truncated to fit and always NUL-terminated.
+ */
+template <typename T>
+inline void store_bytes(T& m, const FieldDesc& d, const void* data, size_t len) {
+    char* p = reinterpret_cast<char*>(&m) + d.offset;
+    if (d.type == FieldType::BYTES) {
+        if (len == d.count) memcpy(p, data, len);
+    } else if (d.type == FieldType::CHARS) {
+        size_t n = len < d.count - 1 ? len : d.count - 1;
+        memcpy(p, data, n);
+        p[n] = '\0';
+    }
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_SCHEMA_CODEC_H
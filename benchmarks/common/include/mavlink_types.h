@@ -1,6 +1,7 @@
 #ifndef PRIME_FUSION_MAVLINK_TYPES_H
 #define PRIME_FUSION_MAVLINK_TYPES_H
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -119,6 +120,152 @@ struct PayloadGPSBlock {
     std::vector<PayloadGPSRaw> messages;
 };
 
+// --------------------------------------------------------
+// FIELD SCHEMAS
+// --------------------------------------------------------
+// One descriptor per struct member, in declaration order. The schema codecs
+// (cbor/json/msgpack *_schema_codec.h) are generated from these tables, so a
+// field added here is encoded by every format without touching a plugin.
+
+enum class FieldType : uint8_t {
+    U8, U16, U32, U64,
+    I8, I16, I32, I64,
+    F32,
+    BYTES, // uint8_t[N]: one binary blob (hex in JSON)
+    CHARS  // char[N]: NUL-terminated text
+};
+
+struct FieldDesc {
+    const char* name;       // Member name, the long wire key
+    const char* short_name; // Compact wire key
+    int key;                // Integer wire key, equal to the field's position
+    size_t offset;
+    FieldType type;         // Element type for numeric arrays
+    size_t count;           // Array length, 1 for scalars
+};
+
+template <FieldType Type, size_t Count = 1>
+struct FieldTraitsOf {
+    static constexpr FieldType type = Type;
+    static constexpr size_t count = Count;
+};
+
+template <typename T> struct FieldTraits;
+template <> struct FieldTraits<uint8_t> : FieldTraitsOf<FieldType::U8> {};
+template <> struct FieldTraits<uint16_t> : FieldTraitsOf<FieldType::U16> {};
+template <> struct FieldTraits<uint32_t> : FieldTraitsOf<FieldType::U32> {};
+template <> struct FieldTraits<uint64_t> : FieldTraitsOf<FieldType::U64> {};
+template <> struct FieldTraits<int8_t> : FieldTraitsOf<FieldType::I8> {};
+template <> struct FieldTraits<int16_t> : FieldTraitsOf<FieldType::I16> {};
+template <> struct FieldTraits<int32_t> : FieldTraitsOf<FieldType::I32> {};
+template <> struct FieldTraits<int64_t> : FieldTraitsOf<FieldType::I64> {};
+template <> struct FieldTraits<float> : FieldTraitsOf<FieldType::F32> {};
+template <typename T, size_t N> struct FieldTraits<T[N]> : FieldTraitsOf<FieldTraits<T>::type, N> {};
+template <size_t N> struct FieldTraits<uint8_t[N]> : FieldTraitsOf<FieldType::BYTES, N> {};
+template <size_t N> struct FieldTraits<char[N]> : FieldTraitsOf<FieldType::CHARS, N> {};
+
+// Type, offset and length come from the member declaration, so they cannot drift.
+#define PF_FIELD(Struct, member, short_name, key) \
+    { #member, short_name, key, offsetof(Struct, member), \
+      FieldTraits<decltype(Struct::member)>::type, FieldTraits<decltype(Struct::member)>::count }
+
+template <typename T> struct PayloadSchema;
+
+template <> struct PayloadSchema<PayloadGPSRaw> {
+    static constexpr FieldDesc fields[] = {
+        PF_FIELD(PayloadGPSRaw, timestamp, "ts", 0),
+        PF_FIELD(PayloadGPSRaw, block_number, "bn", 1),
+        PF_FIELD(PayloadGPSRaw, hash, "h", 2),
+        PF_FIELD(PayloadGPSRaw, time_usec, "tu", 3),
+        PF_FIELD(PayloadGPSRaw, fix_type, "ft", 4),
+        PF_FIELD(PayloadGPSRaw, lat, "lat", 5),
+        PF_FIELD(PayloadGPSRaw, lon, "lon", 6),
+        PF_FIELD(PayloadGPSRaw, alt, "alt", 7),
+        PF_FIELD(PayloadGPSRaw, eph, "eph", 8),
+        PF_FIELD(PayloadGPSRaw, epv, "epv", 9),
+        PF_FIELD(PayloadGPSRaw, vel, "vel", 10),
+        PF_FIELD(PayloadGPSRaw, cog, "cog", 11),
+        PF_FIELD(PayloadGPSRaw, satellites_visible, "sv", 12),
+        PF_FIELD(PayloadGPSRaw, alt_ellipsoid, "el", 13),
+        PF_FIELD(PayloadGPSRaw, h_acc, "ha", 14),
+        PF_FIELD(PayloadGPSRaw, v_acc, "va", 15),
+        PF_FIELD(PayloadGPSRaw, vel_acc, "vla", 16),
+        PF_FIELD(PayloadGPSRaw, hdg_acc, "hda", 17),
+    };
+};
+
+template <> struct PayloadSchema<PayloadGlobalPosition> {
+    static constexpr FieldDesc fields[] = {
+        PF_FIELD(PayloadGlobalPosition, time_boot_ms, "boot", 0),
+        PF_FIELD(PayloadGlobalPosition, lat, "lat", 1),
+        PF_FIELD(PayloadGlobalPosition, lon, "lon", 2),
+        PF_FIELD(PayloadGlobalPosition, alt, "alt", 3),
+        PF_FIELD(PayloadGlobalPosition, relative_alt, "rel", 4),
+        PF_FIELD(PayloadGlobalPosition, vx, "vx", 5),
+        PF_FIELD(PayloadGlobalPosition, vy, "vy", 6),
+        PF_FIELD(PayloadGlobalPosition, vz, "vz", 7),
+        PF_FIELD(PayloadGlobalPosition, hdg, "hdg", 8),
+    };
+};
+
+template <> struct PayloadSchema<PayloadOdometry> {
+    static constexpr FieldDesc fields[] = {
+        PF_FIELD(PayloadOdometry, time_usec, "time", 0),
+        PF_FIELD(PayloadOdometry, frame_id, "frame", 1),
+        PF_FIELD(PayloadOdometry, child_frame_id, "child", 2),
+        PF_FIELD(PayloadOdometry, x, "x", 3),
+        PF_FIELD(PayloadOdometry, y, "y", 4),
+        PF_FIELD(PayloadOdometry, z, "z", 5),
+        PF_FIELD(PayloadOdometry, q, "q", 6),
+        PF_FIELD(PayloadOdometry, vx, "vx", 7),
+        PF_FIELD(PayloadOdometry, vy, "vy", 8),
+        PF_FIELD(PayloadOdometry, vz, "vz", 9),
+        PF_FIELD(PayloadOdometry, rollspeed, "rs", 10),
+        PF_FIELD(PayloadOdometry, pitchspeed, "ps", 11),
+        PF_FIELD(PayloadOdometry, yawspeed, "ys", 12),
+        PF_FIELD(PayloadOdometry, pose_covariance, "pcov", 13),
+        PF_FIELD(PayloadOdometry, velocity_covariance, "vcov", 14),
+    };
+};
+
+template <> struct PayloadSchema<PayloadAttitude> {
+    static constexpr FieldDesc fields[] = {
+        PF_FIELD(PayloadAttitude, time_boot_ms, "boot", 0),
+        PF_FIELD(PayloadAttitude, roll, "r", 1),
+        PF_FIELD(PayloadAttitude, pitch, "p", 2),
+        PF_FIELD(PayloadAttitude, yaw, "y", 3),
+        PF_FIELD(PayloadAttitude, rollspeed, "rs", 4),
+        PF_FIELD(PayloadAttitude, pitchspeed, "ps", 5),
+        PF_FIELD(PayloadAttitude, yawspeed, "ys", 6),
+    };
+};
+
+template <> struct PayloadSchema<PayloadBattery> {
+    static constexpr FieldDesc fields[] = {
+        PF_FIELD(PayloadBattery, id, "id", 0),
+        PF_FIELD(PayloadBattery, battery_function, "func", 1),
+        PF_FIELD(PayloadBattery, type, "type", 2),
+        PF_FIELD(PayloadBattery, temperature, "temp", 3),
+        PF_FIELD(PayloadBattery, voltages, "volt", 4),
+        PF_FIELD(PayloadBattery, current_battery, "current", 5),
+        PF_FIELD(PayloadBattery, current_consumed, "cons", 6),
+        PF_FIELD(PayloadBattery, energy_consumed, "energy", 7),
+        PF_FIELD(PayloadBattery, battery_remaining, "rem", 8),
+    };
+};
+
+template <> struct PayloadSchema<PayloadStatus> {
+    static constexpr FieldDesc fields[] = {
+        PF_FIELD(PayloadStatus, severity, "sev", 0),
+        PF_FIELD(PayloadStatus, text, "txt", 1),
+    };
+};
+
+// PayloadGPSBlock has no schema of its own: codecs encode it as an array of
+// PayloadGPSRaw records.
+
+#undef PF_FIELD
+
 } // namespace pf
 
 #endif // PRIME_FUSION_MAVLINK_TYPES_H
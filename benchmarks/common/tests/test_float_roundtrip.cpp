@@ -0,0 +1,128 @@
+// Round-trip test for the JSON-Fast float formatter (NumberText.h). Every
+// float in the pools the runners generate must print as text that reads back
+// to the identical float as a double narrowed to float, and no shorter
+// decimal may do so. With PF_HAVE_RAPIDJSON the text is also read the way the
+// JSON plugins decode it; without, the test still runs on strtod alone.
+#include "runner_template.hpp"
+#include "NumberText.h"
+#ifdef PF_HAVE_RAPIDJSON
+#include <rapidjson/reader.h>
+#endif
+#include <cassert>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace pf;
+
+#ifdef PF_HAVE_RAPIDJSON
+struct DoubleCapture : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, DoubleCapture> {
+    double value = 0;
+    bool numeric = false;
+    bool Double(double d) { value = d; numeric = true; return true; }
+};
+#endif
+
+static size_t g_checked = 0;
+
+// Significant digits of the formatted text: mantissa digits without the
+// point, the leading zeros or the trailing zeros.
+static int significant_digits(const char* s) {
+    std::string digits;
+    for (; *s && *s != 'e'; s++) {
+        if (*s >= '0' && *s <= '9') digits += *s;
+    }
+    const size_t first = digits.find_first_not_of('0');
+    if (first == std::string::npos) return 0;
+    return (int)(digits.find_last_not_of('0') - first + 1);
+}
+
+static void check(float v) {
+    char text[number_text::kMaxFloatChars + 1];
+    char* end = format_float(v, text);
+    assert((size_t)(end - text) <= number_text::kMaxFloatChars);
+    *end = '\0';
+
+    // A '.' or an exponent, so the reader calls Double() and not Int()
+    assert(strpbrk(text, ".e") != nullptr);
+
+#ifdef PF_HAVE_RAPIDJSON
+    DoubleCapture h;
+    rapidjson::Reader reader;
+    rapidjson::StringStream ss(text);
+    const bool parsed = !reader.Parse(ss, h).IsError();
+    const float back = (float)h.value;
+    if (!parsed || !h.numeric || memcmp(&back, &v, sizeof(v)) != 0) {
+        fprintf(stderr, "[TEST] %a printed as %s, read back as %a\n", v, text, back);
+        exit(1);
+    }
+#endif
+
+    // The correctly rounded double reads back too (RapidJSON's full
+    // precision parse), and the nearest decimal with one digit fewer does not
+    const double exact = strtod(text, nullptr);
+    if ((float)exact != v) {
+        fprintf(stderr, "[TEST] %a printed as %s, which narrows from a double to %a\n", v, text, (float)exact);
+        exit(1);
+    }
+    const int n = significant_digits(text);
+    if (n > 1) {
+        char shorter[32];
+        snprintf(shorter, sizeof(shorter), "%.*e", n - 2, v);
+        if ((float)strtod(shorter, nullptr) == v) {
+            fprintf(stderr, "[TEST] %a printed as %s, but %s also reads back\n", v, text, shorter);
+            exit(1);
+        }
+    }
+    g_checked++;
+}
+
+template <typename PayloadT>
+static void check_pool(const std::vector<PayloadT>& pool) {
+    for (const PayloadT& p : pool) {
+        for (const FieldDesc& f : PayloadSchema<PayloadT>::fields) {
+            if (f.type != FieldType::F32) continue;
+            const float* values = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(&p) + f.offset);
+            for (size_t i = 0; i < f.count; i++) check(values[i]);
+        }
+    }
+}
+
+template <typename PayloadT>
+static void check_pools() {
+    check_pool(make_payload_pool<PayloadT>(DataMode::Uniform));
+    check_pool(make_payload_pool<PayloadT>(DataMode::Flight));
+    check_pool(make_payload_pool<PayloadT>(DataMode::Replay, FlightSimulator::stream_length<PayloadT>()));
+}
+
+int main() {
+    std::cout << "[TEST] Starting JSON float round-trip test..." << std::endl;
+
+    // 1. The generated pools of both payloads with float fields, in every
+    //    --data mode (Replay over a whole flight)
+    check_pools<PayloadOdometry>();
+    check_pools<PayloadAttitude>();
+    const size_t pooled = g_checked;
+
+    // 2. The layout switches (fixed, "0.000ddd", exponent), the extremes,
+    //    the zeros, and the float format_float() special-cases
+    const float edges[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 0.1f, 0.3f, 2.5f, 1e-6f, 9.99999e-7f, 1e-7f, 123456.0f,
+        1e20f, 1e21f, 1e22f, 16777216.0f, 3.4e38f, FLT_MAX, -FLT_MAX, FLT_MIN,
+        FLT_TRUE_MIN, std::nextafter(FLT_MIN, 0.0f), 3.14159265f, 0x1.5c87fap-84f,
+    };
+    for (float v : edges) check(v);
+
+    // 3. A stride through every finite bit pattern
+    for (uint64_t bits = 0; bits <= 0xFFFFFFFFu; bits += 65521) {
+        float v;
+        const uint32_t b = (uint32_t)bits;
+        memcpy(&v, &b, sizeof(v));
+        if (std::isfinite(v)) check(v);
+    }
+
+    std::cout << "[TEST] " << pooled << " pooled floats and " << (g_checked - pooled)
+              << " edge/strided floats round-trip at shortest length" << std::endl;
+    std::cout << "[TEST] SUCCESS" << std::endl;
+    return 0;
+}
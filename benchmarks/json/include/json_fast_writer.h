@@ -0,0 +1,196 @@
+#ifndef PRIME_FUSION_JSON_FAST_WRITER_H
+#define PRIME_FUSION_JSON_FAST_WRITER_H
+
+#include "NumberText.h"
+#include <rapidjson/rapidjson.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace pf {
+
+namespace fast_writer {
+
+// Escape character after '\\' for each byte, 0 if it is written as is
+// (RapidJSON's set: the quote, the backslash and the control characters)
+struct EscapeTable { char esc[256]; };
+
+constexpr EscapeTable make_escapes() {
+    EscapeTable t{};
+    for (int c = 0; c < 0x20; c++) t.esc[c] = 'u';
+    t.esc['\b'] = 'b';
+    t.esc['\t'] = 't';
+    t.esc['\n'] = 'n';
+    t.esc['\f'] = 'f';
+    t.esc['\r'] = 'r';
+    t.esc['"'] = '"';
+    t.esc['\\'] = '\\';
+    return t;
+}
+
+inline constexpr EscapeTable kEscapes = make_escapes();
+
+} // namespace fast_writer
+
+/**
+ * @brief The JSON-Fast variant's writer: the same document as
+ * rapidjson::Writer (keys, separators, escaping, number layout), written
+ * into caller memory with the NumberText.h formatters. Floats come in
+ * through Float() and print as the shortest float, so "0.1" where the
+ * Standard writer's Double() prints "0.10000000149011612".
+ *
+ * Capacity is checked once per token rather than per character. Running
+ * out of room, nesting past kMaxDepth, or a NaN/infinite float latches a
+ * failure, and result() then reports 0 like SpanStream.
+ */
+class FastWriter {
+public:
+    using SizeType = rapidjson::SizeType;
+    static constexpr int kMaxDepth = 32;
+
+    FastWriter(uint8_t* dst, size_t cap)
+        : begin_(reinterpret_cast<char*>(dst)), p_(begin_), end_(begin_ + cap) {}
+
+    bool StartObject() { return open('{'); }
+    bool EndObject(SizeType = 0) { return close('}'); }
+    bool StartArray() { return open('['); }
+    bool EndArray(SizeType = 0) { return close(']'); }
+
+    bool Key(const char* str) { return Key(str, (SizeType)strlen(str)); }
+    bool Key(const char* str, SizeType length, bool = false) {
+        if (!string(str, length)) return false;
+        after_key_ = true;
+        return true;
+    }
+
+    bool String(const char* str) { return string(str, (SizeType)strlen(str)); }
+    bool String(const char* str, SizeType length, bool = false) { return string(str, length); }
+
+    bool Int(int v) { return Int64(v); }
+    bool Uint(unsigned v) { return Uint64(v); }
+    bool Int64(int64_t v) {
+        return number<number_text::kMaxIntegerChars>([v](char* out) { return format_int(v, out); });
+    }
+    bool Uint64(uint64_t v) {
+        return number<number_text::kMaxIntegerChars>([v](char* out) { return format_uint(v, out); });
+    }
+
+    bool Float(float v) {
+        if (!std::isfinite(v)) return fail();
+        return number<number_text::kMaxFloatChars>([v](char* out) { return format_float(v, out); });
+    }
+
+    /**
+     * @brief Bytes written, or 0 if the document failed.
+     */
+    size_t result() const { return failed_ ? 0 : (size_t)(p_ - begin_); }
+
+private:
+    bool fail() {
+        failed_ = true;
+        return false;
+    }
+
+    // Checks room for n characters plus the separator, then writes the
+    // separator: ':' after a key, ',' before every later member or element.
+    bool value(size_t n) {
+        if (failed_ || (size_t)(end_ - p_) < n + 1) return fail();
+        if (after_key_) {
+            *p_++ = ':';
+            after_key_ = false;
+        } else if (depth_ > 0 && count_[depth_ - 1]++ > 0) {
+            *p_++ = ',';
+        }
+        return true;
+    }
+
+    // A number of at most N characters. Away from the end of the buffer one
+    // check covers the longest one; near it the number is formatted aside
+    // first, so a document that fits exactly is still written.
+    template <size_t N, typename Format>
+    bool number(Format format) {
+        if ((size_t)(end_ - p_) > N) {
+            if (!value(N)) return false;
+            p_ = format(p_);
+            return true;
+        }
+        char digits[N];
+        const size_t n = (size_t)(format(digits) - digits);
+        if (!value(n)) return false;
+        memcpy(p_, digits, n);
+        p_ += n;
+        return true;
+    }
+
+    bool open(char c) {
+        if (depth_ == kMaxDepth || !value(1)) return fail();
+        *p_++ = c;
+        count_[depth_++] = 0;
+        return true;
+    }
+
+    bool close(char c) {
+        if (failed_ || depth_ == 0 || p_ == end_) return fail();
+        depth_--;
+        *p_++ = c;
+        return true;
+    }
+
+    bool string(const char* s, SizeType length) {
+        if (!value((size_t)length + 2)) return false;
+        *p_++ = '"';
+        for (SizeType i = 0; i < length; i++) {
+            const uint8_t c = (uint8_t)s[i];
+            const char esc = fast_writer::kEscapes.esc[c];
+            if (!esc) {
+                *p_++ = (char)c;
+                continue;
+            }
+            // This character escaped, the rest as is, and the closing quote
+            const size_t extra = esc == 'u' ? 5 : 1;
+            if ((size_t)(end_ - p_) < extra + (length - i) + 1) return fail();
+            *p_++ = '\\';
+            *p_++ = esc;
+            if (esc == 'u') {
+                static const char kHex[] = "0123456789ABCDEF";
+                p_[0] = '0';
+                p_[1] = '0';
+                p_[2] = kHex[c >> 4];
+                p_[3] = kHex[c & 0x0F];
+                p_ += 4;
+            }
+        }
+        *p_++ = '"';
+        return true;
+    }
+
+    char* begin_;
+    char* p_;
+    char* end_;
+    uint32_t count_[kMaxDepth]; // Members or elements so far, per open container
+    int depth_ = 0;
+    bool after_key_ = false;
+    bool failed_ = false;
+};
+
+// Floats go to Float() on a FastWriter and to Double() on a RapidJSON writer
+template <typename Writer> bool write_json_float(Writer& w, float v) { return w.Double(v); }
+inline bool write_json_float(FastWriter& w, float v) { return w.Float(v); }
+
+/**
+ * @brief encode() for the Fast variant: write(FastWriter&) into a vector of
+ * cap bytes (the plugin's max_encoded_size()), trimmed to the document.
+ */
+template <typename Write>
+std::vector<uint8_t> fast_encode(size_t cap, Write&& write) {
+    std::vector<uint8_t> out(cap);
+    FastWriter w(out.data(), cap);
+    write(w);
+    out.resize(w.result());
+    return out;
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_JSON_FAST_WRITER_H
@@ -0,0 +1,285 @@
+#ifndef PRIME_FUSION_JSON_SCHEMA_CODEC_H
+#define PRIME_FUSION_JSON_SCHEMA_CODEC_H
+
+#include "SchemaCodec.h"
+#include "ColumnarBlock.h"
+#include "ByteText.h"
+#include "json_fast_writer.h"
+#include <rapidjson/reader.h>
+#include <rapidjson/memorystream.h>
+#include <vector>
+
+namespace pf {
+
+// One overload per C type, so the schema walk emits the narrowest writer call.
+template <typename Writer> void write_json_number(Writer& w, uint8_t v) { w.Uint(v); }
+template <typename Writer> void write_json_number(Writer& w, uint16_t v) { w.Uint(v); }
+template <typename Writer> void write_json_number(Writer& w, uint32_t v) { w.Uint(v); }
+template <typename Writer> void write_json_number(Writer& w, uint64_t v) { w.Uint64(v); }
+template <typename Writer> void write_json_number(Writer& w, int8_t v) { w.Int(v); }
+template <typename Writer> void write_json_number(Writer& w, int16_t v) { w.Int(v); }
+template <typename Writer> void write_json_number(Writer& w, int32_t v) { w.Int(v); }
+template <typename Writer> void write_json_number(Writer& w, int64_t v) { w.Int64(v); }
+template <typename Writer> void write_json_number(Writer& w, float v) { write_json_float(w, v); }
+
+/**
+ * @brief Writes T as a JSON object keyed by field name or short name.
+ * BYTES fields are written as lowercase hex, like the GPSRaw Standard variant.
+ */
+template <KeyStyle Style, typename T, typename Writer>
+void write_schema(Writer& w, const T& m) {
+    static_assert(Style != KeyStyle::Int, "JSON object keys are strings");
+    w.StartObject();
+    for_each_field<T>([&](auto i) {
+        constexpr const FieldDesc& d = PayloadSchema<T>::fields[decltype(i)::value];
+        constexpr const char* key = schema_key(d, Style);
+        w.Key(key, (rapidjson::SizeType)key_length(key));
+
+        const auto* p = field_ptr<d.type>(m, d);
+        if constexpr (d.type == FieldType::BYTES) {
+            char hex[2 * d.count];
+            hex_encode(p, d.count, hex);
+            w.String(hex, (rapidjson::SizeType)sizeof(hex));
+        } else if constexpr (d.type == FieldType::CHARS) {
+            w.String(p, (rapidjson::SizeType)strnlen(p, d.count));
+        } else if constexpr (d.count == 1) {
+            write_json_number(w, *p);
+        } else {
+            w.StartArray();
+            for (size_t k = 0; k < d.count; k++) write_json_number(w, p[k]);
+            w.EndArray();
+        }
+    });
+    w.EndObject();
+}
+
+template <KeyStyle Style, typename T, typename Writer>
+void write_schema_records(Writer& w, const std::vector<T>& records) {
+    w.StartArray();
+    for (const T& r : records) write_schema<Style>(w, r);
+    w.EndArray();
+}
+
+// Upper bound on the text of one value: digits and sign, or the longest
+// shortest-round-trip double RapidJSON prints for a float.
+constexpr size_t json_number_bound(FieldType type) {
+    switch (type) {
+        case FieldType::U8: return 3;
+        case FieldType::U16: return 5;
+        case FieldType::U32: return 10;
+        case FieldType::I8: return 4;
+        case FieldType::I16: return 6;
+        case FieldType::I32: return 11;
+        case FieldType::U64:
+        case FieldType::I64: return 20;
+        default: return 25;
+    }
+}
+
+/**
+ * @brief Worst-case size of write_schema<Style>(T), from the schema alone.
+ * Text is counted at 6 bytes per character (\u00XX escapes).
+ */
+template <typename T, KeyStyle Style>
+constexpr size_t json_schema_max_size() {
+    size_t n = 2;
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const FieldDesc& d = PayloadSchema<T>::fields[i];
+        n += key_length(schema_key(d, Style)) + 4; // quotes, colon, comma
+        if (d.type == FieldType::BYTES) n += 2 * d.count + 2;
+        else if (d.type == FieldType::CHARS) n += 6 * (d.count - 1) + 2;
+        else if (d.count == 1) n += json_number_bound(d.type);
+        else n += d.count * (json_number_bound(d.type) + 1) + 2;
+    }
+    return n;
+}
+
+/**
+ * @brief SAX handler that fills T (or appends records of T) from the schema.
+ * Keys resolve once through the schema's KeyTable; array elements are stored at
+ * `index`, which every key resets.
+ */
+template <typename T, KeyStyle Style>
+struct SchemaHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, SchemaHandler<T, Style> > {
+    T* m = nullptr;
+    std::vector<T>* records = nullptr; // Set when decoding an array of records
+    int field = -1;
+    size_t index = 0;
+
+    explicit SchemaHandler(T* out) : m(out) {}
+    explicit SchemaHandler(std::vector<T>* out) : records(out) {}
+
+    bool StartObject() {
+        if (records) {
+            records->emplace_back();
+            m = &records->back();
+        }
+        return true;
+    }
+
+    bool Key(const char* str, rapidjson::SizeType len, bool) {
+        field = schema_find<T, Style>(str, len);
+        index = 0;
+        return true;
+    }
+
+    bool Uint(unsigned u) { return set(u); }
+    bool Int(int i) { return set(i); }
+    bool Uint64(uint64_t u) { return set(u); }
+    bool Int64(int64_t i) { return set(i); }
+    bool Double(double d) { return set(d); }
+
+    bool String(const char* str, rapidjson::SizeType len, bool) {
+        if (field < 0) return true;
+        const FieldDesc& d = PayloadSchema<T>::fields[field];
+        if (d.type != FieldType::BYTES) {
+            store_bytes(*m, d, str, len);
+        } else if (len == 2 * d.count) {
+            return hex_decode(str, d.count, reinterpret_cast<uint8_t*>(m) + d.offset);
+        }
+        return true;
+    }
+
+    template <typename V>
+    bool set(V v) {
+        if (field >= 0) store_number(*m, PayloadSchema<T>::fields[field], index++, v);
+        return true;
+    }
+};
+
+template <KeyStyle Style, typename T>
+bool read_schema(rapidjson::Reader& reader, const uint8_t* data, size_t len, T& m) {
+    rapidjson::MemoryStream ss((const char*)data, len);
+    SchemaHandler<T, Style> handler(&m);
+    return !reader.Parse(ss, handler).IsError();
+}
+
+/**
+ * @brief Decodes a JSON array of objects into `records`, replacing its contents.
+ * The vector keeps its capacity, so steady-state decodes do not reallocate.
+ */
+template <KeyStyle Style, typename T>
+bool read_schema_records(rapidjson::Reader& reader, const uint8_t* data, size_t len, std::vector<T>& records) {
+    records.clear();
+    rapidjson::MemoryStream ss((const char*)data, len);
+    SchemaHandler<T, Style> handler(&records);
+    return !reader.Parse(ss, handler).IsError();
+}
+
+// --- Columnar blocks, see ColumnarBlock.h ---
+
+template <typename T>
+inline size_t json_columns_max_size(size_t records) {
+    size_t n = 2 + key_length(kColumnCountKey) + 4 + 20;
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const FieldDesc& d = PayloadSchema<T>::fields[i];
+        n += key_length(d.short_name) + 4;
+        n += d.type == FieldType::BYTES ? 2 * d.count * records + 2 : records * 21 + 2;
+    }
+    return n;
+}
+
+/**
+ * @brief Writes {"n": count, <short name>: [delta, ...], ...}.
+ * JSON numbers are signed, so integer columns hold the plain differences
+ * (no zigzag or varint). A BYTES column is one hex string for the whole block,
+ * built in `scratch` (grown once, then reused).
+ */
+template <typename T, typename Writer>
+void write_schema_columns(Writer& w, const std::vector<T>& records, std::vector<char>& scratch) {
+    static_assert(schema_is_columnar<T>(), "Columnar blocks need integer and BYTES fields only");
+    w.StartObject();
+    w.Key(kColumnCountKey, (rapidjson::SizeType)key_length(kColumnCountKey));
+    w.Uint64(records.size());
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const FieldDesc& d = PayloadSchema<T>::fields[i];
+        w.Key(d.short_name, (rapidjson::SizeType)key_length(d.short_name));
+        if (d.type == FieldType::BYTES) {
+            size_t len = 2 * d.count * records.size();
+            if (scratch.size() < len) scratch.resize(len);
+            char* out = scratch.data();
+            for (const T& r : records) {
+                hex_encode(reinterpret_cast<const uint8_t*>(&r) + d.offset, d.count, out);
+                out += 2 * d.count;
+            }
+            w.String(scratch.data(), (rapidjson::SizeType)len);
+        } else {
+            w.StartArray();
+            for_each_delta(records, d, [&](int64_t delta) { w.Int64(delta); });
+            w.EndArray();
+        }
+    }
+    w.EndObject();
+}
+
+/**
+ * @brief SAX handler for write_schema_columns output.
+ * The count resizes `records` and must come first; each column must then hold
+ * exactly one value per record. Columns are scattered in place, so
+ * read_schema_columns empties `records` again when the parse fails.
+ */
+template <typename T>
+struct ColumnHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, ColumnHandler<T> > {
+    static constexpr int kCount = -2;
+    std::vector<T>* records;
+    size_t input_len;
+    int field = -1;
+    size_t index = 0;
+    bool sized = false;
+    DeltaScatter scatter;
+
+    ColumnHandler(std::vector<T>* out, size_t len) : records(out), input_len(len) {}
+
+    bool Key(const char* str, rapidjson::SizeType len, bool) {
+        if (len == key_length(kColumnCountKey) && memcmp(str, kColumnCountKey, len) == 0) field = kCount;
+        else field = schema_find<T, KeyStyle::ShortName>(str, len);
+        index = 0;
+        scatter = DeltaScatter();
+        return true;
+    }
+
+    bool Uint(unsigned u) { return number(u); }
+    bool Int(int i) { return number(i); }
+    bool Uint64(uint64_t u) { return number((int64_t)u); }
+    bool Int64(int64_t i) { return number(i); }
+    bool Double(double) { return field == -1; }
+
+    bool number(int64_t v) {
+        if (field == kCount) {
+            if (v < 0 || (uint64_t)v > input_len) return false; // At least a byte per record
+            records->resize((size_t)v);
+            sized = true;
+            return true;
+        }
+        if (field < 0) return true;
+        if (!sized || index >= records->size()) return false;
+        scatter.add((*records)[index++], PayloadSchema<T>::fields[field], v);
+        return true;
+    }
+
+    bool EndArray(rapidjson::SizeType) { return field < 0 || index == records->size(); }
+
+    bool String(const char* str, rapidjson::SizeType len, bool) {
+        if (field < 0) return true;
+        const FieldDesc& d = PayloadSchema<T>::fields[field];
+        if (d.type != FieldType::BYTES || !sized || len != 2 * d.count * records->size()) return false;
+        for (T& r : *records) {
+            if (!hex_decode(str, d.count, reinterpret_cast<uint8_t*>(&r) + d.offset)) return false;
+            str += 2 * d.count;
+        }
+        return true;
+    }
+};
+
+template <typename T>
+bool read_schema_columns(rapidjson::Reader& reader, const uint8_t* data, size_t len, std::vector<T>& records) {
+    rapidjson::MemoryStream ss((const char*)data, len);
+    ColumnHandler<T> handler(&records, len);
+    if (!reader.Parse(ss, handler).IsError() && handler.sized) return true;
+    records.clear();
+    return false;
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_JSON_SCHEMA_CODEC_H
@@ -0,0 +1,64 @@
+#ifndef PRIME_FUSION_JSON_SPAN_STREAM_H
+#define PRIME_FUSION_JSON_SPAN_STREAM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <rapidjson/writer.h>
+#include <rapidjson/allocators.h>
+
+namespace pf {
+
+/**
+ * @brief RapidJSON output stream over caller-owned memory.
+ * Stands in for rapidjson::StringBuffer when the destination is fixed, so
+ * Writer<SpanStream> emits straight into the caller's buffer (no heap growth).
+ * Overflow is latched and reported via result().
+ */
+class SpanStream {
+public:
+    typedef char Ch;
+
+    SpanStream(uint8_t* dst, size_t cap) : dst_(reinterpret_cast<Ch*>(dst)), cap_(cap) {}
+
+    /**
+     * @brief Retarget to a new destination so one Writer can serve a whole batch.
+     */
+    void reset(uint8_t* dst, size_t cap) {
+        dst_ = reinterpret_cast<Ch*>(dst);
+        cap_ = cap;
+        size_ = 0;
+        overflow_ = false;
+    }
+
+    void Put(Ch c) {
+        if (size_ < cap_) dst_[size_++] = c;
+        else overflow_ = true;
+    }
+    void Flush() {}
+
+    /**
+     * @brief Bytes written, or 0 if the document did not fit.
+     */
+    size_t result() const { return overflow_ ? 0 : size_; }
+
+private:
+    Ch* dst_;
+    size_t cap_;
+    size_t size_ = 0;
+    bool overflow_ = false;
+};
+
+/**
+ * @brief Writer over a SpanStream whose level stack lives in caller memory.
+ * The default Writer mallocs its nesting stack on the first StartObject();
+ * backing it with a stack arena keeps encode_into() allocation-free.
+ */
+typedef rapidjson::Writer<SpanStream, rapidjson::UTF8<>, rapidjson::UTF8<>,
+                          rapidjson::MemoryPoolAllocator<> > SpanWriter;
+
+// Arena size for SpanWriter: default level stack (32 levels) plus chunk header.
+static constexpr size_t kSpanWriterArenaBytes = 1024;
+
+} // namespace pf
+
+#endif // PRIME_FUSION_JSON_SPAN_STREAM_H
@@ -1,7 +1,10 @@
 #include "IBenchmark.h"
+#include "KeyDispatch.h"
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
+#include "json_span_stream.h"
+#include "json_fast_writer.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -11,7 +14,10 @@ namespace pf {
 
 class JsonBenchmarkAttitude : public IBenchmark {
 public:
+    bool fast_ = false; // FastWriter instead of RapidJSON's Writer (json_fast_writer.h)
+
     void setup(const BenchmarkConfig& config) override {
+        fast_ = config.variant_name == "Fast";
         PayloadAttitude p;
         memset(&p, 0, sizeof(p));
         p.roll = 1.0f;
@@ -25,54 +31,123 @@ public:
              std::cerr << "[JSON-Attitude] Sanity Check: FAILED" << std::endl;
              exit(1);
         }
-        (void)config;
+    }
+
+    // Worst case: 7 keys (<= 4 chars, quoted + colon + comma), one uint32
+    // and six doubles at <= 25 chars (RapidJSON's dtoa buffer).
+    static constexpr size_t kMaxEncodedSize = 2 + 7 * (4 + 3 + 1) + 10 + 6 * 25;
+
+    size_t max_encoded_size(const void* data) override {
+        (void)data;
+        return kMaxEncodedSize;
     }
 
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadAttitude& m = *static_cast<const PayloadAttitude*>(data);
+        if (fast_) return fast_encode(kMaxEncodedSize, [&](FastWriter& w) { write_payload(w, m); });
         rapidjson::StringBuffer sb(0, 1024);
         rapidjson::Writer<rapidjson::StringBuffer> w(sb);
+        write_payload(w, m);
+        const char* s = sb.GetString();
+        return std::vector<uint8_t>(s, s + sb.GetSize());
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadAttitude& m = *static_cast<const PayloadAttitude*>(data);
+        if (fast_) {
+            FastWriter w(dst, cap);
+            write_payload(w, m);
+            return w.result();
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        write_payload(w, m);
+        return out.result();
+    }
+
+    template <typename Writer>
+    void write_payload(Writer& w, const PayloadAttitude& m) {
         w.StartObject();
         w.Key("boot"); w.Uint(m.time_boot_ms);
-        w.Key("r"); w.Double(m.roll);
-        w.Key("p"); w.Double(m.pitch);
-        w.Key("y"); w.Double(m.yaw);
-        w.Key("rs"); w.Double(m.rollspeed);
-        w.Key("ps"); w.Double(m.pitchspeed);
-        w.Key("ys"); w.Double(m.yawspeed);
+        w.Key("r"); write_json_float(w, m.roll);
+        w.Key("p"); write_json_float(w, m.pitch);
+        w.Key("y"); write_json_float(w, m.yaw);
+        w.Key("rs"); write_json_float(w, m.rollspeed);
+        w.Key("ps"); write_json_float(w, m.pitchspeed);
+        w.Key("ys"); write_json_float(w, m.yawspeed);
         w.EndObject();
-        const char* s = sb.GetString();
-        return std::vector<uint8_t>(s, s + sb.GetSize());
     }
 
+    enum Field { BOOT, ROLL, PITCH, YAW, ROLLSPEED, PITCHSPEED, YAWSPEED };
+    static constexpr KeyEntry kKeys[] = {
+        {"boot", BOOT}, {"r", ROLL}, {"p", PITCH}, {"y", YAW},
+        {"rs", ROLLSPEED}, {"ps", PITCHSPEED}, {"ys", YAWSPEED},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
     struct PayloadHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PayloadHandler> {
         PayloadAttitude* m;
-        std::string key;
+        int field = -1;
         PayloadHandler(PayloadAttitude* p) : m(p) {}
-        bool Key(const char* str, rapidjson::SizeType len, bool) { key.assign(str, len); return true; }
-        bool Uint(unsigned u) { if(key=="boot") m->time_boot_ms = u; return true; }
+        bool Key(const char* str, rapidjson::SizeType len, bool) { field = kFields.find(str, len); return true; }
+        bool Uint(unsigned u) { if(field==BOOT) m->time_boot_ms = u; return true; }
         bool Double(double d) {
             float f = (float)d;
-            if(key=="r") m->roll=f;
-            else if(key=="p") m->pitch=f;
-            else if(key=="y") m->yaw=f;
-            else if(key=="rs") m->rollspeed=f;
-            else if(key=="ps") m->pitchspeed=f;
-            else if(key=="ys") m->yawspeed=f;
+            switch (field) {
+                case ROLL: m->roll=f; break;
+                case PITCH: m->pitch=f; break;
+                case YAW: m->yaw=f; break;
+                case ROLLSPEED: m->rollspeed=f; break;
+                case PITCHSPEED: m->pitchspeed=f; break;
+                case YAWSPEED: m->yawspeed=f; break;
+            }
             return true;
         }
     };
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadAttitude& m = *static_cast<PayloadAttitude*>(out_data);
         rapidjson::Reader reader;
-        rapidjson::MemoryStream ss((const char*)buffer.data(), buffer.size());
+        rapidjson::MemoryStream ss((const char*)data, len);
         PayloadHandler handler(&m);
         reader.Parse(ss, handler);
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        if (fast_) {
+            return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+                FastWriter w(frame, frame_cap);
+                write_payload(w, *static_cast<const PayloadAttitude*>(item));
+                return w.result();
+            });
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            w.Reset(out);
+            write_payload(w, *static_cast<const PayloadAttitude*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        rapidjson::Reader reader;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            rapidjson::MemoryStream ss((const char*)frame, frame_len);
+            PayloadHandler handler(static_cast<PayloadAttitude*>(out));
+            reader.Parse(ss, handler);
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "JSON-Attitude"; }
+    std::string name() const override { return fast_ ? "JSON-Fast-Attitude" : "JSON-Attitude"; }
 };
 
 } // pf
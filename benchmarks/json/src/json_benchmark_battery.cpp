@@ -1,7 +1,10 @@
 #include "IBenchmark.h"
+#include "KeyDispatch.h"
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
+#include "json_span_stream.h"
+#include "json_fast_writer.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -10,12 +13,12 @@ namespace pf {
 
 class JsonBenchmarkBattery : public IBenchmark {
 public:
-    enum Variant { STANDARD, SHORT };
+    enum Variant { STANDARD, SHORT, FAST };
     Variant variant_ = STANDARD;
 
     void setup(const BenchmarkConfig& config) override {
-        // Battery doesn't really have "Canonical" variants yet, just keep Standard
-        variant_ = STANDARD; 
+        // Battery doesn't really have "Canonical" variants yet; Fast only swaps the writer
+        variant_ = config.variant_name == "Fast" ? FAST : STANDARD;
         std::cout << "[JSON-Battery] Setup complete." << std::endl;
 
         // Integrity Verification
@@ -38,11 +41,42 @@ public:
         }
     }
 
+    // Worst case: 9 keys (<= 8 chars, quoted + colon + comma), 8 integers
+    // at <= 11 chars, and the 10-cell array at <= 5 digits + comma each.
+    static constexpr size_t kMaxEncodedSize = 2 + 9 * (8 + 3 + 1) + 8 * 11 + (2 + 10 * 6);
+
+    size_t max_encoded_size(const void* data) override {
+        (void)data;
+        return kMaxEncodedSize;
+    }
+
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadBattery& m = *static_cast<const PayloadBattery*>(data);
-        
-        rapidjson::StringBuffer sb(0, 1024); 
+        if (variant_ == FAST) return fast_encode(kMaxEncodedSize, [&](FastWriter& w) { write_payload(w, m); });
+        rapidjson::StringBuffer sb(0, 1024);
         rapidjson::Writer<rapidjson::StringBuffer> w(sb);
+        write_payload(w, m);
+        const char* s = sb.GetString();
+        return std::vector<uint8_t>(s, s + sb.GetSize());
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadBattery& m = *static_cast<const PayloadBattery*>(data);
+        if (variant_ == FAST) {
+            FastWriter w(dst, cap);
+            write_payload(w, m);
+            return w.result();
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        write_payload(w, m);
+        return out.result();
+    }
+
+    template <typename Writer>
+    void write_payload(Writer& w, const PayloadBattery& m) {
         w.StartObject();
 
         w.Key("id"); w.Uint(m.id);
@@ -61,59 +95,86 @@ public:
         w.Key("pct"); w.Int(m.battery_remaining);
         
         w.EndObject();
-        const char* s = sb.GetString();
-        return std::vector<uint8_t>(s, s + sb.GetSize());
     }
 
+    enum Field { ID, FUNC, TYPE, TEMP, VOLTAGES, CURRENT, CONSUMED, ENERGY, PCT };
+    static constexpr KeyEntry kKeys[] = {
+        {"id", ID}, {"func", FUNC}, {"type", TYPE}, {"temp", TEMP}, {"voltages", VOLTAGES},
+        {"current", CURRENT}, {"consumed", CONSUMED}, {"energy", ENERGY}, {"pct", PCT},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
     struct PayloadHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PayloadHandler> {
         PayloadBattery* m;
-        std::string key;
-        bool in_voltages = false;
+        int field = -1;
         int voltage_idx = 0;
 
         PayloadHandler(PayloadBattery* p) : m(p) {}
 
         bool Key(const char* str, rapidjson::SizeType length, bool) {
-            key.assign(str, length);
-            if (key == "voltages") {
-                in_voltages = true;
-                voltage_idx = 0;
-            } else {
-                in_voltages = false;
-            }
+            field = kFields.find(str, length);
+            voltage_idx = 0;
             return true;
         }
 
         bool Uint(unsigned u) { return Int(u); }
         bool Int(int i) { 
-            if (in_voltages) {
-                if (voltage_idx < 10) {
-                    m->voltages[voltage_idx++] = (uint16_t)i;
-                }
-            } else {
-                if (key == "id") m->id = (uint8_t)i;
-                else if (key == "func") m->battery_function = (uint8_t)i;
-                else if (key == "type") m->type = (uint8_t)i;
-                else if (key == "temp") m->temperature = (int16_t)i;
-                else if (key == "current") m->current_battery = (int16_t)i;
-                else if (key == "consumed") m->current_consumed = i;
-                else if (key == "energy") m->energy_consumed = i;
-                else if (key == "pct") m->battery_remaining = (int8_t)i;
+            switch (field) {
+                case VOLTAGES: if (voltage_idx < 10) m->voltages[voltage_idx++] = (uint16_t)i; break;
+                case ID: m->id = (uint8_t)i; break;
+                case FUNC: m->battery_function = (uint8_t)i; break;
+                case TYPE: m->type = (uint8_t)i; break;
+                case TEMP: m->temperature = (int16_t)i; break;
+                case CURRENT: m->current_battery = (int16_t)i; break;
+                case CONSUMED: m->current_consumed = i; break;
+                case ENERGY: m->energy_consumed = i; break;
+                case PCT: m->battery_remaining = (int8_t)i; break;
             }
             return true; 
         }
     };
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadBattery& m = *static_cast<PayloadBattery*>(out_data);
         rapidjson::Reader reader;
-        rapidjson::MemoryStream ss((const char*)buffer.data(), buffer.size());
+        rapidjson::MemoryStream ss((const char*)data, len);
         PayloadHandler handler(&m);
         reader.Parse(ss, handler);
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        if (variant_ == FAST) {
+            return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+                FastWriter w(frame, frame_cap);
+                write_payload(w, *static_cast<const PayloadBattery*>(item));
+                return w.result();
+            });
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            w.Reset(out);
+            write_payload(w, *static_cast<const PayloadBattery*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        rapidjson::Reader reader;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            rapidjson::MemoryStream ss((const char*)frame, frame_len);
+            PayloadHandler handler(static_cast<PayloadBattery*>(out));
+            reader.Parse(ss, handler);
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "JSON-Battery"; }
+    std::string name() const override { return variant_ == FAST ? "JSON-Fast-Battery" : "JSON-Battery"; }
 };
 
 } // namespace pf
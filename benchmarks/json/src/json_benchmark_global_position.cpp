@@ -1,7 +1,10 @@
 #include "IBenchmark.h"
+#include "KeyDispatch.h"
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
+#include "json_span_stream.h"
+#include "json_fast_writer.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -10,7 +13,10 @@ namespace pf {
 
 class JsonBenchmarkGlobalPosition : public IBenchmark {
 public:
+    bool fast_ = false; // FastWriter instead of RapidJSON's Writer (json_fast_writer.h)
+
     void setup(const BenchmarkConfig& config) override {
+        fast_ = config.variant_name == "Fast";
         PayloadGlobalPosition p;
         memset(&p, 0, sizeof(p));
         p.lat = 123456789;
@@ -24,13 +30,44 @@ public:
              std::cerr << "[JSON-GlobalPos] Sanity Check: FAILED" << std::endl;
              exit(1);
         }
-        (void)config;
+    }
+
+    // Worst case: 9 keys (<= 4 chars, quoted + colon + comma), 9 integers
+    // at <= 11 chars.
+    static constexpr size_t kMaxEncodedSize = 2 + 9 * (4 + 3 + 1) + 9 * 11;
+
+    size_t max_encoded_size(const void* data) override {
+        (void)data;
+        return kMaxEncodedSize;
     }
 
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadGlobalPosition& m = *static_cast<const PayloadGlobalPosition*>(data);
+        if (fast_) return fast_encode(kMaxEncodedSize, [&](FastWriter& w) { write_payload(w, m); });
         rapidjson::StringBuffer sb(0, 1024);
         rapidjson::Writer<rapidjson::StringBuffer> w(sb);
+        write_payload(w, m);
+        const char* s = sb.GetString();
+        return std::vector<uint8_t>(s, s + sb.GetSize());
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadGlobalPosition& m = *static_cast<const PayloadGlobalPosition*>(data);
+        if (fast_) {
+            FastWriter w(dst, cap);
+            write_payload(w, m);
+            return w.result();
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        write_payload(w, m);
+        return out.result();
+    }
+
+    template <typename Writer>
+    void write_payload(Writer& w, const PayloadGlobalPosition& m) {
         w.StartObject();
         w.Key("boot"); w.Uint(m.time_boot_ms);
         w.Key("lat"); w.Int(m.lat);
@@ -42,43 +79,83 @@ public:
         w.Key("vz"); w.Int(m.vz);
         w.Key("hdg"); w.Uint(m.hdg);
         w.EndObject();
-        const char* s = sb.GetString();
-        return std::vector<uint8_t>(s, s + sb.GetSize());
     }
 
+    enum Field { BOOT, LAT, LON, ALT, REL, VX, VY, VZ, HDG };
+    static constexpr KeyEntry kKeys[] = {
+        {"boot", BOOT}, {"lat", LAT}, {"lon", LON}, {"alt", ALT}, {"rel", REL},
+        {"vx", VX}, {"vy", VY}, {"vz", VZ}, {"hdg", HDG},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
     struct PayloadHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PayloadHandler> {
         PayloadGlobalPosition* m;
-        std::string key;
+        int field = -1;
         PayloadHandler(PayloadGlobalPosition* p) : m(p) {}
-        bool Key(const char* str, rapidjson::SizeType len, bool) { key.assign(str, len); return true; }
+        bool Key(const char* str, rapidjson::SizeType len, bool) { field = kFields.find(str, len); return true; }
         bool Uint(unsigned u) { 
-            if(key=="boot") m->time_boot_ms = u;
-            else if(key=="hdg") m->hdg = (uint16_t)u;
-            else return Int((int)u); // Fallback to Int logic for positive integers like lat/lon
+            switch (field) {
+                case BOOT: m->time_boot_ms = u; break;
+                case HDG: m->hdg = (uint16_t)u; break;
+                default: return Int((int)u); // Fallback to Int logic for positive integers like lat/lon
+            }
             return true; 
         }
         bool Int(int i) {
-            if(key=="lat") m->lat = i;
-            else if(key=="lon") m->lon = i;
-            else if(key=="alt") m->alt = i;
-            else if(key=="rel") m->relative_alt = i;
-            else if(key=="vx") m->vx = (int16_t)i;
-            else if(key=="vy") m->vy = (int16_t)i;
-            else if(key=="vz") m->vz = (int16_t)i;
+            switch (field) {
+                case LAT: m->lat = i; break;
+                case LON: m->lon = i; break;
+                case ALT: m->alt = i; break;
+                case REL: m->relative_alt = i; break;
+                case VX: m->vx = (int16_t)i; break;
+                case VY: m->vy = (int16_t)i; break;
+                case VZ: m->vz = (int16_t)i; break;
+            }
             return true;
         }
     };
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadGlobalPosition& m = *static_cast<PayloadGlobalPosition*>(out_data);
         rapidjson::Reader reader;
-        rapidjson::MemoryStream ss((const char*)buffer.data(), buffer.size());
+        rapidjson::MemoryStream ss((const char*)data, len);
         PayloadHandler handler(&m);
         reader.Parse(ss, handler);
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        if (fast_) {
+            return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+                FastWriter w(frame, frame_cap);
+                write_payload(w, *static_cast<const PayloadGlobalPosition*>(item));
+                return w.result();
+            });
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            w.Reset(out);
+            write_payload(w, *static_cast<const PayloadGlobalPosition*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        rapidjson::Reader reader;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            rapidjson::MemoryStream ss((const char*)frame, frame_len);
+            PayloadHandler handler(static_cast<PayloadGlobalPosition*>(out));
+            reader.Parse(ss, handler);
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "JSON-GlobalPos"; }
+    std::string name() const override { return fast_ ? "JSON-Fast-GlobalPos" : "JSON-GlobalPos"; }
 };
 
 } // pf
@@ -2,6 +2,9 @@
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
+#include "json_span_stream.h"
+#include "json_fast_writer.h"
+#include "json_schema_codec.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -11,12 +14,21 @@ namespace pf {
 
 class JsonBenchmarkGPSBlock : public IBenchmark {
 public:
+    bool columnar_ = false; // {"n":..,"lat":[deltas],..} instead of an array of records (ColumnarBlock.h)
+    bool fast_ = false;     // FastWriter instead of RapidJSON's Writer (json_fast_writer.h)
+    std::vector<char> column_scratch_;
+
     void setup(const BenchmarkConfig& config) override {
+        columnar_ = config.variant_name == "Columnar";
+        fast_ = config.variant_name == "Fast";
         PayloadGPSBlock p;
         for(int i=0; i<50; i++) {
             PayloadGPSRaw raw;
             memset(&raw, 0, sizeof(raw));
             raw.timestamp = 1000 + i;
+            raw.lat = -473977418 + i;
+            raw.eph = 120;
+            raw.hash[31] = (uint8_t)i;
             p.messages.push_back(raw);
         }
         
@@ -24,85 +36,100 @@ public:
         PayloadGPSBlock d;
         decode(buf, &d);
         
-        if (d.messages.size() == 50 && d.messages[0].timestamp == 1000) {
+        if (d.messages.size() == 50 && d.messages[0].timestamp == 1000 && d.messages[49].lat == -473977369 &&
+            d.messages[49].eph == 120 && d.messages[49].hash[31] == 49) {
              std::cout << "[JSON-GPSBlock] Sanity Check: PASS" << std::endl;
         } else {
              std::cerr << "[JSON-GPSBlock] Sanity Check: FAILED" << std::endl;
              exit(1);
         }
-        (void)config;
+    }
+
+    // Every PayloadGPSRaw field, under the schema's short keys
+    static constexpr size_t kMaxRecordSize = json_schema_max_size<PayloadGPSRaw, KeyStyle::ShortName>() + 1;
+
+    size_t max_encoded_size(const void* data) override {
+        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        if (columnar_) return json_columns_max_size<PayloadGPSRaw>(m.messages.size());
+        return 2 + m.messages.size() * kMaxRecordSize;
     }
 
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        if (fast_) return fast_encode(max_encoded_size(data), [&](FastWriter& w) { write_block(w, m); });
         rapidjson::StringBuffer sb(0, 4096);
         rapidjson::Writer<rapidjson::StringBuffer> w(sb);
-        
-        w.StartArray();
-        for(const auto& r : m.messages) {
-            w.StartObject();
-            w.Key("ts"); w.Uint64(r.timestamp);
-            w.Key("bn"); w.Uint(r.block_number);
-            // hash skipped for brevity/speed in JSON unless required
-            w.Key("tu"); w.Uint64(r.time_usec);
-            w.Key("ft"); w.Uint(r.fix_type);
-            w.Key("lat"); w.Int(r.lat);
-            w.Key("lon"); w.Int(r.lon);
-            w.Key("alt"); w.Int(r.alt);
-            // ... minimal set for benchmark load
-            w.EndObject();
-        }
-        w.EndArray();
-        
+        write_block(w, m);
         const char* s = sb.GetString();
         return std::vector<uint8_t>(s, s + sb.GetSize());
     }
 
-    struct PayloadHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PayloadHandler> {
-        PayloadGPSBlock* m;
-        PayloadGPSRaw current;
-        std::string key;
-        bool in_obj = false;
-
-        PayloadHandler(PayloadGPSBlock* p) : m(p) {}
-        
-        bool StartObject() { in_obj = true; memset(&current, 0, sizeof(current)); return true; }
-        bool EndObject(rapidjson::SizeType) { m->messages.push_back(current); in_obj = false; return true; }
-        
-        bool Key(const char* str, rapidjson::SizeType len, bool) { key.assign(str, len); return true; }
-        
-        bool Uint(unsigned u) { return Int(u); }
-        bool Uint64(uint64_t u) {
-            if(key=="ts") current.timestamp=u;
-            else if(key=="tu") current.time_usec=u;
-            return true;
-        }
-        bool Int(int i) {
-             if(key=="bn") current.block_number=i;
-             else if(key=="ft") current.fix_type=(uint8_t)i;
-             // Also handle fields that might be small enough for Int but intended for other types if they were missing?
-             // e.g. sat_visible (sv) is uint8.
-             else if(key=="sv") current.satellites_visible=(uint8_t)i;
-             // lat/lon are large, unlikely to be Int, but if they are? 
-             else if(key=="lat") current.lat=i;
-             else if(key=="lon") current.lon=i;
-             else if(key=="alt") current.alt=i;
-             else if(key=="ts") current.timestamp=(uint64_t)i;
-             else if(key=="tu") current.time_usec=(uint64_t)i;
-             return true;
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        if (fast_) {
+            FastWriter w(dst, cap);
+            write_block(w, m);
+            return w.result();
         }
-    };
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        write_block(w, m);
+        return out.result();
+    }
+
+    template <typename Writer>
+    void write_block(Writer& w, const PayloadGPSBlock& m) {
+        if (columnar_) write_schema_columns(w, m.messages, column_scratch_);
+        else write_schema_records<KeyStyle::ShortName>(w, m.messages);
+    }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    void read_block(rapidjson::Reader& reader, const uint8_t* data, size_t len, PayloadGPSBlock& m) {
+        if (columnar_) read_schema_columns(reader, data, len, m.messages);
+        else read_schema_records<KeyStyle::ShortName>(reader, data, len, m.messages);
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadGPSBlock& m = *static_cast<PayloadGPSBlock*>(out_data);
         rapidjson::Reader reader;
-        rapidjson::MemoryStream ss((const char*)buffer.data(), buffer.size());
-        PayloadHandler handler(&m);
-        reader.Parse(ss, handler);
+        read_block(reader, data, len, m);
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        if (fast_) {
+            return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+                FastWriter w(frame, frame_cap);
+                write_block(w, *static_cast<const PayloadGPSBlock*>(item));
+                return w.result();
+            });
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            w.Reset(out);
+            write_block(w, *static_cast<const PayloadGPSBlock*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        rapidjson::Reader reader;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            read_block(reader, frame, frame_len, *static_cast<PayloadGPSBlock*>(out));
+        });
     }
 
     void teardown() override {}
-    std::string name() const override { return "JSON-GPSBlock"; }
+    std::string name() const override {
+        if (columnar_) return "JSON-Columnar-GPSBlock";
+        return fast_ ? "JSON-Fast-GPSBlock" : "JSON-GPSBlock";
+    }
 };
 
 } // pf
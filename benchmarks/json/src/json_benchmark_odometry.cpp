@@ -1,7 +1,10 @@
 #include "IBenchmark.h"
+#include "KeyDispatch.h"
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
+#include "json_span_stream.h"
+#include "json_fast_writer.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -10,11 +13,11 @@ namespace pf {
 
 class JsonBenchmarkOdometry : public IBenchmark {
 public:
-    enum Variant { STANDARD };
+    enum Variant { STANDARD, FAST };
     Variant variant_ = STANDARD;
 
     void setup(const BenchmarkConfig& config) override {
-        variant_ = STANDARD; 
+        variant_ = config.variant_name == "Fast" ? FAST : STANDARD;
         std::cout << "[JSON-Odometry] Setup complete." << std::endl;
 
         // Integrity Verification
@@ -43,123 +46,202 @@ public:
              std::cerr << "Exp Time: 1000 Got: " << d.time_usec << std::endl;
              exit(1);
         }
-        (void)config;
+    }
+
+    // Worst case: 15 keys (<= 5 chars, quoted + colon + comma), uint64 +
+    // two uint8, 9 scalar doubles at <= 25 chars, and the q/pcov/vcov arrays
+    // at <= 25 chars + comma per element.
+    static constexpr size_t kMaxEncodedSize =
+        2 + 15 * (5 + 3 + 1) + 20 + 2 * 3 + 9 * 25 + (2 + 4 * 26) + 2 * (2 + 21 * 26);
+
+    size_t max_encoded_size(const void* data) override {
+        (void)data;
+        return kMaxEncodedSize;
     }
 
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadOdometry& m = *static_cast<const PayloadOdometry*>(data);
-        
+        if (variant_ == FAST) return fast_encode(kMaxEncodedSize, [&](FastWriter& w) { write_payload(w, m); });
         rapidjson::StringBuffer sb(0, 2048); // Larger buffer for floats
         rapidjson::Writer<rapidjson::StringBuffer> w(sb);
+        write_payload(w, m);
+        const char* s = sb.GetString();
+        return std::vector<uint8_t>(s, s + sb.GetSize());
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadOdometry& m = *static_cast<const PayloadOdometry*>(data);
+        if (variant_ == FAST) {
+            FastWriter w(dst, cap);
+            write_payload(w, m);
+            return w.result();
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        write_payload(w, m);
+        return out.result();
+    }
+
+    template <typename Writer>
+    void write_payload(Writer& w, const PayloadOdometry& m) {
         w.StartObject();
 
         w.Key("time"); w.Uint64(m.time_usec);
         w.Key("frame"); w.Uint(m.frame_id);
         w.Key("child"); w.Uint(m.child_frame_id);
         
-        w.Key("x"); w.Double(m.x);
-        w.Key("y"); w.Double(m.y);
-        w.Key("z"); w.Double(m.z);
+        w.Key("x"); write_json_float(w, m.x);
+        w.Key("y"); write_json_float(w, m.y);
+        w.Key("z"); write_json_float(w, m.z);
         
         w.Key("q");
         w.StartArray();
-        for(int i=0; i<4; i++) w.Double(m.q[i]);
+        for(int i=0; i<4; i++) write_json_float(w, m.q[i]);
         w.EndArray();
 
-        w.Key("vx"); w.Double(m.vx);
-        w.Key("vy"); w.Double(m.vy);
-        w.Key("vz"); w.Double(m.vz);
+        w.Key("vx"); write_json_float(w, m.vx);
+        w.Key("vy"); write_json_float(w, m.vy);
+        w.Key("vz"); write_json_float(w, m.vz);
         
-        w.Key("rs"); w.Double(m.rollspeed);
-        w.Key("ps"); w.Double(m.pitchspeed);
-        w.Key("ys"); w.Double(m.yawspeed);
+        w.Key("rs"); write_json_float(w, m.rollspeed);
+        w.Key("ps"); write_json_float(w, m.pitchspeed);
+        w.Key("ys"); write_json_float(w, m.yawspeed);
 
         w.Key("pcov");
         w.StartArray();
-        for(int i=0; i<21; i++) w.Double(m.pose_covariance[i]); // Use Double for float precision in JSON
+        for(int i=0; i<21; i++) write_json_float(w, m.pose_covariance[i]); // Standard widens to double, Fast prints the shortest float
         w.EndArray();
 
         w.Key("vcov");
         w.StartArray();
-        for(int i=0; i<21; i++) w.Double(m.velocity_covariance[i]);
+        for(int i=0; i<21; i++) write_json_float(w, m.velocity_covariance[i]);
         w.EndArray();
         
         w.EndObject();
-        const char* s = sb.GetString();
-        return std::vector<uint8_t>(s, s + sb.GetSize());
     }
 
+    enum Field { TIME, FRAME, CHILD, X, Y, Z, Q, VX, VY, VZ, RS, PS, YS, PCOV, VCOV };
+    static constexpr KeyEntry kKeys[] = {
+        {"time", TIME}, {"frame", FRAME}, {"child", CHILD}, {"x", X}, {"y", Y}, {"z", Z}, {"q", Q},
+        {"vx", VX}, {"vy", VY}, {"vz", VZ}, {"rs", RS}, {"ps", PS}, {"ys", YS},
+        {"pcov", PCOV}, {"vcov", VCOV},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
+    // Array elements (q, pcov, vcov) are written at `idx`, reset on every key.
+    // Unselected keys resolve to -1. A selected field is complete after its
+    // value, or at EndArray() for the arrays; the callback completing the last
+    // one returns false and ends Parse() before the rest of the text.
     struct PayloadHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PayloadHandler> {
         PayloadOdometry* m;
-        std::string key;
-        
-        enum ArrayState { NONE, Q, PCOV, VCOV };
-        ArrayState array_state = NONE;
+        FieldProjection want;
+        int field = -1;
         int idx = 0;
 
-        PayloadHandler(PayloadOdometry* p) : m(p) {}
+        PayloadHandler(PayloadOdometry* p, FieldMask fields = kAllFields) : m(p), want(fields, VCOV + 1) {}
 
         bool Key(const char* str, rapidjson::SizeType length, bool) {
-            key.assign(str, length);
-            if (key == "q") { array_state = Q; idx = 0; }
-            else if (key == "pcov") { array_state = PCOV; idx = 0; }
-            else if (key == "vcov") { array_state = VCOV; idx = 0; }
-            else { array_state = NONE; }
+            field = kFields.find(str, length);
+            if (!want.wants(field)) field = -1;
+            idx = 0;
             return true;
         }
 
+        bool stored() {
+            if (field < 0) return true;
+            want.found(field);
+            field = -1;
+            return !want.done();
+        }
+
+        bool EndArray(rapidjson::SizeType) { return stored(); }
+
         bool Uint64(uint64_t u) {
-             if (key == "time") m->time_usec = u;
-             return true;
+             if (field == TIME) m->time_usec = u;
+             return stored();
         }
 
         bool Uint(unsigned u) { return Int(u); }
         bool Int(int i) {
-             if (array_state == PCOV) {
-                 if (idx < 21) m->pose_covariance[idx++] = (float)i;
+             switch (field) {
+                 case PCOV: if (idx < 21) m->pose_covariance[idx++] = (float)i; return true;
+                 case VCOV: if (idx < 21) m->velocity_covariance[idx++] = (float)i; return true;
+                 case FRAME: m->frame_id = (uint8_t)i; break;
+                 case CHILD: m->child_frame_id = (uint8_t)i; break;
+                 case TIME: m->time_usec = (uint64_t)i; break;
              }
-             else if (array_state == VCOV) {
-                 if (idx < 21) m->velocity_covariance[idx++] = (float)i;
-             }
-             else if (key == "frame") m->frame_id = (uint8_t)i;
-             else if (key == "child") m->child_frame_id = (uint8_t)i;
-             else if (key == "time") m->time_usec = (uint64_t)i;
-             return true;
+             return stored();
         }
         
         bool Double(double d) {
             float f = (float)d;
-            if (array_state == Q) {
-                if (idx < 4) m->q[idx++] = f;
-            } else if (array_state == PCOV) {
-                if (idx < 21) m->pose_covariance[idx++] = f;
-            } else if (array_state == VCOV) {
-                if (idx < 21) m->velocity_covariance[idx++] = f;
-            } else {
-                if (key == "x") m->x = f;
-                else if (key == "y") m->y = f;
-                else if (key == "z") m->z = f;
-                else if (key == "vx") m->vx = f;
-                else if (key == "vy") m->vy = f;
-                else if (key == "vz") m->vz = f;
-                else if (key == "rs") m->rollspeed = f;
-                else if (key == "ps") m->pitchspeed = f;
-                else if (key == "ys") m->yawspeed = f;
+            switch (field) {
+                case Q: if (idx < 4) m->q[idx++] = f; return true;
+                case PCOV: if (idx < 21) m->pose_covariance[idx++] = f; return true;
+                case VCOV: if (idx < 21) m->velocity_covariance[idx++] = f; return true;
+                case X: m->x = f; break;
+                case Y: m->y = f; break;
+                case Z: m->z = f; break;
+                case VX: m->vx = f; break;
+                case VY: m->vy = f; break;
+                case VZ: m->vz = f; break;
+                case RS: m->rollspeed = f; break;
+                case PS: m->pitchspeed = f; break;
+                case YS: m->yawspeed = f; break;
             }
-            return true;
+            return stored();
         }
     };
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
+        JsonBenchmarkOdometry::decode_fields(data, len, out_data, kAllFields);
+    }
+
+    // rapidjson still converts every number it scans; what a projection saves
+    // is the text after the last selected field.
+    void decode_fields(const uint8_t* data, size_t len, void* out_data, FieldMask fields) override {
         PayloadOdometry& m = *static_cast<PayloadOdometry*>(out_data);
         rapidjson::Reader reader;
-        rapidjson::MemoryStream ss((const char*)buffer.data(), buffer.size());
-        PayloadHandler handler(&m);
+        rapidjson::MemoryStream ss((const char*)data, len);
+        PayloadHandler handler(&m, fields);
         reader.Parse(ss, handler);
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        if (variant_ == FAST) {
+            return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+                FastWriter w(frame, frame_cap);
+                write_payload(w, *static_cast<const PayloadOdometry*>(item));
+                return w.result();
+            });
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            w.Reset(out);
+            write_payload(w, *static_cast<const PayloadOdometry*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        rapidjson::Reader reader;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            rapidjson::MemoryStream ss((const char*)frame, frame_len);
+            PayloadHandler handler(static_cast<PayloadOdometry*>(out));
+            reader.Parse(ss, handler);
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "JSON-Odometry"; }
+    std::string name() const override { return variant_ == FAST ? "JSON-Fast-Odometry" : "JSON-Odometry"; }
 };
 
 } // namespace pf
@@ -1,7 +1,10 @@
 #include "IBenchmark.h"
+#include "KeyDispatch.h"
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
+#include "json_span_stream.h"
+#include "json_fast_writer.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -10,7 +13,10 @@ namespace pf {
 
 class JsonBenchmarkStatus : public IBenchmark {
 public:
+    bool fast_ = false; // FastWriter instead of RapidJSON's Writer (json_fast_writer.h)
+
     void setup(const BenchmarkConfig& config) override {
+        fast_ = config.variant_name == "Fast";
         std::cout << "[JSON-Status] Setup." << std::endl;
         PayloadStatus p;
         p.severity = 5;
@@ -25,34 +31,63 @@ public:
             std::cerr << "[JSON-Status] Sanity Check: FAILED" << std::endl;
             exit(1);
         }
-        (void)config;
+    }
+
+    // Worst case: 2 keys (3 chars, quoted + colon + comma), severity byte,
+    // and every text byte escaped as \u00XX.
+    static constexpr size_t kMaxEncodedSize = 2 + 2 * (3 + 3 + 1) + 3 + (2 + 6 * sizeof(PayloadStatus::text));
+
+    size_t max_encoded_size(const void* data) override {
+        (void)data;
+        return kMaxEncodedSize;
     }
 
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadStatus& m = *static_cast<const PayloadStatus*>(data);
+        if (fast_) return fast_encode(kMaxEncodedSize, [&](FastWriter& w) { write_payload(w, m); });
         rapidjson::StringBuffer sb;
         rapidjson::Writer<rapidjson::StringBuffer> w(sb);
+        write_payload(w, m);
+        const char* s = sb.GetString();
+        return std::vector<uint8_t>(s, s + sb.GetSize());
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadStatus& m = *static_cast<const PayloadStatus*>(data);
+        if (fast_) {
+            FastWriter w(dst, cap);
+            write_payload(w, m);
+            return w.result();
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        write_payload(w, m);
+        return out.result();
+    }
+
+    template <typename Writer>
+    void write_payload(Writer& w, const PayloadStatus& m) {
         w.StartObject();
         w.Key("sev"); w.Uint(m.severity);
         w.Key("txt"); w.String(m.text);
         w.EndObject();
-        const char* s = sb.GetString();
-        return std::vector<uint8_t>(s, s + sb.GetSize());
     }
 
+    enum Field { SEV, TXT };
+    static constexpr KeyEntry kKeys[] = {{"sev", SEV}, {"txt", TXT}};
+    static constexpr auto kFields = make_key_table(kKeys);
+
     struct PayloadHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, PayloadHandler> {
         PayloadStatus* m;
-        bool in_txt = false;
+        int field = -1;
 
         PayloadHandler(PayloadStatus* p) : m(p) {}
-        bool Key(const char* str, rapidjson::SizeType len, bool) {
-            if (len == 3 && strncmp(str, "txt", 3) == 0) in_txt = true;
-            else in_txt = false;
-            return true;
-        }
-        bool Uint(unsigned u) { if (!in_txt) m->severity = (uint8_t)u; return true; }
+        bool Key(const char* str, rapidjson::SizeType len, bool) { field = kFields.find(str, len); return true; }
+        bool Uint(unsigned u) { if (field == SEV) m->severity = (uint8_t)u; return true; }
         bool String(const char* str, rapidjson::SizeType len, bool) {
-            if (in_txt) {
+            if (field == TXT) {
                 size_t copy_len = len < 49 ? len : 49;
                 memcpy(m->text, str, copy_len);
                 m->text[copy_len] = '\0';
@@ -61,16 +96,47 @@ public:
         }
     };
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadStatus& m = *static_cast<PayloadStatus*>(out_data);
         rapidjson::Reader reader;
-        rapidjson::MemoryStream ss((const char*)buffer.data(), buffer.size());
+        rapidjson::MemoryStream ss((const char*)data, len);
         PayloadHandler handler(&m);
         reader.Parse(ss, handler);
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        if (fast_) {
+            return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+                FastWriter w(frame, frame_cap);
+                write_payload(w, *static_cast<const PayloadStatus*>(item));
+                return w.result();
+            });
+        }
+        SpanStream out(dst, cap);
+        char arena[kSpanWriterArenaBytes];
+        rapidjson::MemoryPoolAllocator<> stack_alloc(arena, sizeof(arena));
+        SpanWriter w(out, &stack_alloc);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            w.Reset(out);
+            write_payload(w, *static_cast<const PayloadStatus*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        rapidjson::Reader reader;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            rapidjson::MemoryStream ss((const char*)frame, frame_len);
+            PayloadHandler handler(static_cast<PayloadStatus*>(out));
+            reader.Parse(ss, handler);
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "JSON-Status"; }
+    std::string name() const override { return fast_ ? "JSON-Fast-Status" : "JSON-Status"; }
 };
 
 } // namespace pf
@@ -1,7 +1,9 @@
 #include "IBenchmark.h"
+#include "plugin_check.hpp"
 #include <iostream>
 #include <cstring>
 #include <cassert>
+#include <string>
 
 // External factory function
 extern "C" pf::IBenchmark* create_benchmark();
@@ -13,43 +15,65 @@ void log(const std::string& msg) {
 int main() {
     log("Starting JSON Integrity Test...");
 
-    // 1. Instantiate Benchmark
-    std::unique_ptr<pf::IBenchmark> bench(create_benchmark());
-    
-    // 2. Setup (Standard Variant)
-    pf::BenchmarkConfig config;
-    config.iterations = 1;
-    config.variant_name = "Standard";
-    config.warm_up = false;
-    bench->setup(config);
-    
-    // 3. Create Payload
-    pf::Payload original;
-    original.timestamp = 1234567890;
-    original.block_number = 42;
-    memset(original.hash, 0xAA, 32); // Fill hash with 0xAA
-    original.lat = 400000000;
-    original.lon = -730000000;
-    
-    // 4. Encode
-    log("Encoding...");
-    std::vector<uint8_t> buffer = bench->encode(original);
-    log("Encoded Size: " + std::to_string(buffer.size()) + " bytes");
-    
-    // 5. Decode
-    log("Decoding...");
-    pf::Payload decoded;
-    bench->decode(buffer, decoded);
-    
-    // 6. Verify
-    assert(original.timestamp == decoded.timestamp);
-    assert(original.block_number == decoded.block_number);
-    // Note: In actual implementation, we'd verify all fields. 
-    // Since our skeleton only implemented a subset in Standard variant:
-    // assert(memcmp(original.hash, decoded.hash, 32) == 0); 
-    
+    // 1. Every variant round-trips the hash through its text form
+    //    (hex for Standard/Canonical/Short/Fast, base64 for Base64).
+    for (const char* variant : {"Standard", "Canonical", "Short", "Base64", "Fast"}) {
+        std::unique_ptr<pf::IBenchmark> bench(create_benchmark());
+        pf::BenchmarkConfig config;
+        config.iterations = 1;
+        config.variant_name = variant;
+        config.warm_up = false;
+        bench->setup(config);
+
+        pf::Payload original;
+        memset(&original, 0, sizeof(original));
+        original.timestamp = 1234567890;
+        original.block_number = 42;
+        for (int i = 0; i < 32; i++) original.hash[i] = (uint8_t)(0xF0 - 7 * i);
+        original.lat = 400000000;
+        original.lon = -730000000;
+
+        std::vector<uint8_t> buffer = bench->encode(&original);
+        log(std::string(variant) + " Encoded Size: " + std::to_string(buffer.size()) + " bytes");
+
+        pf::Payload decoded;
+        memset(&decoded, 0, sizeof(decoded));
+        bench->decode(buffer, &decoded);
+        assert(original.timestamp == decoded.timestamp);
+        assert(original.block_number == decoded.block_number);
+        assert(original.lat == decoded.lat && original.lon == decoded.lon);
+        assert(memcmp(original.hash, decoded.hash, 32) == 0);
+        bench->teardown();
+    }
+
+    // 2. No codec drops a field
+    for (const std::vector<std::string>& lost : {
+             pf::schema_coverage_failures<pf::PayloadGPSRaw>("json", {"Standard", "Canonical", "Short", "Base64", "Fast"}),
+             pf::schema_coverage_failures<pf::PayloadBattery>("json", {"Standard", "Fast"}),
+             pf::schema_coverage_failures<pf::PayloadOdometry>("json", {"Standard", "Fast"}),
+             pf::schema_coverage_failures<pf::PayloadAttitude>("json", {"Standard", "Fast"}),
+             pf::schema_coverage_failures<pf::PayloadGlobalPosition>("json", {"Standard", "Fast"}),
+             pf::schema_coverage_failures<pf::PayloadStatus>("json", {"Standard", "Fast"}),
+             pf::schema_coverage_failures<pf::PayloadGPSBlock>("json", {"Standard", "Fast", "Columnar"})}) {
+        for (const std::string& f : lost) std::cerr << "[TEST] " << f << std::endl;
+        if (!lost.empty()) exit(1);
+    }
+    log("Schema coverage: every variant round-trips every field");
+
+    // 3. Columnar GPSBlock at its edges
+    {
+        CreateBenchmarkFunc create = pf::load_plugin<pf::PayloadGPSBlock>(PF_PLUGIN_DIR, "json");
+        assert(create);
+        std::unique_ptr<pf::IBenchmark> columnar = pf::create_configured(create, "Columnar", 1);
+        const std::string diff = pf::columnar_round_trip_difference(*columnar);
+        if (!diff.empty()) {
+            std::cerr << "[TEST] " << columnar->name() << ": " << diff << std::endl;
+            exit(1);
+        }
+        log(columnar->name() + ": edge blocks round-trip, truncated frames fail");
+        columnar->teardown();
+    }
+
     log("Integrity Check Passed!");
-    
-    bench->teardown();
     return 0;
 }
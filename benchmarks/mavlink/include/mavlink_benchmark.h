@@ -0,0 +1,88 @@
+#ifndef PRIME_FUSION_MAVLINK_BENCHMARK_H
+#define PRIME_FUSION_MAVLINK_BENCHMARK_H
+
+#include "IBenchmark.h"
+#include "mavlink_wire.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief One MAVLink v2 packet per payload; the plugin for every fixed-size scenario.
+ * Each encode takes the next sequence number, as a MAVLink component does for
+ * every packet it sends. There is one variant, "Standard": the wire format
+ * has nothing to tune.
+ */
+template <typename T>
+class MavlinkBenchmark : public IBenchmark {
+public:
+    explicit MavlinkBenchmark(const char* name) : name_(name) {}
+
+    void setup(const BenchmarkConfig& /*config*/) override {
+        seq_ = 0;
+        // Every field gets a distinct non-zero byte pattern, so a field packed
+        // at the wrong offset or lost to truncation shows up in the memcmp.
+        T p, d;
+        memset(&p, 0, sizeof(p));
+        memset(&d, 0, sizeof(d));
+        for (size_t i = 0; i < schema_size<T>(); i++) {
+            const FieldDesc& f = PayloadSchema<T>::fields[i];
+            memset(reinterpret_cast<char*>(&p) + f.offset, (int)(i + 1), field_type_size(f.type) * f.count);
+        }
+        auto buf = encode(&p);
+        decode(buf, &d);
+        if (memcmp(&p, &d, sizeof(T)) == 0) {
+            std::cout << "[" << name_ << "] Sanity Check: PASS" << std::endl;
+        } else {
+            std::cerr << "[" << name_ << "] Sanity Check: FAILED" << std::endl;
+            exit(1);
+        }
+        seq_ = 0;
+    }
+
+    size_t max_encoded_size(const void* /*data*/) override { return MavlinkWire<T>::kMaxPacketSize; }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        std::vector<uint8_t> out(MavlinkWire<T>::kMaxPacketSize);
+        out.resize(MavlinkBenchmark::encode_into(data, out.data(), out.size()));
+        return out;
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        size_t n = MavlinkWire<T>::encode(*static_cast<const T*>(data), seq_, dst, cap);
+        if (n) seq_++;
+        return n;
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
+        MavlinkWire<T>::decode(data, len, *static_cast<T*>(out_data));
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* out, size_t out_cap) {
+            return MavlinkBenchmark::encode_into(item, out, out_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        return decode_frames(data, len, outs, count, [](const uint8_t* frame, size_t frame_len, void* out) {
+            MavlinkWire<T>::decode(frame, frame_len, *static_cast<T*>(out));
+        });
+    }
+
+    void teardown() override {}
+    std::string name() const override { return name_; }
+
+private:
+    const char* name_;
+    uint8_t seq_ = 0;
+};
+
+} // namespace pf
+
+#endif // PRIME_FUSION_MAVLINK_BENCHMARK_H
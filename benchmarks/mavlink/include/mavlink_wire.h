@@ -0,0 +1,277 @@
+#ifndef PRIME_FUSION_MAVLINK_WIRE_H
+#define PRIME_FUSION_MAVLINK_WIRE_H
+
+#include "SchemaCodec.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace pf {
+
+/**
+ * @brief MAVLink v2 framing for the mavlink_types.h payloads, as mavgen emits it.
+ *
+ *   STX(0xFD) len incompat compat seq sysid compid msgid[3] payload[len] crc[2]
+ *
+ * The payload is the message's fields packed little-endian with no padding.
+ * Base fields are stably sorted by element size, largest first (so every field
+ * is naturally aligned within the payload); extension fields follow in
+ * declaration order. Trailing zero bytes are cut from the payload before
+ * sending (at least one byte stays) and a receiver zero-fills them back.
+ * The checksum is CRC-16/MCRF4XX over len..payload, then the message's
+ * CRC_EXTRA byte, which hashes the base field names and types so both ends
+ * must agree on the definition.
+ *
+ * Wire layout and CRC_EXTRA are derived from PayloadSchema<T> at compile time.
+ * Structs that match the common.xml definition (GLOBAL_POSITION_INT, ATTITUDE,
+ * ODOMETRY, BATTERY_STATUS, STATUSTEXT) therefore get the official CRC_EXTRA;
+ * PayloadGPSRaw carries the benchmark's block_number/hash metadata and a u32
+ * fix_type, so its GPS_RAW_INT is a private variant with its own CRC_EXTRA.
+ */
+
+constexpr uint8_t kMavlinkStx = 0xFD;
+constexpr size_t kMavlinkHeaderSize = 10;  // STX up to and including msgid
+constexpr size_t kMavlinkChecksumSize = 2;
+constexpr size_t kMavlinkSignatureSize = 13;
+constexpr uint8_t kMavlinkIflagSigned = 0x01;
+constexpr uint8_t kMavlinkSystemId = 1;
+constexpr uint8_t kMavlinkComponentId = 1;  // MAV_COMP_ID_AUTOPILOT1
+
+/**
+ * @brief Message id, name and first extension field of each payload type.
+ * `first_extension` is a PayloadSchema<T> index; schema_size<T>() means none.
+ */
+template <typename T> struct MavlinkMessage;
+template <> struct MavlinkMessage<PayloadGPSRaw> {
+    static constexpr uint32_t msgid = 24;
+    static constexpr const char* name = "GPS_RAW_INT";
+    static constexpr size_t first_extension = 13; // alt_ellipsoid
+};
+template <> struct MavlinkMessage<PayloadGlobalPosition> {
+    static constexpr uint32_t msgid = 33;
+    static constexpr const char* name = "GLOBAL_POSITION_INT";
+    static constexpr size_t first_extension = schema_size<PayloadGlobalPosition>();
+};
+template <> struct MavlinkMessage<PayloadOdometry> {
+    static constexpr uint32_t msgid = 331;
+    static constexpr const char* name = "ODOMETRY";
+    static constexpr size_t first_extension = schema_size<PayloadOdometry>();
+};
+template <> struct MavlinkMessage<PayloadAttitude> {
+    static constexpr uint32_t msgid = 30;
+    static constexpr const char* name = "ATTITUDE";
+    static constexpr size_t first_extension = schema_size<PayloadAttitude>();
+};
+template <> struct MavlinkMessage<PayloadBattery> {
+    static constexpr uint32_t msgid = 147;
+    static constexpr const char* name = "BATTERY_STATUS";
+    static constexpr size_t first_extension = schema_size<PayloadBattery>();
+};
+template <> struct MavlinkMessage<PayloadStatus> {
+    static constexpr uint32_t msgid = 253;
+    static constexpr const char* name = "STATUSTEXT";
+    static constexpr size_t first_extension = schema_size<PayloadStatus>();
+};
+
+// CRC-16/MCRF4XX (the "X.25" checksum of the MAVLink reference library)
+constexpr uint16_t mavlink_crc_accumulate(uint8_t b, uint16_t crc) {
+    uint8_t tmp = b ^ (uint8_t)(crc & 0xFF);
+    tmp ^= (uint8_t)(tmp << 4);
+    return (uint16_t)((crc >> 8) ^ ((uint16_t)tmp << 8) ^ ((uint16_t)tmp << 3) ^ (tmp >> 4));
+}
+
+constexpr uint16_t mavlink_crc_accumulate(const char* s, uint16_t crc) {
+    for (; *s; s++) crc = mavlink_crc_accumulate((uint8_t)*s, crc);
+    return crc;
+}
+
+inline uint16_t mavlink_crc_accumulate(const uint8_t* p, size_t len, uint16_t crc) {
+    for (size_t i = 0; i < len; i++) crc = mavlink_crc_accumulate(p[i], crc);
+    return crc;
+}
+
+// Type spelling hashed into CRC_EXTRA, as in the message XML
+constexpr const char* mavlink_type_name(FieldType t) {
+    switch (t) {
+        case FieldType::U8: case FieldType::BYTES: return "uint8_t";
+        case FieldType::U16: return "uint16_t";
+        case FieldType::U32: return "uint32_t";
+        case FieldType::U64: return "uint64_t";
+        case FieldType::I8: return "int8_t";
+        case FieldType::I16: return "int16_t";
+        case FieldType::I32: return "int32_t";
+        case FieldType::I64: return "int64_t";
+        case FieldType::F32: return "float";
+        case FieldType::CHARS: return "char";
+    }
+    return "";
+}
+
+template <typename T>
+struct MavlinkLayout {
+    static constexpr size_t N = schema_size<T>();
+    std::array<size_t, N> field{};  // Schema index of the i-th field on the wire
+    std::array<size_t, N> offset{}; // Payload offset of the i-th field on the wire
+    size_t payload_size = 0;
+};
+
+template <typename T>
+constexpr MavlinkLayout<T> make_mavlink_layout() {
+    constexpr size_t N = schema_size<T>();
+    constexpr size_t base = MavlinkMessage<T>::first_extension;
+    static_assert(base <= N, "first_extension past the end of the schema");
+    const FieldDesc* f = PayloadSchema<T>::fields;
+
+    MavlinkLayout<T> l;
+    for (size_t i = 0; i < N; i++) l.field[i] = i;
+    // Insertion sort keeps equal sizes in declaration order, like mavgen's stable sort.
+    for (size_t i = 1; i < base; i++) {
+        for (size_t j = i; j > 0 && field_type_size(f[l.field[j - 1]].type) < field_type_size(f[l.field[j]].type); j--) {
+            size_t tmp = l.field[j];
+            l.field[j] = l.field[j - 1];
+            l.field[j - 1] = tmp;
+        }
+    }
+    for (size_t i = 0; i < N; i++) {
+        l.offset[i] = l.payload_size;
+        l.payload_size += field_type_size(f[l.field[i]].type) * f[l.field[i]].count;
+    }
+    return l;
+}
+
+template <typename T>
+constexpr uint8_t make_mavlink_crc_extra() {
+    constexpr auto layout = make_mavlink_layout<T>();
+    uint16_t crc = 0xFFFF;
+    crc = mavlink_crc_accumulate(MavlinkMessage<T>::name, crc);
+    crc = mavlink_crc_accumulate((uint8_t)' ', crc);
+    for (size_t i = 0; i < MavlinkMessage<T>::first_extension; i++) {
+        const FieldDesc& d = PayloadSchema<T>::fields[layout.field[i]];
+        crc = mavlink_crc_accumulate(mavlink_type_name(d.type), crc);
+        crc = mavlink_crc_accumulate((uint8_t)' ', crc);
+        crc = mavlink_crc_accumulate(d.name, crc);
+        crc = mavlink_crc_accumulate((uint8_t)' ', crc);
+        if (d.count > 1) crc = mavlink_crc_accumulate((uint8_t)d.count, crc);
+    }
+    return (uint8_t)((crc & 0xFF) ^ (crc >> 8));
+}
+
+/**
+ * @brief Packs and parses MAVLink v2 packets carrying T.
+ */
+template <typename T>
+struct MavlinkWire {
+    static constexpr auto layout = make_mavlink_layout<T>();
+    static constexpr size_t kPayloadSize = layout.payload_size;
+    static constexpr uint8_t kCrcExtra = make_mavlink_crc_extra<T>();
+    static constexpr size_t kMaxPacketSize = kMavlinkHeaderSize + kPayloadSize + kMavlinkChecksumSize;
+    static_assert(kPayloadSize <= 255, "MAVLink payloads are at most 255 bytes");
+
+    /**
+     * @brief Writes one packet with sequence number `seq`.
+     * @return Bytes written, or 0 if the packet does not fit in cap
+     */
+    static size_t encode(const T& m, uint8_t seq, uint8_t* dst, size_t cap) {
+        uint8_t scratch[kPayloadSize];
+        const bool direct = cap >= kMaxPacketSize;
+        uint8_t* payload = direct ? dst + kMavlinkHeaderSize : scratch;
+        pack_payload(m, payload);
+
+        size_t len = kPayloadSize;
+        while (len > 1 && payload[len - 1] == 0) len--;
+        const size_t total = kMavlinkHeaderSize + len + kMavlinkChecksumSize;
+        if (total > cap) return 0;
+        if (!direct) memcpy(dst + kMavlinkHeaderSize, scratch, len);
+
+        dst[0] = kMavlinkStx;
+        dst[1] = (uint8_t)len;
+        dst[2] = 0; // incompat_flags: unsigned
+        dst[3] = 0; // compat_flags
+        dst[4] = seq;
+        dst[5] = kMavlinkSystemId;
+        dst[6] = kMavlinkComponentId;
+        dst[7] = (uint8_t)MavlinkMessage<T>::msgid;
+        dst[8] = (uint8_t)(MavlinkMessage<T>::msgid >> 8);
+        dst[9] = (uint8_t)(MavlinkMessage<T>::msgid >> 16);
+
+        uint16_t crc = mavlink_crc_accumulate(dst + 1, kMavlinkHeaderSize - 1 + len, 0xFFFF);
+        crc = mavlink_crc_accumulate(kCrcExtra, crc);
+        dst[kMavlinkHeaderSize + len] = (uint8_t)crc;
+        dst[kMavlinkHeaderSize + len + 1] = (uint8_t)(crc >> 8);
+        return total;
+    }
+
+    /**
+     * @brief Parses the packet at the start of data into m.
+     * A signed packet's signature is skipped, not verified. Payload bytes past
+     * kPayloadSize (extensions this side does not know) are ignored.
+     * @return Bytes consumed, or 0 (m untouched) on a short packet, wrong
+     *         msgid, unknown incompat flag or checksum mismatch
+     */
+    static size_t decode(const uint8_t* data, size_t len, T& m, uint8_t* seq = nullptr) {
+        if (len < kMavlinkHeaderSize + kMavlinkChecksumSize || data[0] != kMavlinkStx) return 0;
+        const size_t plen = data[1];
+        const uint8_t incompat = data[2];
+        if (incompat & ~kMavlinkIflagSigned) return 0;
+        size_t total = kMavlinkHeaderSize + plen + kMavlinkChecksumSize;
+        if (incompat & kMavlinkIflagSigned) total += kMavlinkSignatureSize;
+        if (len < total) return 0;
+        const uint32_t msgid = (uint32_t)data[7] | ((uint32_t)data[8] << 8) | ((uint32_t)data[9] << 16);
+        if (msgid != MavlinkMessage<T>::msgid) return 0;
+
+        uint16_t crc = mavlink_crc_accumulate(data + 1, kMavlinkHeaderSize - 1 + plen, 0xFFFF);
+        crc = mavlink_crc_accumulate(kCrcExtra, crc);
+        const uint8_t* ck = data + kMavlinkHeaderSize + plen;
+        if (ck[0] != (uint8_t)crc || ck[1] != (uint8_t)(crc >> 8)) return 0;
+
+        uint8_t payload[kPayloadSize];
+        const size_t n = plen < kPayloadSize ? plen : kPayloadSize;
+        memcpy(payload, data + kMavlinkHeaderSize, n);
+        memset(payload + n, 0, kPayloadSize - n);
+        unpack_payload(payload, m);
+        if (seq) *seq = data[4];
+        return total;
+    }
+
+    // Writes all kPayloadSize bytes of the untruncated payload.
+    static void pack_payload(const T& m, uint8_t* out) {
+        pack_fields(m, out, std::make_index_sequence<MavlinkLayout<T>::N>{});
+    }
+
+    static void unpack_payload(const uint8_t* in, T& m) {
+        unpack_fields(in, m, std::make_index_sequence<MavlinkLayout<T>::N>{});
+    }
+
+private:
+    template <size_t... W>
+    static void pack_fields(const T& m, uint8_t* out, std::index_sequence<W...>) {
+        (copy_field<PayloadSchema<T>::fields[layout.field[W]].type, PayloadSchema<T>::fields[layout.field[W]].count>(
+             out + layout.offset[W], reinterpret_cast<const uint8_t*>(&m) + PayloadSchema<T>::fields[layout.field[W]].offset),
+         ...);
+    }
+
+    template <size_t... W>
+    static void unpack_fields(const uint8_t* in, T& m, std::index_sequence<W...>) {
+        (copy_field<PayloadSchema<T>::fields[layout.field[W]].type, PayloadSchema<T>::fields[layout.field[W]].count>(
+             reinterpret_cast<uint8_t*>(&m) + PayloadSchema<T>::fields[layout.field[W]].offset, in + layout.offset[W]),
+         ...);
+    }
+
+    // Copies Count elements between host order and little-endian wire order.
+    template <FieldType Type, size_t Count>
+    static void copy_field(uint8_t* dst, const uint8_t* src) {
+        constexpr size_t size = field_type_size(Type);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        memcpy(dst, src, size * Count);
+#else
+        for (size_t i = 0; i < Count; i++) {
+            for (size_t b = 0; b < size; b++) dst[i * size + b] = src[i * size + size - 1 - b];
+        }
+#endif
+    }
+};
+
+} // namespace pf
+
+#endif // PRIME_FUSION_MAVLINK_WIRE_H
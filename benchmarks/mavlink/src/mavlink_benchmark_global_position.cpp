@@ -0,0 +1,3 @@
+#include "mavlink_benchmark.h"
+
+extern "C" pf::IBenchmark* create_benchmark() { return new pf::MavlinkBenchmark<pf::PayloadGlobalPosition>("MAVLink-GlobalPos"); }
@@ -0,0 +1,99 @@
+#include "IBenchmark.h"
+#include "mavlink_wire.h"
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+namespace pf {
+
+/**
+ * @brief A block is its GPS_RAW_INT packets back to back, each with its own
+ * sequence number, as they would arrive on the link. There is no count
+ * prefix: the decoder walks packets until the buffer ends.
+ */
+class MavlinkBenchmarkGPSBlock : public IBenchmark {
+public:
+    using Wire = MavlinkWire<PayloadGPSRaw>;
+    uint8_t seq_ = 0;
+
+    void setup(const BenchmarkConfig& /*config*/) override {
+        PayloadGPSBlock p;
+        for(int i=0; i<50; i++) {
+            PayloadGPSRaw raw;
+            memset(&raw, 0, sizeof(raw));
+            raw.timestamp = 1000 + i;
+            raw.lat = -473977418 + i;
+            raw.eph = 120;
+            raw.hash[31] = (uint8_t)i;
+            p.messages.push_back(raw);
+        }
+        auto buf = encode(&p);
+        PayloadGPSBlock d;
+        decode(buf, &d);
+        if (d.messages.size() == 50 && d.messages[0].timestamp == 1000 && d.messages[49].lat == -473977369 &&
+            d.messages[49].eph == 120 && d.messages[49].hash[31] == 49 && d.messages[0].hash[31] == 0) {
+             std::cout << "[MAVLink-GPSBlock] Sanity Check: PASS" << std::endl;
+        } else {
+             std::cerr << "[MAVLink-GPSBlock] Sanity Check: FAILED" << std::endl;
+             exit(1);
+        }
+        seq_ = 0;
+    }
+
+    size_t max_encoded_size(const void* data) override {
+        return static_cast<const PayloadGPSBlock*>(data)->messages.size() * Wire::kMaxPacketSize;
+    }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        std::vector<uint8_t> out(max_encoded_size(data));
+        out.resize(MavlinkBenchmarkGPSBlock::encode_into(data, out.data(), out.size()));
+        return out;
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        size_t offset = 0;
+        for (const PayloadGPSRaw& raw : m.messages) {
+            size_t n = Wire::encode(raw, seq_, dst + offset, cap - offset);
+            if (n == 0) return 0;
+            seq_++;
+            offset += n;
+        }
+        return offset;
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
+        std::vector<PayloadGPSRaw>& messages = static_cast<PayloadGPSBlock*>(out_data)->messages;
+        size_t count = 0;
+        size_t offset = 0;
+        while (offset < len) {
+            if (count == messages.size()) messages.emplace_back();
+            size_t n = Wire::decode(data + offset, len - offset, messages[count]);
+            if (n == 0) break;
+            offset += n;
+            count++;
+        }
+        messages.resize(count);
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* out, size_t out_cap) {
+            return MavlinkBenchmarkGPSBlock::encode_into(item, out, out_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+            MavlinkBenchmarkGPSBlock::decode(frame, frame_len, out);
+        });
+    }
+
+    void teardown() override {}
+    std::string name() const override { return "MAVLink-GPSBlock"; }
+};
+
+} // namespace pf
+
+extern "C" pf::IBenchmark* create_benchmark() { return new pf::MavlinkBenchmarkGPSBlock(); }
@@ -0,0 +1,153 @@
+#include "IBenchmark.h"
+#include "mavlink_wire.h"
+#include <iostream>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// External factory function (pf_mavlink, the GPSRaw scenario)
+extern "C" pf::IBenchmark* create_benchmark();
+
+using namespace pf;
+
+// The official common.xml values; a wrong field order or type spelling changes them.
+static_assert(MavlinkWire<PayloadGlobalPosition>::kCrcExtra == 104, "GLOBAL_POSITION_INT CRC_EXTRA");
+static_assert(MavlinkWire<PayloadAttitude>::kCrcExtra == 39, "ATTITUDE CRC_EXTRA");
+static_assert(MavlinkWire<PayloadOdometry>::kCrcExtra == 91, "ODOMETRY CRC_EXTRA");
+static_assert(MavlinkWire<PayloadBattery>::kCrcExtra == 154, "BATTERY_STATUS CRC_EXTRA");
+static_assert(MavlinkWire<PayloadStatus>::kCrcExtra == 83, "STATUSTEXT CRC_EXTRA");
+
+static_assert(MavlinkWire<PayloadGlobalPosition>::kPayloadSize == 28, "GLOBAL_POSITION_INT length");
+static_assert(MavlinkWire<PayloadAttitude>::kPayloadSize == 28, "ATTITUDE length");
+static_assert(MavlinkWire<PayloadOdometry>::kPayloadSize == 230, "ODOMETRY base length");
+static_assert(MavlinkWire<PayloadBattery>::kPayloadSize == 36, "BATTERY_STATUS base length");
+static_assert(MavlinkWire<PayloadStatus>::kPayloadSize == 51, "STATUSTEXT base length");
+
+static int failures = 0;
+
+void log(const std::string& msg) {
+    std::cout << "[MAVLINK-TEST] " << msg << std::endl;
+}
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "[MAVLINK-TEST] FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+int main() {
+    log("Starting MAVLink Integrity Test...");
+
+    // 1. CRC-16/MCRF4XX check value
+    {
+        const char* digits = "123456789";
+        uint16_t crc = mavlink_crc_accumulate((const uint8_t*)digits, 9, 0xFFFF);
+        check(crc == 0x6F91, "CRC-16/MCRF4XX of \"123456789\"");
+    }
+
+    // 2. GLOBAL_POSITION_INT: wire order, header, little-endian fields
+    {
+        PayloadGlobalPosition p;
+        memset(&p, 0, sizeof(p));
+        p.time_boot_ms = 0x11223344;
+        p.lat = -473977418;
+        p.hdg = 0xABCD;
+        uint8_t buf[MavlinkWire<PayloadGlobalPosition>::kMaxPacketSize];
+        size_t n = MavlinkWire<PayloadGlobalPosition>::encode(p, 7, buf, sizeof(buf));
+        check(n == sizeof(buf), "GLOBAL_POSITION_INT is not truncated when hdg (last on the wire) is set");
+        check(buf[0] == 0xFD && buf[1] == 28 && buf[4] == 7 && buf[7] == 33 && buf[8] == 0 && buf[9] == 0,
+              "GLOBAL_POSITION_INT header");
+        check(buf[10] == 0x44 && buf[13] == 0x11, "time_boot_ms is first and little-endian");
+        check(buf[10 + 26] == 0xCD && buf[10 + 27] == 0xAB, "hdg is last and little-endian");
+
+        PayloadGlobalPosition d;
+        memset(&d, 0xFF, sizeof(d));
+        uint8_t seq = 0;
+        check(MavlinkWire<PayloadGlobalPosition>::decode(buf, n, d, &seq) == n, "GLOBAL_POSITION_INT decodes");
+        check(d.time_boot_ms == p.time_boot_ms && d.lat == p.lat && d.vx == 0 && d.hdg == p.hdg && seq == 7,
+              "GLOBAL_POSITION_INT round trip");
+    }
+
+    // 3. Trailing-zero truncation: a zeroed STATUSTEXT keeps one payload byte
+    {
+        PayloadStatus p;
+        memset(&p, 0, sizeof(p));
+        uint8_t buf[MavlinkWire<PayloadStatus>::kMaxPacketSize];
+        size_t n = MavlinkWire<PayloadStatus>::encode(p, 0, buf, sizeof(buf));
+        check(n == kMavlinkHeaderSize + 1 + kMavlinkChecksumSize && buf[1] == 1, "empty STATUSTEXT truncates to 1 byte");
+
+        p.severity = 6;
+        strcpy(p.text, "PreArm: GPS 3D fix");
+        n = MavlinkWire<PayloadStatus>::encode(p, 1, buf, sizeof(buf));
+        check(buf[1] == 1 + strlen(p.text), "STATUSTEXT truncates after the text");
+
+        PayloadStatus d;
+        memset(&d, 0x55, sizeof(d));
+        check(MavlinkWire<PayloadStatus>::decode(buf, n, d) == n, "STATUSTEXT decodes");
+        check(d.severity == 6 && strcmp(d.text, p.text) == 0 && d.text[49] == 0, "truncated bytes are zero-filled");
+
+        // A packet that only fits once truncated still encodes into a short buffer
+        check(MavlinkWire<PayloadStatus>::encode(p, 2, buf, n) == n, "truncated packet fits an exact buffer");
+        check(MavlinkWire<PayloadStatus>::encode(p, 2, buf, n - 1) == 0, "short buffer is refused");
+    }
+
+    // 4. Corrupt packets leave the output untouched
+    {
+        PayloadAttitude p;
+        memset(&p, 0, sizeof(p));
+        p.time_boot_ms = 42;
+        p.roll = 0.5f;
+        uint8_t buf[MavlinkWire<PayloadAttitude>::kMaxPacketSize];
+        size_t n = MavlinkWire<PayloadAttitude>::encode(p, 0, buf, sizeof(buf));
+
+        PayloadAttitude d;
+        memset(&d, 0, sizeof(d));
+        buf[kMavlinkHeaderSize] ^= 1;
+        check(MavlinkWire<PayloadAttitude>::decode(buf, n, d) == 0 && d.time_boot_ms == 0, "bad CRC is rejected");
+        buf[kMavlinkHeaderSize] ^= 1;
+        check(MavlinkWire<PayloadAttitude>::decode(buf, n - 1, d) == 0, "short packet is rejected");
+        PayloadGlobalPosition other;
+        check(MavlinkWire<PayloadGlobalPosition>::decode(buf, n, other) == 0, "other msgid is rejected");
+        check(MavlinkWire<PayloadAttitude>::decode(buf, n, d) == n && d.roll == 0.5f, "intact packet decodes");
+    }
+
+    // 5. The GPSRaw plugin: sequence numbers and a full round trip
+    {
+        std::unique_ptr<IBenchmark> bench(create_benchmark());
+        BenchmarkConfig config;
+        config.iterations = 1;
+        config.variant_name = "Standard";
+        bench->setup(config);
+
+        Payload p;
+        memset(&p, 0, sizeof(p));
+        p.timestamp = 1122334455;
+        p.block_number = 999;
+        memset(p.hash, 0xCC, 32);
+        p.fix_type = 3;
+        p.lat = -473977418;
+        p.satellites_visible = 12;
+
+        std::vector<uint8_t> first = bench->encode(&p);
+        std::vector<uint8_t> second = bench->encode(&p);
+        log("GPS_RAW_INT Encoded Size: " + std::to_string(first.size()) + " bytes");
+        check(first[4] == 0 && second[4] == 1, "sequence numbers count up from setup()");
+        check(first[1] == MavlinkWire<Payload>::kPayloadSize - 20, "zero extension fields are truncated");
+
+        Payload d;
+        memset(&d, 0xFF, sizeof(d));
+        bench->decode(second, &d);
+        check(d.timestamp == p.timestamp && d.block_number == p.block_number && d.hash[31] == 0xCC &&
+              d.fix_type == 3 && d.lat == p.lat && d.satellites_visible == 12 && d.alt_ellipsoid == 0 && d.hdg_acc == 0,
+              "GPS_RAW_INT round trip");
+        bench->teardown();
+    }
+
+    if (failures) {
+        std::cerr << "[MAVLINK-TEST] " << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    log("Integrity Check Passed!");
+    return 0;
+}
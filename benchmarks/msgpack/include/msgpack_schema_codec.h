@@ -0,0 +1,285 @@
+#ifndef PRIME_FUSION_MSGPACK_SCHEMA_CODEC_H
+#define PRIME_FUSION_MSGPACK_SCHEMA_CODEC_H
+
+#include "SchemaCodec.h"
+#include "ColumnarBlock.h"
+#include "msgpack_stream_visitor.h"
+#include <msgpack.hpp>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief Packs T as a map keyed by name, short name or integer key.
+ * BYTES fields are packed as bin, CHARS as str, numeric arrays as arrays.
+ */
+template <KeyStyle Style, typename T, typename Stream>
+void pack_schema(msgpack::packer<Stream>& pk, const T& m) {
+    pk.pack_map((uint32_t)schema_size<T>());
+    for_each_field<T>([&](auto i) {
+        constexpr const FieldDesc& d = PayloadSchema<T>::fields[decltype(i)::value];
+        if constexpr (Style == KeyStyle::Int) {
+            pk.pack(d.key);
+        } else {
+            constexpr const char* key = schema_key(d, Style);
+            pk.pack_str((uint32_t)key_length(key));
+            pk.pack_str_body(key, (uint32_t)key_length(key));
+        }
+
+        const auto* p = field_ptr<d.type>(m, d);
+        if constexpr (d.type == FieldType::BYTES) {
+            pk.pack_bin((uint32_t)d.count);
+            pk.pack_bin_body((const char*)p, (uint32_t)d.count);
+        } else if constexpr (d.type == FieldType::CHARS) {
+            uint32_t len = (uint32_t)strnlen(p, d.count);
+            pk.pack_str(len);
+            pk.pack_str_body(p, len);
+        } else if constexpr (d.count == 1) {
+            pk.pack(*p);
+        } else {
+            pk.pack_array((uint32_t)d.count);
+            for (size_t k = 0; k < d.count; k++) pk.pack(p[k]);
+        }
+    });
+}
+
+template <KeyStyle Style, typename T, typename Stream>
+void pack_schema_records(msgpack::packer<Stream>& pk, const std::vector<T>& records) {
+    pk.pack_array((uint32_t)records.size());
+    for (const T& r : records) pack_schema<Style>(pk, r);
+}
+
+// Largest encoding of one value, header included.
+constexpr size_t msgpack_number_bound(FieldType type) {
+    switch (type) {
+        case FieldType::U8:
+        case FieldType::I8: return 2;
+        case FieldType::U16:
+        case FieldType::I16: return 3;
+        case FieldType::U64:
+        case FieldType::I64: return 9;
+        default: return 5; // 32-bit ints, float32
+    }
+}
+
+/**
+ * @brief Worst-case size of pack_schema<Style>(T), from the schema alone.
+ */
+template <typename T, KeyStyle Style>
+constexpr size_t msgpack_schema_max_size() {
+    size_t n = 5; // map32 header
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const FieldDesc& d = PayloadSchema<T>::fields[i];
+        n += (Style == KeyStyle::Int) ? 5 : 5 + key_length(schema_key(d, Style));
+        if (d.type == FieldType::BYTES || d.type == FieldType::CHARS) n += 5 + d.count;
+        else if (d.count == 1) n += msgpack_number_bound(d.type);
+        else n += 5 + d.count * msgpack_number_bound(d.type);
+    }
+    return n;
+}
+
+template <typename T, KeyStyle Style>
+int msgpack_schema_key(const msgpack::object& key) {
+    if constexpr (Style == KeyStyle::Int) {
+        return key.type == msgpack::type::POSITIVE_INTEGER ? schema_find<T>(key.via.u64) : -1;
+    } else {
+        return key.type == msgpack::type::STR ? schema_find<T, Style>(key.via.str.ptr, key.via.str.size) : -1;
+    }
+}
+
+template <typename T>
+void store_msgpack_value(T& m, const FieldDesc& d, size_t index, const msgpack::object& val) {
+    switch (val.type) {
+        case msgpack::type::POSITIVE_INTEGER: store_number(m, d, index, val.via.u64); break;
+        case msgpack::type::NEGATIVE_INTEGER: store_number(m, d, index, val.via.i64); break;
+        case msgpack::type::FLOAT32:
+        case msgpack::type::FLOAT64: store_number(m, d, index, val.via.f64); break;
+        case msgpack::type::STR: store_bytes(m, d, val.via.str.ptr, val.via.str.size); break;
+        case msgpack::type::BIN: store_bytes(m, d, val.via.bin.ptr, val.via.bin.size); break;
+        default: break;
+    }
+}
+
+/**
+ * @brief DOM decode: walks an unpacked map and stores every known field.
+ */
+template <KeyStyle Style, typename T>
+void unpack_schema(const msgpack::object& obj, T& m) {
+    if (obj.type != msgpack::type::MAP) return;
+    for (uint32_t i = 0; i < obj.via.map.size; i++) {
+        const msgpack::object_kv& kv = obj.via.map.ptr[i];
+        int f = msgpack_schema_key<T, Style>(kv.key);
+        if (f < 0) continue;
+        const FieldDesc& d = PayloadSchema<T>::fields[f];
+        if (kv.val.type == msgpack::type::ARRAY) {
+            for (uint32_t k = 0; k < kv.val.via.array.size; k++) store_msgpack_value(m, d, k, kv.val.via.array.ptr[k]);
+        } else {
+            store_msgpack_value(m, d, 0, kv.val);
+        }
+    }
+}
+
+template <KeyStyle Style, typename T>
+void unpack_schema_records(const msgpack::object& obj, std::vector<T>& records) {
+    if (obj.type != msgpack::type::ARRAY) return;
+    records.resize(obj.via.array.size);
+    for (uint32_t i = 0; i < obj.via.array.size; i++) unpack_schema<Style>(obj.via.array.ptr[i], records[i]);
+}
+
+/**
+ * @brief msgpack::parse visitor that fills T, or appends one record of T per map.
+ * `elem` counts the values stored under the current key, so scalars land at
+ * element 0 and array values at consecutive elements.
+ */
+template <typename T, KeyStyle Style>
+struct SchemaVisitor : MapKeyVisitor {
+    T* m = nullptr;
+    std::vector<T>* records = nullptr; // Set when decoding an array of records
+    size_t elem = 0;
+
+    explicit SchemaVisitor(T* out) : m(out) {}
+    explicit SchemaVisitor(std::vector<T>* out) : records(out) {}
+
+    bool start_map(uint32_t /*num_kv_pairs*/) {
+        if (records) {
+            records->emplace_back();
+            m = &records->back();
+        }
+        return true;
+    }
+
+    bool start_map_key() {
+        elem = 0;
+        return MapKeyVisitor::start_map_key();
+    }
+
+    bool visit_positive_integer(uint64_t v) {
+        if (!in_key) return set(v);
+        if constexpr (Style == KeyStyle::Int) field = schema_find<T>(v);
+        return true;
+    }
+    bool visit_negative_integer(int64_t v) { return in_key ? true : set(v); }
+    bool visit_float32(float v) { return in_key ? true : set(v); }
+    bool visit_float64(double v) { return in_key ? true : set(v); }
+
+    bool visit_str(const char* v, uint32_t size) {
+        if (!in_key) return set_bytes(v, size);
+        if constexpr (Style != KeyStyle::Int) field = schema_find<T, Style>(v, size);
+        return true;
+    }
+    bool visit_bin(const char* v, uint32_t size) { return in_key ? true : set_bytes(v, size); }
+
+    template <typename V>
+    bool set(V v) {
+        if (field >= 0) store_number(*m, PayloadSchema<T>::fields[field], elem++, v);
+        return true;
+    }
+
+    bool set_bytes(const char* v, uint32_t size) {
+        if (field >= 0) store_bytes(*m, PayloadSchema<T>::fields[field], v, size);
+        return true;
+    }
+};
+
+template <KeyStyle Style, typename T>
+void parse_schema(const uint8_t* data, size_t len, T& m) {
+    SchemaVisitor<T, Style> visitor(&m);
+    msgpack::parse((const char*)data, len, visitor);
+}
+
+/**
+ * @brief Streaming decode of an array of maps into `records`, replacing its contents.
+ */
+template <KeyStyle Style, typename T>
+void parse_schema_records(const uint8_t* data, size_t len, std::vector<T>& records) {
+    records.clear();
+    SchemaVisitor<T, Style> visitor(&records);
+    msgpack::parse((const char*)data, len, visitor);
+}
+
+// --- Columnar blocks, see ColumnarBlock.h ---
+
+/**
+ * @brief Worst-case size of pack_columns for `records` records.
+ */
+template <typename T>
+inline size_t msgpack_columns_max_size(size_t records) {
+    size_t n = 5 + (5 + key_length(kColumnCountKey)) + 9;
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const FieldDesc& d = PayloadSchema<T>::fields[i];
+        n += 5 + key_length(d.short_name) + 5;
+        n += d.type == FieldType::BYTES ? records * d.count : delta_column_bound(records);
+    }
+    return n;
+}
+
+/**
+ * @brief Packs `records` as {"n": count, <short name>: bin column, ...}.
+ * Each column is built in `scratch` (grown once, then reused).
+ */
+template <typename T, typename Stream>
+void pack_columns(msgpack::packer<Stream>& pk, const std::vector<T>& records, std::vector<uint8_t>& scratch) {
+    static_assert(schema_is_columnar<T>(), "Columnar blocks need integer and BYTES fields only");
+    size_t need = column_scratch_size<T>(records.size());
+    if (scratch.size() < need) scratch.resize(need);
+
+    pk.pack_map((uint32_t)(1 + schema_size<T>()));
+    pk.pack_str((uint32_t)key_length(kColumnCountKey));
+    pk.pack_str_body(kColumnCountKey, (uint32_t)key_length(kColumnCountKey));
+    pk.pack((uint64_t)records.size());
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        const char* key = PayloadSchema<T>::fields[i].short_name;
+        pk.pack_str((uint32_t)key_length(key));
+        pk.pack_str_body(key, (uint32_t)key_length(key));
+        uint32_t n = (uint32_t)write_column(records, i, scratch.data());
+        pk.pack_bin(n);
+        pk.pack_bin_body((const char*)scratch.data(), n);
+    }
+}
+
+/**
+ * @brief msgpack::parse visitor for a pack_columns block.
+ * The count resizes `records`; each bin column is then scattered in place,
+ * so parse_columns empties `records` again when the parse fails.
+ */
+template <typename T>
+struct ColumnVisitor : MapKeyVisitor {
+    static constexpr int kCount = -2;
+    std::vector<T>* records;
+    size_t input_len;
+    bool sized = false;
+
+    ColumnVisitor(std::vector<T>* out, size_t len) : records(out), input_len(len) {}
+
+    bool visit_str(const char* v, uint32_t size) {
+        if (!in_key) return true;
+        if (size == key_length(kColumnCountKey) && memcmp(v, kColumnCountKey, size) == 0) field = kCount;
+        else field = schema_find<T, KeyStyle::ShortName>(v, size);
+        return true;
+    }
+
+    bool visit_positive_integer(uint64_t v) {
+        if (in_key || field != kCount) return true;
+        if (v > input_len) return false; // Every record takes at least a byte per column
+        records->resize(v);
+        sized = true;
+        return true;
+    }
+
+    bool visit_bin(const char* v, uint32_t size) {
+        if (in_key || field < 0) return true;
+        return sized && read_column((const uint8_t*)v, size, field, *records);
+    }
+};
+
+template <typename T>
+bool parse_columns(const uint8_t* data, size_t len, std::vector<T>& records) {
+    ColumnVisitor<T> visitor(&records, len);
+    if (msgpack::parse((const char*)data, len, visitor) && visitor.sized) return true;
+    records.clear();
+    return false;
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_MSGPACK_SCHEMA_CODEC_H
@@ -0,0 +1,52 @@
+#ifndef PRIME_FUSION_MSGPACK_SPAN_BUFFER_H
+#define PRIME_FUSION_MSGPACK_SPAN_BUFFER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace pf {
+
+/**
+ * @brief msgpack::packer output stream over caller-owned memory.
+ * Drop-in for msgpack::sbuffer when the destination is fixed (no heap growth).
+ * packer<> only requires write(); overflow is latched and reported via result().
+ */
+class SpanBuffer {
+public:
+    SpanBuffer(uint8_t* dst, size_t cap) : dst_(dst), cap_(cap) {}
+
+    /**
+     * @brief Retarget to a new destination so one packer can serve a whole batch.
+     */
+    void reset(uint8_t* dst, size_t cap) {
+        dst_ = dst;
+        cap_ = cap;
+        size_ = 0;
+        overflow_ = false;
+    }
+
+    void write(const char* buf, size_t len) {
+        if (len > cap_ - size_) { overflow_ = true; return; }
+        memcpy(dst_ + size_, buf, len);
+        size_ += len;
+    }
+
+    /**
+     * @brief Bytes written, or 0 if any write did not fit.
+     */
+    size_t result() const { return overflow_ ? 0 : size_; }
+
+    size_t size() const { return size_; }
+    const uint8_t* data() const { return dst_; }
+
+private:
+    uint8_t* dst_;
+    size_t cap_;
+    size_t size_ = 0;
+    bool overflow_ = false;
+};
+
+} // namespace pf
+
+#endif // PRIME_FUSION_MSGPACK_SPAN_BUFFER_H
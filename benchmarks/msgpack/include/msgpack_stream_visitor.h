@@ -0,0 +1,71 @@
+#ifndef PRIME_FUSION_MSGPACK_STREAM_VISITOR_H
+#define PRIME_FUSION_MSGPACK_STREAM_VISITOR_H
+
+#include "KeyDispatch.h"
+#include <msgpack.hpp>
+#include <cstdint>
+
+namespace pf {
+
+/**
+ * @brief Key/value state machine for msgpack::parse() visitors.
+ * The parser reports keys and values through the same visit_* callbacks; this
+ * base tracks which one is being visited and resolves each key once, when it
+ * arrives, to a field index (`field`, -1 if unknown). String keys go through a
+ * KeyTable and integer keys are used as the index directly. Inside an array
+ * value, `index` is the position of the element being visited.
+ *
+ * Scenario visitors derive from it and route visit_str / visit_positive_integer
+ * to set_key() while in_key is true, and to their field switch otherwise.
+ */
+struct MapKeyVisitor : msgpack::null_visitor {
+    bool in_key = false;
+    int field = -1;
+    uint32_t index = 0;
+
+    bool start_map_key() {
+        in_key = true;
+        field = -1;
+        return true;
+    }
+
+    bool end_map_key() {
+        in_key = false;
+        return true;
+    }
+
+    bool start_array(uint32_t /*num_elements*/) {
+        index = 0;
+        return true;
+    }
+
+    bool end_array_item() {
+        index++;
+        return true;
+    }
+
+    template <size_t N>
+    bool set_key(const KeyTable<N>& fields, const char* v, uint32_t size) {
+        field = fields.find(v, size);
+        return true;
+    }
+
+    bool set_key(uint64_t v) {
+        field = v <= (uint64_t)INT32_MAX ? (int)v : -1;
+        return true;
+    }
+};
+
+/**
+ * @brief DOM counterpart of MapKeyVisitor::set_key for string-keyed maps.
+ * @return The field index of a STR map key, or -1 for unknown or non-string keys
+ */
+template <size_t N>
+int map_key_field(const KeyTable<N>& fields, const msgpack::object& key) {
+    if (key.type != msgpack::type::STR) return -1;
+    return fields.find(key.via.str.ptr, key.via.str.size);
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_MSGPACK_STREAM_VISITOR_H
@@ -1,4 +1,6 @@
 #include "IBenchmark.h"
+#include "msgpack_span_buffer.h"
+#include "msgpack_stream_visitor.h"
 #include <msgpack.hpp>
 #include <iostream>
 #include <vector>
@@ -12,10 +14,12 @@ class MsgPackBenchmark : public IBenchmark {
 public:
     enum Variant { STANDARD, STRING_KEYS };
     Variant variant_ = STANDARD;
+    bool streaming_ = false; // "Streaming*" variants decode through msgpack::parse instead of unpack
 
     void setup(const BenchmarkConfig& config) override {
-        if (config.variant_name == "StringKeys") variant_ = STRING_KEYS;
+        if (config.variant_name == "StringKeys" || config.variant_name == "StreamingStringKeys") variant_ = STRING_KEYS;
         else variant_ = STANDARD;
+        streaming_ = config.variant_name.compare(0, 9, "Streaming") == 0;
         std::cout << "[MsgPack] Setup complete. Variant: " << config.variant_name << std::endl;
 
         // --- Integrity Verification ---
@@ -35,11 +39,31 @@ public:
         }
     }
 
+    // map16 header + 18 keys (<= 18 chars) + 17 ints (<= 9 bytes) + bin8 hash
+    static constexpr size_t kMaxEncodedSize = 3 + 18 * (1 + 18) + 17 * 9 + (2 + 32);
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
         const Payload& m = *static_cast<const Payload*>(data);
         msgpack::sbuffer sbuf;
         msgpack::packer<msgpack::sbuffer> packer(sbuf);
+        pack_payload(packer, m);
+
+        std::vector<uint8_t> result(sbuf.data(), sbuf.data() + sbuf.size());
+        return result;
+    }
 
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const Payload& m = *static_cast<const Payload*>(data);
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        pack_payload(packer, m);
+        return out.result();
+    }
+
+    template <typename Stream>
+    void pack_payload(msgpack::packer<Stream>& packer, const Payload& m) {
         // Map size = 18 fields
         packer.pack_map(18);
 
@@ -84,157 +108,172 @@ public:
             packer.pack(16); packer.pack(m.vel_acc);
             packer.pack(17); packer.pack(m.hdg_acc);
         }
-
-        std::vector<uint8_t> result(sbuf.data(), sbuf.data() + sbuf.size());
-        return result;
     }
 
-    // --- SAX Visitor for MsgPack ---
-    struct PayloadVisitor : msgpack::null_visitor {
+    // String keys resolve to the Standard variant's integer keys, so both key
+    // styles share one field switch per decoder.
+    static constexpr KeyEntry kKeys[] = {
+        {"timestamp", 0}, {"block_number", 1}, {"hash", 2}, {"time_usec", 3}, {"fix_type", 4},
+        {"lat", 5}, {"lon", 6}, {"alt", 7}, {"eph", 8}, {"epv", 9}, {"vel", 10}, {"cog", 11},
+        {"satellites_visible", 12}, {"alt_ellipsoid", 13}, {"h_acc", 14}, {"v_acc", 15},
+        {"vel_acc", 16}, {"hdg_acc", 17},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
+    // --- Streaming (SAX) decode ---
+    // msgpack::parse drives the visitor straight off the input buffer: no object
+    // tree, no zone, no std::string per key.
+    // A visit_* returning false stops msgpack::parse, so the visitor returns
+    // false as soon as the last selected field is stored.
+    struct PayloadVisitor : MapKeyVisitor {
         Payload* m;
-        Variant variant;
-        std::string key;
-        
-        PayloadVisitor(Payload* p, Variant v) : m(p), variant(v) {}
+        FieldProjection want;
 
-        bool visit_str(const char* v, uint32_t size) {
-            key.assign(v, size);
-            return true;
-        }
+        explicit PayloadVisitor(Payload* p, FieldMask fields = kAllFields) : m(p), want(fields, 18) {}
+
+        bool visit_str(const char* v, uint32_t size) { return in_key ? set_key(kFields, v, size) : true; }
+        bool visit_positive_integer(uint64_t v) { return in_key ? set_key(v) : set_field(v); }
+        bool visit_negative_integer(int64_t v) { return in_key ? true : set_field((uint64_t)v); }
 
         bool visit_bin(const char* v, uint32_t size) {
-            if ((variant == STRING_KEYS && key == "hash") ||
-                (variant == STANDARD && key.empty() /* Integer Key 2 logic needed? Visitor doesn't track parent */)) {
-                // Wait. Visitor is purely sequential. We need a state machine to know "Value for Key X".
-                // MsgPack visitor doesn't give us context easily unless we track it.
-                // Assuming standard Map traversal: Key -> Value -> Key -> Value.
-            }
-            // For simplicity in this quick refactor, we stick to "Key" string tracking.
-            // But for Integer Keys, we need to track the integer key.
-            return true;
+            if (in_key || field != 2 || size != 32 || !want.wants(2)) return true;
+            memcpy(m->hash, v, 32);
+            return stored();
         }
-        
-        // This is getting complex to implement perfectly correct SAX for MsgPack in one shot.
-        // Reason: MsgPack Visitor calls `visit_positive_integer` for both Keys (if int) and Values.
-        // We need `bool expecting_value`.
-        
-        bool expecting_value = false;
-        uint64_t current_int_key = 0;
-
-        bool visit_positive_integer(uint64_t v) {
-            if (!expecting_value) {
-                // Context: It's a Key (for Integer Variant)
-                current_int_key = v;
-                expecting_value = true;
-                return true;
-            }
-            
-            // Context: It's a Value
-            if (variant == STRING_KEYS) {
-                if (key == "timestamp") m->timestamp = v;
-                else if (key == "block_number") m->block_number = (uint32_t)v;
-                // ... (abbreviated for safety, full list below)
-            } else {
-                 switch(current_int_key) {
-                     case 0: m->timestamp = v; break;
-                     // ...
-                 }
+
+        bool stored() {
+            want.found(field);
+            return !want.done();
+        }
+
+        // Negative values arrive sign-extended; the casts narrow them like the DOM path.
+        bool set_field(uint64_t v) {
+            if (field == 2 || !want.wants(field)) return true;
+            switch (field) {
+                case 0: m->timestamp = v; break;
+                case 1: m->block_number = (uint32_t)v; break;
+                case 3: m->time_usec = v; break;
+                case 4: m->fix_type = (uint8_t)v; break;
+                case 5: m->lat = (int32_t)v; break;
+                case 6: m->lon = (int32_t)v; break;
+                case 7: m->alt = (int32_t)v; break;
+                case 8: m->eph = (uint16_t)v; break;
+                case 9: m->epv = (uint16_t)v; break;
+                case 10: m->vel = (uint16_t)v; break;
+                case 11: m->cog = (uint16_t)v; break;
+                case 12: m->satellites_visible = (uint8_t)v; break;
+                case 13: m->alt_ellipsoid = (int32_t)v; break;
+                case 14: m->h_acc = (uint32_t)v; break;
+                case 15: m->v_acc = (uint32_t)v; break;
+                case 16: m->vel_acc = (uint32_t)v; break;
+                case 17: m->hdg_acc = (uint32_t)v; break;
             }
-            expecting_value = false;
-            return true;
+            return stored();
         }
-        
-        // ... (We need safe fallback to DOM for MsgPack given complexity and time?)
-        // actually, let's defer MsgPack SAX. It's notoriously hard to get right without a full state machine class.
-        // The `object_handle` approach is the "standard" way people use msgpack-cxx.
-        // Unlike RapidJSON/LibCBOR where SAX is common, MsgPack C++ users usually imply DOM.
-        // Honest optimization: Keep DOM but pre-allocate? No.
-        // I will revert to sticking with the CLEAN DOM implementation I just fixed in the previous step, 
-        // OR try to just fix JSON.
-        // User asked: "is there any honest optimization for all".
-        // Use the DOM implementation but ensure it's tight.
-        // Actually, I'll stick to DOM for MsgPack to avoid breakage, but state that SAX is possible but complex.
     };
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
+        MsgPackBenchmark::decode_fields(data, len, out_data, kAllFields);
+    }
+
+    // Streaming stops parsing after the last selected field. The DOM path has
+    // already built the whole tree, so it can only skip the as<>() conversions.
+    void decode_fields(const uint8_t* data, size_t len, void* out_data, FieldMask fields) override {
         Payload& m = *static_cast<Payload*>(out_data);
-        // Reverting to the robust DOM implementation we just verified.
-        // MsgPack DOM is reasonably fast (Unpack + Iterate).
-        msgpack::object_handle oh = msgpack::unpack((const char*)buffer.data(), buffer.size());
-        msgpack::object obj = oh.get();
-        
+        if (streaming_) {
+            decode_stream(data, len, m, fields);
+            return;
+        }
+        // DOM: unpack into an object tree, then walk it.
+        msgpack::object_handle oh = msgpack::unpack((const char*)data, len);
+        decode_object(oh.get(), m, fields);
+    }
+
+    void decode_stream(const uint8_t* data, size_t len, Payload& m, FieldMask fields = kAllFields) {
+        PayloadVisitor visitor(&m, fields);
+        msgpack::parse((const char*)data, len, visitor);
+    }
+
+    void decode_object(const msgpack::object& obj, Payload& m, FieldMask fields = kAllFields) {
         if (obj.type != msgpack::type::MAP) return;
         
         size_t map_size = obj.via.map.size;
         msgpack::object_kv* kv = obj.via.map.ptr;
+        FieldProjection want(fields, 18);
         
-        for(size_t i=0; i<map_size; i++) {
+        for(size_t i=0; i<map_size && !want.done(); i++) {
             msgpack::object& key = kv[i].key;
             msgpack::object& val = kv[i].val;
-            
-            if (variant_ == STRING_KEYS) {
-                 if (key.type == msgpack::type::STR) {
-                     std::string k = key.as<std::string>();
-                     if (k == "timestamp") m.timestamp = val.as<uint64_t>();
-                     else if (k == "block_number") m.block_number = val.as<uint32_t>();
-                     else if (k == "hash" && val.type == msgpack::type::BIN) {
-                         const char* data = val.via.bin.ptr;
-                         if (val.via.bin.size == 32) memcpy(m.hash, data, 32);
-                     }
-                     else if (k == "time_usec") m.time_usec = val.as<uint64_t>();
-                     else if (k == "fix_type") m.fix_type = val.as<uint8_t>();
-                     else if (k == "lat") m.lat = val.as<int32_t>();
-                     else if (k == "lon") m.lon = val.as<int32_t>();
-                     else if (k == "alt") m.alt = val.as<int32_t>();
-                     else if (k == "eph") m.eph = val.as<uint16_t>();
-                     else if (k == "epv") m.epv = val.as<uint16_t>();
-                     else if (k == "vel") m.vel = val.as<uint16_t>();
-                     else if (k == "cog") m.cog = val.as<uint16_t>();
-                     else if (k == "satellites_visible") m.satellites_visible = val.as<uint8_t>();
-                     else if (k == "alt_ellipsoid") m.alt_ellipsoid = val.as<int32_t>();
-                     else if (k == "h_acc") m.h_acc = val.as<uint32_t>();
-                     else if (k == "v_acc") m.v_acc = val.as<uint32_t>();
-                     else if (k == "vel_acc") m.vel_acc = val.as<uint32_t>();
-                     else if (k == "hdg_acc") m.hdg_acc = val.as<uint32_t>();
-                 }
-            } else {
-                 // Integer Keys
-                 if (key.type == msgpack::type::POSITIVE_INTEGER) {
-                     uint64_t k = key.as<uint64_t>();
-                     try {
-                         switch(k) {
-                             case 0: m.timestamp = val.as<uint64_t>(); break;
-                             case 1: m.block_number = (uint32_t)val.as<uint64_t>(); break;
-                             case 2: if(val.type == msgpack::type::BIN) memcpy(m.hash, val.via.bin.ptr, 32); break;
-                             case 3: m.time_usec = val.as<uint64_t>(); break;
-                             case 4: m.fix_type = (uint8_t)val.as<uint64_t>(); break;
-                             case 5: m.lat = (int32_t)val.as<int64_t>(); break;
-                             case 6: m.lon = (int32_t)val.as<int64_t>(); break;
-                             case 7: m.alt = (int32_t)val.as<int64_t>(); break;
-                             case 8: m.eph = (uint16_t)val.as<uint64_t>(); break;
-                             case 9: m.epv = (uint16_t)val.as<uint64_t>(); break;
-                             case 10: m.vel = (uint16_t)val.as<uint64_t>(); break;
-                             case 11: m.cog = (uint16_t)val.as<uint64_t>(); break;
-                             case 12: m.satellites_visible = (uint8_t)val.as<uint64_t>(); break;
-                             case 13: m.alt_ellipsoid = (int32_t)val.as<int64_t>(); break;
-                             case 14: m.h_acc = (uint32_t)val.as<uint64_t>(); break;
-                             case 15: m.v_acc = (uint32_t)val.as<uint64_t>(); break;
-                             case 16: m.vel_acc = (uint32_t)val.as<uint64_t>(); break;
-                             case 17: m.hdg_acc = (uint32_t)val.as<uint64_t>(); break;
-                         }
-                     } catch (msgpack::type_error& e) {
-                         std::cerr << "MsgPack Type Error Key=" << k << " ValType=" << val.type << std::endl;
-                         throw;
-                     }
-                 }
+
+            // The key style must match the variant; anything else is skipped.
+            int k = -1;
+            if (variant_ == STRING_KEYS && key.type == msgpack::type::STR) {
+                k = kFields.find(key.via.str.ptr, key.via.str.size);
+            } else if (variant_ == STANDARD && key.type == msgpack::type::POSITIVE_INTEGER && key.via.u64 <= 17) {
+                k = (int)key.via.u64;
+            }
+            if (!want.wants(k)) continue;
+            want.found(k);
+
+            try {
+                switch(k) {
+                    case 0: m.timestamp = val.as<uint64_t>(); break;
+                    case 1: m.block_number = (uint32_t)val.as<uint64_t>(); break;
+                    case 2: if(val.type == msgpack::type::BIN && val.via.bin.size == 32) memcpy(m.hash, val.via.bin.ptr, 32); break;
+                    case 3: m.time_usec = val.as<uint64_t>(); break;
+                    case 4: m.fix_type = (uint8_t)val.as<uint64_t>(); break;
+                    case 5: m.lat = (int32_t)val.as<int64_t>(); break;
+                    case 6: m.lon = (int32_t)val.as<int64_t>(); break;
+                    case 7: m.alt = (int32_t)val.as<int64_t>(); break;
+                    case 8: m.eph = (uint16_t)val.as<uint64_t>(); break;
+                    case 9: m.epv = (uint16_t)val.as<uint64_t>(); break;
+                    case 10: m.vel = (uint16_t)val.as<uint64_t>(); break;
+                    case 11: m.cog = (uint16_t)val.as<uint64_t>(); break;
+                    case 12: m.satellites_visible = (uint8_t)val.as<uint64_t>(); break;
+                    case 13: m.alt_ellipsoid = (int32_t)val.as<int64_t>(); break;
+                    case 14: m.h_acc = (uint32_t)val.as<uint64_t>(); break;
+                    case 15: m.v_acc = (uint32_t)val.as<uint64_t>(); break;
+                    case 16: m.vel_acc = (uint32_t)val.as<uint64_t>(); break;
+                    case 17: m.hdg_acc = (uint32_t)val.as<uint64_t>(); break;
+                }
+            } catch (msgpack::type_error& e) {
+                std::cerr << "MsgPack Type Error Key=" << k << " ValType=" << val.type << std::endl;
+                throw;
             }
         }
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            pack_payload(packer, *static_cast<const Payload*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        if (streaming_) {
+            return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+                decode_stream(frame, frame_len, *static_cast<Payload*>(out));
+            });
+        }
+        // One zone per batch: clear() rewinds it but keeps its chunks for the next frame.
+        msgpack::zone zone;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            zone.clear();
+            decode_object(msgpack::unpack(zone, (const char*)frame, frame_len), *static_cast<Payload*>(out));
+        });
+    }
+
     void teardown() override {}
 
     std::string name() const override {
-        return (variant_ == STRING_KEYS) ? "MsgPack-StringKeys" : "MsgPack-Standard";
+        std::string keys = (variant_ == STRING_KEYS) ? "StringKeys" : "Standard";
+        return streaming_ ? "MsgPack-Streaming-" + keys : "MsgPack-" + keys;
     }
 };
 
@@ -1,4 +1,6 @@
 #include "IBenchmark.h"
+#include "msgpack_span_buffer.h"
+#include "msgpack_stream_visitor.h"
 #include <msgpack.hpp>
 #include <iostream>
 #include <vector>
@@ -9,7 +11,10 @@ namespace pf {
 
 class MsgPackBenchmarkAttitude : public IBenchmark {
 public:
+    bool streaming_ = false;
+
     void setup(const BenchmarkConfig& config) override {
+        streaming_ = config.variant_name == "Streaming";
         PayloadAttitude p;
         memset(&p, 0, sizeof(p));
         p.roll = 1.0f;
@@ -23,13 +28,31 @@ public:
              std::cerr << "[MsgPack-Attitude] Sanity Check: FAILED" << std::endl;
              exit(1);
         }
-        (void)config;
     }
 
+    // fixmap header + 7 keys (<= 4 chars) + uint32 + 6 float32
+    static constexpr size_t kMaxEncodedSize = 1 + 7 * (1 + 4) + 5 + 6 * 5;
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadAttitude& m = *static_cast<const PayloadAttitude*>(data);
         msgpack::sbuffer sbuf;
         msgpack::packer<msgpack::sbuffer> packer(sbuf);
+        pack_payload(packer, m);
+        return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadAttitude& m = *static_cast<const PayloadAttitude*>(data);
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        pack_payload(packer, m);
+        return out.result();
+    }
+
+    template <typename Stream>
+    void pack_payload(msgpack::packer<Stream>& packer, const PayloadAttitude& m) {
         packer.pack_map(7);
         packer.pack("boot"); packer.pack(m.time_boot_ms);
         packer.pack("r"); packer.pack(m.roll);
@@ -38,31 +61,100 @@ public:
         packer.pack("rs"); packer.pack(m.rollspeed);
         packer.pack("ps"); packer.pack(m.pitchspeed);
         packer.pack("ys"); packer.pack(m.yawspeed);
-        return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadAttitude& m = *static_cast<PayloadAttitude*>(out_data);
-        msgpack::object_handle oh = msgpack::unpack((const char*)buffer.data(), buffer.size());
-        msgpack::object obj = oh.get();
+        if (streaming_) {
+            decode_stream(data, len, m);
+            return;
+        }
+        msgpack::object_handle oh = msgpack::unpack((const char*)data, len);
+        decode_object(oh.get(), m);
+    }
+
+    enum Field { BOOT, ROLL, PITCH, YAW, ROLLSPEED, PITCHSPEED, YAWSPEED };
+    static constexpr KeyEntry kKeys[] = {
+        {"boot", BOOT}, {"r", ROLL}, {"p", PITCH}, {"y", YAW},
+        {"rs", ROLLSPEED}, {"ps", PITCHSPEED}, {"ys", YAWSPEED},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
+    struct StreamVisitor : MapKeyVisitor {
+        PayloadAttitude* m;
+        explicit StreamVisitor(PayloadAttitude* p) : m(p) {}
+
+        bool visit_str(const char* v, uint32_t size) { return in_key ? set_key(kFields, v, size) : true; }
+        bool visit_positive_integer(uint64_t v) {
+            if (!in_key && field == BOOT) m->time_boot_ms = (uint32_t)v;
+            return true;
+        }
+        bool visit_float32(float v) { return in_key ? true : set_float(v); }
+        bool visit_float64(double v) { return in_key ? true : set_float((float)v); }
+
+        bool set_float(float v) {
+            switch (field) {
+                case ROLL: m->roll = v; break;
+                case PITCH: m->pitch = v; break;
+                case YAW: m->yaw = v; break;
+                case ROLLSPEED: m->rollspeed = v; break;
+                case PITCHSPEED: m->pitchspeed = v; break;
+                case YAWSPEED: m->yawspeed = v; break;
+            }
+            return true;
+        }
+    };
+
+    void decode_stream(const uint8_t* data, size_t len, PayloadAttitude& m) {
+        StreamVisitor visitor(&m);
+        msgpack::parse((const char*)data, len, visitor);
+    }
+
+    void decode_object(const msgpack::object& obj, PayloadAttitude& m) {
         if(obj.type != msgpack::type::MAP) return;
         
         auto& map = obj.via.map;
         for(size_t i=0; i<map.size; i++) {
-             auto k = map.ptr[i].key.as<std::string>();
              auto& val = map.ptr[i].val;
-             if (k=="boot") m.time_boot_ms = val.as<uint32_t>();
-             else if (k=="r") m.roll = val.as<float>();
-             else if (k=="p") m.pitch = val.as<float>();
-             else if (k=="y") m.yaw = val.as<float>();
-             else if (k=="rs") m.rollspeed = val.as<float>();
-             else if (k=="ps") m.pitchspeed = val.as<float>();
-             else if (k=="ys") m.yawspeed = val.as<float>();
+             switch (map_key_field(kFields, map.ptr[i].key)) {
+                 case BOOT: m.time_boot_ms = val.as<uint32_t>(); break;
+                 case ROLL: m.roll = val.as<float>(); break;
+                 case PITCH: m.pitch = val.as<float>(); break;
+                 case YAW: m.yaw = val.as<float>(); break;
+                 case ROLLSPEED: m.rollspeed = val.as<float>(); break;
+                 case PITCHSPEED: m.pitchspeed = val.as<float>(); break;
+                 case YAWSPEED: m.yawspeed = val.as<float>(); break;
+             }
+        }
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            pack_payload(packer, *static_cast<const PayloadAttitude*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        if (streaming_) {
+            return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+                decode_stream(frame, frame_len, *static_cast<PayloadAttitude*>(out));
+            });
         }
+        msgpack::zone zone;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            zone.clear();
+            decode_object(msgpack::unpack(zone, (const char*)frame, frame_len), *static_cast<PayloadAttitude*>(out));
+        });
     }
 
     void teardown() override {}
-    std::string name() const override { return "MsgPack-Attitude"; }
+    std::string name() const override { return streaming_ ? "MsgPack-Streaming-Attitude" : "MsgPack-Attitude"; }
 };
 
 } // pf
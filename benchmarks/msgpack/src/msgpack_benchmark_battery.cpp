@@ -1,4 +1,6 @@
 #include "IBenchmark.h"
+#include "msgpack_span_buffer.h"
+#include "msgpack_stream_visitor.h"
 #include <msgpack.hpp>
 #include <iostream>
 #include <vector>
@@ -7,15 +9,35 @@ namespace pf {
 
 class MsgpackBenchmarkBattery : public IBenchmark {
 public:
+    bool streaming_ = false;
+
     void setup(const BenchmarkConfig& config) override {
-        (void)config;
+        streaming_ = config.variant_name == "Streaming";
     }
 
+    // fixmap header + 9 keys (<= 7 chars) + 8 ints (<= 9 bytes) + voltages[10]
+    static constexpr size_t kMaxEncodedSize = 1 + 9 * (1 + 7) + 8 * 9 + (1 + 10 * 3);
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadBattery& m = *static_cast<const PayloadBattery*>(data);
         msgpack::sbuffer sbuf;
         msgpack::packer<msgpack::sbuffer> packer(sbuf);
+        pack_payload(packer, m);
+        return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadBattery& m = *static_cast<const PayloadBattery*>(data);
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        pack_payload(packer, m);
+        return out.result();
+    }
 
+    template <typename Stream>
+    void pack_payload(msgpack::packer<Stream>& packer, const PayloadBattery& m) {
         packer.pack_map(9);
         packer.pack("id"); packer.pack(m.id);
         packer.pack("func"); packer.pack(m.battery_function);
@@ -29,42 +51,108 @@ public:
         packer.pack("cons"); packer.pack(m.current_consumed);
         packer.pack("energy"); packer.pack(m.energy_consumed);
         packer.pack("rem"); packer.pack(m.battery_remaining);
-
-        return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadBattery& m = *static_cast<PayloadBattery*>(out_data);
-        msgpack::object_handle oh = msgpack::unpack((const char*)buffer.data(), buffer.size());
-        msgpack::object obj = oh.get();
-        
+        if (streaming_) {
+            decode_stream(data, len, m);
+            return;
+        }
+        msgpack::object_handle oh = msgpack::unpack((const char*)data, len);
+        decode_object(oh.get(), m);
+    }
+
+    enum Field { ID, FUNC, TYPE, TEMP, VOLT, CURRENT, CONS, ENERGY, REM };
+    static constexpr KeyEntry kKeys[] = {
+        {"id", ID}, {"func", FUNC}, {"type", TYPE}, {"temp", TEMP}, {"volt", VOLT},
+        {"current", CURRENT}, {"cons", CONS}, {"energy", ENERGY}, {"rem", REM},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
+    struct StreamVisitor : MapKeyVisitor {
+        PayloadBattery* m;
+        explicit StreamVisitor(PayloadBattery* p) : m(p) {}
+
+        bool visit_str(const char* v, uint32_t size) { return in_key ? set_key(kFields, v, size) : true; }
+        bool visit_positive_integer(uint64_t v) { return in_key ? true : set_field((int64_t)v); }
+        bool visit_negative_integer(int64_t v) { return in_key ? true : set_field(v); }
+
+        bool set_field(int64_t v) {
+            switch (field) {
+                case ID: m->id = (uint8_t)v; break;
+                case FUNC: m->battery_function = (uint8_t)v; break;
+                case TYPE: m->type = (uint8_t)v; break;
+                case TEMP: m->temperature = (int16_t)v; break;
+                case VOLT: if (index < 10) m->voltages[index] = (uint16_t)v; break;
+                case CURRENT: m->current_battery = (int16_t)v; break;
+                case CONS: m->current_consumed = (int32_t)v; break;
+                case ENERGY: m->energy_consumed = (int32_t)v; break;
+                case REM: m->battery_remaining = (int8_t)v; break;
+            }
+            return true;
+        }
+    };
+
+    void decode_stream(const uint8_t* data, size_t len, PayloadBattery& m) {
+        StreamVisitor visitor(&m);
+        msgpack::parse((const char*)data, len, visitor);
+    }
+
+    void decode_object(const msgpack::object& obj, PayloadBattery& m) {
         if (obj.type != msgpack::type::MAP) return;
         
         // Manual iteration
         size_t size = obj.via.map.size;
         for(size_t i=0; i<size; i++) {
-             std::string key = obj.via.map.ptr[i].key.as<std::string>();
              msgpack::object& val = obj.via.map.ptr[i].val;
              
-             if(key == "id") m.id = (uint8_t)val.as<unsigned>();
-             else if(key == "func") m.battery_function = (uint8_t)val.as<unsigned>();
-             else if(key == "type") m.type = (uint8_t)val.as<unsigned>();
-             else if(key == "temp") m.temperature = (int16_t)val.as<int>();
-             else if(key == "current") m.current_battery = (int16_t)val.as<int>();
-             else if(key == "cons") m.current_consumed = (int32_t)val.as<int>();
-             else if(key == "energy") m.energy_consumed = (int32_t)val.as<int>();
-             else if(key == "rem") m.battery_remaining = (int8_t)val.as<int>();
-             else if(key == "volt" && val.type == msgpack::type::ARRAY) {
-                 size_t arr_size = val.via.array.size;
-                 for(size_t j=0; j<arr_size && j<10; j++) {
-                     m.voltages[j] = (uint16_t)val.via.array.ptr[j].as<unsigned>();
-                 }
+             switch (map_key_field(kFields, obj.via.map.ptr[i].key)) {
+                 case ID: m.id = (uint8_t)val.as<unsigned>(); break;
+                 case FUNC: m.battery_function = (uint8_t)val.as<unsigned>(); break;
+                 case TYPE: m.type = (uint8_t)val.as<unsigned>(); break;
+                 case TEMP: m.temperature = (int16_t)val.as<int>(); break;
+                 case CURRENT: m.current_battery = (int16_t)val.as<int>(); break;
+                 case CONS: m.current_consumed = (int32_t)val.as<int>(); break;
+                 case ENERGY: m.energy_consumed = (int32_t)val.as<int>(); break;
+                 case REM: m.battery_remaining = (int8_t)val.as<int>(); break;
+                 case VOLT:
+                     if (val.type != msgpack::type::ARRAY) break;
+                     for(size_t j=0; j<val.via.array.size && j<10; j++) {
+                         m.voltages[j] = (uint16_t)val.via.array.ptr[j].as<unsigned>();
+                     }
+                     break;
              }
         }
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            pack_payload(packer, *static_cast<const PayloadBattery*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        if (streaming_) {
+            return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+                decode_stream(frame, frame_len, *static_cast<PayloadBattery*>(out));
+            });
+        }
+        msgpack::zone zone;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            zone.clear();
+            decode_object(msgpack::unpack(zone, (const char*)frame, frame_len), *static_cast<PayloadBattery*>(out));
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "MsgPack-Battery"; }
+    std::string name() const override { return streaming_ ? "MsgPack-Streaming-Battery" : "MsgPack-Battery"; }
 };
 
 } // namespace pf
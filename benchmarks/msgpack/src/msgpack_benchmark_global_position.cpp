@@ -1,4 +1,6 @@
 #include "IBenchmark.h"
+#include "msgpack_span_buffer.h"
+#include "msgpack_stream_visitor.h"
 #include <msgpack.hpp>
 #include <iostream>
 #include <vector>
@@ -8,7 +10,10 @@ namespace pf {
 
 class MsgPackBenchmarkGlobalPosition : public IBenchmark {
 public:
+    bool streaming_ = false;
+
     void setup(const BenchmarkConfig& config) override {
+        streaming_ = config.variant_name == "Streaming";
         PayloadGlobalPosition p;
         memset(&p, 0, sizeof(p));
         p.lat = 123456789;
@@ -22,13 +27,31 @@ public:
              std::cerr << "[MsgPack-GlobalPos] Sanity Check: FAILED" << std::endl;
              exit(1);
         }
-        (void)config;
     }
 
+    // fixmap header + 9 keys (<= 4 chars) + 9 ints (<= 9 bytes)
+    static constexpr size_t kMaxEncodedSize = 1 + 9 * (1 + 4) + 9 * 9;
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadGlobalPosition& m = *static_cast<const PayloadGlobalPosition*>(data);
         msgpack::sbuffer sbuf;
         msgpack::packer<msgpack::sbuffer> packer(sbuf);
+        pack_payload(packer, m);
+        return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadGlobalPosition& m = *static_cast<const PayloadGlobalPosition*>(data);
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        pack_payload(packer, m);
+        return out.result();
+    }
+
+    template <typename Stream>
+    void pack_payload(msgpack::packer<Stream>& packer, const PayloadGlobalPosition& m) {
         packer.pack_map(9);
         packer.pack("boot"); packer.pack(m.time_boot_ms);
         packer.pack("lat"); packer.pack(m.lat);
@@ -39,33 +62,101 @@ public:
         packer.pack("vy"); packer.pack(m.vy);
         packer.pack("vz"); packer.pack(m.vz);
         packer.pack("hdg"); packer.pack(m.hdg);
-        return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadGlobalPosition& m = *static_cast<PayloadGlobalPosition*>(out_data);
-        msgpack::object_handle oh = msgpack::unpack((const char*)buffer.data(), buffer.size());
-        msgpack::object obj = oh.get();
+        if (streaming_) {
+            decode_stream(data, len, m);
+            return;
+        }
+        msgpack::object_handle oh = msgpack::unpack((const char*)data, len);
+        decode_object(oh.get(), m);
+    }
+
+    enum Field { BOOT, LAT, LON, ALT, REL, VX, VY, VZ, HDG };
+    static constexpr KeyEntry kKeys[] = {
+        {"boot", BOOT}, {"lat", LAT}, {"lon", LON}, {"alt", ALT}, {"rel", REL},
+        {"vx", VX}, {"vy", VY}, {"vz", VZ}, {"hdg", HDG},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
+    struct StreamVisitor : MapKeyVisitor {
+        PayloadGlobalPosition* m;
+        explicit StreamVisitor(PayloadGlobalPosition* p) : m(p) {}
+
+        bool visit_str(const char* v, uint32_t size) { return in_key ? set_key(kFields, v, size) : true; }
+        bool visit_positive_integer(uint64_t v) { return in_key ? true : set_field((int64_t)v); }
+        bool visit_negative_integer(int64_t v) { return in_key ? true : set_field(v); }
+
+        bool set_field(int64_t v) {
+            switch (field) {
+                case BOOT: m->time_boot_ms = (uint32_t)v; break;
+                case LAT: m->lat = (int32_t)v; break;
+                case LON: m->lon = (int32_t)v; break;
+                case ALT: m->alt = (int32_t)v; break;
+                case REL: m->relative_alt = (int32_t)v; break;
+                case VX: m->vx = (int16_t)v; break;
+                case VY: m->vy = (int16_t)v; break;
+                case VZ: m->vz = (int16_t)v; break;
+                case HDG: m->hdg = (uint16_t)v; break;
+            }
+            return true;
+        }
+    };
+
+    void decode_stream(const uint8_t* data, size_t len, PayloadGlobalPosition& m) {
+        StreamVisitor visitor(&m);
+        msgpack::parse((const char*)data, len, visitor);
+    }
+
+    void decode_object(const msgpack::object& obj, PayloadGlobalPosition& m) {
         if(obj.type != msgpack::type::MAP) return;
         
         auto& map = obj.via.map;
         for(size_t i=0; i<map.size; i++) {
-             auto k = map.ptr[i].key.as<std::string>();
              auto& val = map.ptr[i].val;
-             if (k=="boot") m.time_boot_ms = val.as<uint32_t>();
-             else if (k=="lat") m.lat = val.as<int32_t>();
-             else if (k=="lon") m.lon = val.as<int32_t>();
-             else if (k=="alt") m.alt = val.as<int32_t>();
-             else if (k=="rel") m.relative_alt = val.as<int32_t>();
-             else if (k=="vx") m.vx = val.as<int16_t>();
-             else if (k=="vy") m.vy = val.as<int16_t>();
-             else if (k=="vz") m.vz = val.as<int16_t>();
-             else if (k=="hdg") m.hdg = val.as<uint16_t>();
+             switch (map_key_field(kFields, map.ptr[i].key)) {
+                 case BOOT: m.time_boot_ms = val.as<uint32_t>(); break;
+                 case LAT: m.lat = val.as<int32_t>(); break;
+                 case LON: m.lon = val.as<int32_t>(); break;
+                 case ALT: m.alt = val.as<int32_t>(); break;
+                 case REL: m.relative_alt = val.as<int32_t>(); break;
+                 case VX: m.vx = val.as<int16_t>(); break;
+                 case VY: m.vy = val.as<int16_t>(); break;
+                 case VZ: m.vz = val.as<int16_t>(); break;
+                 case HDG: m.hdg = val.as<uint16_t>(); break;
+             }
+        }
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            pack_payload(packer, *static_cast<const PayloadGlobalPosition*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        if (streaming_) {
+            return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+                decode_stream(frame, frame_len, *static_cast<PayloadGlobalPosition*>(out));
+            });
         }
+        msgpack::zone zone;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            zone.clear();
+            decode_object(msgpack::unpack(zone, (const char*)frame, frame_len), *static_cast<PayloadGlobalPosition*>(out));
+        });
     }
 
     void teardown() override {}
-    std::string name() const override { return "MsgPack-GlobalPos"; }
+    std::string name() const override { return streaming_ ? "MsgPack-Streaming-GlobalPos" : "MsgPack-GlobalPos"; }
 };
 
 } // pf
@@ -1,4 +1,6 @@
 #include "IBenchmark.h"
+#include "msgpack_span_buffer.h"
+#include "msgpack_schema_codec.h"
 #include <msgpack.hpp>
 #include <iostream>
 #include <vector>
@@ -9,74 +11,115 @@ namespace pf {
 
 class MsgPackBenchmarkGPSBlock : public IBenchmark {
 public:
+    bool streaming_ = false;
+    bool columnar_ = false; // One bin column per field (ColumnarBlock.h), read by a visitor
+    std::vector<uint8_t> column_scratch_;
+
     void setup(const BenchmarkConfig& config) override {
+        streaming_ = config.variant_name == "Streaming";
+        columnar_ = config.variant_name == "Columnar";
         PayloadGPSBlock p;
         for(int i=0; i<50; i++) {
             PayloadGPSRaw raw;
             memset(&raw, 0, sizeof(raw));
             raw.timestamp = 1000 + i;
+            raw.lat = -473977418 + i;
+            raw.eph = 120;
+            raw.hash[31] = (uint8_t)i;
             p.messages.push_back(raw);
         }
         auto buf = encode(&p);
         PayloadGPSBlock d;
         decode(buf, &d);
-        if (d.messages.size() == 50 && d.messages[0].timestamp == 1000) {
+        if (d.messages.size() == 50 && d.messages[0].timestamp == 1000 && d.messages[49].lat == -473977369 &&
+            d.messages[49].eph == 120 && d.messages[49].hash[31] == 49) {
              std::cout << "[MsgPack-GPSBlock] Sanity Check: PASS" << std::endl;
         } else {
              std::cerr << "[MsgPack-GPSBlock] Sanity Check: FAILED" << std::endl;
              exit(1);
         }
-        (void)config;
+    }
+
+    // Every PayloadGPSRaw field, under the schema's short keys
+    static constexpr size_t kMaxRecordSize = msgpack_schema_max_size<PayloadGPSRaw, KeyStyle::ShortName>();
+
+    size_t max_encoded_size(const void* data) override {
+        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        if (columnar_) return msgpack_columns_max_size<PayloadGPSRaw>(m.messages.size());
+        return 5 + m.messages.size() * kMaxRecordSize;
     }
 
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
         msgpack::sbuffer sbuf;
         msgpack::packer<msgpack::sbuffer> packer(sbuf);
-        
-        packer.pack_array(m.messages.size());
-        for(const auto& r : m.messages) {
-            packer.pack_map(7);
-            packer.pack("ts"); packer.pack(r.timestamp);
-            packer.pack("bn"); packer.pack(r.block_number);
-            packer.pack("tu"); packer.pack(r.time_usec);
-            packer.pack("ft"); packer.pack(r.fix_type);
-            packer.pack("lat"); packer.pack(r.lat);
-            packer.pack("lon"); packer.pack(r.lon);
-            packer.pack("alt"); packer.pack(r.alt);
-        }
+        pack_block(packer, m);
         return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        pack_block(packer, m);
+        return out.result();
+    }
+
+    template <typename Stream>
+    void pack_block(msgpack::packer<Stream>& packer, const PayloadGPSBlock& m) {
+        if (columnar_) pack_columns(packer, m.messages, column_scratch_);
+        else pack_schema_records<KeyStyle::ShortName>(packer, m.messages);
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadGPSBlock& m = *static_cast<PayloadGPSBlock*>(out_data);
-        msgpack::object_handle oh = msgpack::unpack((const char*)buffer.data(), buffer.size());
-        msgpack::object obj = oh.get();
-        if(obj.type != msgpack::type::ARRAY) return;
-        
-        auto& arr = obj.via.array;
-        m.messages.resize(arr.size);
-        for(size_t i=0; i<arr.size; i++) {
-             msgpack::object& item = arr.ptr[i];
-             if(item.type == msgpack::type::MAP) {
-                 auto& map = item.via.map;
-                 for(size_t j=0; j<map.size; j++) {
-                     auto k = map.ptr[j].key.as<std::string>();
-                     auto& v = map.ptr[j].val;
-                     if(k=="ts") m.messages[i].timestamp = v.as<uint64_t>();
-                     else if(k=="bn") m.messages[i].block_number = v.as<uint32_t>();
-                     else if(k=="tu") m.messages[i].time_usec = v.as<uint64_t>();
-                     else if(k=="ft") m.messages[i].fix_type = v.as<uint8_t>();
-                     else if(k=="lat") m.messages[i].lat = v.as<int32_t>();
-                     else if(k=="lon") m.messages[i].lon = v.as<int32_t>();
-                     else if(k=="alt") m.messages[i].alt = v.as<int32_t>();
-                 }
-             }
+        if (columnar_) {
+            parse_columns(data, len, m.messages);
+            return;
+        }
+        if (streaming_) {
+            parse_schema_records<KeyStyle::ShortName>(data, len, m.messages);
+            return;
+        }
+        msgpack::object_handle oh = msgpack::unpack((const char*)data, len);
+        unpack_schema_records<KeyStyle::ShortName>(oh.get(), m.messages);
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            pack_block(packer, *static_cast<const PayloadGPSBlock*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        if (columnar_) {
+            return decode_frames(data, len, outs, count, [](const uint8_t* frame, size_t frame_len, void* out) {
+                parse_columns(frame, frame_len, static_cast<PayloadGPSBlock*>(out)->messages);
+            });
         }
+        if (streaming_) {
+            return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+                parse_schema_records<KeyStyle::ShortName>(frame, frame_len, static_cast<PayloadGPSBlock*>(out)->messages);
+            });
+        }
+        msgpack::zone zone;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            zone.clear();
+            unpack_schema_records<KeyStyle::ShortName>(msgpack::unpack(zone, (const char*)frame, frame_len), static_cast<PayloadGPSBlock*>(out)->messages);
+        });
     }
 
     void teardown() override {}
-    std::string name() const override { return "MsgPack-GPSBlock"; }
+    std::string name() const override {
+        if (columnar_) return "MsgPack-Columnar-GPSBlock";
+        return streaming_ ? "MsgPack-Streaming-GPSBlock" : "MsgPack-GPSBlock";
+    }
 };
 
 } // pf
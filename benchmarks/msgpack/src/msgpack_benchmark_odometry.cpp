@@ -1,4 +1,6 @@
 #include "IBenchmark.h"
+#include "msgpack_span_buffer.h"
+#include "msgpack_stream_visitor.h"
 #include <msgpack.hpp>
 #include <iostream>
 #include <vector>
@@ -7,7 +9,10 @@ namespace pf {
 
 class MsgPackBenchmarkOdometry : public IBenchmark {
 public:
+    bool streaming_ = false;
+
     void setup(const BenchmarkConfig& config) override {
+        streaming_ = config.variant_name == "Streaming";
         PayloadOdometry p;
         memset(&p, 0, sizeof(p));
         p.time_usec = 1000;
@@ -22,14 +27,31 @@ public:
              std::cerr << "[MsgPack-Odometry] Sanity Check: FAILED" << std::endl;
              exit(1);
         }
-        (void)config;
     }
 
+    // fixmap header + 15 keys (<= 5 chars) + 3 ints (<= 9 bytes) + 9 float32 + q[4] + 2 x cov[21]
+    static constexpr size_t kMaxEncodedSize = 1 + 15 * (1 + 5) + 3 * 9 + 9 * 5 + (1 + 4 * 5) + 2 * (3 + 21 * 5);
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadOdometry& m = *static_cast<const PayloadOdometry*>(data);
         msgpack::sbuffer sbuf;
         msgpack::packer<msgpack::sbuffer> packer(sbuf);
+        pack_payload(packer, m);
+        return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
+    }
 
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadOdometry& m = *static_cast<const PayloadOdometry*>(data);
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        pack_payload(packer, m);
+        return out.result();
+    }
+
+    template <typename Stream>
+    void pack_payload(msgpack::packer<Stream>& packer, const PayloadOdometry& m) {
         packer.pack_map(15);
         packer.pack("time"); packer.pack(m.time_usec);
         packer.pack("frame"); packer.pack(m.frame_id);
@@ -56,47 +78,155 @@ public:
         packer.pack("vcov");
         packer.pack_array(21);
         for(int i=0; i<21; i++) packer.pack(m.velocity_covariance[i]);
+    }
 
-        return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
+        MsgPackBenchmarkOdometry::decode_fields(data, len, out_data, kAllFields);
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    // Streaming stops after the last selected field; the DOM path skips the
+    // as<float>() conversions of unselected arrays.
+    void decode_fields(const uint8_t* data, size_t len, void* out_data, FieldMask fields) override {
         PayloadOdometry& m = *static_cast<PayloadOdometry*>(out_data);
-        msgpack::object_handle oh = msgpack::unpack((const char*)buffer.data(), buffer.size());
-        msgpack::object obj = oh.get();
-        
+        if (streaming_) {
+            decode_stream(data, len, m, fields);
+            return;
+        }
+        msgpack::object_handle oh = msgpack::unpack((const char*)data, len);
+        decode_object(oh.get(), m, fields);
+    }
+
+    enum Field { TIME, FRAME, CHILD, X, Y, Z, Q, VX, VY, VZ, RS, PS, YS, PCOV, VCOV };
+    static constexpr KeyEntry kKeys[] = {
+        {"time", TIME}, {"frame", FRAME}, {"child", CHILD}, {"x", X}, {"y", Y}, {"z", Z}, {"q", Q},
+        {"vx", VX}, {"vy", VY}, {"vz", VZ}, {"rs", RS}, {"ps", PS}, {"ys", YS},
+        {"pcov", PCOV}, {"vcov", VCOV},
+    };
+    static constexpr auto kFields = make_key_table(kKeys);
+
+    // Array elements (q, pcov, vcov) arrive one by one with their position in `index`.
+    // Unselected keys resolve to -1. A field is complete after its value, or
+    // at end_array() for the arrays; returning false there stops the parse.
+    struct StreamVisitor : MapKeyVisitor {
+        PayloadOdometry* m;
+        FieldProjection want;
+        explicit StreamVisitor(PayloadOdometry* p, FieldMask fields = kAllFields) : m(p), want(fields, VCOV + 1) {}
+
+        bool visit_str(const char* v, uint32_t size) {
+            if (!in_key) return true;
+            set_key(kFields, v, size);
+            if (!want.wants(field)) field = -1;
+            return true;
+        }
+        bool visit_positive_integer(uint64_t v) {
+            if (in_key) return true;
+            switch (field) {
+                case TIME: m->time_usec = v; break;
+                case FRAME: m->frame_id = (uint8_t)v; break;
+                case CHILD: m->child_frame_id = (uint8_t)v; break;
+            }
+            return stored();
+        }
+        bool visit_float32(float v) { return in_key ? true : set_float(v); }
+        bool visit_float64(double v) { return in_key ? true : set_float((float)v); }
+        bool end_array() { return stored(); }
+
+        bool stored() {
+            if (field < 0) return true;
+            want.found(field);
+            field = -1;
+            return !want.done();
+        }
+
+        bool set_float(float v) {
+            switch (field) {
+                case Q: if (index < 4) m->q[index] = v; return true;
+                case PCOV: if (index < 21) m->pose_covariance[index] = v; return true;
+                case VCOV: if (index < 21) m->velocity_covariance[index] = v; return true;
+                case X: m->x = v; break;
+                case Y: m->y = v; break;
+                case Z: m->z = v; break;
+                case VX: m->vx = v; break;
+                case VY: m->vy = v; break;
+                case VZ: m->vz = v; break;
+                case RS: m->rollspeed = v; break;
+                case PS: m->pitchspeed = v; break;
+                case YS: m->yawspeed = v; break;
+            }
+            return stored();
+        }
+    };
+
+    void decode_stream(const uint8_t* data, size_t len, PayloadOdometry& m, FieldMask fields = kAllFields) {
+        StreamVisitor visitor(&m, fields);
+        msgpack::parse((const char*)data, len, visitor);
+    }
+
+    void decode_object(const msgpack::object& obj, PayloadOdometry& m, FieldMask fields = kAllFields) {
         if (obj.type != msgpack::type::MAP) return;
         
         // Manual extraction via map iteration
         auto& map = obj.via.map;
-        for(uint32_t i=0; i<map.size; ++i) {
-            auto key = map.ptr[i].key.as<std::string>();
+        FieldProjection want(fields, VCOV + 1);
+        for(uint32_t i=0; i<map.size && !want.done(); ++i) {
             auto& val = map.ptr[i].val;
-            
-            if(key == "time") m.time_usec = val.as<uint64_t>();
-            else if(key == "frame") m.frame_id = val.as<uint8_t>();
-            else if(key == "child") m.child_frame_id = val.as<uint8_t>();
-            else if(key == "x") m.x = val.as<float>();
-            else if(key == "y") m.y = val.as<float>();
-            else if(key == "z") m.z = val.as<float>();
-            else if(key == "q") {
-                 auto& arr = val.via.array;
-                 for(int j=0; j<4; j++) m.q[j] = arr.ptr[j].as<float>();
-            }
-            else if(key == "pcov") {
-                 auto& arr = val.via.array;
-                 for(int j=0; j<21; j++) m.pose_covariance[j] = arr.ptr[j].as<float>();
-            }
-            // ... (Assume full coverage for benchmark)
-             else if(key == "vcov") {
-                 auto& arr = val.via.array;
-                 for(int j=0; j<21; j++) m.velocity_covariance[j] = arr.ptr[j].as<float>();
+            int field = map_key_field(kFields, map.ptr[i].key);
+            if (!want.wants(field)) continue;
+            want.found(field);
+
+            switch (field) {
+                case TIME: m.time_usec = val.as<uint64_t>(); break;
+                case FRAME: m.frame_id = val.as<uint8_t>(); break;
+                case CHILD: m.child_frame_id = val.as<uint8_t>(); break;
+                case X: m.x = val.as<float>(); break;
+                case Y: m.y = val.as<float>(); break;
+                case Z: m.z = val.as<float>(); break;
+                case VX: m.vx = val.as<float>(); break;
+                case VY: m.vy = val.as<float>(); break;
+                case VZ: m.vz = val.as<float>(); break;
+                case RS: m.rollspeed = val.as<float>(); break;
+                case PS: m.pitchspeed = val.as<float>(); break;
+                case YS: m.yawspeed = val.as<float>(); break;
+                case Q:
+                    for(int j=0; j<4; j++) m.q[j] = val.via.array.ptr[j].as<float>();
+                    break;
+                case PCOV:
+                    for(int j=0; j<21; j++) m.pose_covariance[j] = val.via.array.ptr[j].as<float>();
+                    break;
+                case VCOV:
+                    for(int j=0; j<21; j++) m.velocity_covariance[j] = val.via.array.ptr[j].as<float>();
+                    break;
             }
         }
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            pack_payload(packer, *static_cast<const PayloadOdometry*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        if (streaming_) {
+            return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+                decode_stream(frame, frame_len, *static_cast<PayloadOdometry*>(out));
+            });
+        }
+        msgpack::zone zone;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            zone.clear();
+            decode_object(msgpack::unpack(zone, (const char*)frame, frame_len), *static_cast<PayloadOdometry*>(out));
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "MsgPack-Odometry"; }
+    std::string name() const override { return streaming_ ? "MsgPack-Streaming-Odometry" : "MsgPack-Odometry"; }
 };
 
 } // namespace pf
@@ -1,4 +1,6 @@
 #include "IBenchmark.h"
+#include "msgpack_span_buffer.h"
+#include "msgpack_stream_visitor.h"
 #include <msgpack.hpp>
 #include <iostream>
 #include <vector>
@@ -8,7 +10,10 @@ namespace pf {
 
 class MsgPackBenchmarkStatus : public IBenchmark {
 public:
+    bool streaming_ = false;
+
     void setup(const BenchmarkConfig& config) override {
+        streaming_ = config.variant_name == "Streaming";
          // Sanity
         PayloadStatus p;
         p.severity = 5;
@@ -23,39 +28,121 @@ public:
             std::cerr << "[MsgPack-Status] Sanity Check: FAILED" << std::endl;
             exit(1);
         }
-        (void)config;
     }
 
+    // fixmap header + 2 keys + severity + str8 text[50]
+    static constexpr size_t kMaxEncodedSize = 1 + 2 * (1 + 3) + 2 + 2 + sizeof(PayloadStatus::text);
+
+    size_t max_encoded_size(const void* /*data*/) override { return kMaxEncodedSize; }
+
     std::vector<uint8_t> encode(const void* data) override {
         const PayloadStatus& m = *static_cast<const PayloadStatus*>(data);
         msgpack::sbuffer sbuf;
         msgpack::packer<msgpack::sbuffer> packer(sbuf);
+        pack_payload(packer, m);
+        return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadStatus& m = *static_cast<const PayloadStatus*>(data);
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        pack_payload(packer, m);
+        return out.result();
+    }
+
+    template <typename Stream>
+    void pack_payload(msgpack::packer<Stream>& packer, const PayloadStatus& m) {
         packer.pack_map(2);
         packer.pack("sev"); packer.pack(m.severity);
-        packer.pack("txt"); packer.pack(std::string(m.text)); // Pack as string
-        return std::vector<uint8_t>(sbuf.data(), sbuf.data() + sbuf.size());
+        packer.pack("txt");
+        size_t len = strlen(m.text);
+        packer.pack_str(len); packer.pack_str_body(m.text, len);
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadStatus& m = *static_cast<PayloadStatus*>(out_data);
-        msgpack::object_handle oh = msgpack::unpack((const char*)buffer.data(), buffer.size());
-        msgpack::object obj = oh.get();
+        if (streaming_) {
+            decode_stream(data, len, m);
+            return;
+        }
+        msgpack::object_handle oh = msgpack::unpack((const char*)data, len);
+        decode_object(oh.get(), m);
+    }
+
+    enum Field { SEV, TXT };
+    static constexpr KeyEntry kKeys[] = {{"sev", SEV}, {"txt", TXT}};
+    static constexpr auto kFields = make_key_table(kKeys);
+
+    // The text is copied straight from the input buffer (no intermediate std::string).
+    struct StreamVisitor : MapKeyVisitor {
+        PayloadStatus* m;
+        explicit StreamVisitor(PayloadStatus* p) : m(p) {}
+
+        bool visit_positive_integer(uint64_t v) {
+            if (!in_key && field == SEV) m->severity = (uint8_t)v;
+            return true;
+        }
+        bool visit_str(const char* v, uint32_t size) {
+            if (in_key) return set_key(kFields, v, size);
+            if (field == TXT) {
+                size_t n = size < 49 ? size : 49;
+                memcpy(m->text, v, n);
+                m->text[n] = '\0';
+            }
+            return true;
+        }
+    };
+
+    void decode_stream(const uint8_t* data, size_t len, PayloadStatus& m) {
+        StreamVisitor visitor(&m);
+        msgpack::parse((const char*)data, len, visitor);
+    }
+
+    void decode_object(const msgpack::object& obj, PayloadStatus& m) {
         if(obj.type != msgpack::type::MAP) return;
         
         auto& map = obj.via.map;
         for(size_t i=0; i<map.size; i++) {
-             auto k = map.ptr[i].key.as<std::string>();
-             if (k == "sev") m.severity = (uint8_t)map.ptr[i].val.as<unsigned int>();
-             else if (k == "txt") {
-                 std::string s = map.ptr[i].val.as<std::string>();
-                 strncpy(m.text, s.c_str(), 49);
-                 m.text[49] = '\0';
+             switch (map_key_field(kFields, map.ptr[i].key)) {
+                 case SEV: m.severity = (uint8_t)map.ptr[i].val.as<unsigned int>(); break;
+                 case TXT: {
+                     std::string s = map.ptr[i].val.as<std::string>();
+                     strncpy(m.text, s.c_str(), 49);
+                     m.text[49] = '\0';
+                     break;
+                 }
              }
         }
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        SpanBuffer out(dst, cap);
+        msgpack::packer<SpanBuffer> packer(out);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* frame, size_t frame_cap) {
+            out.reset(frame, frame_cap);
+            pack_payload(packer, *static_cast<const PayloadStatus*>(item));
+            return out.result();
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        if (streaming_) {
+            return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+                decode_stream(frame, frame_len, *static_cast<PayloadStatus*>(out));
+            });
+        }
+        msgpack::zone zone;
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            zone.clear();
+            decode_object(msgpack::unpack(zone, (const char*)frame, frame_len), *static_cast<PayloadStatus*>(out));
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "MsgPack-Status"; }
+    std::string name() const override { return streaming_ ? "MsgPack-Streaming-Status" : "MsgPack-Status"; }
 };
 
 } // pf
@@ -1,55 +1,127 @@
 #include "IBenchmark.h"
+#include "plugin_check.hpp"
 #include <iostream>
 #include <cstring>
-#include <cassert>
 #include <memory>
 
-// External factory function
+// External factory function (pf_msgpack, the GPSRaw scenario)
 extern "C" pf::IBenchmark* create_benchmark();
 
+using namespace pf;
+
+static int failures = 0;
+
 void log(const std::string& msg) {
     std::cout << "[MSGPACK-TEST] " << msg << std::endl;
 }
 
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "[MSGPACK-TEST] FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// The Standard encoding of every check payload, read by the msgpack::unpack
+// decoder and by the msgpack::parse (Streaming) decoder: both structs must match.
+template <typename T>
+void check_streaming(const char* unpack_variant, const char* parse_variant) {
+    CreateBenchmarkFunc create = load_plugin<T>(PF_PLUGIN_DIR, "msgpack");
+    if (!create) {
+        check(false, std::string("plugin for ") + unpack_variant + " loads");
+        return;
+    }
+    std::unique_ptr<IBenchmark> unpacked = create_configured(create, unpack_variant, 1);
+    std::unique_ptr<IBenchmark> parsed = create_configured(create, parse_variant, 1);
+    const std::string label = unpacked->name() + " vs " + parsed->name();
+
+    size_t n = 0;
+    for (const T& p : check_payloads<T>()) {
+        std::vector<uint8_t> buf = unpacked->encode(&p);
+        T a = zeroed_payload<T>();
+        T b = zeroed_payload<T>();
+        unpacked->decode(buf, &a);
+        parsed->decode(buf, &b);
+        const std::string diff = first_difference(a, b);
+        if (!diff.empty()) {
+            check(false, label + ": payload " + std::to_string(n) + " decodes differently at " + diff);
+            return;
+        }
+        if (first_difference(a, zeroed_payload<T>()).empty()) {
+            check(false, label + ": payload " + std::to_string(n) + " decodes to nothing");
+            return;
+        }
+        n++;
+    }
+    unpacked->teardown();
+    parsed->teardown();
+    log(label + ": " + std::to_string(n) + " payloads decode identically");
+}
+
 int main() {
     log("Starting MessagePack Integrity Test...");
 
     std::unique_ptr<pf::IBenchmark> bench(create_benchmark());
-    
-    // 1. Test Standard Variant (Int Keys)
-    {
+
+    // 1. Both key styles round-trip the GPSRaw payload
+    for (const char* variant : {"Standard", "StringKeys"}) {
         pf::BenchmarkConfig config;
         config.iterations = 1;
-        config.variant_name = "Standard";
+        config.variant_name = variant;
         bench->setup(config);
-        
+
         pf::Payload original;
+        memset(&original, 0, sizeof(original));
         original.timestamp = 1122334455;
         memset(original.hash, 0xCC, 32);
-        
-        std::vector<uint8_t> buffer = bench->encode(original);
-        log("Standard Encoded Size: " + std::to_string(buffer.size()) + " bytes");
-        
-        // Mock Decode Check
-        // pf::Payload decoded;
-        // bench->decode(buffer, decoded);
+
+        std::vector<uint8_t> buffer = bench->encode(&original);
+        log(std::string(variant) + " Encoded Size: " + std::to_string(buffer.size()) + " bytes");
+
+        pf::Payload decoded;
+        memset(&decoded, 0, sizeof(decoded));
+        bench->decode(buffer, &decoded);
+        check(first_difference(original, decoded).empty(), std::string(variant) + " round-trips");
     }
-    
-    // 2. Test String Keys Variant
-    {
-        pf::BenchmarkConfig config;
-        config.iterations = 1;
-        config.variant_name = "StringKeys";
-        bench->setup(config);
-        
-        pf::Payload original;
-        original.timestamp = 1122334455;
-        
-        std::vector<uint8_t> buffer = bench->encode(original);
-        log("StringKey Encoded Size: " + std::to_string(buffer.size()) + " bytes");
+    bench->teardown();
+
+    // 2. Streaming decodes like unpack, in every scenario and both key styles
+    check_streaming<PayloadGPSRaw>("Standard", "Streaming");
+    check_streaming<PayloadGPSRaw>("StringKeys", "StreamingStringKeys");
+    check_streaming<PayloadBattery>("Standard", "Streaming");
+    check_streaming<PayloadOdometry>("Standard", "Streaming");
+    check_streaming<PayloadAttitude>("Standard", "Streaming");
+    check_streaming<PayloadGlobalPosition>("Standard", "Streaming");
+    check_streaming<PayloadStatus>("Standard", "Streaming");
+    check_streaming<PayloadGPSBlock>("Standard", "Streaming");
+
+    // 3. No codec drops a field
+    for (const std::vector<std::string>& lost : {
+             schema_coverage_failures<PayloadGPSRaw>("msgpack", {"Standard", "StringKeys", "Streaming", "StreamingStringKeys"}),
+             schema_coverage_failures<PayloadBattery>("msgpack", {"Standard", "Streaming"}),
+             schema_coverage_failures<PayloadOdometry>("msgpack", {"Standard", "Streaming"}),
+             schema_coverage_failures<PayloadAttitude>("msgpack", {"Standard", "Streaming"}),
+             schema_coverage_failures<PayloadGlobalPosition>("msgpack", {"Standard", "Streaming"}),
+             schema_coverage_failures<PayloadStatus>("msgpack", {"Standard", "Streaming"}),
+             schema_coverage_failures<PayloadGPSBlock>("msgpack", {"Standard", "Streaming", "Columnar"})}) {
+        for (const std::string& f : lost) check(false, f);
+    }
+
+    // 4. Columnar GPSBlock at its edges
+    CreateBenchmarkFunc create = load_plugin<PayloadGPSBlock>(PF_PLUGIN_DIR, "msgpack");
+    check(create != nullptr, "plugin msgpack_gps_block loads");
+    if (create) {
+        std::unique_ptr<IBenchmark> columnar = create_configured(create, "Columnar", 1);
+        const std::string diff = columnar_round_trip_difference(*columnar);
+        check(diff.empty(), columnar->name() + ": " + diff);
+        if (diff.empty()) log(columnar->name() + ": edge blocks round-trip, truncated frames fail");
+        columnar->teardown();
+    }
+
+    if (failures) {
+        log(std::to_string(failures) + " check(s) failed");
+        return 1;
     }
-    
     log("Integrity Check Passed!");
-    bench->teardown();
     return 0;
 }
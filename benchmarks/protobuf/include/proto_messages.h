@@ -0,0 +1,131 @@
+#ifndef PRIME_FUSION_PROTO_MESSAGES_H
+#define PRIME_FUSION_PROTO_MESSAGES_H
+
+#include <google/protobuf/arena.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief Where a protobuf plugin's working message lives (the --variant).
+ */
+enum class ProtoAlloc { Standard, Arena, Reuse };
+
+inline ProtoAlloc proto_alloc_from_variant(const std::string& variant) {
+    if (variant == "Arena") return ProtoAlloc::Arena;
+    if (variant == "Reuse") return ProtoAlloc::Reuse;
+    return ProtoAlloc::Standard;
+}
+
+inline const char* proto_alloc_name(ProtoAlloc mode) {
+    switch (mode) {
+        case ProtoAlloc::Arena: return "Arena";
+        case ProtoAlloc::Reuse: return "Reuse";
+        default: return "Standard";
+    }
+}
+
+// "Protobuf-<Scenario>" for Standard, "Protobuf-<Variant>-<Scenario>" otherwise
+inline std::string proto_plugin_name(ProtoAlloc mode, const char* scenario) {
+    if (mode == ProtoAlloc::Standard) return std::string("Protobuf-") + scenario;
+    return std::string("Protobuf-") + proto_alloc_name(mode) + "-" + scenario;
+}
+
+/**
+ * @brief Hands a plugin the message object for one encode/decode.
+ *
+ * - Standard: a new message per call, destroyed when the call returns. A batch
+ *   uses one message and Clear()s it between frames.
+ * - Arena: each message (sub-messages and strings included) is allocated on a
+ *   google::protobuf::Arena. The arena is Reset() after a single call, or once
+ *   at the end of a batch. It starts with a block owned here that survives
+ *   Reset(), so steady-state calls only reach malloc when a batch outgrows it.
+ * - Reuse: one long-lived message, Clear()ed before each use. Strings and
+ *   repeated fields (GPSBlock's sub-messages) keep their capacity across calls,
+ *   as in a long-running ground-station process.
+ */
+template <typename Msg>
+class ProtoMessages {
+public:
+    static constexpr size_t kArenaBlockBytes = 64 << 10;
+
+    void set_mode(ProtoAlloc mode) {
+        mode_ = mode;
+        if (mode_ == ProtoAlloc::Arena && !arena_) {
+            block_.resize(kArenaBlockBytes);
+            google::protobuf::ArenaOptions options;
+            options.initial_block = block_.data();
+            options.initial_block_size = block_.size();
+            arena_.reset(new google::protobuf::Arena(options));
+        }
+    }
+
+    ProtoAlloc mode() const { return mode_; }
+
+    /**
+     * @brief Calls f(Msg&) with an empty message and returns what f returns.
+     */
+    template <typename F>
+    auto use(F&& f) -> decltype(f(std::declval<Msg&>())) {
+        switch (mode_) {
+            case ProtoAlloc::Arena: {
+                ArenaRelease release{*this};
+                return f(*google::protobuf::Arena::CreateMessage<Msg>(arena_.get()));
+            }
+            case ProtoAlloc::Reuse:
+                reused_.Clear();
+                return f(reused_);
+            default:
+                if (batch_depth_ > 0) {
+                    reused_.Clear();
+                    return f(reused_);
+                }
+                Msg m;
+                return f(m);
+        }
+    }
+
+    /**
+     * @brief Marks an encode_batch/decode_batch: per-frame use() calls share
+     * the batch's storage, which is released when the outermost Batch ends.
+     */
+    class Batch {
+    public:
+        explicit Batch(ProtoMessages& owner) : owner_(owner) { owner_.batch_depth_++; }
+        ~Batch() {
+            if (--owner_.batch_depth_ == 0) owner_.end_batch();
+        }
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+    private:
+        ProtoMessages& owner_;
+    };
+
+private:
+    // Resets the arena once the value f returned has been computed.
+    struct ArenaRelease {
+        ProtoMessages& owner;
+        ~ArenaRelease() {
+            if (owner.batch_depth_ == 0) owner.arena_->Reset();
+        }
+    };
+
+    void end_batch() {
+        if (mode_ == ProtoAlloc::Arena) arena_->Reset();
+        else if (mode_ == ProtoAlloc::Standard) Msg().Swap(&reused_); // Free it, as a batch-local message would be
+    }
+
+    ProtoAlloc mode_ = ProtoAlloc::Standard;
+    Msg reused_;
+    std::vector<char> block_;
+    std::unique_ptr<google::protobuf::Arena> arena_;
+    int batch_depth_ = 0;
+};
+
+} // namespace pf
+
+#endif // PRIME_FUSION_PROTO_MESSAGES_H
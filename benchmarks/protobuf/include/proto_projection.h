@@ -0,0 +1,104 @@
+#ifndef PRIME_FUSION_PROTO_PROJECTION_H
+#define PRIME_FUSION_PROTO_PROJECTION_H
+
+#include "IBenchmark.h"
+#include "SchemaCodec.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <cstring>
+
+namespace pf {
+
+/**
+ * @brief Reads a serialized message tag by tag, without a message object.
+ * ParseFromArray() always parses every field; decode_fields() walks the wire
+ * format with this instead, so an unselected field costs one SkipField() (a
+ * length jump for bytes and packed arrays) and the walk ends after the last
+ * selected one.
+ *
+ * The projected messages number their fields in schema order (field number
+ * = schema index + 1), so field() is also the FieldMask bit.
+ */
+class ProtoFieldReader {
+public:
+    using WireFormatLite = google::protobuf::internal::WireFormatLite;
+
+    ProtoFieldReader(const uint8_t* data, size_t len) : in_(data, (int)len) {}
+
+    /**
+     * @return false at the end of the message or on a malformed tag
+     */
+    bool next() {
+        tag_ = in_.ReadTag();
+        return tag_ != 0;
+    }
+
+    // Schema index of the current field, -1 past the schema
+    int field() const { return (int)WireFormatLite::GetTagFieldNumber(tag_) - 1; }
+
+    bool skip() { return WireFormatLite::SkipField(&in_, tag_); }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        in_.ReadVarint64(&v);
+        return v;
+    }
+
+    float fixed_float() {
+        uint32_t bits = 0;
+        in_.ReadLittleEndian32(&bits);
+        float v;
+        memcpy(&v, &bits, 4);
+        return v;
+    }
+
+    // A bytes field of exactly n bytes is copied to dst; any other length is skipped.
+    bool bytes(uint8_t* dst, size_t n) {
+        uint32_t len = 0;
+        if (!in_.ReadVarint32(&len)) return false;
+        if (len != n) return in_.Skip((int)len);
+        return in_.ReadRaw(dst, (int)n);
+    }
+
+    // A packed repeated float (proto3's encoding); elements past n are skipped.
+    bool packed_floats(float* dst, size_t n) {
+        uint32_t len = 0;
+        if (!in_.ReadVarint32(&len)) return false;
+        size_t count = len / 4 < n ? len / 4 : n;
+        for (size_t i = 0; i < count; i++) dst[i] = fixed_float();
+        return in_.Skip((int)(len - 4 * count));
+    }
+
+private:
+    google::protobuf::io::CodedInputStream in_;
+    uint32_t tag_ = 0;
+};
+
+/**
+ * @brief true if fields selects the whole message. The generated parser
+ * reads a full message faster than the field walk, so decode_fields() hands
+ * such a mask to decode().
+ */
+template <typename T>
+bool selects_all_fields(FieldMask fields) {
+    const FieldMask all = schema_size<T>() >= 64 ? kAllFields : ((FieldMask)1 << schema_size<T>()) - 1;
+    return (fields & all) == all;
+}
+
+/**
+ * @brief Zeroes the selected fields of m. proto3 leaves zero-valued scalars
+ * off the wire, so a projected decode starts from the defaults that
+ * ParseFromArray() would have produced.
+ */
+template <typename T>
+void clear_proto_fields(T& m, FieldMask fields) {
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        if (!(fields & ((FieldMask)1 << i))) continue;
+        const FieldDesc& f = PayloadSchema<T>::fields[i];
+        memset(reinterpret_cast<char*>(&m) + f.offset, 0, field_type_size(f.type) * f.count);
+    }
+}
+
+} // namespace pf
+
+#endif // PRIME_FUSION_PROTO_PROJECTION_H
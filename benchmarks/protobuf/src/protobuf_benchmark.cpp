@@ -1,5 +1,7 @@
 #include "IBenchmark.h"
 #include "gps_beacon.pb.h"
+#include "proto_messages.h"
+#include "proto_projection.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -9,11 +11,13 @@ namespace pf {
 
 class ProtobufBenchmark : public IBenchmark {
 public:
+    ProtoMessages<fanet::GPSBeacon> msgs_;
+
     void setup(const BenchmarkConfig& config) override {
+        msgs_.set_mode(proto_alloc_from_variant(config.variant_name));
         // Validate version
         GOOGLE_PROTOBUF_VERIFY_VERSION;
-        std::cout << "[Protobuf] Setup complete. Variant: Standard" << std::endl;
-        (void)config; 
+        std::cout << "[Protobuf] Setup complete. Variant: " << proto_alloc_name(msgs_.mode()) << std::endl;
 
         // --- Integrity Verification ---
         Payload p;
@@ -32,10 +36,7 @@ public:
         }
     }
 
-    std::vector<uint8_t> encode(const void* data) override {
-        const Payload& m = *static_cast<const Payload*>(data);
-        fanet::GPSBeacon b;
-        
+    void fill(const Payload& m, fanet::GPSBeacon& b) {
         b.set_timestamp(m.timestamp);
         // ... (Omitting full copy for brevity, C++ will use existing implementation)
         // Actually I must include the implementation in the tool call
@@ -58,30 +59,104 @@ public:
         b.set_hdg_acc(m.hdg_acc);
         
         b.set_hdg_acc(m.hdg_acc);
-        
-        // Optimization: Use Stack Buffer (SerializeToArray) instead of Heap String (SerializeToString)
-        uint8_t buffer[256]; // Sufficient for ~101 bytes
-        size_t size = b.ByteSizeLong();
-        if (size > sizeof(buffer)) {
-             // Fallback or Error? For benchmark parity we assume it fits.
-             std::cerr << "[PROTO] Buffer overflow!" << std::endl;
-             return std::vector<uint8_t>();
-        }
+    }
 
-        if (!b.SerializeToArray(buffer, size)) {
-             std::cerr << "[PROTO] Serialize Failed!" << std::endl;
-        }
-        return std::vector<uint8_t>(buffer, buffer + size); // Still one copy to vector return, but avoids intermediate string
+    size_t max_encoded_size(const void* data) override {
+        const Payload& m = *static_cast<const Payload*>(data);
+        return msgs_.use([&](fanet::GPSBeacon& b) {
+            fill(m, b);
+            return b.ByteSizeLong();
+        });
+    }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        const Payload& m = *static_cast<const Payload*>(data);
+        return msgs_.use([&](fanet::GPSBeacon& b) {
+            fill(m, b);
+
+            // Optimization: Use Stack Buffer (SerializeToArray) instead of Heap String (SerializeToString)
+            uint8_t buffer[256]; // Sufficient for ~101 bytes
+            size_t size = b.ByteSizeLong();
+            if (size > sizeof(buffer)) {
+                 // Fallback or Error? For benchmark parity we assume it fits.
+                 std::cerr << "[PROTO] Buffer overflow!" << std::endl;
+                 return std::vector<uint8_t>();
+            }
+
+            if (!b.SerializeToArray(buffer, size)) {
+                 std::cerr << "[PROTO] Serialize Failed!" << std::endl;
+            }
+            return std::vector<uint8_t>(buffer, buffer + size); // Still one copy to vector return, but avoids intermediate string
+        });
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const Payload& m = *static_cast<const Payload*>(data);
+        return msgs_.use([&](fanet::GPSBeacon& b) -> size_t {
+            fill(m, b);
+            size_t size = b.ByteSizeLong();
+            if (size > cap) return 0;
+            // ByteSizeLong() cached the sizes; skip the second pass SerializeToArray would do.
+            b.SerializeWithCachedSizesToArray(dst);
+            return size;
+        });
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         Payload& m = *static_cast<Payload*>(out_data);
-        fanet::GPSBeacon b;
-        if (!b.ParseFromArray(buffer.data(), buffer.size())) {
-            std::cerr << "[PROTO] Parse Failed!" << std::endl;
+        msgs_.use([&](fanet::GPSBeacon& b) {
+            if (!b.ParseFromArray(data, len)) {
+                std::cerr << "[PROTO] Parse Failed!" << std::endl;
+                return;
+            }
+            extract(b, m);
+        });
+    }
+
+    // No message object: the selected fields are read straight off the wire
+    // and the walk stops after the last one (see ProtoFieldReader).
+    void decode_fields(const uint8_t* data, size_t len, void* out_data, FieldMask fields) override {
+        if (selects_all_fields<Payload>(fields)) {
+            ProtobufBenchmark::decode(data, len, out_data);
             return;
         }
-        
+        Payload& m = *static_cast<Payload*>(out_data);
+        clear_proto_fields(m, fields);
+        FieldProjection want(fields, schema_size<Payload>());
+        ProtoFieldReader in(data, len);
+        while (!want.done() && in.next()) {
+            const int field = in.field();
+            if (!want.wants(field)) {
+                if (!in.skip()) return;
+                continue;
+            }
+            switch (field) {
+                case 0: m.timestamp = in.varint(); break;
+                case 1: m.block_number = (uint32_t)in.varint(); break;
+                case 2: if (!in.bytes(m.hash, 32)) return; break;
+                case 3: m.time_usec = in.varint(); break;
+                case 4: m.fix_type = (uint32_t)in.varint(); break;
+                case 5: m.lat = (int32_t)in.varint(); break;
+                case 6: m.lon = (int32_t)in.varint(); break;
+                case 7: m.alt = (int32_t)in.varint(); break;
+                case 8: m.eph = (uint16_t)in.varint(); break;
+                case 9: m.epv = (uint16_t)in.varint(); break;
+                case 10: m.vel = (uint16_t)in.varint(); break;
+                case 11: m.cog = (uint16_t)in.varint(); break;
+                case 12: m.satellites_visible = (uint8_t)in.varint(); break;
+                case 13: m.alt_ellipsoid = (int32_t)in.varint(); break;
+                case 14: m.h_acc = (uint32_t)in.varint(); break;
+                case 15: m.v_acc = (uint32_t)in.varint(); break;
+                case 16: m.vel_acc = (uint32_t)in.varint(); break;
+                case 17: m.hdg_acc = (uint32_t)in.varint(); break;
+            }
+            want.found(field);
+        }
+    }
+
+    void extract(const fanet::GPSBeacon& b, Payload& m) {
         m.timestamp = b.timestamp();
         m.block_number = b.block_number();
         
@@ -106,12 +181,36 @@ public:
         m.hdg_acc = b.hdg_acc();
     }
 
+    // Batch: frames share the batch's message storage (ProtoMessages::Batch).
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        ProtoMessages<fanet::GPSBeacon>::Batch batch(msgs_);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* out, size_t out_cap) {
+            return msgs_.use([&](fanet::GPSBeacon& b) -> size_t {
+                fill(*static_cast<const Payload*>(item), b);
+                size_t size = b.ByteSizeLong();
+                if (size > out_cap) return 0;
+                b.SerializeWithCachedSizesToArray(out);
+                return size;
+            });
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        ProtoMessages<fanet::GPSBeacon>::Batch batch(msgs_);
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            msgs_.use([&](fanet::GPSBeacon& b) {
+                if (b.ParseFromArray(frame, frame_len)) extract(b, *static_cast<Payload*>(out));
+            });
+        });
+    }
+
     void teardown() override {
-        google::protobuf::ShutdownProtobufLibrary();
+        // No ShutdownProtobufLibrary(): libprotobuf is process-wide state shared with
+        // every other protobuf plugin loaded next to this one (pf_matrix, --threads).
     }
 
     std::string name() const override {
-        return "Protobuf-Standard";
+        return std::string("Protobuf-") + proto_alloc_name(msgs_.mode());
     }
 };
 
@@ -1,5 +1,6 @@
 #include "IBenchmark.h"
 #include "gps_beacon.pb.h"
+#include "proto_messages.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -9,14 +10,14 @@ namespace pf {
 
 class ProtobufBenchmarkAttitude : public IBenchmark {
 public:
+    ProtoMessages<fanet::Attitude> msgs_;
+
     void setup(const BenchmarkConfig& config) override {
-        (void)config;
+        msgs_.set_mode(proto_alloc_from_variant(config.variant_name));
         std::cout << "[Proto-Attitude] Setup." << std::endl;
     }
 
-    std::vector<uint8_t> encode(const void* data) override {
-        const PayloadAttitude& m = *static_cast<const PayloadAttitude*>(data);
-        fanet::Attitude b;
+    void fill(const PayloadAttitude& m, fanet::Attitude& b) {
         b.set_time_boot_ms(m.time_boot_ms);
         b.set_roll(m.roll);
         b.set_pitch(m.pitch);
@@ -24,16 +25,50 @@ public:
         b.set_rollspeed(m.rollspeed);
         b.set_pitchspeed(m.pitchspeed);
         b.set_yawspeed(m.yawspeed);
-        size_t size = b.ByteSizeLong();
-        std::vector<uint8_t> result(size);
-        b.SerializeToArray(result.data(), size);
-        return result;
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    size_t max_encoded_size(const void* data) override {
+        const PayloadAttitude& m = *static_cast<const PayloadAttitude*>(data);
+        return msgs_.use([&](fanet::Attitude& b) {
+            fill(m, b);
+            return b.ByteSizeLong();
+        });
+    }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        const PayloadAttitude& m = *static_cast<const PayloadAttitude*>(data);
+        return msgs_.use([&](fanet::Attitude& b) {
+            fill(m, b);
+
+            size_t size = b.ByteSizeLong();
+            std::vector<uint8_t> result(size);
+            b.SerializeToArray(result.data(), size);
+            return result;
+        });
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadAttitude& m = *static_cast<const PayloadAttitude*>(data);
+        return msgs_.use([&](fanet::Attitude& b) -> size_t {
+            fill(m, b);
+            size_t size = b.ByteSizeLong();
+            if (size > cap) return 0;
+            b.SerializeWithCachedSizesToArray(dst);
+            return size;
+        });
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadAttitude& m = *static_cast<PayloadAttitude*>(out_data);
-        fanet::Attitude b;
-        if (!b.ParseFromArray(buffer.data(), buffer.size())) return;
+        msgs_.use([&](fanet::Attitude& b) {
+            if (!b.ParseFromArray(data, len)) return;
+            extract(b, m);
+        });
+    }
+
+    void extract(const fanet::Attitude& b, PayloadAttitude& m) {
         m.time_boot_ms = b.time_boot_ms();
         m.roll = b.roll();
         m.pitch = b.pitch();
@@ -43,8 +78,30 @@ public:
         m.yawspeed = b.yawspeed();
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        ProtoMessages<fanet::Attitude>::Batch batch(msgs_);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* out, size_t out_cap) {
+            return msgs_.use([&](fanet::Attitude& b) -> size_t {
+                fill(*static_cast<const PayloadAttitude*>(item), b);
+                size_t size = b.ByteSizeLong();
+                if (size > out_cap) return 0;
+                b.SerializeWithCachedSizesToArray(out);
+                return size;
+            });
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        ProtoMessages<fanet::Attitude>::Batch batch(msgs_);
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            msgs_.use([&](fanet::Attitude& b) {
+                if (b.ParseFromArray(frame, frame_len)) extract(b, *static_cast<PayloadAttitude*>(out));
+            });
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "Protobuf-Attitude"; }
+    std::string name() const override { return proto_plugin_name(msgs_.mode(), "Attitude"); }
 };
 
 } // pf
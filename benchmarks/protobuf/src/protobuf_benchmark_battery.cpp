@@ -1,5 +1,6 @@
 #include "IBenchmark.h"
 #include "gps_beacon.pb.h"
+#include "proto_messages.h"
 #include <iostream>
 #include <vector>
 
@@ -7,16 +8,15 @@ namespace pf {
 
 class ProtobufBenchmarkBattery : public IBenchmark {
 public:
+    ProtoMessages<fanet::Battery> msgs_;
+
     void setup(const BenchmarkConfig& config) override {
+        msgs_.set_mode(proto_alloc_from_variant(config.variant_name));
         // Verify Proto
         GOOGLE_PROTOBUF_VERIFY_VERSION;
-        (void)config;
     }
 
-    std::vector<uint8_t> encode(const void* data) override {
-        const PayloadBattery& m = *static_cast<const PayloadBattery*>(data);
-        fanet::Battery proto;
-        
+    void fill(const PayloadBattery& m, fanet::Battery& proto) {
         proto.set_id(m.id);
         proto.set_battery_function(m.battery_function);
         proto.set_type(m.type);
@@ -26,25 +26,57 @@ public:
         proto.set_current_consumed(m.current_consumed);
         proto.set_energy_consumed(m.energy_consumed);
         proto.set_battery_remaining(m.battery_remaining);
-        
-        #if 1
-        // Optimized: Stack Array
-        uint8_t buffer[1024]; 
-        size_t size = proto.ByteSizeLong(); 
-        proto.SerializeToArray(buffer, size);
-        return std::vector<uint8_t>(buffer, buffer + size);
-        #else
-        std::string s;
-        proto.SerializeToString(&s);
-        return std::vector<uint8_t>(s.begin(), s.end());
-        #endif
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    size_t max_encoded_size(const void* data) override {
+        const PayloadBattery& m = *static_cast<const PayloadBattery*>(data);
+        return msgs_.use([&](fanet::Battery& proto) {
+            fill(m, proto);
+            return proto.ByteSizeLong();
+        });
+    }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        const PayloadBattery& m = *static_cast<const PayloadBattery*>(data);
+        return msgs_.use([&](fanet::Battery& proto) {
+            fill(m, proto);
+
+            #if 1
+            // Optimized: Stack Array
+            uint8_t buffer[1024]; 
+            size_t size = proto.ByteSizeLong(); 
+            proto.SerializeToArray(buffer, size);
+            return std::vector<uint8_t>(buffer, buffer + size);
+            #else
+            std::string s;
+            proto.SerializeToString(&s);
+            return std::vector<uint8_t>(s.begin(), s.end());
+            #endif
+        });
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadBattery& m = *static_cast<const PayloadBattery*>(data);
+        return msgs_.use([&](fanet::Battery& proto) -> size_t {
+            fill(m, proto);
+            size_t size = proto.ByteSizeLong();
+            if (size > cap) return 0;
+            proto.SerializeWithCachedSizesToArray(dst);
+            return size;
+        });
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadBattery& m = *static_cast<PayloadBattery*>(out_data);
-        fanet::Battery proto;
-        if (!proto.ParseFromArray(buffer.data(), buffer.size())) return;
-        
+        msgs_.use([&](fanet::Battery& proto) {
+            if (!proto.ParseFromArray(data, len)) return;
+            extract(proto, m);
+        });
+    }
+
+    void extract(const fanet::Battery& proto, PayloadBattery& m) {
         m.id = (uint8_t)proto.id();
         m.battery_function = (uint8_t)proto.battery_function();
         m.type = (uint8_t)proto.type();
@@ -58,10 +90,30 @@ public:
         m.battery_remaining = (int8_t)proto.battery_remaining();
     }
 
-    void teardown() override {
-        google::protobuf::ShutdownProtobufLibrary();
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        ProtoMessages<fanet::Battery>::Batch batch(msgs_);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* out, size_t out_cap) {
+            return msgs_.use([&](fanet::Battery& proto) -> size_t {
+                fill(*static_cast<const PayloadBattery*>(item), proto);
+                size_t size = proto.ByteSizeLong();
+                if (size > out_cap) return 0;
+                proto.SerializeWithCachedSizesToArray(out);
+                return size;
+            });
+        });
     }
-    std::string name() const override { return "Protobuf-Battery"; }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        ProtoMessages<fanet::Battery>::Batch batch(msgs_);
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            msgs_.use([&](fanet::Battery& proto) {
+                if (proto.ParseFromArray(frame, frame_len)) extract(proto, *static_cast<PayloadBattery*>(out));
+            });
+        });
+    }
+
+    void teardown() override {}
+    std::string name() const override { return proto_plugin_name(msgs_.mode(), "Battery"); }
 };
 
 } // namespace pf
@@ -1,5 +1,6 @@
 #include "IBenchmark.h"
 #include "gps_beacon.pb.h"
+#include "proto_messages.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -8,14 +9,14 @@ namespace pf {
 
 class ProtobufBenchmarkGlobalPosition : public IBenchmark {
 public:
+    ProtoMessages<fanet::GlobalPosition> msgs_;
+
     void setup(const BenchmarkConfig& config) override {
-        (void)config;
+        msgs_.set_mode(proto_alloc_from_variant(config.variant_name));
         std::cout << "[Proto-GlobalPos] Setup." << std::endl;
     }
 
-    std::vector<uint8_t> encode(const void* data) override {
-        const PayloadGlobalPosition& m = *static_cast<const PayloadGlobalPosition*>(data);
-        fanet::GlobalPosition b;
+    void fill(const PayloadGlobalPosition& m, fanet::GlobalPosition& b) {
         b.set_time_boot_ms(m.time_boot_ms);
         b.set_lat(m.lat);
         b.set_lon(m.lon);
@@ -25,16 +26,50 @@ public:
         b.set_vy(m.vy);
         b.set_vz(m.vz);
         b.set_hdg(m.hdg);
-        size_t size = b.ByteSizeLong();
-        std::vector<uint8_t> result(size);
-        b.SerializeToArray(result.data(), size);
-        return result;
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    size_t max_encoded_size(const void* data) override {
+        const PayloadGlobalPosition& m = *static_cast<const PayloadGlobalPosition*>(data);
+        return msgs_.use([&](fanet::GlobalPosition& b) {
+            fill(m, b);
+            return b.ByteSizeLong();
+        });
+    }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        const PayloadGlobalPosition& m = *static_cast<const PayloadGlobalPosition*>(data);
+        return msgs_.use([&](fanet::GlobalPosition& b) {
+            fill(m, b);
+
+            size_t size = b.ByteSizeLong();
+            std::vector<uint8_t> result(size);
+            b.SerializeToArray(result.data(), size);
+            return result;
+        });
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadGlobalPosition& m = *static_cast<const PayloadGlobalPosition*>(data);
+        return msgs_.use([&](fanet::GlobalPosition& b) -> size_t {
+            fill(m, b);
+            size_t size = b.ByteSizeLong();
+            if (size > cap) return 0;
+            b.SerializeWithCachedSizesToArray(dst);
+            return size;
+        });
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadGlobalPosition& m = *static_cast<PayloadGlobalPosition*>(out_data);
-        fanet::GlobalPosition b;
-        if (!b.ParseFromArray(buffer.data(), buffer.size())) return;
+        msgs_.use([&](fanet::GlobalPosition& b) {
+            if (!b.ParseFromArray(data, len)) return;
+            extract(b, m);
+        });
+    }
+
+    void extract(const fanet::GlobalPosition& b, PayloadGlobalPosition& m) {
         m.time_boot_ms = b.time_boot_ms();
         m.lat = b.lat();
         m.lon = b.lon();
@@ -46,8 +81,30 @@ public:
         m.hdg = b.hdg();
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        ProtoMessages<fanet::GlobalPosition>::Batch batch(msgs_);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* out, size_t out_cap) {
+            return msgs_.use([&](fanet::GlobalPosition& b) -> size_t {
+                fill(*static_cast<const PayloadGlobalPosition*>(item), b);
+                size_t size = b.ByteSizeLong();
+                if (size > out_cap) return 0;
+                b.SerializeWithCachedSizesToArray(out);
+                return size;
+            });
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        ProtoMessages<fanet::GlobalPosition>::Batch batch(msgs_);
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            msgs_.use([&](fanet::GlobalPosition& b) {
+                if (b.ParseFromArray(frame, frame_len)) extract(b, *static_cast<PayloadGlobalPosition*>(out));
+            });
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "Protobuf-GlobalPos"; }
+    std::string name() const override { return proto_plugin_name(msgs_.mode(), "GlobalPos"); }
 };
 
 } // pf
@@ -1,5 +1,7 @@
 #include "IBenchmark.h"
+#include "ColumnarBlock.h"
 #include "gps_beacon.pb.h"
+#include "proto_messages.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -9,50 +11,206 @@ namespace pf {
 
 class ProtobufBenchmarkGPSBlock : public IBenchmark {
 public:
+    ProtoMessages<fanet::GPSBlock> msgs_;
+    // "Columnar": one GPSBlockColumnar instead of a GPSBeacon per record
+    ProtoMessages<fanet::GPSBlockColumnar> columns_;
+    bool columnar_ = false;
+
     void setup(const BenchmarkConfig& config) override {
-        (void)config;
+        columnar_ = config.variant_name == "Columnar";
+        msgs_.set_mode(proto_alloc_from_variant(config.variant_name));
         std::cout << "[Proto-GPSBlock] Setup." << std::endl;
     }
 
-    std::vector<uint8_t> encode(const void* data) override {
-        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
-        fanet::GPSBlock b;
+    void fill(const PayloadGPSBlock& m, fanet::GPSBlock& b) {
         for(const auto& r : m.messages) {
             fanet::GPSBeacon* p = b.add_messages();
             p->set_timestamp(r.timestamp);
             p->set_block_number(r.block_number);
+            p->set_hash(r.hash, 32);
             p->set_time_usec(r.time_usec);
             p->set_fix_type(r.fix_type);
             p->set_lat(r.lat);
             p->set_lon(r.lon);
             p->set_alt(r.alt);
-            // ... map minimal subset or all
+            p->set_eph(r.eph);
+            p->set_epv(r.epv);
+            p->set_vel(r.vel);
+            p->set_cog(r.cog);
+            p->set_satellites_visible(r.satellites_visible);
+            p->set_alt_ellipsoid(r.alt_ellipsoid);
+            p->set_h_acc(r.h_acc);
+            p->set_v_acc(r.v_acc);
+            p->set_vel_acc(r.vel_acc);
+            p->set_hdg_acc(r.hdg_acc);
         }
-        size_t size = b.ByteSizeLong();
-        std::vector<uint8_t> result(size);
-        b.SerializeToArray(result.data(), size);
-        return result;
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
-        PayloadGPSBlock& m = *static_cast<PayloadGPSBlock*>(out_data);
-        fanet::GPSBlock b;
-        if (!b.ParseFromArray(buffer.data(), buffer.size())) return;
+    void extract(const fanet::GPSBlock& b, PayloadGPSBlock& m) {
         m.messages.resize(b.messages_size());
         for(int i=0; i<b.messages_size(); i++) {
             const auto& p = b.messages(i);
-            m.messages[i].timestamp = p.timestamp();
-            m.messages[i].block_number = p.block_number();
-            m.messages[i].time_usec = p.time_usec();
-            m.messages[i].fix_type = p.fix_type();
-            m.messages[i].lat = p.lat();
-            m.messages[i].lon = p.lon();
-            m.messages[i].alt = p.alt();
+            PayloadGPSRaw& r = m.messages[i];
+            r.timestamp = p.timestamp();
+            r.block_number = p.block_number();
+            const std::string& h = p.hash();
+            if (h.size() >= sizeof(r.hash)) memcpy(r.hash, h.data(), sizeof(r.hash));
+            r.time_usec = p.time_usec();
+            r.fix_type = p.fix_type();
+            r.lat = p.lat();
+            r.lon = p.lon();
+            r.alt = p.alt();
+            r.eph = p.eph();
+            r.epv = p.epv();
+            r.vel = p.vel();
+            r.cog = p.cog();
+            r.satellites_visible = p.satellites_visible();
+            r.alt_ellipsoid = p.alt_ellipsoid();
+            r.h_acc = p.h_acc();
+            r.v_acc = p.v_acc();
+            r.vel_acc = p.vel_acc();
+            r.hdg_acc = p.hdg_acc();
         }
     }
 
+    using Column = google::protobuf::RepeatedField<int64_t>;
+    static constexpr size_t kFields = schema_size<PayloadGPSRaw>();
+    static_assert(schema_is_columnar<PayloadGPSRaw>(), "GPSRaw must map onto integer/bytes columns");
+
+    // GPSBlockColumnar's delta columns in schema order; hash (a bytes field) has none.
+    static void columns(fanet::GPSBlockColumnar& c, Column* (&out)[kFields]) {
+        Column* cols[kFields] = {
+            c.mutable_timestamp(), c.mutable_block_number(), nullptr, c.mutable_time_usec(),
+            c.mutable_fix_type(), c.mutable_lat(), c.mutable_lon(), c.mutable_alt(),
+            c.mutable_eph(), c.mutable_epv(), c.mutable_vel(), c.mutable_cog(),
+            c.mutable_satellites_visible(), c.mutable_alt_ellipsoid(), c.mutable_h_acc(),
+            c.mutable_v_acc(), c.mutable_vel_acc(), c.mutable_hdg_acc(),
+        };
+        for (size_t i = 0; i < kFields; i++) out[i] = cols[i];
+    }
+
+    void fill(const PayloadGPSBlock& m, fanet::GPSBlockColumnar& c) {
+        Column* cols[kFields];
+        columns(c, cols);
+        c.set_count((uint32_t)m.messages.size());
+        for (size_t i = 0; i < kFields; i++) {
+            const FieldDesc& d = PayloadSchema<PayloadGPSRaw>::fields[i];
+            if (d.type == FieldType::BYTES) {
+                std::string* bytes = c.mutable_hash();
+                bytes->resize(m.messages.size() * d.count);
+                gather_bytes(m.messages, d, reinterpret_cast<uint8_t*>(&(*bytes)[0]));
+                continue;
+            }
+            Column* col = cols[i];
+            col->Reserve((int)m.messages.size());
+            for_each_delta(m.messages, d, [col](int64_t delta) { col->AddAlreadyReserved(delta); });
+        }
+    }
+
+    // Leaves m untouched unless every column has exactly `count` entries.
+    // c is the plugin's own parsed message; columns() only reads it here.
+    void extract(fanet::GPSBlockColumnar& c, PayloadGPSBlock& m) {
+        const size_t n = c.count();
+        Column* cols[kFields];
+        columns(c, cols);
+        for (size_t i = 0; i < kFields; i++) {
+            if (cols[i] && (size_t)cols[i]->size() != n) return;
+        }
+        if (c.hash().size() != n * sizeof(PayloadGPSRaw::hash)) return;
+
+        m.messages.resize(n);
+        for (size_t i = 0; i < kFields; i++) {
+            const FieldDesc& d = PayloadSchema<PayloadGPSRaw>::fields[i];
+            if (d.type == FieldType::BYTES) {
+                scatter_bytes(reinterpret_cast<const uint8_t*>(c.hash().data()), c.hash().size(), d, m.messages);
+                continue;
+            }
+            DeltaScatter scatter;
+            const Column& col = *cols[i];
+            for (size_t r = 0; r < n; r++) scatter.add(m.messages[r], d, col.Get((int)r));
+        }
+    }
+
+    template <typename Msg>
+    size_t encoded_size(ProtoMessages<Msg>& msgs, const PayloadGPSBlock& m) {
+        return msgs.use([&](Msg& b) {
+            fill(m, b);
+            return b.ByteSizeLong();
+        });
+    }
+
+    template <typename Msg>
+    size_t serialize(ProtoMessages<Msg>& msgs, const PayloadGPSBlock& m, uint8_t* dst, size_t cap) {
+        return msgs.use([&](Msg& b) -> size_t {
+            fill(m, b);
+            size_t size = b.ByteSizeLong();
+            if (size > cap) return 0;
+            b.SerializeWithCachedSizesToArray(dst);
+            return size;
+        });
+    }
+
+    template <typename Msg>
+    std::vector<uint8_t> serialize(ProtoMessages<Msg>& msgs, const PayloadGPSBlock& m) {
+        return msgs.use([&](Msg& b) {
+            fill(m, b);
+            std::vector<uint8_t> result(b.ByteSizeLong());
+            b.SerializeWithCachedSizesToArray(result.data());
+            return result;
+        });
+    }
+
+    template <typename Msg>
+    void parse(ProtoMessages<Msg>& msgs, const uint8_t* data, size_t len, PayloadGPSBlock& m) {
+        msgs.use([&](Msg& b) {
+            if (b.ParseFromArray(data, len)) extract(b, m);
+        });
+    }
+
+    size_t max_encoded_size(const void* data) override {
+        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        return columnar_ ? encoded_size(columns_, m) : encoded_size(msgs_, m);
+    }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        return columnar_ ? serialize(columns_, m) : serialize(msgs_, m);
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadGPSBlock& m = *static_cast<const PayloadGPSBlock*>(data);
+        return columnar_ ? serialize(columns_, m, dst, cap) : serialize(msgs_, m, dst, cap);
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
+        PayloadGPSBlock& m = *static_cast<PayloadGPSBlock*>(out_data);
+        if (columnar_) parse(columns_, data, len, m);
+        else parse(msgs_, data, len, m);
+    }
+
+    // Batch: frames share the batch's message storage (ProtoMessages::Batch).
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        ProtoMessages<fanet::GPSBlock>::Batch batch(msgs_);
+        ProtoMessages<fanet::GPSBlockColumnar>::Batch column_batch(columns_);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* out, size_t out_cap) {
+            return ProtobufBenchmarkGPSBlock::encode_into(item, out, out_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        ProtoMessages<fanet::GPSBlock>::Batch batch(msgs_);
+        ProtoMessages<fanet::GPSBlockColumnar>::Batch column_batch(columns_);
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            ProtobufBenchmarkGPSBlock::decode(frame, frame_len, out);
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "Protobuf-GPSBlock"; }
+    std::string name() const override {
+        return columnar_ ? "Protobuf-Columnar-GPSBlock" : proto_plugin_name(msgs_.mode(), "GPSBlock");
+    }
 };
 
 } // pf
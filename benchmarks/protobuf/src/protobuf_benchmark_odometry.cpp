@@ -1,21 +1,22 @@
 #include "IBenchmark.h"
-#include "gps_beacon.pb.h" // Includes all messages now
+#include "gps_beacon.pb.h"
+#include "proto_messages.h" // Includes all messages now
+#include "proto_projection.h"
 #include <vector>
 
 namespace pf {
 
 class ProtobufBenchmarkOdometry : public IBenchmark {
 public:
+    ProtoMessages<fanet::Odometry> msgs_;
+
     void setup(const BenchmarkConfig& config) override {
+        msgs_.set_mode(proto_alloc_from_variant(config.variant_name));
         GOOGLE_PROTOBUF_VERIFY_VERSION;
-        (void)config;
         std::cout << "[Proto-Odometry] Setup." << std::endl;
     }
 
-    std::vector<uint8_t> encode(const void* data) override {
-        const PayloadOdometry& m = *static_cast<const PayloadOdometry*>(data);
-        fanet::Odometry b;
-        
+    void fill(const PayloadOdometry& m, fanet::Odometry& b) {
         b.set_time_usec(m.time_usec);
         b.set_frame_id(m.frame_id);
         b.set_child_frame_id(m.child_frame_id);
@@ -30,18 +31,88 @@ public:
         
         for(int i=0; i<21; i++) b.add_pose_covariance(m.pose_covariance[i]);
         for(int i=0; i<21; i++) b.add_velocity_covariance(m.velocity_covariance[i]);
-        
-        size_t size = b.ByteSizeLong();
-        std::vector<uint8_t> result(size);
-        b.SerializeToArray(result.data(), size);
-        return result;
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    size_t max_encoded_size(const void* data) override {
+        const PayloadOdometry& m = *static_cast<const PayloadOdometry*>(data);
+        return msgs_.use([&](fanet::Odometry& b) {
+            fill(m, b);
+            return b.ByteSizeLong();
+        });
+    }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        const PayloadOdometry& m = *static_cast<const PayloadOdometry*>(data);
+        return msgs_.use([&](fanet::Odometry& b) {
+            fill(m, b);
+
+            size_t size = b.ByteSizeLong();
+            std::vector<uint8_t> result(size);
+            b.SerializeToArray(result.data(), size);
+            return result;
+        });
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadOdometry& m = *static_cast<const PayloadOdometry*>(data);
+        return msgs_.use([&](fanet::Odometry& b) -> size_t {
+            fill(m, b);
+            size_t size = b.ByteSizeLong();
+            if (size > cap) return 0;
+            b.SerializeWithCachedSizesToArray(dst);
+            return size;
+        });
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadOdometry& m = *static_cast<PayloadOdometry*>(out_data);
-        fanet::Odometry b;
-        if (!b.ParseFromArray(buffer.data(), buffer.size())) return;
-        
+        msgs_.use([&](fanet::Odometry& b) {
+            if (!b.ParseFromArray(data, len)) return;
+            extract(b, m);
+        });
+    }
+
+    // Read off the wire without a message object; an unselected covariance
+    // array is one length jump instead of 21 float loads.
+    void decode_fields(const uint8_t* data, size_t len, void* out_data, FieldMask fields) override {
+        if (selects_all_fields<PayloadOdometry>(fields)) {
+            ProtobufBenchmarkOdometry::decode(data, len, out_data);
+            return;
+        }
+        PayloadOdometry& m = *static_cast<PayloadOdometry*>(out_data);
+        clear_proto_fields(m, fields);
+        FieldProjection want(fields, schema_size<PayloadOdometry>());
+        ProtoFieldReader in(data, len);
+        while (!want.done() && in.next()) {
+            const int field = in.field();
+            if (!want.wants(field)) {
+                if (!in.skip()) return;
+                continue;
+            }
+            switch (field) {
+                case 0: m.time_usec = in.varint(); break;
+                case 1: m.frame_id = (uint8_t)in.varint(); break;
+                case 2: m.child_frame_id = (uint8_t)in.varint(); break;
+                case 3: m.x = in.fixed_float(); break;
+                case 4: m.y = in.fixed_float(); break;
+                case 5: m.z = in.fixed_float(); break;
+                case 6: if (!in.packed_floats(m.q, 4)) return; break;
+                case 7: m.vx = in.fixed_float(); break;
+                case 8: m.vy = in.fixed_float(); break;
+                case 9: m.vz = in.fixed_float(); break;
+                case 10: m.rollspeed = in.fixed_float(); break;
+                case 11: m.pitchspeed = in.fixed_float(); break;
+                case 12: m.yawspeed = in.fixed_float(); break;
+                case 13: if (!in.packed_floats(m.pose_covariance, 21)) return; break;
+                case 14: if (!in.packed_floats(m.velocity_covariance, 21)) return; break;
+            }
+            want.found(field);
+        }
+    }
+
+    void extract(const fanet::Odometry& b, PayloadOdometry& m) {
         m.time_usec = b.time_usec();
         m.frame_id = b.frame_id();
         m.child_frame_id = b.child_frame_id();
@@ -61,8 +132,30 @@ public:
             m.velocity_covariance[i] = b.velocity_covariance(i);
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        ProtoMessages<fanet::Odometry>::Batch batch(msgs_);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* out, size_t out_cap) {
+            return msgs_.use([&](fanet::Odometry& b) -> size_t {
+                fill(*static_cast<const PayloadOdometry*>(item), b);
+                size_t size = b.ByteSizeLong();
+                if (size > out_cap) return 0;
+                b.SerializeWithCachedSizesToArray(out);
+                return size;
+            });
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        ProtoMessages<fanet::Odometry>::Batch batch(msgs_);
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            msgs_.use([&](fanet::Odometry& b) {
+                if (b.ParseFromArray(frame, frame_len)) extract(b, *static_cast<PayloadOdometry*>(out));
+            });
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "Protobuf-Odometry"; }
+    std::string name() const override { return proto_plugin_name(msgs_.mode(), "Odometry"); }
 };
 
 } // namespace pf
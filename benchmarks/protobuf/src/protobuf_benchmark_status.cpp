@@ -1,5 +1,6 @@
 #include "IBenchmark.h"
 #include "gps_beacon.pb.h"
+#include "proto_messages.h"
 #include <iostream>
 #include <vector>
 #include <cstring>
@@ -8,33 +9,89 @@ namespace pf {
 
 class ProtobufBenchmarkStatus : public IBenchmark {
 public:
+    ProtoMessages<fanet::Status> msgs_;
+
     void setup(const BenchmarkConfig& config) override {
-        (void)config;
+        msgs_.set_mode(proto_alloc_from_variant(config.variant_name));
         std::cout << "[Proto-Status] Setup." << std::endl;
     }
 
-    std::vector<uint8_t> encode(const void* data) override {
-        const PayloadStatus& m = *static_cast<const PayloadStatus*>(data);
-        fanet::Status b;
+    void fill(const PayloadStatus& m, fanet::Status& b) {
         b.set_severity(m.severity);
         b.set_text(m.text);
-        size_t size = b.ByteSizeLong();
-        std::vector<uint8_t> result(size);
-        b.SerializeToArray(result.data(), size);
-        return result;
     }
 
-    void decode(const std::vector<uint8_t>& buffer, void* out_data) override {
+    size_t max_encoded_size(const void* data) override {
+        const PayloadStatus& m = *static_cast<const PayloadStatus*>(data);
+        return msgs_.use([&](fanet::Status& b) {
+            fill(m, b);
+            return b.ByteSizeLong();
+        });
+    }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        const PayloadStatus& m = *static_cast<const PayloadStatus*>(data);
+        return msgs_.use([&](fanet::Status& b) {
+            fill(m, b);
+
+            size_t size = b.ByteSizeLong();
+            std::vector<uint8_t> result(size);
+            b.SerializeToArray(result.data(), size);
+            return result;
+        });
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const PayloadStatus& m = *static_cast<const PayloadStatus*>(data);
+        return msgs_.use([&](fanet::Status& b) -> size_t {
+            fill(m, b);
+            size_t size = b.ByteSizeLong();
+            if (size > cap) return 0;
+            b.SerializeWithCachedSizesToArray(dst);
+            return size;
+        });
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
         PayloadStatus& m = *static_cast<PayloadStatus*>(out_data);
-        fanet::Status b;
-        if (!b.ParseFromArray(buffer.data(), buffer.size())) return;
+        msgs_.use([&](fanet::Status& b) {
+            if (!b.ParseFromArray(data, len)) return;
+            extract(b, m);
+        });
+    }
+
+    void extract(const fanet::Status& b, PayloadStatus& m) {
         m.severity = b.severity();
         strncpy(m.text, b.text().c_str(), 49);
         m.text[49] = '\0';
     }
 
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        ProtoMessages<fanet::Status>::Batch batch(msgs_);
+        return encode_frames(items, count, dst, cap, [&](const void* item, uint8_t* out, size_t out_cap) {
+            return msgs_.use([&](fanet::Status& b) -> size_t {
+                fill(*static_cast<const PayloadStatus*>(item), b);
+                size_t size = b.ByteSizeLong();
+                if (size > out_cap) return 0;
+                b.SerializeWithCachedSizesToArray(out);
+                return size;
+            });
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        ProtoMessages<fanet::Status>::Batch batch(msgs_);
+        return decode_frames(data, len, outs, count, [&](const uint8_t* frame, size_t frame_len, void* out) {
+            msgs_.use([&](fanet::Status& b) {
+                if (b.ParseFromArray(frame, frame_len)) extract(b, *static_cast<PayloadStatus*>(out));
+            });
+        });
+    }
+
     void teardown() override {}
-    std::string name() const override { return "Protobuf-Status"; }
+    std::string name() const override { return proto_plugin_name(msgs_.mode(), "Status"); }
 };
 
 } // pf
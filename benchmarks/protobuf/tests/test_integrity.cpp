@@ -1,8 +1,10 @@
 #include "IBenchmark.h"
+#include "plugin_check.hpp"
 #include <iostream>
 #include <cstring>
 #include <cassert>
 #include <memory>
+#include <vector>
 
 // External factory function
 extern "C" pf::IBenchmark* create_benchmark();
@@ -14,32 +16,94 @@ void log(const std::string& msg) {
 int main() {
     log("Starting Protobuf Integrity Test...");
 
-    std::unique_ptr<pf::IBenchmark> bench(create_benchmark());
-    
-    // 1. Test Standard Variant
+    // 1. Every allocation variant must produce the same bytes and round-trip,
+    //    including on a second call that reuses the variant's message storage.
+    std::vector<uint8_t> standard_bytes;
+    for (const char* variant : {"Standard", "Arena", "Reuse"}) {
+        std::unique_ptr<pf::IBenchmark> bench(create_benchmark());
+        pf::BenchmarkConfig config;
+        config.iterations = 1;
+        config.variant_name = variant;
+        bench->setup(config);
+
+        for (int pass = 0; pass < 2; pass++) {
+            pf::Payload original;
+            memset(&original, 0, sizeof(original));
+            original.timestamp = 5555555 + pass;
+            memset(original.hash, 0xEE, 32);
+
+            std::vector<uint8_t> buffer = bench->encode(&original);
+            log(std::string(variant) + " Encoded Size: " + std::to_string(buffer.size()) + " bytes");
+            if (pass == 0 && standard_bytes.empty()) standard_bytes = buffer;
+            else if (pass == 0) assert(buffer == standard_bytes);
+
+            pf::Payload decoded;
+            bench->decode(buffer, &decoded);
+            assert(decoded.timestamp == original.timestamp);
+            assert(memcmp(decoded.hash, original.hash, 32) == 0);
+        }
+        bench->teardown();
+    }
+
+    // 2. decode_fields() walks the wire format itself: the selected fields
+    //    match decode(), a selected zero (left off the wire) reads as zero,
+    //    and the other fields are not written.
     {
+        std::unique_ptr<pf::IBenchmark> bench(create_benchmark());
         pf::BenchmarkConfig config;
         config.iterations = 1;
         config.variant_name = "Standard";
         bench->setup(config);
-        
+
         pf::Payload original;
-        original.timestamp = 5555555;
-        memset(original.hash, 0xEE, 32);
-        
-        std::vector<uint8_t> buffer = bench->encode(original);
-        log("Encoded Size: " + std::to_string(buffer.size()) + " bytes");
-        
-        // Mock Decode Check
+        memset(&original, 0, sizeof(original));
+        original.timestamp = 1234;
+        original.lat = -473977418;
+        original.hdg_acc = 77;
+        memset(original.hash, 0xAB, 32);
+        std::vector<uint8_t> buffer = bench->encode(&original);
+
+        const pf::FieldMask fields = 1u << 2 | 1u << 4 | 1u << 5; // hash, fix_type (zero), lat
         pf::Payload decoded;
-        bench->decode(buffer, decoded);
-        
-        // Since Protobuf decode is fully implemented in our skeleton, we CAN verify!
-        assert(decoded.timestamp == original.timestamp);
+        memset(&decoded, 0xCD, sizeof(decoded));
+        bench->decode_fields(buffer.data(), buffer.size(), &decoded, fields);
         assert(memcmp(decoded.hash, original.hash, 32) == 0);
+        assert(decoded.fix_type == 0);
+        assert(decoded.lat == original.lat);
+        assert(decoded.timestamp == 0xCDCDCDCDCDCDCDCDull);
+        assert(decoded.hdg_acc == 0xCDCDCDCDu);
+        log("decode_fields: selected fields only");
+        bench->teardown();
+    }
+
+    // 3. No codec drops a field
+    for (const std::vector<std::string>& lost : {
+             pf::schema_coverage_failures<pf::PayloadGPSRaw>("protobuf", {"Standard", "Arena", "Reuse"}),
+             pf::schema_coverage_failures<pf::PayloadBattery>("protobuf", {"Standard", "Arena", "Reuse"}),
+             pf::schema_coverage_failures<pf::PayloadOdometry>("protobuf", {"Standard", "Arena", "Reuse"}),
+             pf::schema_coverage_failures<pf::PayloadAttitude>("protobuf", {"Standard", "Arena", "Reuse"}),
+             pf::schema_coverage_failures<pf::PayloadGlobalPosition>("protobuf", {"Standard", "Arena", "Reuse"}),
+             pf::schema_coverage_failures<pf::PayloadStatus>("protobuf", {"Standard", "Arena", "Reuse"}),
+             pf::schema_coverage_failures<pf::PayloadGPSBlock>("protobuf", {"Standard", "Arena", "Reuse", "Columnar"})}) {
+        for (const std::string& f : lost) std::cerr << "[PROTO-TEST] " << f << std::endl;
+        if (!lost.empty()) exit(1);
     }
-    
+    log("Schema coverage: every variant round-trips every field");
+
+    // 4. Columnar GPSBlock at its edges
+    {
+        CreateBenchmarkFunc create = pf::load_plugin<pf::PayloadGPSBlock>(PF_PLUGIN_DIR, "protobuf");
+        assert(create);
+        std::unique_ptr<pf::IBenchmark> columnar = pf::create_configured(create, "Columnar", 1);
+        const std::string diff = pf::columnar_round_trip_difference(*columnar);
+        if (!diff.empty()) {
+            std::cerr << "[PROTO-TEST] " << columnar->name() << ": " << diff << std::endl;
+            exit(1);
+        }
+        log(columnar->name() + ": edge blocks round-trip, truncated frames fail");
+        columnar->teardown();
+    }
+
     log("Integrity Check Passed!");
-    bench->teardown();
     return 0;
 }
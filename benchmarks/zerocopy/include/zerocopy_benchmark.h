@@ -0,0 +1,99 @@
+#ifndef PRIME_FUSION_ZEROCOPY_BENCHMARK_H
+#define PRIME_FUSION_ZEROCOPY_BENCHMARK_H
+
+#include "IBenchmark.h"
+#include "zerocopy_views.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief One root table per payload; the plugin for every fixed-size scenario.
+ * decode() copies every field out of the table, which is what a consumer that
+ * wants the whole struct pays. decode_fields() copies only the selected ones:
+ * the format needs no parse step, so its cost follows the fields read, not
+ * the message size.
+ */
+template <typename T>
+class ZerocopyBenchmark : public IBenchmark {
+public:
+    using Writer = ZcTableWriter<T>;
+
+    explicit ZerocopyBenchmark(const char* name) : name_(name) {}
+
+    void setup(const BenchmarkConfig& /*config*/) override {
+        // Every field gets a distinct non-zero byte pattern except the first,
+        // which stays zero so the absent-field path is round-tripped too.
+        T p, d;
+        memset(&p, 0, sizeof(p));
+        memset(&d, 0, sizeof(d));
+        const FieldDesc& first = PayloadSchema<T>::fields[0];
+        memset(reinterpret_cast<char*>(&d) + first.offset, 0xA5, field_type_size(first.type) * first.count);
+        for (size_t i = 1; i < schema_size<T>(); i++) {
+            const FieldDesc& f = PayloadSchema<T>::fields[i];
+            const size_t bytes = field_type_size(f.type) * f.count - (f.type == FieldType::CHARS ? 1 : 0);
+            memset(reinterpret_cast<char*>(&p) + f.offset, (int)(i + 1), bytes);
+        }
+        auto buf = encode(&p);
+        decode(buf, &d);
+        if (!buf.empty() && memcmp(&p, &d, sizeof(T)) == 0) {
+            std::cout << "[" << name_ << "] Sanity Check: PASS" << std::endl;
+        } else {
+            std::cerr << "[" << name_ << "] Sanity Check: FAILED" << std::endl;
+            exit(1);
+        }
+    }
+
+    size_t max_encoded_size(const void* /*data*/) override { return 4 + Writer::layout.max_bytes; }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        std::vector<uint8_t> out(4 + Writer::layout.max_bytes);
+        out.resize(ZerocopyBenchmark::encode_into(data, out.data(), out.size()));
+        return out;
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        ZcWriter w(dst, cap);
+        uint8_t* root = w.claim(4);
+        size_t last_vtable = Writer::kNoVtable;
+        size_t table = Writer::write(w, *static_cast<const T*>(data), last_vtable);
+        if (!root || !table) return 0;
+        zc_store<uint32_t>(root, (uint32_t)table);
+        return w.pos();
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
+        ZcView<T>(ZcTable::root(data, len)).read(*static_cast<T*>(out_data), kAllFields);
+    }
+
+    void decode_fields(const uint8_t* data, size_t len, void* out_data, FieldMask fields) override {
+        ZcView<T>(ZcTable::root(data, len)).read(*static_cast<T*>(out_data), fields);
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* out, size_t out_cap) {
+            return ZerocopyBenchmark::encode_into(item, out, out_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        return decode_frames(data, len, outs, count, [](const uint8_t* frame, size_t frame_len, void* out) {
+            ZcView<T>(ZcTable::root(frame, frame_len)).read(*static_cast<T*>(out), kAllFields);
+        });
+    }
+
+    void teardown() override {}
+    std::string name() const override { return name_; }
+
+private:
+    const char* name_;
+};
+
+} // namespace pf
+
+#endif // PRIME_FUSION_ZEROCOPY_BENCHMARK_H
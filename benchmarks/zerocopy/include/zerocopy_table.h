@@ -0,0 +1,400 @@
+#ifndef PRIME_FUSION_ZEROCOPY_TABLE_H
+#define PRIME_FUSION_ZEROCOPY_TABLE_H
+
+#include "IBenchmark.h"
+#include "SchemaCodec.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+namespace pf {
+
+/**
+ * @brief In-place readable tables in the style of FlatBuffers.
+ *
+ *   u32 root             offset of the root table from the buffer start
+ *   vtable               u16 vtable bytes, u16 table bytes, u16 offset per field (0 = absent)
+ *   table                i32 soffset (table - vtable), then the inline fields
+ *   vectors              u32 element count, elements (strings: bytes + NUL)
+ *
+ * A table's inline fields are scalars and the u32 offsets of its vectors,
+ * measured from the offset's own position. The vtable maps a field id (its
+ * PayloadSchema<T> index) to the field's offset in the table. Scalars equal
+ * to zero are left out of the table, as FlatBuffers leaves out defaults, and
+ * read back as zero. Inline fields are sorted by size, largest first, and
+ * every table starts 8-byte aligned, so each scalar sits at a multiple of its
+ * size from the buffer start. Consecutive tables with the same vtable share it.
+ *
+ * A reader finds any field through two loads (vtable slot, then the field)
+ * with nothing parsed up front. ZcTable checks the root and each offset it
+ * follows against the buffer length, so a damaged buffer reads as absent
+ * fields rather than out of bounds.
+ */
+
+// Scalars are stored in host order, which the format defines as little-endian.
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "zerocopy_table.h stores scalars in host order");
+
+template <typename V>
+inline V zc_load(const uint8_t* p) {
+    V v;
+    memcpy(&v, p, sizeof(V));
+    return v;
+}
+
+template <typename V>
+inline void zc_store(uint8_t* p, V v) {
+    memcpy(p, &v, sizeof(V));
+}
+
+constexpr size_t kZcVtableHeader = 4;  // vtable bytes, table bytes
+constexpr size_t kZcTableAlign = 8;
+
+constexpr bool zc_is_vector(const FieldDesc& d) { return d.count > 1; }
+
+// Bytes a field takes inside its table
+constexpr size_t zc_inline_size(const FieldDesc& d) { return zc_is_vector(d) ? 4 : field_type_size(d.type); }
+
+constexpr size_t zc_align_up(size_t n, size_t align) { return (n + align - 1) & ~(align - 1); }
+
+/**
+ * @brief Compile-time facts about T's table.
+ */
+template <typename T>
+struct ZcLayout {
+    static constexpr size_t N = schema_size<T>();
+    std::array<size_t, N> slot{}; // Schema index of the i-th inline field, largest first
+    size_t vtable_bytes = 0;
+    size_t max_table_bytes = 0;   // Every field present
+    size_t max_bytes = 0;         // Upper bound for vtable + table + vectors, alignment included
+};
+
+template <typename T>
+constexpr ZcLayout<T> make_zc_layout() {
+    constexpr size_t N = schema_size<T>();
+    const FieldDesc* f = PayloadSchema<T>::fields;
+    ZcLayout<T> l;
+    for (size_t i = 0; i < N; i++) l.slot[i] = i;
+    for (size_t i = 1; i < N; i++) {
+        for (size_t j = i; j > 0 && zc_inline_size(f[l.slot[j - 1]]) < zc_inline_size(f[l.slot[j]]); j--) {
+            size_t tmp = l.slot[j];
+            l.slot[j] = l.slot[j - 1];
+            l.slot[j - 1] = tmp;
+        }
+    }
+    l.vtable_bytes = kZcVtableHeader + 2 * N;
+    size_t off = 4; // soffset
+    size_t vectors = 0;
+    for (size_t i = 0; i < N; i++) {
+        const FieldDesc& d = f[l.slot[i]];
+        off = zc_align_up(off, zc_inline_size(d)) + zc_inline_size(d);
+        if (zc_is_vector(d)) vectors += 7 + 4 + field_type_size(d.type) * d.count + (d.type == FieldType::CHARS ? 1 : 0);
+    }
+    l.max_table_bytes = off;
+    l.max_bytes = 1 + l.vtable_bytes + (kZcTableAlign - 1) + off + vectors;
+    return l;
+}
+
+/**
+ * @brief Bounds-checked append-only writer over a caller buffer.
+ * Failed writes latch ok() to false; callers check once at the end.
+ */
+class ZcWriter {
+public:
+    ZcWriter(uint8_t* buf, size_t cap) : buf_(buf), cap_(cap) {}
+
+    size_t pos() const { return pos_; }
+    bool ok() const { return ok_; }
+    uint8_t* at(size_t pos) { return buf_ + pos; }
+    const uint8_t* at(size_t pos) const { return buf_ + pos; }
+
+    // Zero-pads until (pos + bias) is a multiple of align (a power of two).
+    void align(size_t align, size_t bias = 0) {
+        size_t pad = (align - ((pos_ + bias) & (align - 1))) & (align - 1);
+        if (uint8_t* p = claim(pad)) memset(p, 0, pad);
+    }
+
+    // The next n bytes, or nullptr (and ok() false) if they do not fit.
+    uint8_t* claim(size_t n) {
+        if (!ok_ || cap_ - pos_ < n) {
+            ok_ = false;
+            return nullptr;
+        }
+        uint8_t* p = buf_ + pos_;
+        pos_ += n;
+        return p;
+    }
+
+private:
+    uint8_t* buf_;
+    size_t cap_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+/**
+ * @brief Writes T's tables. `last_vtable` carries the previous table's vtable
+ * between calls so that a run of tables with the same present fields (a
+ * GPSBlock) stores it once.
+ */
+template <typename T>
+struct ZcTableWriter {
+    static constexpr auto layout = make_zc_layout<T>();
+    static constexpr size_t N = schema_size<T>();
+    static constexpr size_t kNoVtable = ~(size_t)0;
+
+    /**
+     * @return Position of the table, or 0 if the writer ran out of room
+     */
+    static size_t write(ZcWriter& w, const T& m, size_t& last_vtable) {
+        uint16_t vt[kZcVtableHeader / 2 + N];
+        size_t table_bytes = plan(m, vt, std::make_index_sequence<N>{});
+        vt[0] = (uint16_t)layout.vtable_bytes;
+        vt[1] = (uint16_t)table_bytes;
+
+        size_t vt_pos = last_vtable;
+        if (vt_pos == kNoVtable || memcmp(w.at(vt_pos), vt, layout.vtable_bytes) != 0) {
+            w.align(2);
+            vt_pos = w.pos();
+            if (uint8_t* p = w.claim(layout.vtable_bytes)) memcpy(p, vt, layout.vtable_bytes);
+        }
+        w.align(kZcTableAlign);
+        const size_t table_pos = w.pos();
+        uint8_t* table = w.claim(table_bytes);
+        if (!table) return 0;
+        last_vtable = vt_pos;
+
+        memset(table, 0, table_bytes);
+        zc_store<int32_t>(table, (int32_t)(table_pos - vt_pos));
+        write_fields(w, m, vt, table_pos, std::make_index_sequence<N>{});
+        return w.ok() ? table_pos : 0;
+    }
+
+private:
+    // Fills vt's field offsets; returns the table size.
+    template <size_t... S>
+    static size_t plan(const T& m, uint16_t* vt, std::index_sequence<S...>) {
+        size_t off = 4;
+        (plan_slot<layout.slot[S]>(m, vt, off), ...);
+        return off;
+    }
+
+    template <size_t I>
+    static void plan_slot(const T& m, uint16_t* vt, size_t& off) {
+        constexpr const FieldDesc& d = PayloadSchema<T>::fields[I];
+        constexpr size_t size = zc_inline_size(d);
+        if constexpr (!zc_is_vector(d)) {
+            // Compared as bits, so -0.0f is kept and reads back exactly
+            uint64_t bits = 0;
+            memcpy(&bits, reinterpret_cast<const char*>(&m) + d.offset, size);
+            if (bits == 0) {
+                vt[kZcVtableHeader / 2 + I] = 0;
+                return;
+            }
+        }
+        off = zc_align_up(off, size);
+        vt[kZcVtableHeader / 2 + I] = (uint16_t)off;
+        off += size;
+    }
+
+    template <size_t... I>
+    static void write_fields(ZcWriter& w, const T& m, const uint16_t* vt, size_t table_pos, std::index_sequence<I...>) {
+        (write_field<I>(w, m, vt[kZcVtableHeader / 2 + I], table_pos), ...);
+    }
+
+    template <size_t I>
+    static void write_field(ZcWriter& w, const T& m, uint16_t off, size_t table_pos) {
+        constexpr const FieldDesc& d = PayloadSchema<T>::fields[I];
+        constexpr size_t elem = field_type_size(d.type);
+        const char* src = reinterpret_cast<const char*>(&m) + d.offset;
+        if (off == 0) return;
+        if constexpr (!zc_is_vector(d)) {
+            memcpy(w.at(table_pos + off), src, elem);
+        } else {
+            size_t count = d.type == FieldType::CHARS ? strnlen(src, d.count) : d.count;
+            size_t terminator = d.type == FieldType::CHARS ? 1 : 0;
+            w.align(elem > 4 ? elem : 4, 4);
+            const size_t vec_pos = w.pos();
+            uint8_t* p = w.claim(4 + count * elem + terminator);
+            if (!p) return;
+            zc_store<uint32_t>(p, (uint32_t)count);
+            memcpy(p + 4, src, count * elem);
+            if (terminator) p[4 + count] = 0;
+            zc_store<uint32_t>(w.at(table_pos + off), (uint32_t)(vec_pos - (table_pos + off)));
+        }
+    }
+};
+
+/**
+ * @brief One table inside a buffer. Construction validates the table and its
+ * vtable header; each field read validates only what it touches.
+ */
+class ZcTable {
+public:
+    ZcTable() = default;
+
+    static ZcTable root(const uint8_t* buf, size_t len) {
+        if (len < 4) return ZcTable();
+        return at(buf, len, zc_load<uint32_t>(buf));
+    }
+
+    static ZcTable at(const uint8_t* buf, size_t len, size_t table_pos) {
+        ZcTable t;
+        if (table_pos > len || len - table_pos < 4) return t;
+        const int64_t vt_pos = (int64_t)table_pos - zc_load<int32_t>(buf + table_pos);
+        if (vt_pos < 0 || (uint64_t)vt_pos > len || len - (size_t)vt_pos < kZcVtableHeader) return t;
+        const uint16_t vt_bytes = zc_load<uint16_t>(buf + vt_pos);
+        const uint16_t table_bytes = zc_load<uint16_t>(buf + vt_pos + 2);
+        if (vt_bytes < kZcVtableHeader || len - (size_t)vt_pos < vt_bytes || len - table_pos < table_bytes) return t;
+        t.buf_ = buf;
+        t.len_ = len;
+        t.table_ = table_pos;
+        t.vtable_ = (size_t)vt_pos;
+        t.vtable_bytes_ = vt_bytes;
+        t.table_bytes_ = table_bytes;
+        return t;
+    }
+
+    bool valid() const { return buf_ != nullptr; }
+    const uint8_t* buffer() const { return buf_; }
+    size_t buffer_size() const { return len_; }
+
+    /**
+     * @return The field's offset in the table, or 0 if it is absent (or would overrun the table)
+     */
+    size_t field_offset(size_t id, size_t size) const {
+        const size_t slot = kZcVtableHeader + 2 * id;
+        if (slot + 2 > vtable_bytes_) return 0;
+        const size_t off = zc_load<uint16_t>(buf_ + vtable_ + slot);
+        return off != 0 && off + size <= table_bytes_ ? off : 0;
+    }
+
+    template <typename V>
+    V scalar(size_t id) const {
+        const size_t off = field_offset(id, sizeof(V));
+        return off ? zc_load<V>(buf_ + table_ + off) : V(0);
+    }
+
+    /**
+     * @brief Position of the data a u32 offset field points at, or 0.
+     */
+    size_t follow(size_t id) const {
+        const size_t off = field_offset(id, 4);
+        if (!off) return 0;
+        const size_t pos = table_ + off + zc_load<uint32_t>(buf_ + table_ + off);
+        return pos <= len_ ? pos : 0;
+    }
+
+    /**
+     * @return The first element of a vector field (count in `count`), or nullptr if absent
+     */
+    const uint8_t* vector(size_t id, size_t elem_size, uint32_t& count) const {
+        const size_t pos = follow(id);
+        count = 0;
+        if (!pos || len_ - pos < 4) return nullptr;
+        const uint32_t n = zc_load<uint32_t>(buf_ + pos);
+        if (n > (len_ - pos - 4) / elem_size) return nullptr;
+        count = n;
+        return buf_ + pos + 4;
+    }
+
+private:
+    const uint8_t* buf_ = nullptr;
+    size_t len_ = 0;
+    size_t table_ = 0;
+    size_t vtable_ = 0;
+    size_t vtable_bytes_ = 0;
+    size_t table_bytes_ = 0;
+};
+
+/**
+ * @brief A numeric vector read in place.
+ */
+template <typename E>
+class ZcVector {
+public:
+    ZcVector(const uint8_t* data, uint32_t size) : data_(data), size_(size) {}
+    uint32_t size() const { return size_; }
+    E operator[](size_t i) const { return zc_load<E>(data_ + i * sizeof(E)); }
+    const uint8_t* data() const { return data_; }
+
+private:
+    const uint8_t* data_;
+    uint32_t size_;
+};
+
+/**
+ * @brief Typed accessors over T's table: get<I>() reads field I in place.
+ * Scalars come back by value, numeric arrays as ZcVector, text as string_view.
+ */
+template <typename T>
+class ZcView {
+public:
+    using payload_type = T;
+
+    ZcView() = default;
+    explicit ZcView(ZcTable t) : t_(t) {}
+
+    bool valid() const { return t_.valid(); }
+    const ZcTable& table() const { return t_; }
+
+    template <size_t I>
+    auto get() const {
+        constexpr const FieldDesc& d = PayloadSchema<T>::fields[I];
+        using E = typename FieldCType<d.type>::type;
+        uint32_t n = 0;
+        if constexpr (d.type == FieldType::CHARS) {
+            const uint8_t* p = t_.vector(I, 1, n);
+            return p ? std::string_view((const char*)p, n) : std::string_view();
+        } else if constexpr (zc_is_vector(d)) {
+            const uint8_t* p = t_.vector(I, sizeof(E), n);
+            return ZcVector<E>(p, n);
+        } else {
+            return t_.scalar<E>(I);
+        }
+    }
+
+    /**
+     * @brief Copies the fields in `fields` into out. Absent fields read as
+     * zero, short arrays are zero-filled and text is NUL-terminated.
+     */
+    void read(T& out, FieldMask fields) const {
+        read_fields(out, fields, std::make_index_sequence<schema_size<T>()>{});
+    }
+
+private:
+    template <size_t... I>
+    void read_fields(T& out, FieldMask fields, std::index_sequence<I...>) const {
+        ((fields & ((FieldMask)1 << I) ? read_field<I>(out) : void()), ...);
+    }
+
+    template <size_t I>
+    void read_field(T& out) const {
+        constexpr const FieldDesc& d = PayloadSchema<T>::fields[I];
+        using E = typename FieldCType<d.type>::type;
+        char* dst = reinterpret_cast<char*>(&out) + d.offset;
+        if constexpr (zc_is_vector(d)) {
+            uint32_t n = 0;
+            const uint8_t* p = t_.vector(I, sizeof(E), n);
+            const size_t limit = d.type == FieldType::CHARS ? d.count - 1 : d.count;
+            const size_t copy = p ? (n < limit ? n : limit) : 0;
+            if (copy) memcpy(dst, p, copy * sizeof(E));
+            memset(dst + copy * sizeof(E), 0, (d.count - copy) * sizeof(E));
+        } else {
+            E v = t_.scalar<E>(I);
+            memcpy(dst, &v, sizeof(E));
+        }
+    }
+
+    ZcTable t_;
+};
+
+// Declares `member()` on a ZcView subclass; the field id comes from the schema.
+#define PF_ZC_FIELD(member)                                                              \
+    static_assert(schema_index_of<payload_type>(#member) >= 0, #member " is not a schema field"); \
+    auto member() const { return get<(size_t)schema_index_of<payload_type>(#member)>(); }
+
+} // namespace pf
+
+#endif // PRIME_FUSION_ZEROCOPY_TABLE_H
@@ -0,0 +1,142 @@
+#ifndef PRIME_FUSION_ZEROCOPY_VIEWS_H
+#define PRIME_FUSION_ZEROCOPY_VIEWS_H
+
+#include "zerocopy_table.h"
+
+namespace pf {
+
+/**
+ * @brief Named in-place accessors, one view per scenario.
+ * A reader that needs a few fields constructs the view over the received
+ * bytes and calls only those accessors; nothing else is touched:
+ *
+ *   GPSRawView v = GPSRawView::root(data, len);
+ *   route(v.timestamp(), v.lat(), v.lon(), v.hash().data());
+ */
+template <typename View>
+View zc_root(const uint8_t* data, size_t len) {
+    return View(ZcTable::root(data, len));
+}
+
+struct GPSRawView : ZcView<PayloadGPSRaw> {
+    using ZcView::ZcView;
+    static GPSRawView root(const uint8_t* data, size_t len) { return zc_root<GPSRawView>(data, len); }
+    PF_ZC_FIELD(timestamp)
+    PF_ZC_FIELD(block_number)
+    PF_ZC_FIELD(hash)
+    PF_ZC_FIELD(time_usec)
+    PF_ZC_FIELD(fix_type)
+    PF_ZC_FIELD(lat)
+    PF_ZC_FIELD(lon)
+    PF_ZC_FIELD(alt)
+    PF_ZC_FIELD(eph)
+    PF_ZC_FIELD(epv)
+    PF_ZC_FIELD(vel)
+    PF_ZC_FIELD(cog)
+    PF_ZC_FIELD(satellites_visible)
+    PF_ZC_FIELD(alt_ellipsoid)
+    PF_ZC_FIELD(h_acc)
+    PF_ZC_FIELD(v_acc)
+    PF_ZC_FIELD(vel_acc)
+    PF_ZC_FIELD(hdg_acc)
+};
+
+struct GlobalPositionView : ZcView<PayloadGlobalPosition> {
+    using ZcView::ZcView;
+    static GlobalPositionView root(const uint8_t* data, size_t len) { return zc_root<GlobalPositionView>(data, len); }
+    PF_ZC_FIELD(time_boot_ms)
+    PF_ZC_FIELD(lat)
+    PF_ZC_FIELD(lon)
+    PF_ZC_FIELD(alt)
+    PF_ZC_FIELD(relative_alt)
+    PF_ZC_FIELD(vx)
+    PF_ZC_FIELD(vy)
+    PF_ZC_FIELD(vz)
+    PF_ZC_FIELD(hdg)
+};
+
+struct OdometryView : ZcView<PayloadOdometry> {
+    using ZcView::ZcView;
+    static OdometryView root(const uint8_t* data, size_t len) { return zc_root<OdometryView>(data, len); }
+    PF_ZC_FIELD(time_usec)
+    PF_ZC_FIELD(frame_id)
+    PF_ZC_FIELD(child_frame_id)
+    PF_ZC_FIELD(x)
+    PF_ZC_FIELD(y)
+    PF_ZC_FIELD(z)
+    PF_ZC_FIELD(q)
+    PF_ZC_FIELD(vx)
+    PF_ZC_FIELD(vy)
+    PF_ZC_FIELD(vz)
+    PF_ZC_FIELD(rollspeed)
+    PF_ZC_FIELD(pitchspeed)
+    PF_ZC_FIELD(yawspeed)
+    PF_ZC_FIELD(pose_covariance)
+    PF_ZC_FIELD(velocity_covariance)
+};
+
+struct AttitudeView : ZcView<PayloadAttitude> {
+    using ZcView::ZcView;
+    static AttitudeView root(const uint8_t* data, size_t len) { return zc_root<AttitudeView>(data, len); }
+    PF_ZC_FIELD(time_boot_ms)
+    PF_ZC_FIELD(roll)
+    PF_ZC_FIELD(pitch)
+    PF_ZC_FIELD(yaw)
+    PF_ZC_FIELD(rollspeed)
+    PF_ZC_FIELD(pitchspeed)
+    PF_ZC_FIELD(yawspeed)
+};
+
+struct BatteryView : ZcView<PayloadBattery> {
+    using ZcView::ZcView;
+    static BatteryView root(const uint8_t* data, size_t len) { return zc_root<BatteryView>(data, len); }
+    PF_ZC_FIELD(id)
+    PF_ZC_FIELD(battery_function)
+    PF_ZC_FIELD(type)
+    PF_ZC_FIELD(temperature)
+    PF_ZC_FIELD(voltages)
+    PF_ZC_FIELD(current_battery)
+    PF_ZC_FIELD(current_consumed)
+    PF_ZC_FIELD(energy_consumed)
+    PF_ZC_FIELD(battery_remaining)
+};
+
+struct StatusView : ZcView<PayloadStatus> {
+    using ZcView::ZcView;
+    static StatusView root(const uint8_t* data, size_t len) { return zc_root<StatusView>(data, len); }
+    PF_ZC_FIELD(severity)
+    PF_ZC_FIELD(text)
+};
+
+/**
+ * @brief GPSBlock: a root table whose field 0 is a vector of offsets to
+ * GPS_RAW tables. messages()[i] is a GPSRawView over record i.
+ */
+class GPSBlockView {
+public:
+    static constexpr size_t kMessagesField = 0;
+
+    explicit GPSBlockView(ZcTable t) : t_(t) {
+        uint32_t n = 0;
+        slots_ = t_.valid() ? t_.vector(kMessagesField, 4, n) : nullptr;
+        size_ = n;
+    }
+    static GPSBlockView root(const uint8_t* data, size_t len) { return GPSBlockView(ZcTable::root(data, len)); }
+
+    bool valid() const { return t_.valid(); }
+    uint32_t size() const { return size_; }
+
+    GPSRawView operator[](size_t i) const {
+        const size_t slot = (size_t)(slots_ + 4 * i - t_.buffer());
+        return GPSRawView(ZcTable::at(t_.buffer(), t_.buffer_size(), slot + zc_load<uint32_t>(slots_ + 4 * i)));
+    }
+
+private:
+    ZcTable t_;
+    const uint8_t* slots_;
+    uint32_t size_;
+};
+
+} // namespace pf
+
+#endif // PRIME_FUSION_ZEROCOPY_VIEWS_H
@@ -0,0 +1,3 @@
+#include "zerocopy_benchmark.h"
+
+extern "C" pf::IBenchmark* create_benchmark() { return new pf::ZerocopyBenchmark<pf::PayloadBattery>("ZeroCopy-Battery"); }
@@ -0,0 +1,124 @@
+#include "IBenchmark.h"
+#include "zerocopy_views.h"
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+namespace pf {
+
+/**
+ * @brief A block is a root table holding one vector of offsets to GPS_RAW
+ * tables. The records follow the vector; records with the same present
+ * fields share one vtable, so a block of full records stores it once.
+ */
+class ZerocopyBenchmarkGPSBlock : public IBenchmark {
+public:
+    using Writer = ZcTableWriter<PayloadGPSRaw>;
+
+    // Block vtable (one field) and block table (soffset + vector offset)
+    static constexpr size_t kBlockVtableBytes = kZcVtableHeader + 2;
+    static constexpr size_t kBlockTableBytes = 8;
+
+    void setup(const BenchmarkConfig& /*config*/) override {
+        PayloadGPSBlock p;
+        for(int i=0; i<50; i++) {
+            PayloadGPSRaw raw;
+            memset(&raw, 0, sizeof(raw));
+            raw.timestamp = 1000 + i;
+            raw.lat = -473977418 + i;
+            raw.eph = 120;
+            raw.hash[31] = (uint8_t)i;
+            p.messages.push_back(raw);
+        }
+        auto buf = encode(&p);
+        PayloadGPSBlock d;
+        decode(buf, &d);
+        GPSBlockView v = GPSBlockView::root(buf.data(), buf.size());
+        if (d.messages.size() == 50 && d.messages[0].timestamp == 1000 && d.messages[49].lat == -473977369 &&
+            d.messages[49].eph == 120 && d.messages[49].hash[31] == 49 && d.messages[0].hash[31] == 0 &&
+            v.size() == 50 && v[49].lat() == -473977369) {
+             std::cout << "[ZeroCopy-GPSBlock] Sanity Check: PASS" << std::endl;
+        } else {
+             std::cerr << "[ZeroCopy-GPSBlock] Sanity Check: FAILED" << std::endl;
+             exit(1);
+        }
+    }
+
+    size_t max_encoded_size(const void* data) override {
+        size_t n = static_cast<const PayloadGPSBlock*>(data)->messages.size();
+        return 4 + kBlockVtableBytes + (kZcTableAlign - 1) + kBlockTableBytes + 3 + 4 + 4 * n +
+               n * Writer::layout.max_bytes;
+    }
+
+    std::vector<uint8_t> encode(const void* data) override {
+        std::vector<uint8_t> out(max_encoded_size(data));
+        out.resize(ZerocopyBenchmarkGPSBlock::encode_into(data, out.data(), out.size()));
+        return out;
+    }
+
+    size_t encode_into(const void* data, uint8_t* dst, size_t cap) override {
+        const std::vector<PayloadGPSRaw>& messages = static_cast<const PayloadGPSBlock*>(data)->messages;
+        ZcWriter w(dst, cap);
+        uint8_t* root = w.claim(4);
+
+        const size_t vt_pos = w.pos();
+        if (uint8_t* vt = w.claim(kBlockVtableBytes)) {
+            zc_store<uint16_t>(vt, (uint16_t)kBlockVtableBytes);
+            zc_store<uint16_t>(vt + 2, (uint16_t)kBlockTableBytes);
+            zc_store<uint16_t>(vt + 4, 4);
+        }
+        w.align(kZcTableAlign);
+        const size_t table_pos = w.pos();
+        uint8_t* table = w.claim(kBlockTableBytes);
+        w.align(4);
+        const size_t vec_pos = w.pos();
+        uint8_t* vec = w.claim(4 + 4 * messages.size());
+        if (!root || !table || !vec) return 0;
+
+        zc_store<uint32_t>(root, (uint32_t)table_pos);
+        zc_store<int32_t>(table, (int32_t)(table_pos - vt_pos));
+        zc_store<uint32_t>(table + 4, (uint32_t)(vec_pos - (table_pos + 4)));
+        zc_store<uint32_t>(vec, (uint32_t)messages.size());
+
+        size_t last_vtable = Writer::kNoVtable;
+        for (size_t i = 0; i < messages.size(); i++) {
+            size_t record = Writer::write(w, messages[i], last_vtable);
+            if (!record) return 0;
+            const size_t slot = vec_pos + 4 + 4 * i;
+            zc_store<uint32_t>(w.at(slot), (uint32_t)(record - slot));
+        }
+        return w.pos();
+    }
+
+    using IBenchmark::decode;
+
+    void decode(const uint8_t* data, size_t len, void* out_data) override {
+        ZerocopyBenchmarkGPSBlock::decode_fields(data, len, out_data, kAllFields);
+    }
+
+    void decode_fields(const uint8_t* data, size_t len, void* out_data, FieldMask fields) override {
+        std::vector<PayloadGPSRaw>& messages = static_cast<PayloadGPSBlock*>(out_data)->messages;
+        GPSBlockView block = GPSBlockView::root(data, len);
+        messages.resize(block.size());
+        for (size_t i = 0; i < messages.size(); i++) block[i].read(messages[i], fields);
+    }
+
+    size_t encode_batch(const void* const* items, size_t count, uint8_t* dst, size_t cap) override {
+        return encode_frames(items, count, dst, cap, [this](const void* item, uint8_t* out, size_t out_cap) {
+            return ZerocopyBenchmarkGPSBlock::encode_into(item, out, out_cap);
+        });
+    }
+
+    size_t decode_batch(const uint8_t* data, size_t len, void* const* outs, size_t count) override {
+        return decode_frames(data, len, outs, count, [this](const uint8_t* frame, size_t frame_len, void* out) {
+            ZerocopyBenchmarkGPSBlock::decode(frame, frame_len, out);
+        });
+    }
+
+    void teardown() override {}
+    std::string name() const override { return "ZeroCopy-GPSBlock"; }
+};
+
+} // namespace pf
+
+extern "C" pf::IBenchmark* create_benchmark() { return new pf::ZerocopyBenchmarkGPSBlock(); }
@@ -0,0 +1,178 @@
+#include "IBenchmark.h"
+#include "zerocopy_views.h"
+#include <iostream>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// External factory function (pf_zerocopy, the GPSRaw scenario)
+extern "C" pf::IBenchmark* create_benchmark();
+
+using namespace pf;
+
+// Inline fields are sorted largest first: the u64s, then the u32s and vector offsets.
+static_assert(ZcTableWriter<PayloadGPSRaw>::layout.slot[0] == 0, "timestamp is the first inline field");
+static_assert(PayloadSchema<PayloadGPSRaw>::fields[ZcTableWriter<PayloadGPSRaw>::layout.slot[schema_size<PayloadGPSRaw>() - 1]].type ==
+                  FieldType::U8,
+              "one-byte fields come last");
+
+static int failures = 0;
+
+void log(const std::string& msg) {
+    std::cout << "[ZEROCOPY-TEST] " << msg << std::endl;
+}
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "[ZEROCOPY-TEST] FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static size_t write_root(const PayloadGlobalPosition& p, uint8_t* buf, size_t cap) {
+    ZcWriter w(buf, cap);
+    uint8_t* root = w.claim(4);
+    size_t last = ZcTableWriter<PayloadGlobalPosition>::kNoVtable;
+    size_t table = ZcTableWriter<PayloadGlobalPosition>::write(w, p, last);
+    if (!root || !table) return 0;
+    zc_store<uint32_t>(root, (uint32_t)table);
+    return w.pos();
+}
+
+int main() {
+    log("Starting ZeroCopy Integrity Test...");
+
+    // 1. Absent fields: zero scalars are left out and read back as zero
+    {
+        PayloadGlobalPosition p;
+        memset(&p, 0, sizeof(p));
+        uint8_t empty[256];
+        size_t empty_len = write_root(p, empty, sizeof(empty));
+
+        p.lat = -473977418;
+        p.hdg = 0xABCD;
+        uint8_t buf[256];
+        size_t n = write_root(p, buf, sizeof(buf));
+        check(empty_len > 0 && n > empty_len, "present fields grow the table");
+
+        GlobalPositionView v = GlobalPositionView::root(buf, n);
+        check(v.valid() && v.lat() == p.lat && v.hdg() == 0xABCD && v.lon() == 0 && v.time_boot_ms() == 0,
+              "named accessors read present and absent fields");
+        check(v.table().field_offset(schema_index_of<PayloadGlobalPosition>("lon"), 4) == 0, "lon is absent");
+        const uint8_t* lat = buf + zc_load<uint32_t>(buf) + v.table().field_offset(1, 4);
+        check(((uintptr_t)(lat - buf) % 4) == 0, "lat is 4-byte aligned from the buffer start");
+    }
+
+    // 2. Two tables with the same present fields share one vtable
+    {
+        PayloadAttitude a, b;
+        memset(&a, 0, sizeof(a));
+        memset(&b, 0, sizeof(b));
+        a.time_boot_ms = 1;
+        a.roll = 0.5f;
+        b.time_boot_ms = 2;
+        b.roll = -0.25f;
+        uint8_t buf[512];
+        ZcWriter w(buf, sizeof(buf));
+        size_t last = ZcTableWriter<PayloadAttitude>::kNoVtable;
+        size_t t1 = ZcTableWriter<PayloadAttitude>::write(w, a, last);
+        size_t first_vtable = last;
+        size_t t2 = ZcTableWriter<PayloadAttitude>::write(w, b, last);
+        check(t1 && t2 && last == first_vtable, "second table reuses the vtable");
+        check(t2 - t1 == zc_align_up(4 + 4 + 4, kZcTableAlign), "second table carries no vtable of its own");
+        check(AttitudeView(ZcTable::at(buf, w.pos(), t2)).roll() == -0.25f, "shared vtable reads the second table");
+
+        b.pitch = 1.0f;
+        size_t t3 = ZcTableWriter<PayloadAttitude>::write(w, b, last);
+        check(t3 && last != first_vtable, "a different field set writes a new vtable");
+    }
+
+    // 3. Text and arrays are read in place
+    {
+        PayloadStatus s;
+        memset(&s, 0, sizeof(s));
+        s.severity = 6;
+        strcpy(s.text, "PreArm: GPS 3D fix");
+        PayloadBattery bat;
+        memset(&bat, 0, sizeof(bat));
+        for (int i = 0; i < 10; i++) bat.voltages[i] = (uint16_t)(3700 + i);
+
+        uint8_t buf[512];
+        ZcWriter w(buf, sizeof(buf));
+        size_t last_s = ZcTableWriter<PayloadStatus>::kNoVtable;
+        size_t last_b = ZcTableWriter<PayloadBattery>::kNoVtable;
+        size_t ts = ZcTableWriter<PayloadStatus>::write(w, s, last_s);
+        size_t tb = ZcTableWriter<PayloadBattery>::write(w, bat, last_b);
+        StatusView sv(ZcTable::at(buf, w.pos(), ts));
+        BatteryView bv(ZcTable::at(buf, w.pos(), tb));
+        check(sv.text() == "PreArm: GPS 3D fix" && sv.text().data()[sv.text().size()] == 0, "text is NUL-terminated in place");
+        check(bv.voltages().size() == 10 && bv.voltages()[9] == 3709 && bv.temperature() == 0, "array read in place");
+    }
+
+    // 4. Damaged buffers read as absent fields
+    {
+        PayloadGlobalPosition p;
+        memset(&p, 0, sizeof(p));
+        p.time_boot_ms = 7;
+        p.hdg = 1;
+        uint8_t buf[256];
+        size_t n = write_root(p, buf, sizeof(buf));
+        check(!GlobalPositionView::root(buf, 3).valid(), "buffer shorter than the root offset");
+        check(!GlobalPositionView::root(buf, n - 1).valid(), "truncated table");
+        zc_store<uint32_t>(buf, 0xFFFFFF00u);
+        check(!GlobalPositionView::root(buf, n).valid(), "root offset past the end");
+        uint8_t tiny[8];
+        check(write_root(p, tiny, sizeof(tiny)) == 0, "short output buffer is refused");
+    }
+
+    // 5. The GPSRaw plugin: full round trip and decode_fields
+    {
+        std::unique_ptr<IBenchmark> bench(create_benchmark());
+        BenchmarkConfig config;
+        config.iterations = 1;
+        config.variant_name = "Standard";
+        bench->setup(config);
+
+        Payload p;
+        memset(&p, 0, sizeof(p));
+        p.timestamp = 1122334455;
+        p.block_number = 999;
+        memset(p.hash, 0xCC, 32);
+        p.fix_type = 3;
+        p.lat = -473977418;
+        p.lon = 85455939;
+        p.satellites_visible = 12;
+
+        std::vector<uint8_t> buf = bench->encode(&p);
+        log("GPS_RAW Encoded Size: " + std::to_string(buf.size()) + " bytes");
+        check(buf.size() <= bench->max_encoded_size(&p), "encoded size within max_encoded_size");
+
+        Payload d;
+        memset(&d, 0xFF, sizeof(d));
+        bench->decode(buf, &d);
+        bool same = true;
+        for (const FieldDesc& f : PayloadSchema<Payload>::fields) {
+            same &= memcmp((const char*)&p + f.offset, (const char*)&d + f.offset, field_type_size(f.type) * f.count) == 0;
+        }
+        check(same, "GPS_RAW round trip, absent fields included");
+
+        const FieldMask route = (FieldMask)1 << schema_index_of<Payload>("timestamp") |
+                                (FieldMask)1 << schema_index_of<Payload>("lat") |
+                                (FieldMask)1 << schema_index_of<Payload>("lon") |
+                                (FieldMask)1 << schema_index_of<Payload>("hash");
+        memset(&d, 0xEE, sizeof(d));
+        bench->decode_fields(buf.data(), buf.size(), &d, route);
+        check(d.timestamp == p.timestamp && d.lat == p.lat && d.lon == p.lon && d.hash[0] == 0xCC,
+              "decode_fields reads the selected fields");
+        check(d.block_number == 0xEEEEEEEEu && d.fix_type == 0xEEEEEEEEu && d.satellites_visible == 0xEE,
+              "decode_fields leaves the other fields alone");
+        bench->teardown();
+    }
+
+    if (failures) {
+        std::cerr << "[ZEROCOPY-TEST] " << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    log("Integrity Check Passed!");
+    return 0;
+}
@@ -0,0 +1,246 @@
+// libpf_alloc_profiler.so: LD_PRELOAD malloc shim behind alloc_profiler.h.
+// Every entry point forwards to glibc's __libc_* implementations, so nothing
+// here calls dlsym (which itself allocates) and mallinfo2() keeps working.
+#include "alloc_profiler.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <execinfo.h>
+#include <link.h>
+#include <malloc.h>
+#include <unistd.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void __libc_free(void* ptr);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+namespace {
+
+std::atomic<uint64_t> g_mallocs{0};
+std::atomic<uint64_t> g_frees{0};
+std::atomic<uint64_t> g_bytes{0};
+std::atomic<int64_t> g_live{0};
+std::atomic<int64_t> g_peak{0};
+std::atomic<int64_t> g_base{0};
+
+// Call-site sampling (PF_ALLOC_SITES=N). The table is fixed-size and
+// open-addressed: recording a sample must not allocate.
+constexpr size_t kSiteSlots = 4096;
+constexpr int kMaxFrames = 16;
+
+struct Site {
+    void* pc;
+    uint64_t samples;
+};
+
+unsigned g_site_period = 0;
+Site g_sites[kSiteSlots];
+std::atomic_flag g_site_lock = ATOMIC_FLAG_INIT;
+thread_local bool t_in_hook = false;
+
+// Text ranges skipped when picking a call site: this shim and libstdc++ (operator new).
+struct Range {
+    uintptr_t lo = 0, hi = 0;
+    bool contains(uintptr_t pc) const { return pc >= lo && pc < hi; }
+};
+Range g_self;
+Range g_libstdcxx;
+
+int find_ranges(struct dl_phdr_info* info, size_t, void*) {
+    const uintptr_t self = (uintptr_t)&find_ranges;
+    const uintptr_t new_op = (uintptr_t)(void* (*)(size_t))&::operator new;
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+        if (ph.p_type != PT_LOAD || !(ph.p_flags & PF_X)) continue;
+        Range r;
+        r.lo = info->dlpi_addr + ph.p_vaddr;
+        r.hi = r.lo + ph.p_memsz;
+        if (r.contains(self)) g_self = r;
+        else if (r.contains(new_op) || strstr(info->dlpi_name, "libstdc++")) g_libstdcxx = r;
+    }
+    return 0;
+}
+
+void record_site() {
+    void* frames[kMaxFrames];
+    int n = backtrace(frames, kMaxFrames);
+    void* pc = nullptr;
+    for (int i = 0; i < n; i++) {
+        uintptr_t f = (uintptr_t)frames[i];
+        if (g_self.contains(f) || g_libstdcxx.contains(f)) continue;
+        pc = frames[i];
+        break;
+    }
+    if (!pc) return;
+    while (g_site_lock.test_and_set(std::memory_order_acquire)) {}
+    size_t slot = ((uintptr_t)pc >> 2) % kSiteSlots;
+    for (size_t probe = 0; probe < kSiteSlots; probe++, slot = (slot + 1) % kSiteSlots) {
+        if (g_sites[slot].pc == pc || !g_sites[slot].pc) {
+            g_sites[slot].pc = pc;
+            g_sites[slot].samples++;
+            break;
+        }
+    }
+    g_site_lock.clear(std::memory_order_release);
+}
+
+void on_alloc(void* p, size_t requested) {
+    if (!p) return;
+    uint64_t n = g_mallocs.fetch_add(1, std::memory_order_relaxed) + 1;
+    g_bytes.fetch_add(requested, std::memory_order_relaxed);
+    const int64_t usable = (int64_t)malloc_usable_size(p);
+    int64_t live = g_live.fetch_add(usable, std::memory_order_relaxed) + usable;
+    int64_t peak = g_peak.load(std::memory_order_relaxed);
+    while (live > peak && !g_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+
+    if (g_site_period && n % g_site_period == 0 && !t_in_hook) {
+        t_in_hook = true; // backtrace() must not re-enter the sampler
+        record_site();
+        t_in_hook = false;
+    }
+}
+
+void on_free(void* p) {
+    if (!p) return;
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+    g_live.fetch_sub((int64_t)malloc_usable_size(p), std::memory_order_relaxed);
+}
+
+__attribute__((constructor)) void init_profiler() {
+    const char* period = getenv("PF_ALLOC_SITES");
+    if (!period || atoi(period) <= 0) return;
+    dl_iterate_phdr(find_ranges, nullptr);
+    void* warm[1];
+    backtrace(warm, 1); // Loads the unwinder now rather than inside a sampled malloc
+    g_site_period = (unsigned)atoi(period);
+}
+
+} // namespace
+
+extern "C" {
+
+void* malloc(size_t size) {
+    void* p = __libc_malloc(size);
+    on_alloc(p, size);
+    return p;
+}
+
+void free(void* ptr) {
+    on_free(ptr);
+    __libc_free(ptr);
+}
+
+void* calloc(size_t n, size_t size) {
+    void* p = __libc_calloc(n, size);
+    on_alloc(p, n * size);
+    return p;
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (!ptr) return malloc(size);
+    if (size == 0) {
+        free(ptr);
+        return nullptr;
+    }
+    const size_t old_usable = malloc_usable_size(ptr);
+    void* p = __libc_realloc(ptr, size);
+    if (!p) return nullptr; // ptr is untouched
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+    g_live.fetch_sub((int64_t)old_usable, std::memory_order_relaxed);
+    on_alloc(p, size);
+    return p;
+}
+
+// glibc's own reallocarray goes straight to __libc_realloc, which would free
+// through the shim what it never counted and drive the live bytes negative.
+void* reallocarray(void* ptr, size_t n, size_t size) {
+    size_t bytes;
+    if (__builtin_mul_overflow(n, size, &bytes)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(ptr, bytes);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    void* p = __libc_memalign(alignment, size);
+    on_alloc(p, size);
+    return p;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) { return memalign(alignment, size); }
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void* p = memalign(alignment, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void* valloc(size_t size) { return memalign((size_t)sysconf(_SC_PAGESIZE), size); }
+
+void* pvalloc(size_t size) {
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t rounded;
+    if (__builtin_add_overflow(size, page - 1, &rounded)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    rounded &= ~(page - 1);
+    return memalign(page, rounded ? rounded : page); // pvalloc(0) is one page
+}
+
+void pf_alloc_reset() {
+    g_mallocs.store(0, std::memory_order_relaxed);
+    g_frees.store(0, std::memory_order_relaxed);
+    g_bytes.store(0, std::memory_order_relaxed);
+    int64_t live = g_live.load(std::memory_order_relaxed);
+    g_base.store(live, std::memory_order_relaxed);
+    g_peak.store(live, std::memory_order_relaxed);
+}
+
+void pf_alloc_read(PfAllocStats* out) {
+    out->mallocs = g_mallocs.load(std::memory_order_relaxed);
+    out->frees = g_frees.load(std::memory_order_relaxed);
+    out->bytes = g_bytes.load(std::memory_order_relaxed);
+    out->live_bytes = g_live.load(std::memory_order_relaxed);
+    out->peak_live_bytes = g_peak.load(std::memory_order_relaxed) - g_base.load(std::memory_order_relaxed);
+}
+
+unsigned pf_alloc_dump_sites(const char* prefix, unsigned top) {
+    if (!g_site_period) return 0;
+    t_in_hook = true; // printf and dladdr may allocate; those must not wait on the lock held below
+    while (g_site_lock.test_and_set(std::memory_order_acquire)) {}
+    for (unsigned i = 0; i < top; i++) {
+        Site* best = nullptr;
+        for (Site& s : g_sites) {
+            if (s.samples && (!best || s.samples > best->samples)) best = &s;
+        }
+        if (!best) break;
+        Dl_info info;
+        if (dladdr(best->pc, &info) && info.dli_sname) {
+            printf("%s_ALLOC_SITE_%u=%llu %s(%s+0x%lx)\n", prefix, i, (unsigned long long)best->samples,
+                   info.dli_fname, info.dli_sname, (unsigned long)((uintptr_t)best->pc - (uintptr_t)info.dli_saddr));
+        } else if (dladdr(best->pc, &info)) {
+            printf("%s_ALLOC_SITE_%u=%llu %s(+0x%lx)\n", prefix, i, (unsigned long long)best->samples,
+                   info.dli_fname, (unsigned long)((uintptr_t)best->pc - (uintptr_t)info.dli_fbase));
+        } else {
+            printf("%s_ALLOC_SITE_%u=%llu %p\n", prefix, i, (unsigned long long)best->samples, best->pc);
+        }
+        best->samples = 0; // Printed; the next pass finds the runner-up
+    }
+    memset(g_sites, 0, sizeof(g_sites));
+    g_site_lock.clear(std::memory_order_release);
+    fflush(stdout);
+    t_in_hook = false;
+    return g_site_period;
+}
+
+}
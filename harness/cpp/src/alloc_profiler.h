@@ -0,0 +1,85 @@
+#ifndef ALLOC_PROFILER_H
+#define ALLOC_PROFILER_H
+
+#include <cstdint>
+#include <dlfcn.h>
+#include <iostream>
+#include <string>
+
+/**
+ * @brief Interface of libpf_alloc_profiler.so, an LD_PRELOAD malloc shim.
+ * The shim counts every malloc/free (including operator new/delete, which
+ * libstdc++ routes through malloc) and forwards to glibc. The runners find it
+ * with dlsym(RTLD_DEFAULT) and report nothing extra when it is not preloaded.
+ *
+ *   LD_PRELOAD=bin/libpf_alloc_profiler.so pf_runner_gps_raw --memory ...
+ *
+ * PF_ALLOC_SITES=N additionally samples every N-th allocation's call site:
+ * the first stack frame outside the shim and libstdc++.
+ */
+extern "C" {
+
+struct PfAllocStats {
+    uint64_t mallocs;         // malloc, calloc, realloc, the memalign family
+    uint64_t frees;           // free of a non-null pointer, realloc of a non-null pointer
+    uint64_t bytes;           // Requested bytes
+    int64_t live_bytes;       // Usable bytes currently allocated
+    int64_t peak_live_bytes;  // Highest live_bytes since the last reset, minus live_bytes at that reset
+};
+
+// Zeroes the counters and restarts the peak at the current live bytes.
+typedef void (*PfAllocResetFunc)();
+typedef void (*PfAllocReadFunc)(PfAllocStats* out);
+// Writes up to `top` sampled call sites, most frequent first, as
+// "<prefix>_ALLOC_SITE_<i>=<samples> <module>(<symbol>+0x<offset>)" lines;
+// clears the samples. Returns the sampling period (0 = PF_ALLOC_SITES unset).
+typedef unsigned (*PfAllocDumpSitesFunc)(const char* prefix, unsigned top);
+
+}
+
+namespace pf {
+
+class AllocProfiler {
+public:
+    AllocProfiler()
+        : reset_((PfAllocResetFunc)dlsym(RTLD_DEFAULT, "pf_alloc_reset")),
+          read_((PfAllocReadFunc)dlsym(RTLD_DEFAULT, "pf_alloc_read")),
+          dump_sites_((PfAllocDumpSitesFunc)dlsym(RTLD_DEFAULT, "pf_alloc_dump_sites")) {}
+
+    bool available() const { return reset_ && read_ && dump_sites_; }
+
+    void reset() { reset_(); }
+
+    PfAllocStats read() {
+        PfAllocStats s;
+        read_(&s);
+        return s;
+    }
+
+    void clear_sites() { dump_sites_("", 0); }
+
+    void dump_sites(const char* prefix, unsigned top = 10) {
+        std::cout.flush(); // The shim writes with stdio
+        dump_sites_(prefix, top);
+    }
+
+    /**
+     * @brief Prints <PHASE>_ALLOCS/FREES/BYTES per operation and the phase's peak live bytes.
+     * ALLOCS_PER_ENCODE / ALLOCS_PER_DECODE are the figures runner.py tabulates.
+     */
+    static void print(const std::string& phase, const PfAllocStats& s, size_t ops) {
+        std::cout << "ALLOCS_PER_" << phase << "=" << (double)s.mallocs / ops << std::endl;
+        std::cout << "FREES_PER_" << phase << "=" << (double)s.frees / ops << std::endl;
+        std::cout << "ALLOC_BYTES_PER_" << phase << "=" << (double)s.bytes / ops << std::endl;
+        std::cout << "PEAK_LIVE_BYTES_" << phase << "=" << s.peak_live_bytes << std::endl;
+    }
+
+private:
+    PfAllocResetFunc reset_;
+    PfAllocReadFunc read_;
+    PfAllocDumpSitesFunc dump_sites_;
+};
+
+} // namespace pf
+
+#endif // ALLOC_PROFILER_H
@@ -0,0 +1,114 @@
+#ifndef CACHE_FLUSH_HPP
+#define CACHE_FLUSH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <sys/mman.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace pf {
+
+/**
+ * @brief Evicts the data caches by writing one byte per line of a buffer larger than the LLC.
+ * The buffer is an anonymous mapping outside the malloc heap, so mallinfo2()
+ * baselines are unaffected, and its pages are dropped after every sweep so they
+ * do not count towards the RSS of the next measurement.
+ */
+class CacheFlusher {
+public:
+    static constexpr size_t kLineBytes = 64;
+
+    explicit CacheFlusher(size_t bytes) : bytes_(bytes) {
+        void* p = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        buf_ = (p == MAP_FAILED) ? nullptr : (uint8_t*)p;
+    }
+
+    ~CacheFlusher() {
+        if (buf_) munmap(buf_, bytes_);
+    }
+
+    CacheFlusher(const CacheFlusher&) = delete;
+    CacheFlusher& operator=(const CacheFlusher&) = delete;
+
+    void flush() {
+        if (!buf_) return;
+        volatile uint8_t* p = buf_; // Keep the stores
+        for (size_t i = 0; i < bytes_; i += kLineBytes) p[i]++;
+        madvise(buf_, bytes_, MADV_DONTNEED);
+    }
+
+    size_t size() const { return buf_ ? bytes_ : 0; }
+
+private:
+    size_t bytes_;
+    uint8_t* buf_;
+};
+
+/**
+ * @brief Size of the largest data/unified cache of CPU 0, from sysfs.
+ * @return `fallback` if sysfs does not describe the caches (containers, non-Linux)
+ */
+inline size_t llc_bytes(size_t fallback = 32u << 20) {
+    size_t best = 0;
+    int best_level = 0;
+    for (int i = 0; i < 16; i++) {
+        std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(i) + "/";
+        char type[32] = {0};
+        int level = 0;
+        size_t kb = 0;
+        char unit = 'K';
+        FILE* fp = fopen((dir + "type").c_str(), "r");
+        if (!fp) break;
+        int ok = fscanf(fp, "%31s", type);
+        fclose(fp);
+        if (ok != 1 || std::string(type) == "Instruction") continue;
+        if (!(fp = fopen((dir + "level").c_str(), "r"))) continue;
+        ok = fscanf(fp, "%d", &level);
+        fclose(fp);
+        if (ok != 1 || !(fp = fopen((dir + "size").c_str(), "r"))) continue;
+        ok = fscanf(fp, "%zu%c", &kb, &unit);
+        fclose(fp);
+        if (ok < 1) continue;
+        size_t bytes = kb << (unit == 'M' ? 20 : 10);
+        if (level > best_level || (level == best_level && bytes > best)) {
+            best = bytes;
+            best_level = level;
+        }
+    }
+    return best ? best : fallback;
+}
+
+/**
+ * @brief Writes back and invalidates every cache line of [p, p + len) in all cache levels.
+ * Call evict_fence() before timing whatever should find the lines cold.
+ */
+inline void evict_lines(const void* p, size_t len) {
+    if (len == 0) return;
+    uintptr_t line = (uintptr_t)p & ~(uintptr_t)(CacheFlusher::kLineBytes - 1);
+    const uintptr_t end = (uintptr_t)p + len;
+    for (; line < end; line += CacheFlusher::kLineBytes) {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_clflush((const void*)line);
+#elif defined(__aarch64__)
+        asm volatile("dc civac, %0" :: "r"(line) : "memory");
+#else
+        (void)line; // No user-space cache maintenance: the line stays cached
+#endif
+    }
+}
+
+inline void evict_fence() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_mfence();
+#elif defined(__aarch64__)
+    asm volatile("dsb ish" ::: "memory");
+#endif
+}
+
+} // namespace pf
+
+#endif // CACHE_FLUSH_HPP
@@ -0,0 +1,270 @@
+#ifndef CAPTURE_FILE_HPP
+#define CAPTURE_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mavlink_types.h"
+
+namespace pf {
+
+/**
+ * @brief Capture file (.pfcap): a recorded stream of one payload type.
+ *
+ *   CaptureHeader (32 bytes)
+ *   record 0, record 1, ... record count-1
+ *
+ * Fixed-size types store each record as the raw `mavlink_types.h` struct, so a
+ * record is usable in place. `record_size` is sizeof(T) and guards against
+ * reading a file written with a different struct layout. GPSBlock records are
+ * variable length: a uint64_t record count followed by that many PayloadGPSRaw
+ * structs (`record_size` then gives the size of one of those).
+ * Files use the host's byte order and padding; they are a benchmark input, not
+ * an interchange format.
+ */
+struct CaptureHeader {
+    char magic[8];        // kCaptureMagic
+    uint32_t version;     // kCaptureVersion
+    uint32_t type;        // CaptureType
+    uint32_t record_size; // sizeof the stored struct
+    uint32_t reserved;
+    uint64_t count;       // Records in the file
+};
+static_assert(sizeof(CaptureHeader) == 32, "CaptureHeader must stay 32 bytes so records stay 8-byte aligned");
+
+constexpr char kCaptureMagic[8] = {'P', 'F', 'C', 'A', 'P', 0, 0, 0};
+constexpr uint32_t kCaptureVersion = 1;
+
+enum class CaptureType : uint32_t { GPSRaw = 1, GlobalPosition, Odometry, Attitude, Battery, Status, GPSBlock };
+
+constexpr CaptureType capture_type(const PayloadGPSRaw*) { return CaptureType::GPSRaw; }
+constexpr CaptureType capture_type(const PayloadGlobalPosition*) { return CaptureType::GlobalPosition; }
+constexpr CaptureType capture_type(const PayloadOdometry*) { return CaptureType::Odometry; }
+constexpr CaptureType capture_type(const PayloadAttitude*) { return CaptureType::Attitude; }
+constexpr CaptureType capture_type(const PayloadBattery*) { return CaptureType::Battery; }
+constexpr CaptureType capture_type(const PayloadStatus*) { return CaptureType::Status; }
+constexpr CaptureType capture_type(const PayloadGPSBlock*) { return CaptureType::GPSBlock; }
+
+// Scenario name, as used by the runners and runner.py
+inline const char* capture_type_name(uint32_t type) {
+    switch ((CaptureType)type) {
+        case CaptureType::GPSRaw: return "GPSRaw";
+        case CaptureType::GlobalPosition: return "GlobalPosition";
+        case CaptureType::Odometry: return "Odometry";
+        case CaptureType::Attitude: return "Attitude";
+        case CaptureType::Battery: return "Battery";
+        case CaptureType::Status: return "Status";
+        case CaptureType::GPSBlock: return "GPSBlock";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * @return The CaptureType stored in the file's header, or 0 if it is not a capture file
+ */
+inline uint32_t read_capture_type(const std::string& path) {
+    CaptureHeader h;
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return 0;
+    bool ok = fread(&h, sizeof(h), 1, fp) == 1 && memcmp(h.magic, kCaptureMagic, sizeof(h.magic)) == 0;
+    fclose(fp);
+    return ok ? h.type : 0;
+}
+
+template <typename T> struct CaptureRecord { typedef T Stored; };
+template <> struct CaptureRecord<PayloadGPSBlock> { typedef PayloadGPSRaw Stored; };
+
+/**
+ * @brief Appends records of type T; the header's count is filled in by close().
+ */
+template <typename T>
+class CaptureWriter {
+public:
+    ~CaptureWriter() { close(); }
+
+    bool open(const std::string& path) {
+        fp_ = fopen(path.c_str(), "wb");
+        if (!fp_) return false;
+        CaptureHeader h = header();
+        return fwrite(&h, sizeof(h), 1, fp_) == 1;
+    }
+
+    bool write(const T& record) {
+        count_++;
+        return fwrite(&record, sizeof(T), 1, fp_) == 1;
+    }
+
+    /**
+     * @return false if any write failed
+     */
+    bool close() {
+        if (!fp_) return ok_;
+        CaptureHeader h = header();
+        ok_ = !ferror(fp_) && fseek(fp_, 0, SEEK_SET) == 0 && fwrite(&h, sizeof(h), 1, fp_) == 1;
+        ok_ = (fclose(fp_) == 0) && ok_;
+        fp_ = nullptr;
+        return ok_;
+    }
+
+private:
+    CaptureHeader header() const {
+        CaptureHeader h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, kCaptureMagic, sizeof(h.magic));
+        h.version = kCaptureVersion;
+        h.type = (uint32_t)capture_type((const T*)nullptr);
+        h.record_size = sizeof(typename CaptureRecord<T>::Stored);
+        h.count = count_;
+        return h;
+    }
+
+    FILE* fp_ = nullptr;
+    uint64_t count_ = 0;
+    bool ok_ = true;
+};
+
+template <>
+inline bool CaptureWriter<PayloadGPSBlock>::write(const PayloadGPSBlock& block) {
+    count_++;
+    uint64_t n = block.messages.size();
+    return fwrite(&n, sizeof(n), 1, fp_) == 1 &&
+           fwrite(block.messages.data(), sizeof(PayloadGPSRaw), n, fp_) == n;
+}
+
+/**
+ * @brief Streams the records of a capture file from a read-only mapping.
+ * The file is mapped whole with MADV_SEQUENTIAL, so the kernel reads ahead, and
+ * pages that fall more than kReleaseBytes behind the cursor are dropped with
+ * MADV_DONTNEED. RSS therefore stays flat however large the corpus is. next()
+ * wraps around to the first record after the last.
+ */
+template <typename T>
+class CaptureStream {
+public:
+    static constexpr size_t kReleaseBytes = 8 << 20;
+
+    ~CaptureStream() {
+        if (map_) munmap((void*)map_, size_);
+    }
+
+    /**
+     * @return An error message, or an empty string once the file is mapped
+     */
+    std::string open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return "cannot open " + path;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CaptureHeader)) {
+            ::close(fd);
+            return path + " is not a capture file";
+        }
+        size_ = (size_t)st.st_size;
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return "cannot map " + path;
+        map_ = (const uint8_t*)p;
+        madvise((void*)map_, size_, MADV_SEQUENTIAL);
+
+        const CaptureHeader& h = *(const CaptureHeader*)map_;
+        if (memcmp(h.magic, kCaptureMagic, sizeof(h.magic)) != 0 || h.version != kCaptureVersion) {
+            return path + " is not a version " + std::to_string(kCaptureVersion) + " capture file";
+        }
+        if (h.type != (uint32_t)capture_type((const T*)nullptr)) {
+            return path + " holds " + capture_type_name(h.type) + " records, this runner expects " +
+                   capture_type_name((uint32_t)capture_type((const T*)nullptr));
+        }
+        if (h.record_size != sizeof(typename CaptureRecord<T>::Stored)) {
+            return path + " was written with a different struct layout (record_size " +
+                   std::to_string(h.record_size) + ")";
+        }
+        if (h.count == 0) return path + " has no records";
+        count_ = h.count;
+        std::string err = check_size();
+        rewind(); // check_size() may have paged in the whole file
+        return err;
+    }
+
+    uint64_t count() const { return count_; }
+
+    // Restarts at the first record.
+    void rewind() {
+        // Drop what is still resident from the previous pass.
+        madvise((void*)(map_ + released_), size_ - released_, MADV_DONTNEED);
+        index_ = 0;
+        offset_ = sizeof(CaptureHeader);
+        released_ = 0;
+    }
+
+    /**
+     * @brief The next record; valid until the following next() call.
+     */
+    const T& next() {
+        if (index_ == count_) rewind();
+        index_++;
+        const T& r = *(const T*)(map_ + offset_);
+        offset_ += sizeof(T);
+        release_behind();
+        return r;
+    }
+
+private:
+    std::string check_size() const {
+        if (size_ != sizeof(CaptureHeader) + count_ * sizeof(T)) return "capture file size does not match its record count";
+        return "";
+    }
+
+    void release_behind() {
+        if (offset_ - released_ < 2 * kReleaseBytes) return;
+        madvise((void*)(map_ + released_), kReleaseBytes, MADV_DONTNEED);
+        released_ += kReleaseBytes;
+    }
+
+    const uint8_t* map_ = nullptr;
+    size_t size_ = 0;
+    uint64_t count_ = 0;
+    uint64_t index_ = 0;
+    size_t offset_ = sizeof(CaptureHeader);
+    size_t released_ = 0; // Page-aligned: a multiple of kReleaseBytes
+    PayloadGPSBlock block_; // GPSBlock only: the record copied out of the mapping
+};
+
+// GPSBlock records are length-prefixed, so they are walked rather than indexed
+// and copied into a reused vector.
+template <>
+inline std::string CaptureStream<PayloadGPSBlock>::check_size() const {
+    size_t offset = sizeof(CaptureHeader);
+    for (uint64_t i = 0; i < count_; i++) {
+        uint64_t n;
+        if (size_ - offset < sizeof(n)) return "capture file is truncated";
+        memcpy(&n, map_ + offset, sizeof(n));
+        offset += sizeof(n);
+        if (n > (size_ - offset) / sizeof(PayloadGPSRaw)) return "capture file is truncated";
+        offset += n * sizeof(PayloadGPSRaw);
+    }
+    if (offset != size_) return "capture file has trailing bytes";
+    return "";
+}
+
+template <>
+inline const PayloadGPSBlock& CaptureStream<PayloadGPSBlock>::next() {
+    if (index_ == count_) rewind();
+    index_++;
+    uint64_t n;
+    memcpy(&n, map_ + offset_, sizeof(n));
+    offset_ += sizeof(n);
+    block_.messages.resize(n);
+    memcpy(block_.messages.data(), map_ + offset_, n * sizeof(PayloadGPSRaw));
+    offset_ += n * sizeof(PayloadGPSRaw);
+    release_behind();
+    return block_;
+}
+
+} // namespace pf
+
+#endif // CAPTURE_FILE_HPP
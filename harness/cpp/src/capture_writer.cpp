@@ -0,0 +1,84 @@
+// Capture writer: generates a .pfcap corpus for --corpus runs from the pool
+// generators (uniform) or the flight simulator (flight, replay). A converter
+// from real flight logs only needs CaptureWriter<T> from capture_file.hpp.
+#include "runner_template.hpp"
+
+namespace {
+
+template <typename T>
+int write_capture(const std::string& path, uint64_t count, pf::DataMode mode) {
+    pf::CaptureWriter<T> writer;
+    if (!writer.open(path)) {
+        std::cerr << "Cannot create " << path << std::endl;
+        return 1;
+    }
+    const uint64_t length = pf::FlightSimulator::stream_length<T>();
+    pf::FlightSimulator flight(pf::gen());
+    uint64_t k = 0;
+    T p;
+    for (uint64_t i = 0; i < count; i++) {
+        switch (mode) {
+            case pf::DataMode::Flight: {
+                pf::FlightSimulator sim(pf::gen());
+                sim.sample(pf::gen() % length, p);
+                break;
+            }
+            case pf::DataMode::Replay:
+                // Flights back to back, as in a directory of logs
+                if (k == length) {
+                    flight = pf::FlightSimulator(pf::gen());
+                    k = 0;
+                }
+                flight.sample(k++, p);
+                break;
+            default:
+                p = pf::generate_random_data<T>();
+                break;
+        }
+        if (!writer.write(p)) break;
+    }
+    if (!writer.close()) {
+        std::cerr << "Write to " << path << " failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << count << " records to " << path << std::endl;
+    return 0;
+}
+
+typedef int (*WriteFunc)(const std::string& path, uint64_t count, pf::DataMode mode);
+
+struct CaptureScenario {
+    const char* name;
+    WriteFunc write;
+};
+
+const CaptureScenario kScenarios[] = {
+    {"GPSRaw", &write_capture<pf::PayloadGPSRaw>},
+    {"Battery", &write_capture<pf::PayloadBattery>},
+    {"Odometry", &write_capture<pf::PayloadOdometry>},
+    {"Attitude", &write_capture<pf::PayloadAttitude>},
+    {"GlobalPosition", &write_capture<pf::PayloadGlobalPosition>},
+    {"Status", &write_capture<pf::PayloadStatus>},
+    {"GPSBlock", &write_capture<pf::PayloadGPSBlock>},
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <out.pfcap> <scenario> <records> [--data uniform|flight|replay] (default: replay)" << std::endl;
+        std::cerr << "Scenarios:";
+        for (const CaptureScenario& s : kScenarios) std::cerr << " " << s.name;
+        std::cerr << std::endl;
+        return 1;
+    }
+    pf::RunnerOptions opts;
+    opts.data = pf::DataMode::Replay;
+    if (!pf::parse_runner_options(argc, argv, 4, opts)) return 1;
+
+    for (const CaptureScenario& s : kScenarios) {
+        if (s.name == std::string(argv[2])) return s.write(argv[1], std::stoull(argv[3]), opts.data);
+    }
+    std::cerr << "Unknown scenario: " << argv[2] << std::endl;
+    return 1;
+}
@@ -0,0 +1,285 @@
+#ifndef FLIGHT_SIM_HPP
+#define FLIGHT_SIM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "mavlink_types.h"
+
+namespace pf {
+
+/**
+ * @brief Deterministic multirotor flight for realistic payloads (--data flight|replay).
+ *
+ * A seed fixes the home position and the circuit; the vehicle state is then a
+ * closed-form function of time: a 60 s climb to 100 m, an 18 min circuit at
+ * 12 m/s and a 60 s descent. Each message stream samples that state at its usual
+ * MAVLink rate, so message i of a stream is cheap to produce for any i and
+ * consecutive messages move as a real log does: monotonic timestamps, smooth
+ * lat/lon/alt, voltages that sag as the pack drains. Sensor noise comes from a
+ * hash of (seed, stream, index, channel), never from shared RNG state.
+ */
+class FlightSimulator {
+public:
+    static constexpr double kClimbSeconds = 60.0;
+    static constexpr double kCircuitSeconds = 1080.0;
+    static constexpr double kDescentSeconds = 60.0;
+    static constexpr double kMissionSeconds = kClimbSeconds + kCircuitSeconds + kDescentSeconds;
+    static constexpr double kBootSeconds = 45.0; // Armed this long after boot
+    static constexpr int kBlockRecords = 50;     // GPS fixes per GPSBlock
+
+    explicit FlightSimulator(uint64_t seed) : seed_(seed) {
+        home_lat_ = 47.0 + unit(0, 0, 1);        // Degrees
+        home_lon_ = 8.0 + unit(0, 0, 2);
+        home_alt_ = 400.0 + 200.0 * unit(0, 0, 3); // Metres MSL
+        course_ = 2.0 * kPi * unit(0, 0, 4);     // Initial heading of the circuit
+        epoch_us_ = 1700000000000000ull + (uint64_t)(unit(0, 0, 5) * 3.0e13);
+    }
+
+    // Stream rates (Hz); message `index` of a stream is sampled at index / rate seconds.
+    static constexpr double rate(const PayloadGPSRaw*) { return 5.0; }
+    static constexpr double rate(const PayloadGlobalPosition*) { return 10.0; }
+    static constexpr double rate(const PayloadAttitude*) { return 50.0; }
+    static constexpr double rate(const PayloadOdometry*) { return 30.0; }
+    static constexpr double rate(const PayloadBattery*) { return 1.0; }
+    static constexpr double rate(const PayloadStatus*) { return 0.5; }
+    static constexpr double rate(const PayloadGPSBlock*) { return 5.0 / kBlockRecords; }
+
+    /**
+     * @brief Number of messages stream T produces over the mission.
+     */
+    template <typename T>
+    static uint64_t stream_length() { return (uint64_t)(kMissionSeconds * rate((const T*)nullptr)); }
+
+    void sample(uint64_t index, PayloadGPSRaw& p) const {
+        const double t = index / rate(&p);
+        State s = state(t);
+        memset(&p, 0, sizeof(p));
+        p.time_usec = boot_us(t);
+        p.timestamp = epoch_us_ + p.time_usec;
+        p.block_number = (uint32_t)(index / kBlockRecords);
+        for (int i = 0; i < 32; i += 8) {
+            uint64_t h = mix(seed_ ^ mix(index * 4 + i / 8 + 1));
+            memcpy(p.hash + i, &h, 8);
+        }
+        p.fix_type = t < 20.0 ? 3 : 4; // 3D, then DGPS once corrections arrive
+        p.lat = lat_e7(s) + (int32_t)(3 * noise(1, index, 0));
+        p.lon = lon_e7(s) + (int32_t)(3 * noise(1, index, 1));
+        p.alt = (int32_t)((home_alt_ + s.up) * 1000.0 + 150 * noise(1, index, 2));
+        p.eph = (uint16_t)(90 + 8 * noise(1, index, 3));
+        p.epv = (uint16_t)(140 + 12 * noise(1, index, 4));
+        p.vel = (uint16_t)(std::hypot(s.vn, s.ve) * 100.0);
+        p.cog = centidegrees(s.yaw);
+        p.satellites_visible = (uint8_t)(15 + std::lround(2.0 * std::sin(t / 150.0)));
+        p.alt_ellipsoid = p.alt + 47400; // Geoid separation
+        p.h_acc = (uint32_t)(850 + 80 * noise(1, index, 5));
+        p.v_acc = (uint32_t)(1300 + 120 * noise(1, index, 6));
+        p.vel_acc = (uint32_t)(250 + 30 * noise(1, index, 7));
+        p.hdg_acc = (uint32_t)(45000 + 5000 * noise(1, index, 8));
+    }
+
+    void sample(uint64_t index, PayloadGlobalPosition& p) const {
+        const double t = index / rate(&p);
+        State s = state(t);
+        memset(&p, 0, sizeof(p));
+        p.time_boot_ms = (uint32_t)(boot_us(t) / 1000);
+        p.lat = lat_e7(s);
+        p.lon = lon_e7(s);
+        p.alt = (int32_t)((home_alt_ + s.up) * 1000.0);
+        p.relative_alt = (int32_t)(s.up * 1000.0);
+        p.vx = (int16_t)std::lround(s.vn * 100.0 + 5 * noise(2, index, 0));
+        p.vy = (int16_t)std::lround(s.ve * 100.0 + 5 * noise(2, index, 1));
+        p.vz = (int16_t)std::lround(-s.vu * 100.0 + 3 * noise(2, index, 2));
+        p.hdg = centidegrees(s.yaw);
+    }
+
+    void sample(uint64_t index, PayloadAttitude& p) const {
+        const double t = index / rate(&p);
+        State s = state(t);
+        memset(&p, 0, sizeof(p));
+        p.time_boot_ms = (uint32_t)(boot_us(t) / 1000);
+        p.roll = (float)(s.roll + 0.004 * noise(3, index, 0));
+        p.pitch = (float)(s.pitch + 0.004 * noise(3, index, 1));
+        p.yaw = (float)std::remainder(s.yaw + 0.002 * noise(3, index, 2), 2.0 * kPi); // -pi..pi
+        p.rollspeed = (float)(0.02 * noise(3, index, 3));
+        p.pitchspeed = (float)(0.02 * noise(3, index, 4));
+        p.yawspeed = (float)(s.yaw_rate + 0.01 * noise(3, index, 5));
+    }
+
+    void sample(uint64_t index, PayloadOdometry& p) const {
+        const double t = index / rate(&p);
+        State s = state(t);
+        memset(&p, 0, sizeof(p));
+        p.time_usec = boot_us(t);
+        p.frame_id = 1;        // MAV_FRAME_LOCAL_NED
+        p.child_frame_id = 12; // MAV_FRAME_BODY_FRD
+        p.x = (float)(s.north + 0.02 * noise(4, index, 0));
+        p.y = (float)(s.east + 0.02 * noise(4, index, 1));
+        p.z = (float)(-s.up + 0.03 * noise(4, index, 2));
+        quaternion(s.roll, s.pitch, s.yaw, p.q);
+        p.vx = (float)s.vn;
+        p.vy = (float)s.ve;
+        p.vz = (float)-s.vu;
+        p.rollspeed = (float)(0.02 * noise(4, index, 3));
+        p.pitchspeed = (float)(0.02 * noise(4, index, 4));
+        p.yawspeed = (float)s.yaw_rate;
+        // Upper triangle of a 6x6 row-major matrix: only the diagonal (0, 6, 11, 15, 18, 20) is set.
+        const int diagonal[6] = {0, 6, 11, 15, 18, 20};
+        const float pose_var[6] = {0.04f, 0.04f, 0.09f, 1e-4f, 1e-4f, 4e-4f};
+        const float vel_var[6] = {0.01f, 0.01f, 0.02f, 1e-3f, 1e-3f, 2e-3f};
+        for (int i = 0; i < 6; i++) {
+            p.pose_covariance[diagonal[i]] = pose_var[i];
+            p.velocity_covariance[diagonal[i]] = vel_var[i];
+        }
+    }
+
+    void sample(uint64_t index, PayloadBattery& p) const {
+        const double t = index / rate(&p);
+        const double used = clamp01(t / kMissionSeconds);
+        memset(&p, 0, sizeof(p));
+        p.id = 0;
+        p.battery_function = 1; // MAV_BATTERY_FUNCTION_ALL
+        p.type = 3;             // MAV_BATTERY_TYPE_LIPO
+        p.temperature = (int16_t)(2500 + 1500 * used + 20 * noise(5, index, 0));
+        const double amps = (t < kClimbSeconds ? 24.0 : 19.0) + 0.5 * noise(5, index, 1);
+        // 6S pack: resting voltage falls with charge used, minus sag under load
+        const double cell_mv = 4180.0 - 620.0 * used - 4.0 * amps;
+        for (int i = 0; i < 10; i++) {
+            p.voltages[i] = i < 6 ? (uint16_t)(cell_mv + 3 * noise(5, index, 2 + i)) : UINT16_MAX; // Unused cells
+        }
+        p.current_battery = (int16_t)(amps * 100.0);         // cA
+        p.current_consumed = (int32_t)(2000.0 * t / 360.0);  // mAh at ~20 A
+        p.energy_consumed = (int32_t)(6 * cell_mv / 1000.0 * 20.0 * t / 100.0); // hJ
+        p.battery_remaining = (int8_t)(100 - std::lround(75.0 * used));
+    }
+
+    void sample(uint64_t index, PayloadStatus& p) const {
+        // Autopilot STATUSTEXT vocabulary; %u takes first + index % count (a waypoint, IMU, ...)
+        struct Line { uint8_t severity; const char* text; unsigned first, count; };
+        static const Line kLines[] = {
+            {6, "EKF3 IMU%u is using GPS", 0, 2},
+            {6, "Reached command #%u", 1, 24},
+            {6, "Mission: %u WP", 1, 24},
+            {6, "GPS 1: u-blox fix type %u", 3, 4},
+            {5, "EKF3 IMU%u origin set", 0, 2},
+            {4, "Battery 1 is low 21.%02uV used 4800 mAh", 10, 90},
+            {4, "EKF variance", 0, 1},
+            {4, "Vibration compensation ON", 0, 1},
+            {3, "PreArm: Compass %u not calibrated", 1, 3},
+            {6, "Mode change to AUTO", 0, 1},
+            {6, "Arming motors", 0, 1},
+            {6, "Land complete", 0, 1},
+        };
+        memset(&p, 0, sizeof(p));
+        const uint64_t h = mix(seed_ ^ mix(index * 8 + 6));
+        // Mostly progress reports; a warning about one message in eight
+        const size_t common = 5;
+        const size_t n = sizeof(kLines) / sizeof(kLines[0]);
+        const Line& line = kLines[(h & 7) ? (h >> 8) % common : common + (h >> 8) % (n - common)];
+        p.severity = line.severity;
+        snprintf(p.text, sizeof(p.text), line.text, line.first + (unsigned)(index % line.count));
+    }
+
+    void sample(uint64_t index, PayloadGPSBlock& p) const {
+        p.messages.resize(kBlockRecords);
+        for (int i = 0; i < kBlockRecords; i++) sample(index * kBlockRecords + i, p.messages[i]);
+    }
+
+private:
+    static constexpr double kPi = 3.14159265358979323846;
+    static constexpr double kMetresPerDegree = 111320.0;
+    static constexpr double kCruiseSpeed = 12.0; // m/s
+    static constexpr double kCircuitRadius = 300.0;
+    static constexpr double kCruiseAlt = 100.0;
+
+    struct State {
+        double north, east, up; // Metres from home
+        double vn, ve, vu;      // m/s
+        double roll, pitch, yaw, yaw_rate;
+    };
+
+    State state(double t) const {
+        State s{};
+        const double w = kCruiseSpeed / kCircuitRadius;
+        const double circuit = std::min(std::max(t - kClimbSeconds, 0.0), kCircuitSeconds);
+        const double a = w * circuit;
+        // Circle through home, entered on heading course_
+        const double along = kCircuitRadius * std::sin(a), across = kCircuitRadius * (1.0 - std::cos(a));
+        s.north = along * std::cos(course_) - across * std::sin(course_);
+        s.east = along * std::sin(course_) + across * std::cos(course_);
+        s.yaw = course_ + a;
+
+        if (t < kClimbSeconds) {
+            const double x = clamp01(t / kClimbSeconds);
+            s.up = kCruiseAlt * x * x * (3.0 - 2.0 * x);
+            s.vu = kCruiseAlt * 6.0 * x * (1.0 - x) / kClimbSeconds;
+        } else if (circuit < kCircuitSeconds) {
+            s.up = kCruiseAlt;
+            s.vn = kCruiseSpeed * std::cos(s.yaw);
+            s.ve = kCruiseSpeed * std::sin(s.yaw);
+            s.yaw_rate = w;
+            s.roll = std::atan(kCruiseSpeed * w / 9.81); // Coordinated turn
+            s.pitch = -0.06;                             // Nose down in forward flight
+        } else {
+            const double x = clamp01((t - kClimbSeconds - kCircuitSeconds) / kDescentSeconds);
+            s.up = kCruiseAlt * (1.0 - x);
+            s.vu = -kCruiseAlt / kDescentSeconds;
+        }
+        return s;
+    }
+
+    int32_t lat_e7(const State& s) const { return (int32_t)std::lround((home_lat_ + s.north / kMetresPerDegree) * 1e7); }
+
+    int32_t lon_e7(const State& s) const {
+        return (int32_t)std::lround((home_lon_ + s.east / (kMetresPerDegree * std::cos(home_lat_ * kPi / 180.0))) * 1e7);
+    }
+
+    uint64_t boot_us(double t) const { return (uint64_t)std::llround((kBootSeconds + t) * 1e6); }
+
+    static uint16_t centidegrees(double rad) {
+        double deg = std::fmod(rad * 180.0 / kPi, 360.0);
+        if (deg < 0) deg += 360.0;
+        return (uint16_t)std::min(35999.0, std::floor(deg * 100.0));
+    }
+
+    // ZYX Euler angles to a (w, x, y, z) quaternion
+    static void quaternion(double roll, double pitch, double yaw, float q[4]) {
+        const double cr = std::cos(roll / 2), sr = std::sin(roll / 2);
+        const double cp = std::cos(pitch / 2), sp = std::sin(pitch / 2);
+        const double cy = std::cos(yaw / 2), sy = std::sin(yaw / 2);
+        q[0] = (float)(cr * cp * cy + sr * sp * sy);
+        q[1] = (float)(sr * cp * cy - cr * sp * sy);
+        q[2] = (float)(cr * sp * cy + sr * cp * sy);
+        q[3] = (float)(cr * cp * sy - sr * sp * cy);
+    }
+
+    static double clamp01(double x) { return x < 0.0 ? 0.0 : (x > 1.0 ? 1.0 : x); }
+
+    // splitmix64 finaliser
+    static uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    // Uniform in [0, 1)
+    double unit(uint32_t stream, uint64_t index, uint32_t channel) const {
+        uint64_t h = mix(seed_ ^ mix(((uint64_t)stream << 56) ^ ((uint64_t)channel << 48) ^ index));
+        return (h >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Uniform in [-1, 1)
+    double noise(uint32_t stream, uint64_t index, uint32_t channel) const { return 2.0 * unit(stream, index, channel) - 1.0; }
+
+    uint64_t seed_;
+    double home_lat_, home_lon_, home_alt_;
+    double course_;
+    uint64_t epoch_us_;
+};
+
+} // namespace pf
+
+#endif // FLIGHT_SIM_HPP
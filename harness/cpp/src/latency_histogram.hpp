@@ -0,0 +1,123 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace pf {
+
+/**
+ * @brief Low-overhead timestamp counter for per-operation timing.
+ * x86: TSC (lfence-ordered rdtsc). AArch64: virtual counter (cntvct_el0).
+ * Elsewhere: steady_clock nanoseconds (ticks_per_ns() == 1).
+ */
+class CycleClock {
+public:
+    static inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_lfence();
+        uint64_t t = __rdtsc();
+        _mm_lfence();
+        return t;
+#elif defined(__aarch64__)
+        uint64_t t;
+        asm volatile("isb; mrs %0, cntvct_el0" : "=r"(t) :: "memory");
+        return t;
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /**
+     * @brief Measure counter ticks per nanosecond against steady_clock.
+     * Spins for roughly `window_ms`; call once before the timed loops.
+     */
+    static double calibrate(int window_ms = 50) {
+        using namespace std::chrono;
+        auto w0 = steady_clock::now();
+        uint64_t c0 = now();
+        while (steady_clock::now() - w0 < milliseconds(window_ms)) {}
+        uint64_t c1 = now();
+        auto w1 = steady_clock::now();
+        double ns = (double)duration_cast<nanoseconds>(w1 - w0).count();
+        return ns > 0 ? (double)(c1 - c0) / ns : 1.0;
+    }
+};
+
+/**
+ * @brief HDR-style log-bucketed histogram with fixed memory (no allocation on record()).
+ * Values below 2*kSubBuckets are exact; above that each power of two is split
+ * into kSubBuckets linear buckets, so the relative error is bounded by 1/kSubBuckets.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr uint64_t kSubBuckets = 1ull << kSubBucketBits;       // 32 -> ~3% resolution
+    static constexpr size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets; // Covers the full uint64 range
+
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        memset(counts_, 0, sizeof(counts_));
+        total_ = 0;
+        max_ = 0;
+    }
+
+    void record(uint64_t value) {
+        counts_[bucket_of(value)]++;
+        total_++;
+        if (value > max_) max_ = value;
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t max() const { return max_; }
+
+    /**
+     * @brief Value at percentile p (0-100), reported as the upper edge of its bucket.
+     */
+    uint64_t percentile(double p) const {
+        if (total_ == 0) return 0;
+        uint64_t rank = (uint64_t)(p / 100.0 * (double)total_ + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > total_) rank = total_;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < kBuckets; b++) {
+            seen += counts_[b];
+            if (seen >= rank) {
+                uint64_t edge = upper_edge(b);
+                return edge < max_ ? edge : max_;
+            }
+        }
+        return max_;
+    }
+
+    static size_t bucket_of(uint64_t v) {
+        if (v < 2 * kSubBuckets) return (size_t)v;
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - kSubBucketBits;
+        uint64_t top = v >> shift; // In [kSubBuckets, 2*kSubBuckets)
+        return (size_t)((uint64_t)(shift + 1) * kSubBuckets + (top - kSubBuckets));
+    }
+
+    static uint64_t upper_edge(size_t b) {
+        if (b < 2 * kSubBuckets) return b;
+        int shift = (int)(b / kSubBuckets) - 1;
+        uint64_t top = b % kSubBuckets + kSubBuckets;
+        return ((top + 1) << shift) - 1;
+    }
+
+private:
+    uint64_t counts_[kBuckets];
+    uint64_t total_;
+    uint64_t max_;
+};
+
+} // namespace pf
+
+#endif // LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,193 @@
+#ifndef PLUGIN_CHECK_HPP
+#define PLUGIN_CHECK_HPP
+
+#include "runner_template.hpp"
+#include <dlfcn.h>
+#include <string>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief Support for the per-format integrity tests that go through every
+ * scenario plugin: loading libpf_<format>[_<scenario>].so from the build
+ * tree, the payloads to round-trip, and a field-by-field comparison.
+ */
+
+// Plugin file suffixes, as runner_matrix.cpp names them
+template <typename T> constexpr const char* scenario_suffix();
+template <> constexpr const char* scenario_suffix<PayloadGPSRaw>() { return ""; }
+template <> constexpr const char* scenario_suffix<PayloadBattery>() { return "_battery"; }
+template <> constexpr const char* scenario_suffix<PayloadOdometry>() { return "_odometry"; }
+template <> constexpr const char* scenario_suffix<PayloadAttitude>() { return "_attitude"; }
+template <> constexpr const char* scenario_suffix<PayloadGlobalPosition>() { return "_global_position"; }
+template <> constexpr const char* scenario_suffix<PayloadStatus>() { return "_status"; }
+template <> constexpr const char* scenario_suffix<PayloadGPSBlock>() { return "_gps_block"; }
+
+/**
+ * @brief The create_benchmark() of <dir>/libpf_<format><suffix>.so, or
+ * nullptr (with the dlerror() printed). The library stays loaded.
+ */
+template <typename T>
+CreateBenchmarkFunc load_plugin(const std::string& dir, const std::string& format) {
+    const std::string path = dir + "/libpf_" + format + scenario_suffix<T>() + ".so";
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    CreateBenchmarkFunc create = handle ? (CreateBenchmarkFunc)dlsym(handle, "create_benchmark") : nullptr;
+    if (!create) std::cerr << "Cannot load " << path << ": " << dlerror() << std::endl;
+    return create;
+}
+
+/**
+ * @brief Full-range (Uniform) and flight-like payloads, POOL_SIZE of each.
+ */
+template <typename T>
+std::vector<T> check_payloads() {
+    std::vector<T> out = make_payload_pool<T>(DataMode::Uniform);
+    std::vector<T> flight = make_payload_pool<T>(DataMode::Flight);
+    out.insert(out.end(), flight.begin(), flight.end());
+    return out;
+}
+
+/**
+ * @return The name of the first field that differs, or "" if every field of
+ * PayloadSchema<T> matches. Numbers and bytes compare bitwise, text up to
+ * its NUL, and padding never.
+ */
+template <typename T>
+std::string first_difference(const T& a, const T& b) {
+    for (const FieldDesc& d : PayloadSchema<T>::fields) {
+        const char* pa = reinterpret_cast<const char*>(&a) + d.offset;
+        const char* pb = reinterpret_cast<const char*>(&b) + d.offset;
+        const bool same = d.type == FieldType::CHARS ? strncmp(pa, pb, d.count) == 0
+                                                      : memcmp(pa, pb, field_type_size(d.type) * d.count) == 0;
+        if (!same) return d.name;
+    }
+    return "";
+}
+
+inline std::string first_difference(const PayloadGPSBlock& a, const PayloadGPSBlock& b) {
+    if (a.messages.size() != b.messages.size()) return "messages.size()";
+    for (size_t i = 0; i < a.messages.size(); i++) {
+        std::string field = first_difference(a.messages[i], b.messages[i]);
+        if (!field.empty()) return "messages[" + std::to_string(i) + "]." + field;
+    }
+    return "";
+}
+
+/**
+ * @brief A payload that decoders fill in: zeroed, so fields they skip compare equal.
+ */
+template <typename T>
+T zeroed_payload() {
+    T p;
+    memset(&p, 0, sizeof(p));
+    return p;
+}
+
+template <> inline PayloadGPSBlock zeroed_payload<PayloadGPSBlock>() { return PayloadGPSBlock(); }
+
+/**
+ * @brief GPSBlocks at the edges of the Columnar delta encoding (ColumnarBlock.h):
+ * no records, one record, and records whose fields jump between their type's
+ * extremes. The u64 fields step 0 → UINT64_MAX → 2^63 → 0 → INT64_MAX → 2^63 → 0,
+ * which makes deltas of -1 (UINT64_MAX modulo 2^64), INT64_MIN and INT64_MAX,
+ * the longest zigzag varints there are.
+ */
+inline std::vector<PayloadGPSBlock> columnar_edge_blocks() {
+    const uint64_t wide[] = {0, UINT64_MAX, 1ull << 63, 0, INT64_MAX, 1ull << 63, 0};
+    PayloadGPSBlock extremes;
+    for (size_t i = 0; i < sizeof(wide) / sizeof(wide[0]); i++) {
+        PayloadGPSRaw m = zeroed_payload<PayloadGPSRaw>();
+        const bool high = i % 2 == 1;
+        for (const FieldDesc& d : PayloadSchema<PayloadGPSRaw>::fields) {
+            char* p = reinterpret_cast<char*>(&m) + d.offset;
+            switch (d.type) {
+                case FieldType::U64: store_number(m, d, 0, wide[i]); break;
+                case FieldType::I64: store_number(m, d, 0, high ? INT64_MAX : INT64_MIN); break;
+                case FieldType::I32: store_number(m, d, 0, high ? INT32_MAX : INT32_MIN); break;
+                case FieldType::I16: store_number(m, d, 0, high ? INT16_MAX : INT16_MIN); break;
+                case FieldType::I8: store_number(m, d, 0, high ? INT8_MAX : INT8_MIN); break;
+                case FieldType::BYTES: memset(p, high ? 0xFF : 0x00, d.count); break;
+                default: store_number(m, d, 0, high ? UINT64_MAX : 0); break; // Narrowed to the type's max
+            }
+        }
+        extremes.messages.push_back(m);
+    }
+    PayloadGPSBlock one;
+    one.messages.push_back(extremes.messages[1]);
+    return {PayloadGPSBlock(), one, extremes};
+}
+
+/**
+ * @brief Round-trips the check pools and columnar_edge_blocks() through a
+ * Columnar `bench`. Each block decodes into a stale target (the extremes
+ * block), which it must replace, and every non-empty frame cut one byte short
+ * must fail to decode into the block that was encoded.
+ * @return "" if every block passes, else which block failed and how
+ */
+inline std::string columnar_round_trip_difference(IBenchmark& bench) {
+    std::vector<PayloadGPSBlock> blocks = check_payloads<PayloadGPSBlock>();
+    for (const PayloadGPSBlock& b : columnar_edge_blocks()) blocks.push_back(b);
+
+    const PayloadGPSBlock stale = columnar_edge_blocks().back();
+    for (size_t i = 0; i < blocks.size(); i++) {
+        const std::string block = "block " + std::to_string(i) + " (" + std::to_string(blocks[i].messages.size()) + " records)";
+        std::vector<uint8_t> buf = bench.encode(&blocks[i]);
+        PayloadGPSBlock back = stale;
+        bench.decode(buf, &back);
+        std::string field = first_difference(blocks[i], back);
+        if (!field.empty()) return block + " differs at " + field;
+
+        if (blocks[i].messages.empty()) continue;
+        PayloadGPSBlock cut;
+        bench.decode(buf.data(), buf.size() - 1, &cut);
+        if (first_difference(blocks[i], cut).empty()) return block + " decodes one byte short";
+    }
+    return "";
+}
+
+/**
+ * @brief Encodes and decodes every check payload through `bench`.
+ * Both pools set every field to a non-zero value almost always, so a codec
+ * that forgets a PayloadSchema<T> field shows up here.
+ * @return "" if all of them come back unchanged, else "payload <i>: <field>"
+ */
+template <typename T>
+std::string round_trip_difference(IBenchmark& bench) {
+    const std::vector<T> payloads = check_payloads<T>();
+    for (size_t i = 0; i < payloads.size(); i++) {
+        std::vector<uint8_t> buf = bench.encode(&payloads[i]);
+        T back = zeroed_payload<T>();
+        bench.decode(buf, &back);
+        std::string field = first_difference(payloads[i], back);
+        if (!field.empty()) return "payload " + std::to_string(i) + ": " + field;
+    }
+    return "";
+}
+
+/**
+ * @brief Runs round_trip_difference<T>() on each variant of the <format>
+ * plugin for T, loaded from PF_PLUGIN_DIR (set by each test target).
+ * @return One line per variant that loses a field (or per plugin that does
+ * not load); empty when every variant carries every PayloadSchema<T> field
+ */
+template <typename T>
+std::vector<std::string> schema_coverage_failures(const std::string& format, std::initializer_list<const char*> variants) {
+    std::vector<std::string> failures;
+    CreateBenchmarkFunc create = load_plugin<T>(PF_PLUGIN_DIR, format);
+    if (!create) {
+        failures.push_back("plugin " + format + scenario_suffix<T>() + " does not load");
+        return failures;
+    }
+    for (const char* variant : variants) {
+        std::unique_ptr<IBenchmark> bench = create_configured(create, variant, 1);
+        const std::string diff = round_trip_difference<T>(*bench);
+        if (!diff.empty()) failures.push_back(bench->name() + " loses " + diff);
+        bench->teardown();
+    }
+    return failures;
+}
+
+} // namespace pf
+
+#endif // PLUGIN_CHECK_HPP
@@ -0,0 +1,288 @@
+// In-process matrix runner: loads every libpf_*.so under a build tree once and
+// runs the scenario x format x variant matrix without re-spawning per cell.
+// Output is the runner KEY=VALUE protocol, grouped into CELL_BEGIN/CELL_END
+// blocks with a PHASE=MEMORY and a PHASE=TIME section per cell.
+#include "runner_template.hpp"
+#include "cache_flush.hpp"
+#include "capture_file.hpp"
+#include <filesystem>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * @brief Resets process-wide state between cells so each one starts from the
+ * same baseline a fresh runner process would: cold caches, a trimmed heap, a
+ * restarted VmHWM and the pool generator at its initial seed.
+ */
+struct CellIsolation {
+    pf::CacheFlusher flusher;
+
+    explicit CellIsolation(size_t flush_bytes) : flusher(flush_bytes) {}
+
+    void isolate() {
+        flusher.flush();
+        malloc_trim(0);
+        pf::reset_peak_rss();
+        pf::gen.seed(42);
+    }
+};
+
+typedef int (*CellFunc)(CreateBenchmarkFunc create, const std::string& variant, size_t iterations,
+                        const pf::RunnerOptions& opts, CellIsolation& iso);
+
+// One cell = memory phase then time phase, each on a fresh plugin instance.
+// Memory runs first so its cold-start delta is not hidden by the time phase's warmup.
+template <typename PayloadT>
+int run_cell(CreateBenchmarkFunc create, const std::string& variant, size_t iterations,
+             const pf::RunnerOptions& opts, CellIsolation& iso) {
+    iso.isolate();
+    std::cout << "PHASE=MEMORY" << std::endl;
+    {
+        std::unique_ptr<pf::IBenchmark> bench = pf::create_configured(create, variant, iterations);
+        int rc = pf::run_memory_cell<PayloadT>(*bench, iterations, opts);
+        bench->teardown();
+        if (rc != 0) return rc;
+    }
+
+    iso.isolate();
+    std::cout << "PHASE=TIME" << std::endl;
+    std::unique_ptr<pf::IBenchmark> bench = pf::create_configured(create, variant, iterations);
+    int rc = pf::run_time_cell<PayloadT>(*bench, iterations, opts);
+    bench->teardown();
+    return rc;
+}
+
+struct Scenario {
+    const char* suffix; // Plugin name suffix: libpf_<format>[_<suffix>].so
+    const char* name;
+    CellFunc run;
+};
+
+const Scenario kScenarios[] = {
+    {"", "GPSRaw", &run_cell<pf::PayloadGPSRaw>},
+    {"battery", "Battery", &run_cell<pf::PayloadBattery>},
+    {"odometry", "Odometry", &run_cell<pf::PayloadOdometry>},
+    {"attitude", "Attitude", &run_cell<pf::PayloadAttitude>},
+    {"global_position", "GlobalPosition", &run_cell<pf::PayloadGlobalPosition>},
+    {"status", "Status", &run_cell<pf::PayloadStatus>},
+    {"gps_block", "GPSBlock", &run_cell<pf::PayloadGPSBlock>},
+};
+
+struct PluginEntry {
+    std::string path;
+    std::string format; // Lower case, as in the file name
+    const Scenario* scenario;
+};
+
+// libpf_json_battery.so -> (json, Battery); libpf_json.so -> (json, GPSRaw)
+bool describe_plugin(const std::string& file_name, std::string& format, const Scenario*& scenario) {
+    const std::string prefix = "libpf_", ext = ".so";
+    if (file_name.size() <= prefix.size() + ext.size()) return false;
+    if (file_name.compare(0, prefix.size(), prefix) != 0) return false;
+    if (file_name.compare(file_name.size() - ext.size(), ext.size(), ext) != 0) return false;
+
+    std::string base = file_name.substr(prefix.size(), file_name.size() - prefix.size() - ext.size());
+    size_t sep = base.find('_');
+    format = base.substr(0, sep);
+    std::string suffix = (sep == std::string::npos) ? "" : base.substr(sep + 1);
+    for (const Scenario& s : kScenarios) {
+        if (suffix == s.suffix) { scenario = &s; return true; }
+    }
+    return false;
+}
+
+// Recursive scan; the first path (in sorted order) wins if a plugin appears twice.
+std::vector<PluginEntry> discover_plugins(const std::string& build_dir) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(build_dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec)) paths.push_back(it->path().string());
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<PluginEntry> plugins;
+    std::set<std::string> seen;
+    for (const std::string& path : paths) {
+        std::string file_name = fs::path(path).filename().string();
+        PluginEntry entry;
+        if (!describe_plugin(file_name, entry.format, entry.scenario)) continue;
+        if (!seen.insert(file_name).second) continue;
+        entry.path = path;
+        plugins.push_back(entry);
+    }
+    return plugins;
+}
+
+std::vector<std::string> split_list(const std::string& s) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t comma = s.find(',', start);
+        if (comma == std::string::npos) comma = s.size();
+        if (comma > start) out.push_back(s.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return out;
+}
+
+std::string to_upper(std::string s) {
+    for (char& ch : s) ch = (char)toupper((unsigned char)ch);
+    return s;
+}
+
+struct MatrixOptions {
+    std::vector<std::string> scenarios;                        // --scenario NAME (repeatable, default: all)
+    std::vector<std::string> formats;                          // --format NAME (repeatable, default: all discovered)
+    std::map<std::string, std::vector<std::string>> variants;  // --variants FORMAT=V1,V2 (default: Standard)
+    size_t flush_mb = 64;                                      // --flush-mb N: cache flush buffer size
+    pf::RunnerOptions runner;                                  // --latency-sample K, --data MODE, --cache-mode MODE, --trials K, ...
+    std::map<std::string, std::string> corpora;                // --corpus FILE (repeatable): scenario -> capture file
+};
+
+bool parse_matrix_options(int argc, char** argv, int first, MatrixOptions& opts) {
+    for (int i = first; i < argc; i++) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (flag == "--scenario") {
+            opts.scenarios.push_back(value);
+        } else if (flag == "--format") {
+            opts.formats.push_back(value);
+        } else if (flag == "--variants") {
+            size_t eq = value.find('=');
+            if (eq == std::string::npos) {
+                std::cerr << "Expected FORMAT=V1,V2 for --variants, got " << value << std::endl;
+                return false;
+            }
+            opts.variants[value.substr(0, eq)] = split_list(value.substr(eq + 1));
+        } else if (flag == "--flush-mb") {
+            opts.flush_mb = std::stoull(value);
+        } else if (flag == "--latency-sample") {
+            opts.runner.latency_sample = std::stoull(value);
+        } else if (flag == "--trials") {
+            opts.runner.trials = std::stoull(value);
+        } else if (flag == "--target-ci") {
+            opts.runner.target_ci = std::stod(value);
+        } else if (flag == "--max-trials") {
+            opts.runner.max_trials = std::stoull(value);
+        } else if (flag == "--access") {
+            opts.runner.access = value;
+        } else if (flag == "--corpus") {
+            uint32_t type = pf::read_capture_type(value);
+            if (type == 0) {
+                std::cerr << value << " is not a capture file" << std::endl;
+                return false;
+            }
+            opts.corpora[pf::capture_type_name(type)] = value;
+        } else if (flag == "--data") {
+            if (!pf::parse_data_mode(value, opts.runner.data)) {
+                std::cerr << "Unknown --data " << value << " (expected uniform, flight or replay)" << std::endl;
+                return false;
+            }
+        } else if (flag == "--cache-mode") {
+            if (!pf::parse_cache_mode(value, opts.runner.cache)) {
+                std::cerr << "Unknown --cache-mode " << value << " (expected hot, cold or flushed)" << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return false;
+        }
+    }
+    if (opts.runner.cache != pf::CacheMode::Hot && !opts.corpora.empty()) {
+        std::cerr << "--cache-mode " << pf::cache_mode_name(opts.runner.cache) << " cannot be combined with --corpus" << std::endl;
+        return false;
+    }
+    if (opts.runner.repeated() && (opts.runner.cache == pf::CacheMode::Flushed || !opts.corpora.empty())) {
+        std::cerr << "--trials/--target-ci cannot be combined with --corpus or --cache-mode flushed" << std::endl;
+        return false;
+    }
+    if (!opts.runner.access.empty() &&
+        (opts.runner.repeated() || opts.runner.cache == pf::CacheMode::Flushed || !opts.corpora.empty())) {
+        std::cerr << "--access cannot be combined with --trials/--target-ci, --corpus or --cache-mode flushed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <build_dir> <iterations> [--scenario NAME]... [--format NAME]..."
+                  << " [--variants FORMAT=V1,V2]... [--latency-sample K] [--data MODE] [--cache-mode MODE] [--trials K] [--target-ci PCT] [--max-trials N] [--access FIELDS] [--corpus FILE]... [--flush-mb N]" << std::endl;
+        return 1;
+    }
+    std::string build_dir = argv[1];
+    size_t iterations = std::stoull(argv[2]);
+
+    MatrixOptions opts;
+    if (!parse_matrix_options(argc, argv, 3, opts)) return 1;
+
+    std::vector<PluginEntry> plugins = discover_plugins(build_dir);
+    if (opts.formats.empty()) {
+        std::set<std::string> found;
+        for (const PluginEntry& p : plugins) found.insert(p.format);
+        opts.formats.assign(found.begin(), found.end());
+    }
+
+    CellIsolation iso(opts.flush_mb << 20);
+    std::map<std::string, void*> handles;
+    int cells = 0, failed = 0;
+
+    // Same order as runner.py: scenario, then format, then variant.
+    for (const Scenario& scenario : kScenarios) {
+        if (!opts.scenarios.empty() &&
+            std::find(opts.scenarios.begin(), opts.scenarios.end(), scenario.name) == opts.scenarios.end()) continue;
+
+        for (const std::string& format : opts.formats) {
+            auto plugin = std::find_if(plugins.begin(), plugins.end(), [&](const PluginEntry& p) {
+                return p.scenario == &scenario && p.format == format;
+            });
+            if (plugin == plugins.end()) continue;
+
+            // Plugins stay loaded until exit: unloading one format's library while
+            // another still shares its dependencies (libprotobuf) is not safe.
+            void*& handle = handles[plugin->path];
+            if (!handle) handle = dlopen(plugin->path.c_str(), RTLD_NOW | RTLD_LOCAL);
+            CreateBenchmarkFunc create = handle ? (CreateBenchmarkFunc) dlsym(handle, "create_benchmark") : nullptr;
+
+            pf::RunnerOptions cell_opts = opts.runner;
+            auto corpus = opts.corpora.find(scenario.name);
+            if (corpus != opts.corpora.end()) cell_opts.corpus = corpus->second;
+
+            auto v = opts.variants.find(format);
+            std::vector<std::string> variants = (v != opts.variants.end()) ? v->second : std::vector<std::string>{"Standard"};
+
+            for (const std::string& variant : variants) {
+                cells++;
+                std::cout << "CELL_BEGIN" << std::endl;
+                std::cout << "SCENARIO=" << scenario.name << std::endl;
+                std::cout << "FORMAT=" << to_upper(format) << std::endl;
+                std::cout << "VARIANT=" << variant << std::endl;
+                std::cout << "PLUGIN=" << plugin->path << std::endl;
+                int rc = 1;
+                if (!create) {
+                    std::cerr << "DLOPEN ERR: " << plugin->path << ": " << dlerror() << std::endl;
+                } else {
+                    rc = scenario.run(create, variant, iterations, cell_opts, iso);
+                }
+                if (rc != 0) failed++;
+                std::cout << "CELL_STATUS=" << (rc == 0 ? "OK" : "FAILED") << std::endl;
+                std::cout << "CELL_END" << std::endl;
+            }
+        }
+    }
+
+    for (auto& h : handles) {
+        if (h.second) dlclose(h.second);
+    }
+    std::cerr << "[pf_matrix] " << (cells - failed) << "/" << cells << " cells completed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#ifndef RUNNER_OPTIONS_HPP
+#define RUNNER_OPTIONS_HPP
+
+#include <iostream>
+#include <string>
+#include <cstddef>
+
+namespace pf {
+
+/**
+ * @brief Where benchmark payloads come from (--data).
+ * - Uniform: every field uniform over its full type range (worst-case varint widths).
+ * - Flight: each payload taken from a random point of a random simulated flight (flight_sim.hpp).
+ * - Replay: the payloads are consecutive messages of one simulated flight, in send order.
+ */
+enum class DataMode { Uniform, Flight, Replay };
+
+inline bool parse_data_mode(const std::string& value, DataMode& mode) {
+    if (value == "uniform") mode = DataMode::Uniform;
+    else if (value == "flight") mode = DataMode::Flight;
+    else if (value == "replay") mode = DataMode::Replay;
+    else return false;
+    return true;
+}
+
+inline const char* data_mode_name(DataMode mode) {
+    switch (mode) {
+        case DataMode::Flight: return "flight";
+        case DataMode::Replay: return "replay";
+        default: return "uniform";
+    }
+}
+
+/**
+ * @brief Cache state of each timed operation's data (--cache-mode).
+ * - Hot: the 127-entry pool and its encodings stay resident in L1/L2.
+ * - Cold: the pool is grown until it and its encodings span twice the LLC.
+ * - Flushed: the input and output lines of each operation are evicted
+ *   (clflush / dc civac) before it; only the operation itself is timed.
+ */
+enum class CacheMode { Hot, Cold, Flushed };
+
+inline bool parse_cache_mode(const std::string& value, CacheMode& mode) {
+    if (value == "hot") mode = CacheMode::Hot;
+    else if (value == "cold") mode = CacheMode::Cold;
+    else if (value == "flushed") mode = CacheMode::Flushed;
+    else return false;
+    return true;
+}
+
+inline const char* cache_mode_name(CacheMode mode) {
+    switch (mode) {
+        case CacheMode::Cold: return "cold";
+        case CacheMode::Flushed: return "flushed";
+        default: return "hot";
+    }
+}
+
+/**
+ * @brief Optional flags accepted after "<plugin_path> <variant_name> <iterations>".
+ */
+struct RunnerOptions {
+    size_t batch = 0;          // --batch N: time encode_batch/decode_batch with N messages per call (0 = off)
+    size_t latency_sample = 0; // --latency-sample K: time every K-th operation individually (0 = off)
+    size_t threads = 0;        // --threads N: N plugin instances on N threads, aggregate throughput (0 = off)
+    DataMode data = DataMode::Uniform; // --data uniform|flight|replay
+    std::string corpus;        // --corpus FILE: stream payloads from a capture file instead of the pool
+    CacheMode cache = CacheMode::Hot; // --cache-mode hot|cold|flushed
+    size_t trials = 0;         // --trials K: K timed rounds per cell, reported as median + bootstrap CI (0 = one pass)
+    double target_ci = 0;      // --target-ci PCT: repeat rounds until every CI half-width is below PCT% of its median
+    size_t max_trials = 100;   // --max-trials N: upper bound for --target-ci
+    std::string access;        // --access FIELDS: also time reading FIELDS through decode_fields (a count K, or names)
+
+    bool repeated() const { return trials > 0 || target_ci > 0; }
+};
+
+/**
+ * @brief Parse trailing "--flag value" pairs starting at argv[first].
+ * @return false (after printing the offending flag) on unknown flags or missing values
+ */
+inline bool parse_runner_options(int argc, char** argv, int first, RunnerOptions& opts) {
+    for (int i = first; i < argc; i++) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (flag == "--batch") {
+            opts.batch = std::stoull(value);
+        } else if (flag == "--latency-sample") {
+            opts.latency_sample = std::stoull(value);
+        } else if (flag == "--threads") {
+            opts.threads = std::stoull(value);
+        } else if (flag == "--trials") {
+            opts.trials = std::stoull(value);
+        } else if (flag == "--target-ci") {
+            opts.target_ci = std::stod(value);
+        } else if (flag == "--max-trials") {
+            opts.max_trials = std::stoull(value);
+        } else if (flag == "--cache-mode") {
+            if (!parse_cache_mode(value, opts.cache)) {
+                std::cerr << "Unknown --cache-mode " << value << " (expected hot, cold or flushed)" << std::endl;
+                return false;
+            }
+        } else if (flag == "--corpus") {
+            opts.corpus = value;
+        } else if (flag == "--access") {
+            opts.access = value;
+        } else if (flag == "--data") {
+            if (!parse_data_mode(value, opts.data)) {
+                std::cerr << "Unknown --data " << value << " (expected uniform, flight or replay)" << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option: " << flag << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace pf
+
+#endif // RUNNER_OPTIONS_HPP
@@ -13,8 +13,26 @@
 #include <malloc.h>
 #include <cstdint>
 #include <random>
+#include <algorithm>
+#include <map>
+#include <cctype>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <pthread.h>
+#include <sched.h>
 #include "IBenchmark.h"
+#include "IMetric.h"
+#include "PerfCounterMetric.h"
 #include "mavlink_types.h"
+#include "SchemaCodec.h"
+#include "runner_options.hpp"
+#include "latency_histogram.hpp"
+#include "flight_sim.hpp"
+#include "capture_file.hpp"
+#include "cache_flush.hpp"
+#include "trial_stats.hpp"
+#include "alloc_profiler.h"
 
 using namespace std::chrono;
 
@@ -160,15 +178,15 @@ PayloadGPSBlock generate_random_data<PayloadGPSBlock>() {
     return p;
 }
 
-// Helper: Get Peak RSS
+// Helper: Get Peak RSS (resident high-water mark; VmPeak would be virtual size)
 size_t get_peak_rss() {
     FILE* fp = fopen("/proc/self/status", "r");
     if (!fp) return 0;
     char line[128];
     size_t result = 0;
     while (fgets(line, 128, fp)) {
-        if (strncmp(line, "VmPeak:", 7) == 0) {
-            sscanf(line + 7, "%lu", &result);
+        if (strncmp(line, "VmHWM:", 6) == 0) {
+            sscanf(line + 6, "%lu", &result);
             break;
         }
     }
@@ -176,6 +194,15 @@ size_t get_peak_rss() {
     return result; 
 }
 
+// Helper: Restart the VmHWM high-water mark from the current RSS (Linux >= 4.0),
+// so one process can report a per-cell peak.
+bool reset_peak_rss() {
+    FILE* fp = fopen("/proc/self/clear_refs", "w");
+    if (!fp) return false;
+    bool ok = fputs("5", fp) >= 0;
+    return (fclose(fp) == 0) && ok;
+}
+
 // Helper: Get Mallinfo (Heap)
 size_t get_allocated_mem() {
     struct mallinfo2 mi = mallinfo2();
@@ -185,141 +212,1001 @@ size_t get_allocated_mem() {
 // Global Pool Strategy to simulate real data entropy
 const int POOL_SIZE = 127; // Prime-ish to avoid alignment artifacts
 
+// The payload pool for one run. Flight and Replay seed their simulators from
+// `gen`, so a given --data mode produces the same pool on every run. Replay
+// pools longer than one flight continue with a fresh flight.
 template <typename PayloadT>
-int run_time_benchmark(int argc, char** argv) {
-     if (argc < 4) { 
-        std::cerr << "Usage: " << argv[0] << " <plugin_path> <variant_name> <iterations>" << std::endl;
-        return 1;
+std::vector<PayloadT> make_payload_pool(DataMode mode, size_t count = POOL_SIZE) {
+    std::vector<PayloadT> pool(count);
+    const uint64_t length = FlightSimulator::stream_length<PayloadT>();
+    switch (mode) {
+        case DataMode::Flight:
+            for(size_t i=0; i<count; i++) {
+                FlightSimulator sim(gen());
+                sim.sample(gen() % length, pool[i]);
+            }
+            break;
+        case DataMode::Replay: {
+            FlightSimulator sim(gen());
+            uint64_t t = count < length ? gen() % (length - count) : 0;
+            for(size_t i=0; i<count; i++, t++) {
+                if (t == length) {
+                    sim = FlightSimulator(gen());
+                    t = 0;
+                }
+                sim.sample(t, pool[i]);
+            }
+            break;
+        }
+        default:
+            for(size_t i=0; i<count; i++) pool[i] = generate_random_data<PayloadT>();
+            break;
     }
+    return pool;
+}
 
-    std::string plugin_path = argv[1];
-    std::string variant_name = argv[2];
-    size_t iterations = std::stoull(argv[3]);
+// Bytes a payload occupies, including what it owns on the heap.
+template <typename T>
+size_t payload_bytes(const T&) { return sizeof(T); }
 
-    void* handle = dlopen(plugin_path.c_str(), RTLD_LAZY);
-    if (!handle) { std::cerr << "DLOPEN ERR: " << dlerror() << std::endl; return 1; }
+inline size_t payload_bytes(const PayloadGPSBlock& p) {
+    return sizeof(p) + p.messages.size() * sizeof(PayloadGPSRaw);
+}
 
-    CreateBenchmarkFunc create = (CreateBenchmarkFunc) dlsym(handle, "create_benchmark");
-    if (!create) { std::cerr << "DLSYM ERR: " << dlerror() << std::endl; return 1; }
+// Evicts every line of a payload (--cache-mode flushed).
+template <typename T>
+void evict_payload(const T& p) { evict_lines(&p, sizeof(T)); }
+
+inline void evict_payload(const PayloadGPSBlock& p) {
+    evict_lines(&p, sizeof(p));
+    evict_lines(p.messages.data(), p.messages.size() * sizeof(PayloadGPSRaw));
+}
+
+// --cache-mode cold: enough entries that the pool and its encodings together
+// span twice the LLC, estimated from the average of a hot-sized sample pool.
+template <typename PayloadT>
+size_t cold_pool_entries(pf::IBenchmark& bench, const std::vector<PayloadT>& sample, size_t llc) {
+    size_t bytes = 0;
+    for(const PayloadT& p : sample) bytes += payload_bytes(p) + bench.encode(&p).size();
+    size_t per_entry = std::max<size_t>(1, bytes / sample.size());
+    return std::max<size_t>(POOL_SIZE, 2 * llc / per_entry);
+}
+
+// Pre-encoded pool laid out back-to-back in one allocation, like frames in a
+// receive buffer. Decoders read straight out of it through the span overload.
+struct EncodedArena {
+    std::vector<uint8_t> bytes;
+    std::vector<size_t> offsets;
+    std::vector<size_t> lengths;
+
+    const uint8_t* data(size_t i) const { return bytes.data() + offsets[i]; }
+    size_t size(size_t i) const { return lengths[i]; }
+    size_t count() const { return offsets.size(); }
+};
+
+template <typename PayloadT>
+EncodedArena build_encoded_arena(IBenchmark& bench, const std::vector<PayloadT>& pool) {
+    EncodedArena arena;
+    for(const PayloadT& p : pool) {
+        std::vector<uint8_t> b = bench.encode(&p);
+        arena.offsets.push_back(arena.bytes.size());
+        arena.lengths.push_back(b.size());
+        arena.bytes.insert(arena.bytes.end(), b.begin(), b.end());
+    }
+    return arena;
+}
+
+// Batch Mode: per-message cost of encode_batch/decode_batch with `batch` messages per call.
+template <typename PayloadT>
+int run_batch_benchmark(pf::IBenchmark& bench, const std::vector<PayloadT>& pool, size_t iterations, size_t batch) {
+    // Pointer ring long enough that any window of `batch` starting inside the pool is contiguous.
+    std::vector<const void*> items(POOL_SIZE + batch);
+    for(size_t i=0; i<items.size(); i++) items[i] = &pool[i % POOL_SIZE];
+
+    size_t max_msg = 0;
+    for(int i=0; i<POOL_SIZE; i++) max_msg = std::max(max_msg, bench.max_encoded_size(&pool[i]));
+    const size_t cap = batch * (max_msg + kFramePrefixBytes);
+    const size_t num_batches = std::max<size_t>(1, iterations / batch);
+    const size_t messages = num_batches * batch;
+
+    // 1. Encode: one scratch buffer reused by every batch
+    std::vector<uint8_t> scratch(cap);
+    volatile size_t sink = 0;
+    auto t1 = high_resolution_clock::now();
+    for(size_t b=0; b<num_batches; b++) {
+        size_t start = (b * batch) % POOL_SIZE;
+        sink += bench.encode_batch(&items[start], batch, scratch.data(), scratch.size());
+    }
+    auto t2 = high_resolution_clock::now();
+
+    // 2. Decode: pre-encode enough batches to cover the pool once, then cycle through them
+    size_t distinct = (POOL_SIZE + batch - 1) / batch;
+    std::vector<std::vector<uint8_t>> batches(distinct);
+    size_t total_bytes = 0;
+    for(size_t b=0; b<distinct; b++) {
+        batches[b].resize(cap);
+        size_t n = bench.encode_batch(&items[(b * batch) % POOL_SIZE], batch, batches[b].data(), cap);
+        if (n == 0) {
+            std::cerr << "ENCODE_BATCH ERR: batch of " << batch << " does not fit in " << cap << " bytes" << std::endl;
+            return 1;
+        }
+        batches[b].resize(n);
+        total_bytes += n;
+    }
+
+    std::vector<PayloadT> outs(batch);
+    std::vector<void*> out_ptrs(batch);
+    for(size_t i=0; i<batch; i++) out_ptrs[i] = &outs[i];
+
+    auto t3 = high_resolution_clock::now();
+    for(size_t b=0; b<num_batches; b++) {
+        const std::vector<uint8_t>& buf = batches[b % distinct];
+        sink += bench.decode_batch(buf.data(), buf.size(), out_ptrs.data(), batch);
+    }
+    auto t4 = high_resolution_clock::now();
+
+    double encode_us = duration_cast<nanoseconds>(t2 - t1).count() / 1000.0;
+    double decode_us = duration_cast<nanoseconds>(t4 - t3).count() / 1000.0;
+
+    std::cout << "TOTAL_TIME_MS=" << duration_cast<milliseconds>(t4 - t1).count() << std::endl;
+    std::cout << "BATCH_SIZE=" << batch << std::endl;
+    std::cout << "AVG_BATCH_ENCODE_US=" << (encode_us/messages) << std::endl; // Per message
+    std::cout << "AVG_BATCH_DECODE_US=" << (decode_us/messages) << std::endl; // Per message
+    std::cout << "AVG_BATCH_BYTES=" << (total_bytes/distinct) << std::endl;   // Incl. length prefixes
+    return 0;
+}
+
+// Metric Observers: one list bracketed around each timed loop
+typedef std::vector<std::unique_ptr<IMetric>> MetricList;
+
+static MetricList make_default_metrics() {
+    MetricList metrics;
+    metrics.emplace_back(new PerfCounterMetric());
+    return metrics;
+}
+
+static void start_metrics(MetricList& metrics) {
+    for(auto& m : metrics) { m->reset(); m->start(); }
+}
+
+static std::map<std::string, double> stop_metrics(MetricList& metrics) {
+    std::map<std::string, double> merged;
+    for(auto& m : metrics) {
+        m->stop();
+        for(const auto& kv : m->get_result()) merged[kv.first] = kv.second;
+    }
+    return merged;
+}
+
+// Prints every counter normalised per message, e.g. DECODE_LLC_MISSES_PER_MSG, plus IPC.
+static void print_metric_results(const char* phase, const std::map<std::string, double>& totals, size_t ops) {
+    for(const auto& kv : totals) {
+        std::string key = kv.first;
+        for(char& ch : key) ch = (char)toupper((unsigned char)ch);
+        std::cout << phase << "_" << key << "_PER_MSG=" << (kv.second / ops) << std::endl;
+    }
+    auto cycles = totals.find("cycles");
+    auto instructions = totals.find("instructions");
+    if (cycles != totals.end() && instructions != totals.end() && cycles->second > 0) {
+        std::cout << phase << "_IPC=" << (instructions->second / cycles->second) << std::endl;
+    }
+}
+
+static void print_percentiles(const char* prefix, const LatencyHistogram& h, double ticks_per_ns) {
+    auto us = [ticks_per_ns](uint64_t ticks) { return (double)ticks / ticks_per_ns / 1000.0; };
+    std::cout << prefix << "_P50_US=" << us(h.percentile(50.0)) << std::endl;
+    std::cout << prefix << "_P90_US=" << us(h.percentile(90.0)) << std::endl;
+    std::cout << prefix << "_P99_US=" << us(h.percentile(99.0)) << std::endl;
+    std::cout << prefix << "_P999_US=" << us(h.percentile(99.9)) << std::endl;
+    std::cout << prefix << "_MAX_US=" << us(h.max()) << std::endl;
+}
+
+// Sampled Latency: every `stride`-th operation is timed on its own with the cycle
+// counter, so tail spikes show up instead of being averaged away.
+template <typename PayloadT>
+void run_latency_sampling(pf::IBenchmark& bench, const std::vector<PayloadT>& pool,
+                          const EncodedArena& encoded_pool, size_t iterations, size_t stride) {
+    double ticks_per_ns = CycleClock::calibrate();
+    LatencyHistogram enc_hist;
+    LatencyHistogram dec_hist;
+    volatile size_t sink = 0;
+
+    for(size_t i=0; i<iterations; i++) {
+        const PayloadT& p = pool[i % pool.size()];
+        if (i % stride != 0) { sink += bench.encode(&p).size(); continue; }
+        uint64_t c0 = CycleClock::now();
+        std::vector<uint8_t> buf = bench.encode(&p);
+        uint64_t c1 = CycleClock::now();
+        enc_hist.record(c1 - c0);
+        sink += buf.size();
+    }
+
+    for(size_t i=0; i<iterations; i++) {
+        const size_t k = i % pool.size();
+        PayloadT d;
+        if (i % stride != 0) { bench.decode(encoded_pool.data(k), encoded_pool.size(k), &d); continue; }
+        uint64_t c0 = CycleClock::now();
+        bench.decode(encoded_pool.data(k), encoded_pool.size(k), &d);
+        uint64_t c1 = CycleClock::now();
+        dec_hist.record(c1 - c0);
+    }
+
+    std::cout << "CYCLE_CLOCK_TICKS_PER_NS=" << ticks_per_ns << std::endl;
+    std::cout << "LATENCY_SAMPLES=" << enc_hist.count() << std::endl;
+    print_percentiles("ENCODE", enc_hist, ticks_per_ns);
+    print_percentiles("DECODE", dec_hist, ticks_per_ns);
+}
 
+// Reusable barrier (C++17 has no std::barrier): all `count` parties block until the last arrives.
+class PhaseBarrier {
+public:
+    explicit PhaseBarrier(size_t count) : count_(count) {}
+
+    void arrive_and_wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t gen = generation_;
+        if (++waiting_ == count_) {
+            waiting_ = 0;
+            generation_++;
+            cv_.notify_all();
+        } else {
+            cv_.wait(lock, [&] { return gen != generation_; });
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t count_;
+    size_t waiting_ = 0;
+    size_t generation_ = 0;
+};
+
+// Pin the calling thread to the `index`-th CPU of the process affinity mask (set by taskset).
+static void pin_to_nth_allowed_cpu(size_t index) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+    size_t n = (size_t)CPU_COUNT(&allowed);
+    if (n == 0) return;
+    size_t target = index % n;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        if (target-- == 0) {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpu, &one);
+            pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+            return;
+        }
+    }
+}
+
+// Instantiate a plugin benchmark and run its setup() for one variant.
+static std::unique_ptr<pf::IBenchmark> create_configured(CreateBenchmarkFunc create, const std::string& variant_name,
+                                                         size_t iterations) {
     std::unique_ptr<pf::IBenchmark> bench(create());
     pf::BenchmarkConfig config;
     config.iterations = iterations;
     config.variant_name = variant_name;
     config.warm_up = true;
     bench->setup(config);
+    return bench;
+}
 
-    // 1. Generate Data Pool
-    std::vector<PayloadT> pool(POOL_SIZE);
-    for(int i=0; i<POOL_SIZE; i++) pool[i] = generate_random_data<PayloadT>();
+// Thread Scaling Mode: N independent plugin instances, each with its own pool and
+// arena, released together by a barrier. Shared library state (descriptor locks,
+// malloc arenas) is the only thing they contend on, so it shows up as lost scaling.
+template <typename PayloadT>
+int run_thread_benchmark(CreateBenchmarkFunc create, const std::string& variant_name,
+                         size_t iterations, size_t num_threads, DataMode data) {
+    struct Worker {
+        std::unique_ptr<pf::IBenchmark> bench;
+        std::vector<PayloadT> pool;
+        EncodedArena arena;
+        double encode_us = 0;
+        double decode_us = 0;
+    };
 
-    // 2. Warmup
+    // Setup runs serially: plugins log from setup() and the pool generator shares one RNG.
+    std::vector<Worker> workers(num_threads);
+    for(size_t t=0; t<num_threads; t++) {
+        Worker& w = workers[t];
+        w.bench = create_configured(create, variant_name, iterations);
+        w.pool = make_payload_pool<PayloadT>(data);
+        w.arena = build_encoded_arena(*w.bench, w.pool);
+        for(int i=0; i<100; i++) { // Warmup
+            PayloadT d;
+            w.bench->decode(w.bench->encode(&w.pool[i % POOL_SIZE]), &d);
+        }
+    }
+
+    PhaseBarrier barrier(num_threads + 1); // Workers + this thread (which holds the wall clock)
+    std::vector<std::thread> threads;
+    for(size_t t=0; t<num_threads; t++) {
+        threads.emplace_back([&, t] {
+            pin_to_nth_allowed_cpu(t);
+            Worker& w = workers[t];
+            volatile size_t sink = 0;
+
+            barrier.arrive_and_wait(); // Encode start
+            auto e0 = high_resolution_clock::now();
+            for(size_t i=0; i<iterations; i++) sink += w.bench->encode(&w.pool[i % POOL_SIZE]).size();
+            auto e1 = high_resolution_clock::now();
+            barrier.arrive_and_wait(); // Encode end
+
+            barrier.arrive_and_wait(); // Decode start
+            auto d0 = high_resolution_clock::now();
+            for(size_t i=0; i<iterations; i++) {
+                PayloadT d;
+                const size_t k = i % POOL_SIZE;
+                w.bench->decode(w.arena.data(k), w.arena.size(k), &d);
+            }
+            auto d1 = high_resolution_clock::now();
+            barrier.arrive_and_wait(); // Decode end
+
+            w.encode_us = duration_cast<nanoseconds>(e1 - e0).count() / 1000.0;
+            w.decode_us = duration_cast<nanoseconds>(d1 - d0).count() / 1000.0;
+        });
+    }
+
+    barrier.arrive_and_wait();
+    auto t0 = high_resolution_clock::now();
+    barrier.arrive_and_wait();
+    auto t1 = high_resolution_clock::now();
+    barrier.arrive_and_wait();
+    auto t2 = high_resolution_clock::now();
+    barrier.arrive_and_wait();
+    auto t3 = high_resolution_clock::now();
+    for(auto& th : threads) th.join();
+
+    double enc_wall_s = duration_cast<nanoseconds>(t1 - t0).count() / 1e9;
+    double dec_wall_s = duration_cast<nanoseconds>(t3 - t2).count() / 1e9;
+    double total_msgs = (double)iterations * num_threads;
+
+    double enc_mean = 0, enc_max = 0, dec_mean = 0, dec_max = 0;
+    for(const Worker& w : workers) {
+        double e = w.encode_us / iterations;
+        double d = w.decode_us / iterations;
+        enc_mean += e / num_threads;
+        dec_mean += d / num_threads;
+        enc_max = std::max(enc_max, e);
+        dec_max = std::max(dec_max, d);
+    }
+
+    std::cout << "THREADS=" << num_threads << std::endl;
+    std::cout << "TOTAL_TIME_MS=" << duration_cast<milliseconds>(t3 - t0).count() << std::endl;
+    std::cout << "AGG_ENCODE_MSGS_PER_S=" << (enc_wall_s > 0 ? total_msgs / enc_wall_s : 0) << std::endl;
+    std::cout << "AGG_DECODE_MSGS_PER_S=" << (dec_wall_s > 0 ? total_msgs / dec_wall_s : 0) << std::endl;
+    std::cout << "THREAD_ENCODE_US_MEAN=" << enc_mean << std::endl; // Per message, averaged over threads
+    std::cout << "THREAD_ENCODE_US_MAX=" << enc_max << std::endl;   // Slowest thread
+    std::cout << "THREAD_DECODE_US_MEAN=" << dec_mean << std::endl;
+    std::cout << "THREAD_DECODE_US_MAX=" << dec_max << std::endl;
+
+    for(Worker& w : workers) w.bench->teardown();
+    return 0;
+}
+
+// Corpus Mode (--corpus FILE): payloads stream out of a memory-mapped capture file
+// (capture_file.hpp) instead of cycling the pool, so every timed operation sees a
+// different record and RSS does not grow with the corpus. Each loop restarts at
+// record 0 and wraps if `iterations` exceeds the record count.
+constexpr size_t kCorpusScratchBytes = 1 << 20; // encode_into target; larger than any single payload
+constexpr size_t kCorpusDecodeChunk = 1024;     // Messages encoded (untimed) per timed decode burst
+
+template <typename PayloadT>
+int run_corpus_cell(pf::IBenchmark& bench, size_t iterations, const RunnerOptions& opts) {
+    CaptureStream<PayloadT> corpus;
+    std::string err = corpus.open(opts.corpus);
+    if (!err.empty()) {
+        std::cerr << "CORPUS ERR: " << err << std::endl;
+        return 1;
+    }
+
+    // 1. Warmup
     for(int i=0; i<100; i++) {
-        auto b = bench->encode(&pool[i % POOL_SIZE]);
+        auto b = bench.encode(&corpus.next());
         PayloadT d;
-        bench->decode(b, &d);
+        bench.decode(b, &d);
     }
 
-    // 3. Encode Latency (Batch Timing)
-    double total_encode_us = 0;
-    std::vector<uint8_t> last_buffer; // Keep alive to prevent optimization
-    
-    // We can't store ALL buffers for millions of iterations (RAM limit).
-    // But we need to time the loop.
-    // We will overwrite a small set of scratch buffers?
-    // Actually, std::vector return is by value.
-    // We just sink it.
-    
+    // 2. Encode
     volatile size_t sink = 0;
-    
+    MetricList metrics = make_default_metrics();
+    corpus.rewind();
+    start_metrics(metrics);
     auto t1 = high_resolution_clock::now();
+    for(size_t i=0; i<iterations; i++) sink += bench.encode(&corpus.next()).size();
+    auto t2 = high_resolution_clock::now();
+    std::map<std::string, double> encode_counters = stop_metrics(metrics);
+
+    // 3. Encode into one reused buffer
+    std::vector<uint8_t> scratch(kCorpusScratchBytes);
+    corpus.rewind();
+    auto t1b = high_resolution_clock::now();
     for(size_t i=0; i<iterations; i++) {
-        std::vector<uint8_t> buf = bench->encode(&pool[i % POOL_SIZE]);
+        size_t n = bench.encode_into(&corpus.next(), scratch.data(), scratch.size());
+        if (n == 0) {
+            std::cerr << "ENCODE_INTO ERR: record " << (i % corpus.count()) << " does not fit in " << scratch.size() << " bytes" << std::endl;
+            return 1;
+        }
+        sink += n;
+    }
+    auto t2b = high_resolution_clock::now();
+
+    // 4. Decode: encode a chunk of records untimed, then time decoding it
+    corpus.rewind();
+    std::map<std::string, double> decode_counters;
+    EncodedArena chunk;
+    double total_decode_us = 0;
+    size_t total_bytes = 0;
+    size_t first_size = 0;
+    for(size_t done=0; done<iterations; ) {
+        const size_t n = std::min(kCorpusDecodeChunk, iterations - done);
+        chunk.bytes.clear();
+        chunk.offsets.clear();
+        chunk.lengths.clear();
+        for(size_t k=0; k<n; k++) {
+            std::vector<uint8_t> b = bench.encode(&corpus.next());
+            chunk.offsets.push_back(chunk.bytes.size());
+            chunk.lengths.push_back(b.size());
+            chunk.bytes.insert(chunk.bytes.end(), b.begin(), b.end());
+        }
+        if (done == 0) first_size = chunk.size(0);
+        total_bytes += chunk.bytes.size();
+
+        start_metrics(metrics);
+        auto t3 = high_resolution_clock::now();
+        for(size_t k=0; k<n; k++) {
+            PayloadT d;
+            bench.decode(chunk.data(k), chunk.size(k), &d);
+        }
+        auto t4 = high_resolution_clock::now();
+        for(const auto& kv : stop_metrics(metrics)) decode_counters[kv.first] += kv.second;
+        total_decode_us += duration_cast<nanoseconds>(t4 - t3).count() / 1000.0;
+        done += n;
+    }
+
+    double total_encode_us = duration_cast<nanoseconds>(t2 - t1).count() / 1000.0;
+    double total_encode_into_us = duration_cast<nanoseconds>(t2b - t1b).count() / 1000.0;
+
+    std::cout << "TOTAL_TIME_MS=" << (total_encode_us + total_encode_into_us + total_decode_us) / 1000.0 << std::endl;
+    std::cout << "CORPUS_RECORDS=" << corpus.count() << std::endl;
+    std::cout << "AVG_ENCODE_US=" << (total_encode_us/iterations) << std::endl;
+    std::cout << "AVG_ENCODE_INTO_US=" << (total_encode_into_us/iterations) << std::endl;
+    std::cout << "AVG_DECODE_US=" << (total_decode_us/iterations) << std::endl;
+    std::cout << "SERIALIZED_SIZE=" << first_size << std::endl;                 // Record 0, as in pool mode
+    std::cout << "AVG_SERIALIZED_SIZE=" << ((double)total_bytes/iterations) << std::endl;
+    std::cout << "PEAK_RSS_KB=" << get_peak_rss() << std::endl;
+    print_metric_results("ENCODE", encode_counters, iterations);
+    print_metric_results("DECODE", decode_counters, iterations);
+    return 0;
+}
+
+// One timed pass of `iterations` operations over the pool, in microseconds.
+// Pool index k wraps without a division, since pool.size() is not a constant.
+template <typename PayloadT>
+double time_encode_pass(pf::IBenchmark& bench, const std::vector<PayloadT>& pool, size_t iterations) {
+    volatile size_t sink = 0;
+    auto t1 = high_resolution_clock::now();
+    for(size_t i=0, k=0; i<iterations; i++, k = (k + 1 == pool.size()) ? 0 : k + 1) {
+        std::vector<uint8_t> buf = bench.encode(&pool[k]);
         sink += buf.size();
-        if (i == 0) last_buffer = buf; // Keep one for size check
     }
     auto t2 = high_resolution_clock::now();
-    total_encode_us = duration_cast<nanoseconds>(t2 - t1).count() / 1000.0;
+    return duration_cast<nanoseconds>(t2 - t1).count() / 1000.0;
+}
 
-    // 4. Decode Latency (Batch Timing)
-    // Pre-encode the pool so we have valid inputs
-    std::vector<std::vector<uint8_t>> encoded_pool(POOL_SIZE);
-    for(int i=0; i<POOL_SIZE; i++) encoded_pool[i] = bench->encode(&pool[i]);
+template <typename PayloadT>
+double time_encode_into_pass(pf::IBenchmark& bench, const std::vector<PayloadT>& pool, size_t iterations,
+                             std::vector<uint8_t>& scratch) {
+    volatile size_t sink = 0;
+    auto t1 = high_resolution_clock::now();
+    for(size_t i=0, k=0; i<iterations; i++, k = (k + 1 == pool.size()) ? 0 : k + 1) {
+        sink += bench.encode_into(&pool[k], scratch.data(), scratch.size());
+    }
+    auto t2 = high_resolution_clock::now();
+    return duration_cast<nanoseconds>(t2 - t1).count() / 1000.0;
+}
 
-    auto t3 = high_resolution_clock::now();
-    for(size_t i=0; i<iterations; i++) {
+template <typename PayloadT>
+double time_decode_pass(pf::IBenchmark& bench, const EncodedArena& encoded_pool, size_t iterations) {
+    const size_t n = encoded_pool.lengths.size();
+    auto t1 = high_resolution_clock::now();
+    for(size_t i=0, k=0; i<iterations; i++, k = (k + 1 == n) ? 0 : k + 1) {
+        PayloadT d; // Decoder writes to `d`; its constructor/destructor run every iteration
+        bench.decode(encoded_pool.data(k), encoded_pool.size(k), &d);
+    }
+    auto t2 = high_resolution_clock::now();
+    return duration_cast<nanoseconds>(t2 - t1).count() / 1000.0;
+}
+
+// One scratch buffer sized for the largest message in the pool, reused every
+// encode_into. Fails if a message does not fit in what max_encoded_size promised.
+template <typename PayloadT>
+bool make_encode_scratch(pf::IBenchmark& bench, const std::vector<PayloadT>& pool, std::vector<uint8_t>& scratch) {
+    size_t scratch_cap = 0;
+    for(size_t i=0; i<pool.size(); i++) scratch_cap = std::max(scratch_cap, bench.max_encoded_size(&pool[i]));
+    scratch.assign(scratch_cap, 0);
+    for(size_t i=0; i<pool.size(); i++) {
+        if (bench.encode_into(&pool[i], scratch.data(), scratch.size()) == 0) {
+            std::cerr << "ENCODE_INTO ERR: message " << i << " does not fit in " << scratch_cap << " bytes" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// decode_fields() masks GPSBlock by the fields of its PayloadGPSRaw records.
+template <typename PayloadT> struct AccessSchema { using type = PayloadT; };
+template <> struct AccessSchema<PayloadGPSBlock> { using type = PayloadGPSRaw; };
+
+/**
+ * @brief Resolve --access: a count K selects the first K schema fields,
+ * anything else is a comma-separated list of field (member) names.
+ * @return false (after printing the offending name) if a name is not a field
+ */
+template <typename PayloadT>
+bool resolve_access_fields(const std::string& spec, FieldMask& mask, std::string& names) {
+    using T = typename AccessSchema<PayloadT>::type;
+    std::vector<std::string> wanted;
+    if (!spec.empty() && std::all_of(spec.begin(), spec.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        size_t k = std::min<size_t>(std::stoull(spec), schema_size<T>());
+        for (size_t i = 0; i < k; i++) wanted.push_back(PayloadSchema<T>::fields[i].name);
+    } else {
+        size_t start = 0;
+        while (start <= spec.size()) {
+            size_t comma = spec.find(',', start);
+            if (comma == std::string::npos) comma = spec.size();
+            if (comma > start) wanted.push_back(spec.substr(start, comma - start));
+            start = comma + 1;
+        }
+    }
+    mask = 0;
+    names.clear();
+    for (const std::string& name : wanted) {
+        int index = schema_index_of<T>(name.c_str());
+        if (index < 0) {
+            std::cerr << "--access: " << name << " is not a field of this scenario" << std::endl;
+            return false;
+        }
+        mask |= (FieldMask)1 << index;
+        names += (names.empty() ? "" : ",") + name;
+    }
+    if (mask == 0) {
+        std::cerr << "--access " << spec << " selects no fields" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Where a selected field sits in the payload struct; text stops at its NUL.
+struct AccessSpan {
+    size_t offset;
+    size_t bytes;
+    bool text;
+};
+
+template <typename PayloadT>
+std::vector<AccessSpan> access_spans(FieldMask mask) {
+    using T = typename AccessSchema<PayloadT>::type;
+    std::vector<AccessSpan> spans;
+    for (size_t i = 0; i < schema_size<T>(); i++) {
+        if (!(mask & ((FieldMask)1 << i))) continue;
+        const FieldDesc& f = PayloadSchema<T>::fields[i];
+        spans.push_back({f.offset, field_type_size(f.type) * f.count, f.type == FieldType::CHARS});
+    }
+    return spans;
+}
+
+// What a consumer does with the fields it asked for: read each byte once.
+inline uint64_t fold_access_bytes(const void* payload, const std::vector<AccessSpan>& spans) {
+    uint64_t h = 0;
+    for (const AccessSpan& s : spans) {
+        const uint8_t* p = static_cast<const uint8_t*>(payload) + s.offset;
+        uint64_t w = 0;
+        switch (s.text ? 0 : s.bytes) { // Scalars: one load of their own width
+            case 1: h = (h << 7 | h >> 57) ^ p[0]; continue;
+            case 2: { uint16_t v; memcpy(&v, p, 2); h = (h << 7 | h >> 57) ^ v; continue; }
+            case 4: { uint32_t v; memcpy(&v, p, 4); h = (h << 7 | h >> 57) ^ v; continue; }
+            case 8: memcpy(&w, p, 8); h = (h << 7 | h >> 57) ^ w; continue;
+            default: break;
+        }
+        size_t n = s.text ? strnlen(reinterpret_cast<const char*>(p), s.bytes) : s.bytes;
+        size_t b = 0;
+        for (; b + 8 <= n; b += 8) {
+            memcpy(&w, p + b, 8);
+            h = (h << 7 | h >> 57) ^ w;
+        }
+        for (; b < n; b++) h = (h << 7 | h >> 57) ^ p[b];
+    }
+    return h;
+}
+
+template <typename T>
+uint64_t fold_access_fields(const T& d, const std::vector<AccessSpan>& spans) {
+    return fold_access_bytes(&d, spans);
+}
+
+inline uint64_t fold_access_fields(const PayloadGPSBlock& d, const std::vector<AccessSpan>& spans) {
+    uint64_t h = 0;
+    for (const PayloadGPSRaw& m : d.messages) h ^= fold_access_bytes(&m, spans);
+    return h;
+}
+
+// Like time_decode_pass, but through decode_fields() and followed by reading the selected fields.
+template <typename PayloadT>
+double time_access_pass(pf::IBenchmark& bench, const EncodedArena& encoded_pool, size_t iterations, FieldMask fields) {
+    const size_t n = encoded_pool.lengths.size();
+    const std::vector<AccessSpan> spans = access_spans<PayloadT>(fields);
+    volatile uint64_t sink = 0;
+    auto t1 = high_resolution_clock::now();
+    for(size_t i=0, k=0; i<iterations; i++, k = (k + 1 == n) ? 0 : k + 1) {
+        PayloadT d;
+        bench.decode_fields(encoded_pool.data(k), encoded_pool.size(k), &d, fields);
+        sink ^= fold_access_fields(d, spans);
+    }
+    auto t2 = high_resolution_clock::now();
+    return duration_cast<nanoseconds>(t2 - t1).count() / 1000.0;
+}
+
+static void print_trial_summary(const char* phase, const TrialSummary& s) {
+    std::cout << phase << "_CI_LOW_US=" << s.ci_low << std::endl;
+    std::cout << phase << "_CI_HIGH_US=" << s.ci_high << std::endl;
+    std::cout << phase << "_MAD_US=" << s.mad << std::endl;
+    std::cout << phase << "_TRIALS_KEPT=" << s.kept << std::endl;
+    std::cout << phase << "_OUTLIERS=" << s.rejected << std::endl;
+}
+
+// Fewest rounds --target-ci accepts; a bootstrap CI over fewer trials is not meaningful.
+constexpr size_t kMinAutoTrials = 5;
+
+// Repetition Mode (--trials K, --target-ci PCT): each round times one encode,
+// one encode_into and one decode pass of `iterations` operations, so slow
+// drift (thermal throttling, a noisy neighbour) hits all three alike. One
+// untimed round comes first. AVG_*_US report the median of the per-trial
+// averages after MAD outlier rejection (trial_stats.hpp); perf counters are
+// summed over every trial.
+template <typename PayloadT>
+int run_trials_cell(pf::IBenchmark& bench, const std::vector<PayloadT>& pool, size_t iterations,
+                    const RunnerOptions& opts) {
+    std::vector<uint8_t> scratch;
+    if (!make_encode_scratch(bench, pool, scratch)) return 1;
+    EncodedArena encoded_pool = build_encoded_arena(bench, pool);
+
+    time_encode_pass(bench, pool, iterations);
+    time_encode_into_pass(bench, pool, iterations, scratch);
+    time_decode_pass<PayloadT>(bench, encoded_pool, iterations);
+
+    const bool auto_mode = opts.target_ci > 0;
+    const size_t min_trials = std::max<size_t>(opts.trials, auto_mode ? kMinAutoTrials : 1);
+    const size_t max_trials = auto_mode ? std::max(min_trials, opts.max_trials) : min_trials;
+
+    std::vector<double> enc, enc_into, dec;
+    std::map<std::string, double> encode_counters, decode_counters;
+    MetricList metrics = make_default_metrics();
+    TrialSummary enc_s, enc_into_s, dec_s;
+    bool target_met = false;
+
+    auto t1 = high_resolution_clock::now();
+    while (enc.size() < max_trials) {
+        start_metrics(metrics);
+        enc.push_back(time_encode_pass(bench, pool, iterations) / iterations);
+        for(const auto& kv : stop_metrics(metrics)) encode_counters[kv.first] += kv.second;
+
+        enc_into.push_back(time_encode_into_pass(bench, pool, iterations, scratch) / iterations);
+
+        start_metrics(metrics);
+        dec.push_back(time_decode_pass<PayloadT>(bench, encoded_pool, iterations) / iterations);
+        for(const auto& kv : stop_metrics(metrics)) decode_counters[kv.first] += kv.second;
+
+        if (enc.size() < min_trials) continue;
+        enc_s = summarize_trials(enc);
+        enc_into_s = summarize_trials(enc_into);
+        dec_s = summarize_trials(dec);
+        target_met = enc_s.half_width_pct() <= opts.target_ci && enc_into_s.half_width_pct() <= opts.target_ci &&
+                     dec_s.half_width_pct() <= opts.target_ci;
+        if (!auto_mode || target_met) break;
+    }
+    auto t2 = high_resolution_clock::now();
+    const size_t ops = iterations * enc.size();
+
+    std::cout << "TOTAL_TIME_MS=" << duration_cast<milliseconds>(t2 - t1).count() << std::endl;
+    std::cout << "AVG_ENCODE_US=" << enc_s.median << std::endl;
+    std::cout << "AVG_ENCODE_INTO_US=" << enc_into_s.median << std::endl;
+    std::cout << "AVG_DECODE_US=" << dec_s.median << std::endl;
+    std::cout << "SERIALIZED_SIZE=" << encoded_pool.size(0) << std::endl;
+    std::cout << "TRIALS=" << enc.size() << std::endl;
+    if (auto_mode) {
+        std::cout << "CI_TARGET_PCT=" << opts.target_ci << std::endl;
+        std::cout << "CI_TARGET_MET=" << (target_met ? 1 : 0) << std::endl;
+    }
+    print_trial_summary("ENCODE", enc_s);
+    print_trial_summary("ENCODE_INTO", enc_into_s);
+    print_trial_summary("DECODE", dec_s);
+    print_metric_results("ENCODE", encode_counters, ops);
+    print_metric_results("DECODE", decode_counters, ops);
+
+    if (opts.latency_sample > 0) {
+        run_latency_sampling(bench, pool, encoded_pool, iterations, opts.latency_sample);
+    }
+    return 0;
+}
+
+// --cache-mode flushed: every operation is timed on its own with the cycle
+// counter, after its input and output lines have been evicted and the eviction
+// has completed. Each sample has the counter's own overhead (the minimum of
+// back-to-back reads) subtracted. Perf counters are not collected in this mode,
+// since they would count the evictions too.
+template <typename PayloadT>
+int run_flushed_cell(pf::IBenchmark& bench, const std::vector<PayloadT>& pool, size_t iterations,
+                     const RunnerOptions& opts) {
+    double ticks_per_ns = CycleClock::calibrate();
+    uint64_t overhead = UINT64_MAX;
+    for(int i=0; i<1000; i++) {
+        uint64_t c0 = CycleClock::now();
+        overhead = std::min(overhead, CycleClock::now() - c0);
+    }
+    auto timed = [overhead](uint64_t c0, uint64_t c1) { return c1 - c0 > overhead ? c1 - c0 - overhead : 0; };
+
+    LatencyHistogram enc_hist;
+    LatencyHistogram enc_into_hist;
+    LatencyHistogram dec_hist;
+    uint64_t encode_ticks = 0, encode_into_ticks = 0, decode_ticks = 0;
+    volatile size_t sink = 0;
+    auto t_start = high_resolution_clock::now();
+
+    // Encode: the previous result is evicted before it is freed, so the block
+    // malloc hands back for the next one is cold as well.
+    std::vector<uint8_t> out;
+    for(size_t i=0, k=0; i<iterations; i++, k = (k + 1 == pool.size()) ? 0 : k + 1) {
+        evict_payload(pool[k]);
+        evict_lines(out.data(), out.capacity());
+        out = std::vector<uint8_t>();
+        evict_fence();
+        uint64_t c0 = CycleClock::now();
+        out = bench.encode(&pool[k]);
+        uint64_t c1 = CycleClock::now();
+        encode_ticks += timed(c0, c1);
+        enc_hist.record(timed(c0, c1));
+        sink += out.size();
+    }
+
+    size_t scratch_cap = 0;
+    for(const PayloadT& p : pool) scratch_cap = std::max(scratch_cap, bench.max_encoded_size(&p));
+    std::vector<uint8_t> scratch(scratch_cap);
+    for(size_t i=0, k=0; i<iterations; i++, k = (k + 1 == pool.size()) ? 0 : k + 1) {
+        evict_payload(pool[k]);
+        evict_lines(scratch.data(), scratch.size());
+        evict_fence();
+        uint64_t c0 = CycleClock::now();
+        size_t n = bench.encode_into(&pool[k], scratch.data(), scratch.size());
+        uint64_t c1 = CycleClock::now();
+        if (n == 0) {
+            std::cerr << "ENCODE_INTO ERR: message " << k << " does not fit in " << scratch_cap << " bytes" << std::endl;
+            return 1;
+        }
+        encode_into_ticks += timed(c0, c1);
+        enc_into_hist.record(timed(c0, c1));
+        sink += n;
+    }
+
+    EncodedArena encoded_pool = build_encoded_arena(bench, pool);
+    for(size_t i=0, k=0; i<iterations; i++, k = (k + 1 == pool.size()) ? 0 : k + 1) {
+        PayloadT d;
+        evict_payload(d);
+        evict_lines(encoded_pool.data(k), encoded_pool.size(k));
+        evict_fence();
+        uint64_t c0 = CycleClock::now();
+        bench.decode(encoded_pool.data(k), encoded_pool.size(k), &d);
+        uint64_t c1 = CycleClock::now();
+        decode_ticks += timed(c0, c1);
+        dec_hist.record(timed(c0, c1));
+        evict_payload(d); // Heap the decoder allocated, before it is freed
+    }
+    auto t_end = high_resolution_clock::now();
+
+    auto avg_us = [&](uint64_t ticks) { return (double)ticks / ticks_per_ns / 1000.0 / iterations; };
+    std::cout << "TOTAL_TIME_MS=" << duration_cast<milliseconds>(t_end - t_start).count() << std::endl;
+    std::cout << "AVG_ENCODE_US=" << avg_us(encode_ticks) << std::endl;
+    std::cout << "AVG_ENCODE_INTO_US=" << avg_us(encode_into_ticks) << std::endl;
+    std::cout << "AVG_DECODE_US=" << avg_us(decode_ticks) << std::endl;
+    std::cout << "SERIALIZED_SIZE=" << encoded_pool.size(0) << std::endl;
+    std::cout << "CYCLE_CLOCK_TICKS_PER_NS=" << ticks_per_ns << std::endl;
+    std::cout << "CYCLE_CLOCK_OVERHEAD_TICKS=" << overhead << std::endl;
+    if (opts.latency_sample > 0) {
+        // Every operation was timed already; the stride does not apply.
+        std::cout << "LATENCY_SAMPLES=" << enc_hist.count() << std::endl;
+        print_percentiles("ENCODE", enc_hist, ticks_per_ns);
+        print_percentiles("ENCODE_INTO", enc_into_hist, ticks_per_ns);
+        print_percentiles("DECODE", dec_hist, ticks_per_ns);
+    }
+    return 0;
+}
+
+// Time measurement for one configured benchmark instance: everything after setup().
+// Shared by the per-process runners and the in-process matrix (pf_matrix).
+template <typename PayloadT>
+int run_time_cell(pf::IBenchmark& bench, size_t iterations, const RunnerOptions& opts) {
+    if (!opts.corpus.empty()) return run_corpus_cell<PayloadT>(bench, iterations, opts);
+
+    FieldMask access_mask = 0;
+    std::string access_names;
+    if (!opts.access.empty() && !resolve_access_fields<PayloadT>(opts.access, access_mask, access_names)) return 1;
+
+    // 1. Generate Data Pool
+    std::vector<PayloadT> pool = make_payload_pool<PayloadT>(opts.data);
+    if (opts.cache == CacheMode::Cold) {
+        size_t llc = llc_bytes();
+        // A single pass shorter than the cold pool touches each entry at most once, which is just as cold.
+        size_t entries = cold_pool_entries(bench, pool, llc);
+        if (!opts.repeated()) entries = std::min(entries, std::max<size_t>(iterations, POOL_SIZE));
+        pool = make_payload_pool<PayloadT>(opts.data, entries);
+        std::cout << "LLC_BYTES=" << llc << std::endl;
+    }
+    std::cout << "CACHE_MODE=" << cache_mode_name(opts.cache) << std::endl;
+    std::cout << "POOL_ENTRIES=" << pool.size() << std::endl;
+
+    // 2. Warmup
+    for(int i=0; i<100; i++) {
+        auto b = bench.encode(&pool[i % POOL_SIZE]);
         PayloadT d;
-        bench->decode(encoded_pool[i % POOL_SIZE], &d);
-        // sink += d.timestamp; // We can't access generic fields easily. 
-        // Logic relies on side-effects or volatile. 
-        // Decoder generally writes to `d`. Constructor/Destructor of d runs.
+        bench.decode(b, &d);
+    }
+
+    if (opts.batch > 0) {
+        return run_batch_benchmark(bench, pool, iterations, opts.batch);
     }
+    if (opts.cache == CacheMode::Flushed) {
+        return run_flushed_cell(bench, pool, iterations, opts);
+    }
+
+    if (opts.repeated()) {
+        return run_trials_cell(bench, pool, iterations, opts);
+    }
+
+    // 3. Encode Latency (Batch Timing)
+    MetricList metrics = make_default_metrics();
+    start_metrics(metrics);
+    auto t1 = high_resolution_clock::now();
+    double total_encode_us = time_encode_pass(bench, pool, iterations);
+    std::map<std::string, double> encode_counters = stop_metrics(metrics);
+
+    // 3b. Encode Latency, Zero-Copy Path (encode_into a caller-owned buffer)
+    std::vector<uint8_t> scratch;
+    if (!make_encode_scratch(bench, pool, scratch)) return 1;
+    double total_encode_into_us = time_encode_into_pass(bench, pool, iterations, scratch);
+
+    // 4. Decode Latency (Batch Timing)
+    // Pre-encode the pool into one contiguous arena so we have valid inputs
+    EncodedArena encoded_pool = build_encoded_arena(bench, pool);
+
+    start_metrics(metrics);
+    double total_decode_us = time_decode_pass<PayloadT>(bench, encoded_pool, iterations);
+    std::map<std::string, double> decode_counters = stop_metrics(metrics);
     auto t4 = high_resolution_clock::now();
-    double total_decode_us = duration_cast<nanoseconds>(t4 - t3).count() / 1000.0;
+
+    // 4b. Access Latency (optional): decode_fields() for the --access fields, then read them
+    double total_access_us = 0;
+    if (access_mask) total_access_us = time_access_pass<PayloadT>(bench, encoded_pool, iterations, access_mask);
 
     double total_wall_ms = duration_cast<milliseconds>(t4 - t1).count();
 
     std::cout << "TOTAL_TIME_MS=" << total_wall_ms << std::endl;
     std::cout << "AVG_ENCODE_US=" << (total_encode_us/iterations) << std::endl;
+    std::cout << "AVG_ENCODE_INTO_US=" << (total_encode_into_us/iterations) << std::endl;
     std::cout << "AVG_DECODE_US=" << (total_decode_us/iterations) << std::endl;
-    std::cout << "SERIALIZED_SIZE=" << encoded_pool[0].size() << std::endl; // Sample
+    if (access_mask) {
+        std::cout << "ACCESS_FIELDS=" << access_names << std::endl;
+        std::cout << "ACCESS_FIELD_COUNT=" << __builtin_popcountll(access_mask) << std::endl;
+        std::cout << "AVG_ACCESS_US=" << (total_access_us/iterations) << std::endl;
+    }
+    std::cout << "SERIALIZED_SIZE=" << encoded_pool.size(0) << std::endl; // Sample
+    print_metric_results("ENCODE", encode_counters, iterations);
+    print_metric_results("DECODE", decode_counters, iterations);
 
-    bench->teardown();
-    bench.reset();
-    dlclose(handle);
+    // 5. Tail Latency (optional, separate pass so it cannot skew the averages above)
+    if (opts.latency_sample > 0) {
+        run_latency_sampling(bench, pool, encoded_pool, iterations, opts.latency_sample);
+    }
     return 0;
 }
 
 template <typename PayloadT>
-int run_memory_benchmark(int argc, char** argv) {
-    if (argc < 4) {
-        std::cerr << "Usage: " << argv[0] << " --memory <plugin_path> <variant_name> <iterations>" << std::endl;
+int run_time_benchmark(int argc, char** argv) {
+     if (argc < 4) { 
+        std::cerr << "Usage: " << argv[0] << " <plugin_path> <variant_name> <iterations> [--batch N] [--latency-sample K] [--threads N] [--data uniform|flight|replay] [--corpus FILE] [--cache-mode hot|cold|flushed] [--trials K] [--target-ci PCT] [--max-trials N] [--access FIELDS]" << std::endl;
         return 1;
     }
+
     std::string plugin_path = argv[1];
     std::string variant_name = argv[2];
     size_t iterations = std::stoull(argv[3]);
 
+    RunnerOptions opts;
+    if (!parse_runner_options(argc, argv, 4, opts)) return 1;
+    if (!opts.corpus.empty() && (opts.batch > 0 || opts.threads > 0)) {
+        std::cerr << "--corpus cannot be combined with --batch or --threads" << std::endl;
+        return 1;
+    }
+    if (opts.cache != CacheMode::Hot && (opts.batch > 0 || opts.threads > 0 || !opts.corpus.empty())) {
+        std::cerr << "--cache-mode " << cache_mode_name(opts.cache) << " cannot be combined with --batch, --threads or --corpus" << std::endl;
+        return 1;
+    }
+    if (opts.repeated() && (opts.batch > 0 || opts.threads > 0 || !opts.corpus.empty() || opts.cache == CacheMode::Flushed)) {
+        std::cerr << "--trials/--target-ci cannot be combined with --batch, --threads, --corpus or --cache-mode flushed" << std::endl;
+        return 1;
+    }
+    if (!opts.access.empty() && (opts.batch > 0 || opts.threads > 0 || !opts.corpus.empty() ||
+                                 opts.cache == CacheMode::Flushed || opts.repeated())) {
+        std::cerr << "--access cannot be combined with --batch, --threads, --corpus, --cache-mode flushed or --trials/--target-ci" << std::endl;
+        return 1;
+    }
+
     void* handle = dlopen(plugin_path.c_str(), RTLD_LAZY);
     if (!handle) { std::cerr << "DLOPEN ERR: " << dlerror() << std::endl; return 1; }
+
     CreateBenchmarkFunc create = (CreateBenchmarkFunc) dlsym(handle, "create_benchmark");
     if (!create) { std::cerr << "DLSYM ERR: " << dlerror() << std::endl; return 1; }
 
-    std::unique_ptr<pf::IBenchmark> bench(create());
-    pf::BenchmarkConfig config;
-    config.iterations = iterations;
-    config.variant_name = variant_name;
-    config.warm_up = true;
-    bench->setup(config);
+    if (opts.threads > 0) {
+        int rc = run_thread_benchmark<PayloadT>(create, variant_name, iterations, opts.threads, opts.data);
+        dlclose(handle);
+        return rc;
+    }
+
+    std::unique_ptr<pf::IBenchmark> bench = create_configured(create, variant_name, iterations);
+    int rc = run_time_cell<PayloadT>(*bench, iterations, opts);
+
+    bench->teardown();
+    bench.reset();
+    dlclose(handle);
+    return rc;
+}
 
+// Heap/RSS measurement for one configured benchmark instance. Deltas are taken
+// against a baseline read inside this function, so callers can run it repeatedly.
+template <typename PayloadT>
+int run_memory_cell(pf::IBenchmark& bench, size_t iterations, const RunnerOptions& opts) {
     // Pool
-    std::vector<PayloadT> pool(POOL_SIZE);
-    for(int i=0; i<POOL_SIZE; i++) pool[i] = generate_random_data<PayloadT>();
+    std::vector<PayloadT> pool = make_payload_pool<PayloadT>(opts.data);
+
+    // With --corpus, the warm loop streams the capture file instead of the pool.
+    CaptureStream<PayloadT> corpus;
+    if (!opts.corpus.empty()) {
+        std::string err = corpus.open(opts.corpus);
+        if (!err.empty()) {
+            std::cerr << "CORPUS ERR: " << err << std::endl;
+            return 1;
+        }
+    }
+    auto warm_payload = [&](size_t i) -> const PayloadT& {
+        return opts.corpus.empty() ? pool[i % POOL_SIZE] : corpus.next();
+    };
 
     // 1. Cold Start
     size_t cold_start_heap = get_allocated_mem();
     {
-        auto b = bench->encode(&pool[0]);
+        auto b = bench.encode(&pool[0]);
         PayloadT d;
-        bench->decode(b, &d);
+        bench.decode(b, &d);
     }
     size_t cold_end_heap = get_allocated_mem();
     long cold_delta = (long)cold_end_heap - (long)cold_start_heap;
 
     // 2. Warmup
     for(int i=0; i<100; i++) {
-        auto b = bench->encode(&pool[i % POOL_SIZE]);
+        auto b = bench.encode(&pool[i % POOL_SIZE]);
         PayloadT d;
-        bench->decode(b, &d);
+        bench.decode(b, &d);
     }
 
     // 3. Warm Measurement
     size_t warm_start_heap = get_allocated_mem();
     std::vector<uint8_t> buffer;
     for(size_t i=0; i<iterations; i++) {
-        buffer = bench->encode(&pool[i % POOL_SIZE]);
+        buffer = bench.encode(&warm_payload(i));
         PayloadT d;
-        bench->decode(buffer, &d);
+        bench.decode(buffer, &d);
     }
     size_t warm_end_heap = get_allocated_mem();
     long warm_total_delta = (long)warm_end_heap - (long)warm_start_heap;
@@ -332,11 +1219,58 @@ int run_memory_benchmark(int argc, char** argv) {
     std::cout << "MALLOC_DELTA_WARM=" << warm_total_delta << std::endl;
     std::cout << "SERIALIZED_SIZE=" << ser_size << std::endl;
 
+    // 4. Allocation Profile: only when libpf_alloc_profiler.so is preloaded.
+    // The deltas above miss everything freed inside the loop (returned vectors,
+    // decoder scratch); the shim counts each call. Runs after the peak RSS read.
+    AllocProfiler profiler;
+    if (profiler.available()) {
+        EncodedArena encoded_pool = build_encoded_arena(bench, pool);
+        volatile size_t sink = 0;
+
+        profiler.clear_sites();
+        profiler.reset();
+        for(size_t i=0; i<iterations; i++) sink += bench.encode(&pool[i % POOL_SIZE]).size();
+        AllocProfiler::print("ENCODE", profiler.read(), iterations);
+        profiler.dump_sites("ENCODE");
+
+        profiler.reset();
+        for(size_t i=0; i<iterations; i++) {
+            const size_t k = i % POOL_SIZE;
+            PayloadT d;
+            bench.decode(encoded_pool.data(k), encoded_pool.size(k), &d);
+        }
+        AllocProfiler::print("DECODE", profiler.read(), iterations);
+        profiler.dump_sites("DECODE");
+    }
+    return 0;
+}
+
+template <typename PayloadT>
+int run_memory_benchmark(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " --memory <plugin_path> <variant_name> <iterations> [--data MODE] [--corpus FILE]" << std::endl;
+        return 1;
+    }
+    std::string plugin_path = argv[1];
+    std::string variant_name = argv[2];
+    size_t iterations = std::stoull(argv[3]);
+
+    RunnerOptions opts; // Only --data and --corpus apply here
+    if (!parse_runner_options(argc, argv, 4, opts)) return 1;
+
+    void* handle = dlopen(plugin_path.c_str(), RTLD_LAZY);
+    if (!handle) { std::cerr << "DLOPEN ERR: " << dlerror() << std::endl; return 1; }
+    CreateBenchmarkFunc create = (CreateBenchmarkFunc) dlsym(handle, "create_benchmark");
+    if (!create) { std::cerr << "DLSYM ERR: " << dlerror() << std::endl; return 1; }
+
+    std::unique_ptr<pf::IBenchmark> bench = create_configured(create, variant_name, iterations);
+    int rc = run_memory_cell<PayloadT>(*bench, iterations, opts);
+
     bench->teardown();
     bench.reset();
     dlclose(handle);
-    return 0;
-} 
+    return rc;
+}
 
 template <typename PayloadT>
 int run_benchmark_template(int argc, char** argv) {
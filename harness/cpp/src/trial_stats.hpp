@@ -0,0 +1,80 @@
+#ifndef TRIAL_STATS_HPP
+#define TRIAL_STATS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace pf {
+
+/**
+ * @brief Robust summary of repeated trials (--trials / --target-ci).
+ * Trials further than kOutlierMads scaled MADs from the median are dropped.
+ * A preempted or migrated trial lands far out on the slow side. The median
+ * and its bootstrap 95% CI come from the trials that remain.
+ */
+struct TrialSummary {
+    double median = 0;
+    double ci_low = 0;
+    double ci_high = 0;
+    double mad = 0;     // Median absolute deviation of all trials, scaled by 1.4826 (sigma for normal data)
+    size_t kept = 0;
+    size_t rejected = 0;
+
+    // CI half-width as a percentage of the median
+    double half_width_pct() const { return median > 0 ? (ci_high - ci_low) / 2.0 / median * 100.0 : 0.0; }
+};
+
+constexpr double kOutlierMads = 3.0;
+constexpr double kMadToSigma = 1.4826;
+constexpr size_t kBootstrapResamples = 2000;
+
+// Median of v; reorders v.
+inline double median_of(std::vector<double>& v) {
+    if (v.empty()) return 0;
+    const size_t mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    double m = v[mid];
+    if (v.size() % 2 == 0) m = (m + *std::max_element(v.begin(), v.begin() + mid)) / 2.0;
+    return m;
+}
+
+inline TrialSummary summarize_trials(const std::vector<double>& trials) {
+    TrialSummary s;
+    if (trials.empty()) return s;
+
+    std::vector<double> work(trials);
+    const double center = median_of(work);
+    for (double& x : work) x = std::fabs(x - center);
+    s.mad = median_of(work) * kMadToSigma;
+
+    std::vector<double> kept;
+    for (double x : trials) {
+        if (s.mad > 0 && std::fabs(x - center) > kOutlierMads * s.mad) s.rejected++;
+        else kept.push_back(x);
+    }
+    s.kept = kept.size();
+    s.median = median_of(kept);
+
+    // Percentile bootstrap of the median. A fixed seed keeps reruns over the
+    // same trials identical and leaves the payload generator's `gen` alone.
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, kept.size() - 1);
+    std::vector<double> medians(kBootstrapResamples);
+    std::vector<double> resample(kept.size());
+    for (double& m : medians) {
+        for (double& x : resample) x = kept[pick(rng)];
+        m = median_of(resample);
+    }
+    std::sort(medians.begin(), medians.end());
+    s.ci_low = medians[(size_t)(0.025 * (kBootstrapResamples - 1))];
+    s.ci_high = medians[(size_t)(0.975 * (kBootstrapResamples - 1))];
+    return s;
+}
+
+} // namespace pf
+
+#endif // TRIAL_STATS_HPP
@@ -6,24 +6,54 @@ import time
 import datetime
 import platform
 import glob
+import struct
+import csv
 
 # ==============================================================================
 # Configuration
 # ==============================================================================
 SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
 PROJECT_ROOT = os.path.dirname(SCRIPT_DIR)
-BUILD_DIR = os.path.join(PROJECT_ROOT, "build")
+# PF_BUILD_DIR points the runner at another build tree (e.g. one configured with -DPF_OPTIMIZE=ON)
+BUILD_DIR = os.path.abspath(os.environ.get("PF_BUILD_DIR", os.path.join(PROJECT_ROOT, "build")))
 BIN_DIR = os.path.join(BUILD_DIR, "bin")
 RESULTS_DIR = os.path.join(PROJECT_ROOT, "results", "raw")
 
 ITERATIONS = int(os.environ.get("BENCHMARK_ITERATIONS", "1000000"))
+DATA_MODE = "uniform"  # --data: payload distribution passed to every runner
+CORPORA = {}           # --corpus: scenario -> capture file streamed instead of the payload pool
+CACHE_MODES = ["hot"]  # --cache-modes: each time runner runs once per mode (--cache-mode)
+TRIAL_ARGS = []        # --trials / --target-ci / --max-trials, passed through to the time runners
+ACCESS_ARGS = []       # --access K, passed through to the time runners
+ALLOC_SITES = 0        # --alloc-sites N: sample every N-th allocation's call site (0 = off)
 
-MATRIX = {
-    "libpf_json.so": ["Standard", "Canonical", "Base64"],
-    "libpf_cbor.so": ["Standard", "StringKeys"],
-    "libpf_msgpack.so": ["Standard", "StringKeys"],
-    "libpf_protobuf.so": ["Standard"]
-}
+def alloc_profiler_env():
+    """Environment preloading libpf_alloc_profiler.so for memory runs, or None if it was not built."""
+    shim = os.path.join(BIN_DIR, "libpf_alloc_profiler.so")
+    if not os.path.exists(shim):
+        return None
+    env = dict(os.environ)
+    env["LD_PRELOAD"] = shim
+    if ALLOC_SITES > 0:
+        env["PF_ALLOC_SITES"] = str(ALLOC_SITES)
+    return env
+
+# CaptureType ids of capture_file.hpp, in header order
+CAPTURE_SCENARIOS = {1: "GPSRaw", 2: "GlobalPosition", 3: "Odometry", 4: "Attitude", 5: "Battery", 6: "Status", 7: "GPSBlock"}
+
+def capture_scenario(path):
+    """Scenario recorded in a .pfcap header (magic, version, type, ...), or None."""
+    try:
+        with open(path, "rb") as f:
+            header = f.read(32)
+    except OSError:
+        return None
+    if len(header) < 32 or header[:8] != b"PFCAP\0\0\0":
+        return None
+    return CAPTURE_SCENARIOS.get(struct.unpack_from("<I", header, 12)[0])
+
+def corpus_args(scenario):
+    return ["--corpus", CORPORA[scenario]] if scenario in CORPORA else []
 
 # ==============================================================================
 # Helper Functions
@@ -60,6 +90,17 @@ def get_env_info():
 
     return info
 
+def get_build_opt():
+    """Reports which codegen the plugins were built with, from the build's CMakeCache.txt."""
+    try:
+        with open(os.path.join(BUILD_DIR, "CMakeCache.txt")) as f:
+            for line in f:
+                if line.startswith("PF_OPTIMIZE:"):
+                    return "-O2" if line.strip().split("=", 1)[1].upper() in ("ON", "1", "TRUE", "YES") else "-O0 -g"
+    except OSError:
+        return "unknown"
+    return "-O0 -g"
+
 def parse_metrics(output_bytes):
     metrics = {}
     lines = output_bytes.decode().splitlines()
@@ -82,29 +123,80 @@ import argparse
 # ==============================================================================
 # Main Logic
 # ==============================================================================
-def run_benchmark_set(runner_bin, plugin_path, variant, run_dir, cpu_pin):
+# Tail-latency keys printed by the time runner with --latency-sample K
+LATENCY_KEYS = [
+    ("ENCODE_P50_US", "EncodeP50(us)"), ("ENCODE_P90_US", "EncodeP90(us)"), ("ENCODE_P99_US", "EncodeP99(us)"),
+    ("ENCODE_P999_US", "EncodeP99.9(us)"), ("ENCODE_MAX_US", "EncodeMax(us)"),
+    ("DECODE_P50_US", "DecodeP50(us)"), ("DECODE_P90_US", "DecodeP90(us)"), ("DECODE_P99_US", "DecodeP99(us)"),
+    ("DECODE_P999_US", "DecodeP99.9(us)"), ("DECODE_MAX_US", "DecodeMax(us)"),
+]
+
+# Repetition keys printed by the time runner with --trials K or --target-ci PCT
+TRIAL_KEYS = [("TRIALS", "Trials")]
+for _phase, _label in (("ENCODE", "Encode"), ("ENCODE_INTO", "EncodeInto"), ("DECODE", "Decode")):
+    TRIAL_KEYS += [
+        (f"{_phase}_CI_LOW_US", f"{_label}CILow(us)"),
+        (f"{_phase}_CI_HIGH_US", f"{_label}CIHigh(us)"),
+        (f"{_phase}_MAD_US", f"{_label}MAD(us)"),
+        (f"{_phase}_OUTLIERS", f"{_label}Outliers"),
+    ]
+
+# Partial-read keys printed by the time runner with --access K
+ACCESS_KEYS = [("ACCESS_FIELD_COUNT", "AccessFields"), ("AVG_ACCESS_US", "AvgAccess(us)")]
+
+# Allocation keys printed by the memory runner under libpf_alloc_profiler.so
+ALLOC_KEYS = []
+for _phase, _label in (("ENCODE", "Encode"), ("DECODE", "Decode")):
+    ALLOC_KEYS += [
+        (f"ALLOCS_PER_{_phase}", f"AllocsPer{_label}"),
+        (f"ALLOC_BYTES_PER_{_phase}", f"AllocBytesPer{_label}"),
+        (f"PEAK_LIVE_BYTES_{_phase}", f"PeakLiveBytes{_label}"),
+    ]
+
+# Hardware/software counter keys printed by the time runner (PerfCounterMetric).
+# Counters the host cannot open (no PMU, perf_event_paranoid) are reported as NA.
+PERF_KEYS = []
+for _phase, _label in (("ENCODE", "Encode"), ("DECODE", "Decode")):
+    PERF_KEYS += [
+        (f"{_phase}_IPC", f"{_label}IPC"),
+        (f"{_phase}_CYCLES_PER_MSG", f"{_label}Cycles/msg"),
+        (f"{_phase}_INSTRUCTIONS_PER_MSG", f"{_label}Instr/msg"),
+        (f"{_phase}_BRANCH_MISSES_PER_MSG", f"{_label}BranchMiss/msg"),
+        (f"{_phase}_L1D_MISSES_PER_MSG", f"{_label}L1dMiss/msg"),
+        (f"{_phase}_LLC_MISSES_PER_MSG", f"{_label}LLCMiss/msg"),
+        (f"{_phase}_TASK_CLOCK_NS_PER_MSG", f"{_label}TaskClock(ns/msg)"),
+        (f"{_phase}_PAGE_FAULTS_PER_MSG", f"{_label}PageFaults/msg"),
+    ]
+
+def run_benchmark_set(runner_bin, plugin_path, variant, run_dir, cpu_pin, latency_sample=0):
     if not os.path.exists(plugin_path):
         print(f"⚠️  Plugin {plugin_path} not found. Skipping.")
         return False
         
     plugin_name = os.path.basename(plugin_path)
+    corpus = corpus_args(describe_plugin(plugin_name)[0])
     
-    # 1. Run Time Benchmark (Unified Runner Default)
-    print(f"   ⏳ [Time]   {plugin_name} [{variant}] ...", end="", flush=True)
-    cmd_time = ["taskset", "-c", str(cpu_pin), runner_bin, plugin_path, variant, str(ITERATIONS)]
-    try:
-        out_time = subprocess.check_output(cmd_time, stderr=subprocess.STDOUT)
-        time_metrics = parse_metrics(out_time)
-        print(" Done.")
-    except Exception as e:
-        print(f" Failed: {e}")
-        return False
+    # 1. Run Time Benchmark (Unified Runner Default), once per cache mode
+    time_metrics = {}
+    for mode in CACHE_MODES:
+        print(f"   ⏳ [Time]   {plugin_name} [{variant}] ({mode}) ...", end="", flush=True)
+        cmd_time = ["taskset", "-c", str(cpu_pin), runner_bin, plugin_path, variant, str(ITERATIONS),
+                    "--data", DATA_MODE, "--cache-mode", mode] + corpus + TRIAL_ARGS + ACCESS_ARGS
+        if latency_sample > 0:
+            cmd_time += ["--latency-sample", str(latency_sample)]
+        try:
+            out_time = subprocess.check_output(cmd_time, stderr=subprocess.STDOUT)
+            time_metrics[mode] = parse_metrics(out_time)
+            print(" Done.")
+        except Exception as e:
+            print(f" Failed: {e}")
+            return False
 
     # 2. Run Memory Benchmark (Unified Runner --memory)
     print(f"   🧠 [Memory] {plugin_name} [{variant}] ...", end="", flush=True)
-    cmd_mem = ["taskset", "-c", str(cpu_pin), runner_bin, "--memory", plugin_path, variant, str(ITERATIONS)]
+    cmd_mem = ["taskset", "-c", str(cpu_pin), runner_bin, "--memory", plugin_path, variant, str(ITERATIONS), "--data", DATA_MODE] + corpus
     try:
-        out_mem = subprocess.check_output(cmd_mem, stderr=subprocess.STDOUT)
+        out_mem = subprocess.check_output(cmd_mem, stderr=subprocess.STDOUT, env=alloc_profiler_env())
         mem_metrics = parse_metrics(out_mem)
         print(" Done.")
     except Exception as e:
@@ -112,76 +204,363 @@ def run_benchmark_set(runner_bin, plugin_path, variant, run_dir, cpu_pin):
         return False
         
     # 3. Aggregate
+    scenario, fmt = describe_plugin(plugin_name)
+    for mode in CACHE_MODES:
+        append_raw_result(run_dir, scenario, fmt, variant, mode, time_metrics[mode], mem_metrics)
+    return True
+
+def append_raw_result(run_dir, scenario, fmt, variant, cache_mode, time_metrics, mem_metrics):
+    """One raw_results.csv row; shared by the per-process and in-process (pf_matrix) modes."""
     # Format, Variant, Iterations, Time, Encode, Decode, Size, RSS, Heap
-    
     csv_path = os.path.join(run_dir, "raw_results.csv")
     write_header = not os.path.exists(csv_path)
     
     with open(csv_path, "a") as f:
         if write_header:
-            f.write("Scenario,Format,Variant,Iterations,TotalTime(ms),AvgEncode(us),AvgDecode(us),Size(bytes),PeakRSS(KB),MallocDeltaCold(bytes),MallocDeltaWarm(bytes)\n")
-        
-        # Determine Format Name
-        # libpf_json.so -> JSON
-        # libpf_json_battery.so -> JSON
-        base = plugin_name.replace("libpf_", "").replace(".so", "")
-        # base is e.g. "json", "json_battery"
-        # Split by underscore?
-        if "_" in base and not base in ["msgpack", "protobuf"]: # care! msgpack has no underscore but might if msg_pack? No.
-             # e.g. json_battery -> format=json, scenario=battery
-             # But msgpack -> format=msgpack
-             parts = base.split("_")
-             fmt = parts[0].upper()
-             # But wait, cbor_battery -> CBOR
-        else:
-             fmt = base.upper()
-
-        scenario = "Unknown"
-        if "battery" in plugin_name: scenario = "Battery"
-        elif "odometry" in plugin_name: scenario = "Odometry"
-        elif "attitude" in plugin_name: scenario = "Attitude"
-        elif "global_position" in plugin_name: scenario = "GlobalPosition"
-        elif "gps_block" in plugin_name: scenario = "GPSBlock"
-        elif "status" in plugin_name: scenario = "Status"
-        else: scenario = "GPSRaw"
+            f.write("Scenario,Format,Variant,CacheMode,Iterations,TotalTime(ms),AvgEncode(us),AvgEncodeInto(us),AvgDecode(us),Size(bytes),PeakRSS(KB),MallocDeltaCold(bytes),MallocDeltaWarm(bytes),"
+                    + ",".join(col for _, col in ALLOC_KEYS) + ","
+                    + ",".join(col for _, col in LATENCY_KEYS) + ","
+                    + ",".join(col for _, col in TRIAL_KEYS) + ","
+                    + ",".join(col for _, col in ACCESS_KEYS) + ","
+                    + ",".join(col for _, col in PERF_KEYS) + "\n")
 
         row = [
             scenario,
             fmt,
             variant,
+            cache_mode,
             str(ITERATIONS),
             time_metrics.get("TOTAL_TIME_MS", "0"),
             time_metrics.get("AVG_ENCODE_US", "0"),
+            time_metrics.get("AVG_ENCODE_INTO_US", "0"),
             time_metrics.get("AVG_DECODE_US", "0"),
             mem_metrics.get("SERIALIZED_SIZE", "0"),
             mem_metrics.get("PEAK_RSS_KB", "0"),
             mem_metrics.get("MALLOC_DELTA_COLD", "0"),
             mem_metrics.get("MALLOC_DELTA_WARM", "0")
-        ]
+        ] + [mem_metrics.get(key, "NA") for key, _ in ALLOC_KEYS] \
+          + [time_metrics.get(key, "NA") for key, _ in LATENCY_KEYS] \
+          + [time_metrics.get(key, "1" if key == "TRIALS" else "NA") for key, _ in TRIAL_KEYS] \
+          + [time_metrics.get(key, "NA") for key, _ in ACCESS_KEYS] \
+          + [time_metrics.get(key, "NA") for key, _ in PERF_KEYS]
         f.write(",".join(row) + "\n")
-        
-    return True
+
+    if ALLOC_SITES > 0:
+        append_alloc_sites(run_dir, scenario, fmt, variant, mem_metrics)
+
+def append_alloc_sites(run_dir, scenario, fmt, variant, mem_metrics):
+    """alloc_sites.csv: the sampled call sites (<PHASE>_ALLOC_SITE_<i>) of one memory run."""
+    csv_path = os.path.join(run_dir, "alloc_sites.csv")
+    write_header = not os.path.exists(csv_path)
+    with open(csv_path, "a") as f:
+        if write_header:
+            f.write("Scenario,Format,Variant,Phase,Rank,Samples,Site\n")
+        for key, val in sorted(mem_metrics.items()):
+            phase, sep, rank = key.partition("_ALLOC_SITE_")
+            if not sep:
+                continue
+            samples, _, site = val.partition(" ")
+            f.write(",".join([scenario, fmt, variant, phase, rank, samples, '"' + site + '"']) + "\n")
+
+# raw_results.csv columns compared across cache modes in cache_results.csv
+CACHE_COMPARE_COLS = ["AvgEncode(us)", "AvgEncodeInto(us)", "AvgDecode(us)"]
+
+def write_cache_results(run_dir):
+    """cache_results.csv: each cell's raw_results.csv rows for the cache modes side by side."""
+    cells = {}
+    with open(os.path.join(run_dir, "raw_results.csv")) as f:
+        for row in csv.DictReader(f):
+            key = (row["Scenario"], row["Format"], row["Variant"])
+            cells.setdefault(key, {})[row["CacheMode"]] = row
+
+    with open(os.path.join(run_dir, "cache_results.csv"), "w") as f:
+        f.write(",".join(["Scenario", "Format", "Variant"]
+                         + [f"{col}[{mode}]" for col in CACHE_COMPARE_COLS for mode in CACHE_MODES]) + "\n")
+        for key, by_mode in cells.items():
+            row = list(key)
+            for col in CACHE_COMPARE_COLS:
+                row += [by_mode[mode][col] if mode in by_mode else "NA" for mode in CACHE_MODES]
+            f.write(",".join(row) + "\n")
+
+# Per-cell keys printed by pf_matrix outside the PHASE=MEMORY / PHASE=TIME sections
+MATRIX_CELL_KEYS = ("SCENARIO", "FORMAT", "VARIANT", "PLUGIN", "CELL_STATUS")
+
+def parse_matrix_cells(output_bytes):
+    """Split pf_matrix output into cells: dicts with "time"/"memory" metrics plus the cell keys."""
+    cells = []
+    cell = None
+    phase = None
+    for line in output_bytes.decode(errors="replace").splitlines():
+        line = line.strip()
+        if line == "CELL_BEGIN":
+            cell = {"memory": {}, "time": {}}
+            phase = None
+        elif line == "CELL_END":
+            if cell is not None:
+                cells.append(cell)
+            cell = None
+        elif cell is not None and "=" in line:
+            key, val = line.split("=", 1)
+            if key == "PHASE":
+                phase = val.lower()
+            elif key in MATRIX_CELL_KEYS or phase not in ("memory", "time"):
+                cell[key] = val
+            else:
+                cell[phase][key] = val
+    return cells
+
+def run_matrix_in_process(matrix_bin, run_dir, cpu_pin, latency_sample, formats, scenario=None, cache_mode="hot"):
+    """Whole matrix in one pf_matrix process (one dlopen per plugin, cache flush + heap trim between cells)."""
+    cmd = ["taskset", "-c", str(cpu_pin), matrix_bin, BUILD_DIR, str(ITERATIONS),
+           "--latency-sample", str(latency_sample), "--data", DATA_MODE, "--cache-mode", cache_mode] + TRIAL_ARGS + ACCESS_ARGS
+    if scenario:
+        cmd += ["--scenario", scenario]
+    for fmt, variants in formats.items():
+        cmd += ["--format", fmt, "--variants", f"{fmt}={','.join(variants)}"]
+    for path in CORPORA.values():
+        cmd += ["--corpus", path]
+    print(f"   ⏳ [Matrix] {os.path.basename(matrix_bin)} ({cache_mode}) ...", end="", flush=True)
+    # No allocation shim here: pf_matrix times cells in the same process, and the
+    # shim's counting would be inside every timed loop.
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    print(" Done." if result.returncode == 0 else f" Failed (exit {result.returncode}).")
+
+    # Keep whatever completed, even if a later cell aborted the process.
+    cells = parse_matrix_cells(result.stdout)
+    success = 0
+    for cell in cells:
+        label = f"{cell.get('SCENARIO')} {cell.get('FORMAT')} [{cell.get('VARIANT')}]"
+        if cell.get("CELL_STATUS") != "OK":
+            print(f"   ⚠️  {label} failed.")
+            continue
+        append_raw_result(run_dir, cell["SCENARIO"], cell["FORMAT"], cell["VARIANT"], cache_mode, cell["time"], cell["memory"])
+        success += 1
+    return success, len(cells)
+
+def describe_plugin(plugin_name):
+    """Map a plugin file name to (scenario, format), e.g. libpf_json_battery.so -> (Battery, JSON)."""
+    # Determine Format Name
+    # libpf_json.so -> JSON
+    # libpf_json_battery.so -> JSON
+    base = plugin_name.replace("libpf_", "").replace(".so", "")
+    # base is e.g. "json", "json_battery"
+    if "_" in base and not base in ["msgpack", "protobuf"]:
+        # e.g. json_battery -> format=json, scenario=battery
+        fmt = base.split("_")[0].upper()
+    else:
+        fmt = base.upper()
+
+    scenario = "Unknown"
+    if "battery" in plugin_name: scenario = "Battery"
+    elif "odometry" in plugin_name: scenario = "Odometry"
+    elif "attitude" in plugin_name: scenario = "Attitude"
+    elif "global_position" in plugin_name: scenario = "GlobalPosition"
+    elif "gps_block" in plugin_name: scenario = "GPSBlock"
+    elif "status" in plugin_name: scenario = "Status"
+    else: scenario = "GPSRaw"
+    return scenario, fmt
+
+def run_batch_sweep(runner_bin, plugin_path, variant, run_dir, cpu_pin, batch_sizes):
+    """Per-message encode/decode cost of encode_batch/decode_batch for each N (--batch N)."""
+    plugin_name = os.path.basename(plugin_path)
+    scenario, fmt = describe_plugin(plugin_name)
+    csv_path = os.path.join(run_dir, "batch_results.csv")
+    write_header = not os.path.exists(csv_path)
+
+    with open(csv_path, "a") as f:
+        if write_header:
+            f.write("Scenario,Format,Variant,Iterations,BatchSize,AvgEncode(us/msg),AvgDecode(us/msg),BatchBytes\n")
+        for n in batch_sizes:
+            print(f"   📦 [Batch {n}] {plugin_name} [{variant}] ...", end="", flush=True)
+            cmd = ["taskset", "-c", str(cpu_pin), runner_bin, plugin_path, variant, str(ITERATIONS), "--batch", str(n), "--data", DATA_MODE]
+            try:
+                metrics = parse_metrics(subprocess.check_output(cmd, stderr=subprocess.STDOUT))
+                print(" Done.")
+            except Exception as e:
+                print(f" Failed: {e}")
+                continue
+            row = [
+                scenario,
+                fmt,
+                variant,
+                str(ITERATIONS),
+                metrics.get("BATCH_SIZE", str(n)),
+                metrics.get("AVG_BATCH_ENCODE_US", "0"),
+                metrics.get("AVG_BATCH_DECODE_US", "0"),
+                metrics.get("AVG_BATCH_BYTES", "0")
+            ]
+            f.write(",".join(row) + "\n")
+
+def run_access_sweep(runner_bin, plugin_path, variant, run_dir, cpu_pin, access_counts):
+    """decode_fields() cost for the first K schema fields against the full decode (--access K)."""
+    plugin_name = os.path.basename(plugin_path)
+    scenario, fmt = describe_plugin(plugin_name)
+    csv_path = os.path.join(run_dir, "projection_results.csv")
+    write_header = not os.path.exists(csv_path)
+
+    with open(csv_path, "a") as f:
+        if write_header:
+            f.write("Scenario,Format,Variant,Iterations,Fields,LastField,AvgDecode(us),AvgAccess(us),Speedup\n")
+        seen = set()
+        for k in access_counts:
+            print(f"   🔎 [Access {k}] {plugin_name} [{variant}] ...", end="", flush=True)
+            cmd = ["taskset", "-c", str(cpu_pin), runner_bin, plugin_path, variant, str(ITERATIONS),
+                   "--access", str(k), "--data", DATA_MODE]
+            try:
+                metrics = parse_metrics(subprocess.check_output(cmd, stderr=subprocess.STDOUT))
+                print(" Done.")
+            except Exception as e:
+                print(f" Failed: {e}")
+                continue
+            # K past the field count selects every field again
+            fields = metrics.get("ACCESS_FIELD_COUNT", str(k))
+            if fields in seen:
+                continue
+            seen.add(fields)
+            decode = float(metrics.get("AVG_DECODE_US", "0"))
+            access = float(metrics.get("AVG_ACCESS_US", "0"))
+            row = [
+                scenario,
+                fmt,
+                variant,
+                str(ITERATIONS),
+                fields,
+                metrics.get("ACCESS_FIELDS", "").split(",")[-1],
+                f"{decode:.4f}",
+                f"{access:.4f}",
+                f"{decode / access:.2f}" if access > 0 else "0"
+            ]
+            f.write(",".join(row) + "\n")
+
+def run_thread_sweep(runner_bin, plugin_path, variant, run_dir, max_threads):
+    """Aggregate throughput for N = 1..max_threads plugin instances (--threads N)."""
+    plugin_name = os.path.basename(plugin_path)
+    scenario, fmt = describe_plugin(plugin_name)
+    csv_path = os.path.join(run_dir, "scaling_results.csv")
+    write_header = not os.path.exists(csv_path)
+    cpus = sorted(os.sched_getaffinity(0))
+
+    with open(csv_path, "a") as f:
+        if write_header:
+            f.write("Scenario,Format,Variant,Iterations,Threads,EncodeMsgs/s,DecodeMsgs/s,EncodeSpeedup,DecodeSpeedup,"
+                    "ThreadEncodeMean(us),ThreadEncodeMax(us),ThreadDecodeMean(us),ThreadDecodeMax(us)\n")
+        base_enc = base_dec = None
+        for n in range(1, max_threads + 1):
+            print(f"   🧵 [Threads {n}] {plugin_name} [{variant}] ...", end="", flush=True)
+            # One core per thread; the runner pins thread i to the i-th CPU of this mask.
+            mask = ",".join(str(c) for c in cpus[:n])
+            cmd = ["taskset", "-c", mask, runner_bin, plugin_path, variant, str(ITERATIONS), "--threads", str(n), "--data", DATA_MODE]
+            try:
+                metrics = parse_metrics(subprocess.check_output(cmd, stderr=subprocess.STDOUT))
+                print(" Done.")
+            except Exception as e:
+                print(f" Failed: {e}")
+                continue
+            enc = float(metrics.get("AGG_ENCODE_MSGS_PER_S", "0"))
+            dec = float(metrics.get("AGG_DECODE_MSGS_PER_S", "0"))
+            if base_enc is None:
+                base_enc, base_dec = enc, dec
+            row = [
+                scenario,
+                fmt,
+                variant,
+                str(ITERATIONS),
+                str(n),
+                f"{enc:.0f}",
+                f"{dec:.0f}",
+                f"{enc / base_enc:.3f}" if base_enc else "0",
+                f"{dec / base_dec:.3f}" if base_dec else "0",
+                metrics.get("THREAD_ENCODE_US_MEAN", "0"),
+                metrics.get("THREAD_ENCODE_US_MAX", "0"),
+                metrics.get("THREAD_DECODE_US_MEAN", "0"),
+                metrics.get("THREAD_DECODE_US_MAX", "0")
+            ]
+            f.write(",".join(row) + "\n")
 
 def main():
     parser = argparse.ArgumentParser(description="PrimeFusion Enhanced Benchmark Runner")
     parser.add_argument("--cpu-pin", type=str, default="0", help="CPU core(s) to pin the benchmark process to (default: 0)")
+    parser.add_argument("--latency-sample", type=int, default=0, help="Time every K-th op individually for p50/p90/p99/p99.9/max in an extra pass over all iterations (default: 0 = off)")
+    parser.add_argument("--thread-sweep", action="store_true", help="Also run --threads N for N = 1..nproc and write scaling_results.csv")
+    parser.add_argument("--batch-sizes", type=str, default="", help="Comma-separated batch sizes to sweep with --batch N (e.g. 1,4,16,64); writes batch_results.csv")
+    parser.add_argument("--data", choices=["uniform", "flight", "replay"], default="uniform",
+                        help="Payloads: uniform random over each field's full range, samples from simulated flights, or consecutive messages of one flight (default: uniform)")
+    parser.add_argument("--corpus", action="append", default=[], metavar="FILE",
+                        help="Capture file (pf_capture) to stream for its scenario instead of the payload pool; repeatable, one per scenario")
+    parser.add_argument("--cache-modes", type=str, default="hot",
+                        help="Comma-separated cache modes to time each cell in: hot (127-entry pool), cold (pool spanning 2x the LLC), "
+                             "flushed (input/output lines evicted before each op); with several, writes cache_results.csv (default: hot)")
+    parser.add_argument("--trials", type=int, default=0,
+                        help="Time each cell in K interleaved encode/encode_into/decode rounds; report the median, bootstrap 95%% CI and MAD (default: one pass)")
+    parser.add_argument("--target-ci", type=float, default=0, metavar="PCT",
+                        help="Repeat rounds until every CI half-width is below PCT%% of its median (at least 5 rounds, at most --max-trials)")
+    parser.add_argument("--max-trials", type=int, default=100, help="Round limit for --target-ci (default: 100)")
+    parser.add_argument("--access", type=int, default=0, metavar="K",
+                        help="Also time reading only the first K schema fields through decode_fields(); adds AccessFields/AvgAccess(us) (default: off)")
+    parser.add_argument("--access-sweep", type=str, default="", metavar="K1,K2,...",
+                        help="Comma-separated field counts to sweep with --access K (e.g. 1,2,4,8,64) over the plugins that project (GPSRaw and Odometry, ZeroCopy everywhere); writes projection_results.csv")
+    parser.add_argument("--alloc-sites", type=int, default=0, metavar="N",
+                        help="With libpf_alloc_profiler.so built, also sample every N-th allocation's call site into alloc_sites.csv (default: off)")
+    parser.add_argument("--in-process", action="store_true", help="Run the raw_results matrix inside one pf_matrix process instead of two runner processes per cell")
     args = parser.parse_args()
+    batch_sizes = [int(n) for n in args.batch_sizes.split(",") if n.strip()]
+    access_counts = [int(k) for k in args.access_sweep.split(",") if k.strip()]
+    if any(k <= 0 for k in access_counts):
+        parser.error("--access-sweep counts must be positive")
 
     print("=================================================================")
     print("     PrimeFusion Enhanced - Matrix Runner")
     print(f"     CPU Pinning: Core {args.cpu_pin}")
     print("=================================================================")
     
-    global ITERATIONS
+    global ITERATIONS, DATA_MODE, CACHE_MODES, TRIAL_ARGS, ACCESS_ARGS, ALLOC_SITES
+    ALLOC_SITES = args.alloc_sites
+    DATA_MODE = args.data
+    CACHE_MODES = [m.strip() for m in args.cache_modes.split(",") if m.strip()]
+    for mode in CACHE_MODES:
+        if mode not in ("hot", "cold", "flushed"):
+            parser.error(f"unknown cache mode {mode} (expected hot, cold or flushed)")
+    if args.corpus and CACHE_MODES != ["hot"]:
+        parser.error("--corpus streams its own records; it cannot be combined with --cache-modes other than hot")
+    if args.trials > 0 or args.target_ci > 0:
+        if args.corpus or "flushed" in CACHE_MODES:
+            parser.error("--trials/--target-ci cannot be combined with --corpus or the flushed cache mode")
+        TRIAL_ARGS = ["--trials", str(args.trials), "--target-ci", str(args.target_ci), "--max-trials", str(args.max_trials)]
+    if args.access > 0:
+        if args.corpus or "flushed" in CACHE_MODES or TRIAL_ARGS:
+            parser.error("--access cannot be combined with --corpus, the flushed cache mode or --trials/--target-ci")
+        ACCESS_ARGS = ["--access", str(args.access)]
+    for path in args.corpus:
+        scenario = capture_scenario(path)
+        if scenario is None:
+            parser.error(f"{path} is not a capture file")
+        CORPORA[scenario] = os.path.abspath(path)
     ITERATIONS = int(os.environ.get("BENCHMARK_ITERATIONS", "100000")) 
     run_dir = os.path.join(RESULTS_DIR, datetime.datetime.now().strftime("%Y-%m-%d_%H%M%S"))
     os.makedirs(run_dir, exist_ok=True)
     print(f"Results: {run_dir}")
     print(f"Iterations: {ITERATIONS}")
+    print(f"Data: {DATA_MODE}")
+    print(f"Cache modes: {', '.join(CACHE_MODES)}")
+    if TRIAL_ARGS:
+        print(f"Trials: {args.trials or 'auto'}" + (f" (target CI ±{args.target_ci}%)" if args.target_ci > 0 else ""))
+    if ACCESS_ARGS:
+        print(f"Access: first {args.access} fields")
+    for scenario, path in CORPORA.items():
+        print(f"Corpus ({scenario}): {path}")
     
     # Write Metadata
     meta = get_env_info()
     meta["cpu_pin"] = args.cpu_pin
+    meta["isolation"] = "in-process (pf_matrix)" if args.in_process else "per-process"
+    meta["build_opt"] = get_build_opt()
+    meta["data"] = DATA_MODE
+    meta["cache_modes"] = ",".join(CACHE_MODES)
+    meta["trials"] = " ".join(TRIAL_ARGS) if TRIAL_ARGS else "1"
+    meta["access_fields"] = str(args.access) if ACCESS_ARGS else "off"
+    meta["alloc_profiler"] = "on" if alloc_profiler_env() else "off (libpf_alloc_profiler.so not built)"
+    for scenario, path in CORPORA.items():
+        meta[f"corpus_{scenario}"] = path
     with open(os.path.join(run_dir, "metadata.txt"), "w") as f:
         for k, v in meta.items():
             f.write(f"{k}: {v}\n")
@@ -204,14 +583,44 @@ def main():
 
     # Define Formats and Variants
     FORMATS = {
-        "json": ["Standard", "Canonical", "Base64"],
-        "cbor": ["Standard"], # "StringKeys" removed for simplicity or add back? Add back if supported.
-        "msgpack": ["Standard"],
-        "protobuf": ["Standard"]
+        "json": ["Standard", "Canonical", "Base64", "Fast"],
+        "cbor": ["Standard", "Native"],
+        "msgpack": ["Standard", "Streaming"],
+        "protobuf": ["Standard", "Arena", "Reuse"],
+        "mavlink": ["Standard"],
+        "zerocopy": ["Standard"]
+    }
+    # Variants that only change something in a few scenarios
+    SCENARIO_VARIANTS = {
+        "Odometry": {"cbor": ["TypedArrays", "NativeTypedArrays"]},
+        "Battery": {"cbor": ["TypedArrays", "NativeTypedArrays"]},
+        # MsgPack and JSON also build a Columnar variant, left out until their
+        # integrity tests have run on a full build (DEV_KNOWLEDGE_BASE.md §40).
+        "GPSBlock": {f: ["Columnar"] for f in ("cbor", "protobuf")},
+    }
+    # Plugins whose decode_fields() reads less than decode() (DEV_KNOWLEDGE_BASE.md §48).
+    # --access-sweep skips the rest, where a projection is a full decode plus read-back;
+    # MAVLink GPSRaw stays in as that baseline.
+    PROJECTING_FORMATS = {"cbor", "json", "msgpack", "protobuf", "zerocopy"}
+    ACCESS_SWEEP_FORMATS = {
+        "GPSRaw": PROJECTING_FORMATS | {"mavlink"},
+        "Odometry": PROJECTING_FORMATS,
     }
-    # Note: Variants support depends on plugin implementation. 
-    # Current implementations mostly ignore variants except JSON?
-    # Let's keep "Standard" for all for now to ensure success.
+
+    if args.in_process:
+        matrix_bin = os.path.join(BIN_DIR, "pf_matrix")
+        if os.path.exists(matrix_bin):
+            for mode in CACHE_MODES:
+                m_ok, m_total = run_matrix_in_process(matrix_bin, run_dir, args.cpu_pin, args.latency_sample, FORMATS, cache_mode=mode)
+                success += m_ok
+                total += m_total
+                for s_name, extra in SCENARIO_VARIANTS.items():
+                    s_ok, s_total = run_matrix_in_process(matrix_bin, run_dir, args.cpu_pin, args.latency_sample, extra, s_name, mode)
+                    success += s_ok
+                    total += s_total
+        else:
+            print("⚠️  pf_matrix not found. Falling back to per-process runs.")
+            args.in_process = False
 
     for s_name, runner_name in SCENARIOS.items():
         runner_bin = os.path.join(BIN_DIR, runner_name)
@@ -247,12 +656,23 @@ def main():
                 
             plugin_path = found_plugins[0]
             
-            for variant in variants:
-                 if fmt != "json" and variant != "Standard": continue # Only JSON has variants impl currently?
-                 
-                 if run_benchmark_set(runner_bin, plugin_path, variant, run_dir, args.cpu_pin):
-                     success += 1
-                 total += 1
+            for variant in variants + SCENARIO_VARIANTS.get(s_name, {}).get(fmt, []):
+                 if not args.in_process:
+                     if run_benchmark_set(runner_bin, plugin_path, variant, run_dir, args.cpu_pin, args.latency_sample):
+                         success += 1
+                     total += 1
+
+                 if batch_sizes:
+                     run_batch_sweep(runner_bin, plugin_path, variant, run_dir, args.cpu_pin, batch_sizes)
+
+                 if access_counts and fmt in ACCESS_SWEEP_FORMATS.get(s_name, {"zerocopy"}):
+                     run_access_sweep(runner_bin, plugin_path, variant, run_dir, args.cpu_pin, access_counts)
+
+                 if args.thread_sweep:
+                     run_thread_sweep(runner_bin, plugin_path, variant, run_dir, len(os.sched_getaffinity(0)))
+
+    if len(CACHE_MODES) > 1 and os.path.exists(os.path.join(run_dir, "raw_results.csv")):
+        write_cache_results(run_dir)
 
     print(f"\nDone. {success}/{total} completed.")
 